@@ -11,20 +11,48 @@
 
 #include "flowgraph/detail/Types.hpp"
 #include "flowgraph/detail/AST.hpp"
+#include "flowgraph/detail/CompiledFlow.hpp"
 #include "flowgraph/detail/Parser.hpp"
+#include "flowgraph/detail/Profiler.hpp"
 #include "flowgraph/detail/Engine.hpp"
+#include "flowgraph/detail/FlowArchive.hpp"
+#include "flowgraph/detail/FlowCache.hpp"
+#include "flowgraph/detail/HotReload.hpp"
+#include "flowgraph/detail/CompletionQueue.hpp"
+#include "flowgraph/detail/Scheduler.hpp"
+#include "flowgraph/detail/Coroutine.hpp"
 
 namespace FlowGraph {
 
+/**
+ * @brief Outcome of FlowGraphEngine::loadDirectory()
+ */
+struct LibraryLoadResult {
+    std::vector<std::string> modules;   // loaded module names, e.g. "auth/login.flow"
+    std::vector<std::string> errors;    // all parse, validation and link errors
+    
+    bool success() const { return errors.empty(); }
+};
+
 /**
  * @brief Main FlowGraph engine for loading and executing flows with debugging support
  */
 class FlowGraphEngine {
 public:
+    FlowGraphEngine() = default;
+    FlowGraphEngine(const FlowGraphEngine&) = delete;
+    FlowGraphEngine& operator=(const FlowGraphEngine&) = delete;
+    
     /**
      * @brief Load a flow from file
+     *
+     * Loading a file whose contents have not changed returns the flow loaded
+     * before, sharing its compiled program.
+     *
      * @param filepath Path to the .flow file
      * @return Loaded flow ready for execution
+     * @throws FlowGraphError (IO) if the file cannot be read, (Parse) on syntax errors,
+     *         (Runtime) if it calls unregistered procedures (see setStrictProcedures())
      */
     Flow loadFlow(const std::string& filepath);
     
@@ -33,9 +61,96 @@ public:
      * @param content Flow content as string
      * @param name Optional name for the flow
      * @return Loaded flow ready for execution
+     * @throws FlowGraphError (Parse) on syntax errors, (Runtime) if it calls unregistered procedures
      */
     Flow parseFlow(const std::string& content, const std::string& name = "");
     
+    /**
+     * @brief Load every flow module below a directory
+     *
+     * All .flow and .flowc files are parsed and compiled in parallel, then
+     * registered as modules named by their path relative to the directory
+     * ("auth/login.flow"; a precompiled auth/login.flowc provides the same
+     * module, and is preferred over auth/login.flow next to it unless it is
+     * older than that source). A link step then checks every PROC reference in
+     * one pass: a reference ending in .flow must name a loaded module (relative
+     * to the calling module or to the directory) and is linked to it so the
+     * call runs natively, anything else must name a registered procedure.
+     * Errors of all modules are collected instead of stopping at the first one;
+     * modules that failed to load are not registered. Loaded modules are
+     * watched for hot reload (see enableHotReload()).
+     *
+     * @param directory Library root
+     * @param threadCount Number of loader threads (0 = hardware concurrency)
+     */
+    LibraryLoadResult loadDirectory(const std::string& directory, size_t threadCount = 0);
+    
+    /**
+     * @brief Find a module loaded by loadDirectory()
+     */
+    std::optional<Flow> getModule(const std::string& name) const { return engine_.findModule(name); }
+    
+    /**
+     * @brief Handle that follows reloads of a module loaded by loadDirectory()
+     */
+    std::optional<FlowHandle> getModuleHandle(const std::string& name) const { return reloader_.findModule(name); }
+    
+    /**
+     * @brief Load a flow file and watch it for hot reload
+     *
+     * The handle always refers to the latest version that loaded without
+     * errors; see FlowReloader.
+     *
+     * @throws FlowGraphError (IO) if the file cannot be read, (Parse) on syntax errors
+     */
+    FlowHandle watchFlow(const std::string& filepath) { return reloader_.watch(filepath); }
+    
+    /**
+     * @brief Check watched files for changes every interval and publish new versions in the background
+     *
+     * Use getReloader().poll() instead to reload at points of your choosing.
+     */
+    void enableHotReload(std::chrono::milliseconds interval = std::chrono::milliseconds(500)) { reloader_.start(interval); }
+    void disableHotReload() { reloader_.stop(); }
+    
+    /**
+     * @brief Watched flows and modules, and the hot-reload thread
+     */
+    FlowReloader& getReloader() { return reloader_; }
+    
+    /**
+     * @brief Write a flow in the binary .flowc format
+     *
+     * Precompiled flows load without lexing or parsing; loadFlow() accepts
+     * them as well.
+     *
+     * @throws FlowGraphError (IO) if the file cannot be written
+     */
+    void saveCompiled(const Flow& flow, const std::string& filepath);
+    
+    /**
+     * @brief Load a flow written by saveCompiled()
+     * @throws FlowGraphError (IO) if the file cannot be read, (Parse) if it is not a valid .flowc file,
+     *         (Runtime) if it calls unregistered procedures
+     */
+    Flow loadCompiled(const std::string& filepath);
+    
+    /**
+     * @brief Whether loading a flow that calls unregistered procedures fails (on by default)
+     * @see Engine::setStrictProcedures
+     */
+    void setStrictProcedures(bool strict) { engine_.setStrictProcedures(strict); }
+    
+    /**
+     * @brief Cache of loaded and parsed flows
+     */
+    FlowCache& getFlowCache() { return cache_; }
+    
+    /**
+     * @brief Profile every flow of this engine (see Engine::setProfiler)
+     */
+    void setProfiler(std::shared_ptr<Profiler> profiler) { engine_.setProfiler(std::move(profiler)); }
+    
     /**
      * @brief Register external procedure with full definition
      * @param name Procedure name
@@ -50,6 +165,14 @@ public:
      */
     void registerProcedure(const std::string& name, ExternalProcedure proc);
     
+    /**
+     * @brief Register a procedure whose concurrent calls are coalesced into batches
+     * @see Engine::registerBatchedProcedure
+     */
+    void registerBatchedProcedure(const std::string& name, const BatchedProcDefinition& procDef) {
+        engine_.registerBatchedProcedure(name, procDef);
+    }
+    
     /**
      * @brief Register legacy synchronous external procedure (for backward compatibility)
      * @param name Procedure name
@@ -57,6 +180,14 @@ public:
      */
     void registerLegacyProcedure(const std::string& name, LegacyExternalProcedure proc);
     
+    /**
+     * @brief Register a compile-time procedure dispatched without type erasure
+     * @tparam Fn Async or legacy procedure function (see Engine::registerProcedure<Fn>)
+     * @param name Procedure name
+     */
+    template<auto Fn>
+    void registerProcedure(const std::string& name) { engine_.registerProcedure<Fn>(name); }
+    
     /**
      * @brief Get procedure implementation for testing purposes
      * @param name Procedure name
@@ -102,8 +233,9 @@ public:
     );
     
 private:
-    Parser parser_;
     Engine engine_;
+    FlowCache cache_{engine_};
+    FlowReloader reloader_{cache_, engine_};  // declared last: its thread stops before the cache goes away
 };
 
 /**
@@ -116,16 +248,174 @@ ExecutionResult executeFlow(const std::string& filepath, const ParameterMap& par
 
 // Inline implementations for FlowGraphEngine methods
 
+inline Flow FlowGraphEngine::loadFlow(const std::string& filepath) {
+    Flow flow = cache_.loadFile(filepath);
+    engine_.checkProcedures(flow);
+    return flow;
+}
+
+inline Flow FlowGraphEngine::parseFlow(const std::string& content, const std::string& name) {
+    Flow flow = cache_.parse(content, name);
+    engine_.checkProcedures(flow);
+    return flow;
+}
+
+inline LibraryLoadResult FlowGraphEngine::loadDirectory(const std::string& directory, size_t threadCount) {
+    namespace fs = std::filesystem;
+    LibraryLoadResult result;
+    
+    struct Module {
+        std::string name;
+        std::string path;
+        std::optional<Flow> flow;
+        std::vector<std::string> errors;
+    };
+    std::vector<Module> modules;
+    std::unordered_map<std::string, size_t> byName;
+    
+    std::error_code error;
+    fs::recursive_directory_iterator it(directory, error), end;
+    if (error) {
+        result.errors.push_back(directory + ": cannot read directory: " + error.message());
+        return result;
+    }
+    for (; it != end; it.increment(error)) {
+        if (error) {
+            result.errors.push_back(directory + ": " + error.message());
+            break;
+        }
+        const fs::path& path = it->path();
+        if (!it->is_regular_file() || (path.extension() != ".flow" && path.extension() != ".flowc")) {
+            continue;
+        }
+        std::string name = path.lexically_relative(directory).replace_extension(".flow").generic_string();
+        auto inserted = byName.emplace(name, modules.size());
+        if (!inserted.second) {
+            Module& existing = modules[inserted.first->second];
+            fs::path other(existing.path);
+            if (other.extension() == path.extension()) {
+                result.errors.push_back(name + ": module provided by both " + existing.path + " and " +
+                                        path.string());
+                continue;
+            }
+            // x.flow next to its x.flowc: take the archive unless it is older than the source
+            const fs::path& archive = path.extension() == ".flowc" ? path : other;
+            const fs::path& source = path.extension() == ".flowc" ? other : path;
+            std::error_code archiveError, sourceError;
+            auto archiveTime = fs::last_write_time(archive, archiveError);
+            auto sourceTime = fs::last_write_time(source, sourceError);
+            bool current = !archiveError && !sourceError && archiveTime >= sourceTime;
+            existing.path = (current ? archive : source).string();
+            continue;
+        }
+        modules.push_back(Module{name, path.string(), std::nullopt, {}});
+    }
+    std::sort(modules.begin(), modules.end(), [](const Module& a, const Module& b) { return a.name < b.name; });
+    
+    // Parse and compile in parallel; FlowCache is thread-safe and uses a parser per load
+    if (threadCount == 0) {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, modules.size());
+    std::atomic<size_t> nextModule{0};
+    auto worker = [&]() {
+        for (size_t i = nextModule.fetch_add(1, std::memory_order_relaxed); i < modules.size();
+             i = nextModule.fetch_add(1, std::memory_order_relaxed)) {
+            Module& module = modules[i];
+            try {
+                module.flow = cache_.loadFile(module.path);
+                const CompiledFlow& program = module.flow->getProgram();
+                for (const auto& message : program.ast().validate()) {
+                    module.errors.push_back(module.name + ": " + message);
+                }
+                for (const auto& message : program.diagnostics()) {
+                    module.errors.push_back(module.name + ": " + message);
+                }
+            } catch (const FlowGraphError& e) {
+                std::string where = module.name;
+                if (e.location() && e.location()->line > 0) {
+                    where += ":" + std::to_string(e.location()->line) + ":" + std::to_string(e.location()->column);
+                }
+                module.errors.push_back(where + ": " + e.what());
+                module.flow.reset();
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    for (auto& module : modules) {
+        if (module.flow) {
+            engine_.registerModule(module.name, *module.flow);
+            reloader_.watch(module.path, *module.flow, module.name);
+            result.modules.push_back(module.name);
+        }
+    }
+    
+    // Link: module calls are bound to the registered callees, every other PROC
+    // must name a registered procedure
+    for (auto& module : modules) {
+        if (!module.flow) {
+            continue;
+        }
+        module.flow->linkModules(module.name);
+        const CompiledFlow& program = module.flow->getProgram();
+        for (NodeIndex i = 0; i < program.nodeCount(); ++i) {
+            const CompiledNode& node = program.node(i);
+            if (node.kind != NodeKind::Proc) {
+                continue;
+            }
+            const std::string& target = node.asProc().procedureName;
+            bool isModule = fs::path(target).extension() == ".flow";
+            if (isModule ? engine_.resolveModuleName(module.name, target).empty() : !engine_.hasProcedure(target)) {
+                module.errors.push_back(module.name + ": " + (isModule ? "Module not found: " : "Procedure not found: ") +
+                                        target + " (node " + node.source->id + ")");
+            }
+        }
+    }
+    
+    for (auto& module : modules) {
+        result.errors.insert(result.errors.end(), module.errors.begin(), module.errors.end());
+    }
+    return result;
+}
+
+inline void FlowGraphEngine::saveCompiled(const Flow& flow, const std::string& filepath) {
+    FlowArchive::save(flow.getProgram().ast(), filepath);
+}
+
+inline Flow FlowGraphEngine::loadCompiled(const std::string& filepath) {
+    Flow flow = cache_.loadCompiledFile(filepath);
+    engine_.checkProcedures(flow);
+    return flow;
+}
+
+inline std::unique_ptr<DebugExecutionContext> FlowGraphEngine::loadFlowForDebugging(
+    const std::string& filepath, const ParameterMap& params) {
+    return loadFlow(filepath).createDebugContext(params);
+}
+
+inline std::unique_ptr<DebugExecutionContext> FlowGraphEngine::parseFlowForDebugging(
+    const std::string& content, const ParameterMap& params, const std::string& name) {
+    return parseFlow(content, name).createDebugContext(params);
+}
+
 inline void FlowGraphEngine::registerProcedure(const std::string& name, const ProcDefinition& procDef) {
     engine_.registerProcedure(name, procDef);
 }
 
 inline void FlowGraphEngine::registerProcedure(const std::string& name, ExternalProcedure proc) {
-    engine_.registerProcedure(name, proc);
+    engine_.registerProcedure(name, std::move(proc));
 }
 
 inline void FlowGraphEngine::registerLegacyProcedure(const std::string& name, LegacyExternalProcedure proc) {
-    engine_.registerLegacyProcedure(name, proc);
+    engine_.registerLegacyProcedure(name, std::move(proc));
 }
 
 inline ExternalProcedure FlowGraphEngine::getProcedure(const std::string& name) {
@@ -140,4 +430,9 @@ inline std::vector<std::string> FlowGraphEngine::getRegisteredProcedures() {
     return engine_.getRegisteredProcedures();
 }
 
+inline ExecutionResult executeFlow(const std::string& filepath, const ParameterMap& params) {
+    FlowGraphEngine engine;
+    return engine.loadFlow(filepath).execute(params);
+}
+
 } // namespace FlowGraph
\ No newline at end of file
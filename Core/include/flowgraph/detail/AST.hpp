@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Types.hpp"
+#include "Arena.hpp"
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace FlowGraph {
@@ -20,16 +22,28 @@ protected:
     ASTNode(Location loc = {}) : location(loc) {}
 };
 
+/**
+ * @brief Node type tag, allows dispatch on node type without RTTI
+ */
+enum class NodeKind {
+    Assign,     // ASSIGN
+    Cond,       // COND
+    Proc,       // PROC
+    Par,        // PAR
+    Join        // JOIN
+};
+
 /**
  * @brief Flow node base class
  */
 class FlowNode : public ASTNode {
 public:
     std::string id;
+    NodeKind kind;
     
 protected:
-    FlowNode(const std::string& nodeId, Location loc = {}) 
-        : ASTNode(loc), id(nodeId) {}
+    FlowNode(NodeKind nodeKind, const std::string& nodeId, Location loc = {}) 
+        : ASTNode(loc), id(nodeId), kind(nodeKind) {}
 };
 
 /**
@@ -43,7 +57,7 @@ public:
     
     AssignNode(const std::string& id, TypeInfo type, const std::string& var, 
                const std::string& expr, Location loc = {})
-        : FlowNode(id, loc), targetType(type), variableName(var), expression(expr) {}
+        : FlowNode(NodeKind::Assign, id, loc), targetType(type), variableName(var), expression(expr) {}
 };
 
 /**
@@ -54,7 +68,7 @@ public:
     std::string condition;
     
     CondNode(const std::string& id, const std::string& cond, Location loc = {})
-        : FlowNode(id, loc), condition(cond) {}
+        : FlowNode(NodeKind::Cond, id, loc), condition(cond) {}
 };
 
 /**
@@ -78,13 +92,64 @@ public:
     std::vector<ProcBinding> bindings;
     
     ProcNode(const std::string& id, const std::string& proc, Location loc = {})
-        : FlowNode(id, loc), procedureName(proc) {}
+        : FlowNode(NodeKind::Proc, id, loc), procedureName(proc) {}
     
     void addBinding(const std::string& localVar, const std::string& procParam, bool isOutput) {
         bindings.emplace_back(localVar, procParam, isOutput);
     }
 };
 
+/**
+ * @brief Fork node (PAR)
+ *
+ * Each default connection starts a branch; the branches run concurrently
+ * until they reach a JOIN.
+ */
+class ParNode : public FlowNode {
+public:
+    ParNode(const std::string& id, Location loc = {}) : FlowNode(NodeKind::Par, id, loc) {}
+};
+
+/**
+ * @brief Join node (JOIN)
+ *
+ * Waits for every branch of the PAR that forked them and merges their
+ * variable writes before continuing on its default connection.
+ */
+class JoinNode : public FlowNode {
+public:
+    JoinNode(const std::string& id, Location loc = {}) : FlowNode(NodeKind::Join, id, loc) {}
+};
+
+/**
+ * @brief Deleter of FlowNodePtr: deletes heap nodes, only destroys arena nodes
+ *
+ * Converts from std::default_delete, so std::make_unique nodes can be added
+ * to FlowAST::nodes as before.
+ */
+struct FlowNodeDeleter {
+    bool inArena = false;
+    
+    FlowNodeDeleter() = default;
+    explicit FlowNodeDeleter(bool arena) noexcept : inArena(arena) {}
+    
+    template<typename T, typename = std::enable_if_t<std::is_convertible_v<T*, FlowNode*>>>
+    FlowNodeDeleter(const std::default_delete<T>&) noexcept {}
+    
+    void operator()(FlowNode* node) const noexcept {
+        if (inArena) {
+            node->~FlowNode(); // memory is released with the arena
+        } else {
+            delete node;
+        }
+    }
+};
+
+template<typename T = FlowNode>
+using NodePtr = std::unique_ptr<T, FlowNodeDeleter>;
+
+using FlowNodePtr = NodePtr<FlowNode>;
+
 /**
  * @brief Flow connection
  */
@@ -112,18 +177,47 @@ struct ErrorDefinition {
 
 /**
  * @brief Complete FlowGraph AST
+ *
+ * Nodes are heap-allocated by default. An AST with an arena (the parser and
+ * .flowc loader create one) allocates the nodes made by makeNode() there, so
+ * they are contiguous and freed in a few blocks; both kinds may be mixed.
  */
 class FlowAST : public ASTNode {
 public:
+    std::unique_ptr<Arena> arena;   // declared first: outlives the nodes
     std::string title;
     std::vector<Parameter> parameters;
     std::vector<ReturnValue> returnValues;
     std::vector<ErrorDefinition> errors;
-    std::vector<std::unique_ptr<FlowNode>> nodes;
+    std::vector<FlowNodePtr> nodes;
     std::vector<FlowConnection> connections;
     
     FlowAST() = default;
     
+    /**
+     * @brief AST whose nodes are allocated in an arena
+     * @param blockSize Size of the first arena block, e.g. derived from the source size
+     */
+    static std::unique_ptr<FlowAST> withArena(size_t blockSize = Arena::DefaultBlockSize) {
+        auto ast = std::make_unique<FlowAST>();
+        ast->arena = std::make_unique<Arena>(blockSize);
+        return ast;
+    }
+    
+    /**
+     * @brief Create a node in the AST's arena, or on the heap if it has none
+     *
+     * The node is not added to nodes; push it there (or drop it) yourself.
+     */
+    template<typename T, typename... Args>
+    NodePtr<T> makeNode(Args&&... args) {
+        static_assert(std::is_base_of_v<FlowNode, T>, "makeNode creates flow nodes");
+        if (arena) {
+            return NodePtr<T>(arena->create<T>(std::forward<Args>(args)...), FlowNodeDeleter(true));
+        }
+        return NodePtr<T>(new T(std::forward<Args>(args)...));
+    }
+    
     // Helper methods
     FlowNode* findNode(const std::string& id) const;
     std::vector<FlowConnection> getConnectionsFrom(const std::string& nodeId) const;
@@ -207,12 +301,12 @@ inline std::vector<std::string> FlowAST::validate() const {
         errors.push_back("Flow must have at least one END connection");
     }
     
-    // Check that all referenced nodes exist
+    // Check that all referenced nodes exist (a declared error name is a valid target - error emission)
     for (const auto& conn : connections) {
         if (conn.fromNode != "START" && !findNode(conn.fromNode)) {
             errors.push_back("Connection references unknown node: " + conn.fromNode);
         }
-        if (conn.toNode != "END" && !findNode(conn.toNode)) {
+        if (conn.toNode != "END" && !findNode(conn.toNode) && !hasError(conn.toNode)) {
             errors.push_back("Connection references unknown node: " + conn.toNode);
         }
     }
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+#if defined(__cpp_lib_memory_resource) && !defined(FLOWGRAPH_NO_PMR)
+#define FLOWGRAPH_HAS_PMR 1
+#endif
+
+namespace FlowGraph {
+
+/**
+ * @brief Monotonic arena: bump allocation in a few large blocks, released together
+ *
+ * Parsed flows place their nodes in the arena of their FlowAST, so one flow's
+ * nodes sit next to each other in memory and unloading the flow frees a
+ * handful of blocks instead of every node. The arena never runs destructors;
+ * owners destroy the objects they created (see FlowNodeDeleter). Blocks
+ * start at the given size and double up to MaxBlockSize. Not thread-safe.
+ *
+ * Where the standard library provides <memory_resource>, resource() adapts
+ * the arena to std::pmr containers (FLOWGRAPH_HAS_PMR).
+ */
+class Arena {
+public:
+    static constexpr size_t DefaultBlockSize = 4096;
+    static constexpr size_t MaxBlockSize = 1 << 20;
+
+    explicit Arena(size_t initialBlockSize = DefaultBlockSize)
+        : nextBlockSize_(std::clamp<size_t>(initialBlockSize, 256, MaxBlockSize)) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() { release(); }
+
+    /**
+     * @brief Allocate uninitialized memory, valid until the arena is destroyed
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Construct an object in the arena; its destructor is not run by the arena
+     */
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        return ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Bytes handed out by allocate()
+     */
+    size_t bytesUsed() const noexcept { return bytesUsed_; }
+
+    size_t blockCount() const noexcept { return blockCount_; }
+
+#ifdef FLOWGRAPH_HAS_PMR
+    /**
+     * @brief Memory resource allocating from this arena (deallocation is a no-op)
+     */
+    std::pmr::memory_resource* resource() noexcept { return &resource_; }
+#endif
+
+private:
+    struct Block {
+        Block* next;
+    };
+
+    static constexpr size_t HeaderSize = (sizeof(Block) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+                                         alignof(std::max_align_t);
+
+    Block* head_ = nullptr;
+    char* cursor_ = nullptr;
+    char* end_ = nullptr;
+    size_t nextBlockSize_;
+    size_t bytesUsed_ = 0;
+    size_t blockCount_ = 0;
+
+#ifdef FLOWGRAPH_HAS_PMR
+    class Resource : public std::pmr::memory_resource {
+    public:
+        explicit Resource(Arena& arena) : arena_(arena) {}
+
+    private:
+        Arena& arena_;
+
+        void* do_allocate(size_t bytes, size_t alignment) override { return arena_.allocate(bytes, alignment); }
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    Resource resource_{*this};
+#endif
+
+    void addBlock(size_t minimumSize);
+    void release() noexcept;
+};
+
+// Implementation (header-only)
+
+inline void* Arena::allocate(size_t size, size_t alignment) {
+    auto aligned = [&]() -> char* {
+        if (!cursor_) {
+            return nullptr;
+        }
+        auto address = reinterpret_cast<uintptr_t>(cursor_);
+        auto padding = (alignment - address % alignment) % alignment;
+        if (padding + size > static_cast<size_t>(end_ - cursor_)) {
+            return nullptr;
+        }
+        return cursor_ + padding;
+    };
+
+    char* result = aligned();
+    if (!result) {
+        addBlock(size + alignment);
+        result = aligned();
+    }
+    cursor_ = result + size;
+    bytesUsed_ += size;
+    return result;
+}
+
+inline void Arena::addBlock(size_t minimumSize) {
+    // Oversized requests get a block of their own; the growth sequence continues after them
+    size_t size = std::max(nextBlockSize_, minimumSize);
+    nextBlockSize_ = std::min(nextBlockSize_ * 2, MaxBlockSize);
+
+    auto* block = static_cast<Block*>(::operator new(HeaderSize + size));
+    block->next = head_;
+    head_ = block;
+    cursor_ = reinterpret_cast<char*>(block) + HeaderSize;
+    end_ = cursor_ + size;
+    ++blockCount_;
+}
+
+inline void Arena::release() noexcept {
+    while (head_) {
+        Block* next = head_->next;
+        ::operator delete(head_);
+        head_ = next;
+    }
+    cursor_ = end_ = nullptr;
+}
+
+} // namespace FlowGraph
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "TypedExpression.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace FlowGraph {
+
+/**
+ * @brief One variable over all lanes of a ColumnBatch
+ *
+ * Number and Boolean values share one vector, booleans as 0/1 like in
+ * typed code; types tells which one a lane holds, Unknown where the
+ * variable is unset.
+ */
+struct Column {
+    std::vector<double> values;
+    std::vector<StaticType> types;
+
+    bool isSet(size_t lane) const { return types[lane] != StaticType::Unknown; }
+    double number(size_t lane) const { return values[lane]; }
+    bool boolean(size_t lane) const { return values[lane] != 0; }
+
+    /**
+     * @brief Value of a lane that is set
+     */
+    Value value(size_t lane) const {
+        return types[lane] == StaticType::Boolean ? Value(values[lane] != 0) : Value(values[lane]);
+    }
+
+    void set(size_t lane, double value, StaticType type) {
+        values[lane] = value;
+        types[lane] = type;
+    }
+};
+
+/**
+ * @brief Variables of many executions of one flow, stored column by column
+ *
+ * Every execution is a lane and every variable a column holding it for all
+ * lanes (see Flow::executeColumns()). Only Number and Boolean variables
+ * have columns.
+ */
+class ColumnBatch {
+public:
+    explicit ColumnBatch(size_t lanes = 0) : lanes_(lanes) {}
+
+    size_t lanes() const { return lanes_; }
+
+    /**
+     * @brief Set a Number variable in every lane
+     * @throws FlowGraphError if values does not have one entry per lane
+     */
+    void setNumbers(const std::string& name, std::vector<double> values);
+
+    /**
+     * @brief Set a Boolean variable in every lane
+     * @throws FlowGraphError if values does not have one entry per lane
+     */
+    void setBooleans(const std::string& name, const std::vector<bool>& values);
+
+    /**
+     * @brief Column of a variable, created with every lane unset
+     */
+    Column& column(const std::string& name);
+
+    /**
+     * @return The variable's column, or nullptr if it has none
+     */
+    const Column* find(const std::string& name) const;
+
+    const std::unordered_map<std::string, Column>& columns() const { return columns_; }
+
+private:
+    size_t lanes_;
+    std::unordered_map<std::string, Column> columns_;
+
+    void checkSize(const std::string& name, size_t size) const;
+};
+
+/**
+ * @brief Outcome of Flow::executeColumns()
+ */
+struct ColumnBatchResult {
+    ColumnBatch returns;                                  // RETURNS of the lanes that succeeded
+    std::vector<std::pair<size_t, std::string>> errors;   // failed lanes and their errors, by lane
+    size_t scalarLanes = 0;                               // lanes that left the columnar path
+
+    /**
+     * @return The lane's error, or nullptr if it succeeded
+     */
+    const std::string* error(size_t lane) const {
+        auto it = std::lower_bound(errors.begin(), errors.end(), lane,
+                                   [](const auto& entry, size_t value) { return entry.first < value; });
+        return it != errors.end() && it->first == lane ? &it->second : nullptr;
+    }
+
+    bool success(size_t lane) const { return error(lane) == nullptr; }
+};
+
+// Implementation (header-only)
+
+inline void ColumnBatch::checkSize(const std::string& name, size_t size) const {
+    if (size != lanes_) {
+        throw FlowGraphError(FlowGraphError::Type::Runtime,
+            "Column " + name + " has " + std::to_string(size) + " values for " + std::to_string(lanes_) + " lanes");
+    }
+}
+
+inline void ColumnBatch::setNumbers(const std::string& name, std::vector<double> values) {
+    checkSize(name, values.size());
+    Column& target = columns_[name];
+    target.values = std::move(values);
+    target.types.assign(lanes_, StaticType::Number);
+}
+
+inline void ColumnBatch::setBooleans(const std::string& name, const std::vector<bool>& values) {
+    checkSize(name, values.size());
+    Column& target = columns_[name];
+    target.values.assign(values.begin(), values.end());
+    target.types.assign(lanes_, StaticType::Boolean);
+}
+
+inline Column& ColumnBatch::column(const std::string& name) {
+    auto [it, added] = columns_.try_emplace(name);
+    if (added) {
+        it->second.values.assign(lanes_, 0.0);
+        it->second.types.assign(lanes_, StaticType::Unknown);
+    }
+    return it->second;
+}
+
+inline const Column* ColumnBatch::find(const std::string& name) const {
+    auto it = columns_.find(name);
+    return it != columns_.end() ? &it->second : nullptr;
+}
+
+} // namespace FlowGraph
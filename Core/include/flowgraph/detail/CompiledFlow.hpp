@@ -0,0 +1,923 @@
+#pragma once
+
+#include "AST.hpp"
+#include "Symbol.hpp"
+#include "TypedExpression.hpp"
+#include "ExpressionKit.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace FlowGraph {
+
+/**
+ * @brief Dense index of a node inside a CompiledFlow
+ */
+using NodeIndex = uint32_t;
+
+/**
+ * @brief Index of a variable storage slot
+ */
+using SlotIndex = uint32_t;
+
+/**
+ * @brief Mapping of variable names to dense storage slots
+ */
+class SlotTable {
+public:
+    /**
+     * @brief Get the slot of a name, adding a new slot if it is not known yet
+     */
+    SlotIndex add(const std::string& name);
+    
+    std::optional<SlotIndex> find(const std::string& name) const;
+    const std::string& name(SlotIndex slot) const { return names_[slot]; }
+    size_t size() const { return names_.size(); }
+    
+private:
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, SlotIndex> index_;
+};
+
+/**
+ * @brief Kind of a resolved connection target
+ */
+enum class TargetKind : uint8_t {
+    None,       // No connection on this port (falls through to END)
+    Node,       // Continue execution at another node
+    End,        // END - flow completes successfully
+    Error       // Error emission (e.g. 20.N -> USER_NOT_FOUND)
+};
+
+/**
+ * @brief Resolved connection target
+ */
+struct CompiledTarget {
+    TargetKind kind = TargetKind::None;
+    uint32_t index = 0;     // node index for Node, error index for Error
+
+    bool isNode() const { return kind == TargetKind::Node; }
+};
+
+/**
+ * @brief Error capture edge of a node (e.g. 10.USER_NOT_FOUND -> 100)
+ */
+struct CompiledErrorEdge {
+    Symbol error;            // captured error name
+    CompiledTarget target;
+};
+
+/**
+ * @brief PROC binding resolved to a variable slot (e.g. x>>value or y<<result)
+ */
+struct CompiledBinding {
+    SlotIndex slot;
+    const std::string* procParam;  // points into the owning AST
+    bool lastUse = false;          // input whose variable is dead after the node, its value may be moved
+};
+
+/**
+ * @brief Contiguous range of compiled bindings
+ */
+struct BindingRange {
+    const CompiledBinding* first = nullptr;
+    const CompiledBinding* last = nullptr;
+    
+    const CompiledBinding* begin() const { return first; }
+    const CompiledBinding* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+};
+
+/**
+ * @brief Contiguous range of variable slots, in ascending order
+ */
+struct SlotRange {
+    const SlotIndex* first = nullptr;
+    const SlotIndex* last = nullptr;
+    
+    const SlotIndex* begin() const { return first; }
+    const SlotIndex* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+};
+
+/**
+ * @brief Node of the compiled execution program
+ */
+struct CompiledNode {
+    NodeKind kind = NodeKind::Assign;
+    const FlowNode* source = nullptr; // owning AST node, kept alive by CompiledFlow
+    Symbol id = NoSymbol;        // interned node ID
+    CompiledTarget next;         // default port
+    CompiledTarget yes;          // Y port of COND (falls back to default port)
+    CompiledTarget no;           // N port of COND (falls back to default port)
+    uint32_t errorEdgeBegin = 0; // range into the error edge table
+    uint32_t errorEdgeCount = 0;
+    uint32_t branchBegin = 0;    // PAR: range into the branch table
+    uint32_t branchCount = 0;
+    ExpressionKit::ASTNodePtr expression; // pre-parsed ASSIGN expression / COND condition
+    std::optional<TypedExpression> typed; // Number/Boolean fast path of the expression, if it has one
+    SlotIndex slot = 0;          // ASSIGN target variable slot
+    uint32_t procIndex = 0;      // dense index among PROC nodes
+    uint32_t bindingBegin = 0;   // PROC bindings: inputs first, then outputs
+    uint32_t inputCount = 0;
+    uint32_t outputCount = 0;
+    uint32_t blockLength = 1;    // ASSIGN: run this and the next blockLength - 1 nodes as one block
+    uint32_t liveBegin = 0;      // PROC: range into the live slot table
+    uint32_t liveCount = 0;
+
+    const AssignNode& asAssign() const { return static_cast<const AssignNode&>(*source); }
+    const CondNode& asCond() const { return static_cast<const CondNode&>(*source); }
+    const ProcNode& asProc() const { return static_cast<const ProcNode&>(*source); }
+};
+
+/**
+ * @brief Contiguous range of PAR branch entry targets
+ */
+struct BranchRange {
+    const CompiledTarget* first = nullptr;
+    const CompiledTarget* last = nullptr;
+
+    const CompiledTarget* begin() const { return first; }
+    const CompiledTarget* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+};
+
+/**
+ * @brief What compilation did with a flow
+ */
+struct CompileStats {
+    size_t sourceNodes = 0;          // nodes in the FlowAST (excluding duplicates)
+    size_t deadNodes = 0;            // unreachable from START, dropped
+    size_t blocks = 0;               // straight-line blocks of two or more ASSIGNs
+    size_t fusedNodes = 0;           // ASSIGNs run inside a block without their own dispatch
+    size_t typedExpressions = 0;     // live expressions with a typed fast path
+    size_t constantExpressions = 0;  // live expressions folded to a constant
+    size_t lastUseInputs = 0;        // PROC inputs whose variable is dead after the call
+    std::vector<std::string> deadNodeIds;
+};
+
+/**
+ * @brief Flat, index-based execution program compiled from a FlowAST
+ *
+ * Node IDs are resolved to dense indices once, all outgoing ports are stored in
+ * a contiguous edge table, and nodes carry a NodeKind tag, so that each
+ * execution step is O(1) and allocation-free. ASSIGN/COND expressions are
+ * parsed once here and only the cached expression tree is evaluated at run
+ * time; expressions over Number and Boolean values are additionally compiled to
+ * typed, constant-folded code (see TypedExpression). Variable names from
+ * PARAMS, RETURNS, ASSIGN targets and PROC bindings are resolved to storage
+ * slots, and PROC bindings are flattened into slot to parameter pairs. Node IDs
+ * and error names are interned, so the program keys and compares them as
+ * integers. The default connections of a PAR node are its branches, kept in a
+ * contiguous branch table.
+ *
+ * Nodes that cannot be reached from START (also through a COND folded to a
+ * constant) are dropped, and ASSIGN chains whose nodes have a single
+ * predecessor are laid out contiguously and fused into blocks that run
+ * without per-node dispatch (CompiledNode::blockLength). Flows without START
+ * keep all nodes. stats() reports the savings. The compiled flow owns its
+ * AST and is immutable after construction.
+ *
+ * A backward liveness analysis over the compiled edges finds, for every PROC
+ * node, the variables its successors may still read (liveAfter()) and the
+ * input bindings that are the last use of their variable. Expressions are
+ * scanned for every name that could be a variable, so the live sets are
+ * conservative; RETURNS are live at END.
+ */
+class CompiledFlow {
+public:
+    /**
+     * @param symbols Table to intern names into (normally the engine's), a
+     *        private table is created if null
+     */
+    explicit CompiledFlow(std::unique_ptr<FlowAST> ast, std::shared_ptr<SymbolTable> symbols = nullptr);
+
+    const FlowAST& ast() const { return *ast_; }
+    
+    /**
+     * @brief Table the node IDs and error names of this flow are interned in
+     */
+    SymbolTable& symbols() const { return *symbols_; }
+
+    /**
+     * @brief Target of the START connection
+     */
+    const CompiledTarget& entry() const { return entry_; }
+
+    size_t nodeCount() const { return nodes_.size(); }
+    const CompiledNode& node(NodeIndex index) const { return nodes_[index]; }
+
+    /**
+     * @brief Resolve a node ID to its index
+     */
+    std::optional<NodeIndex> findNodeIndex(const std::string& id) const;
+
+    /**
+     * @brief Variable slots known at compile time
+     */
+    const SlotTable& slots() const { return slots_; }
+    
+    /**
+     * @brief Slots of the PARAMS variables, in declaration order
+     */
+    const std::vector<SlotIndex>& paramSlots() const { return paramSlots_; }
+    
+    /**
+     * @brief Slots of the RETURNS variables, in declaration order
+     */
+    const std::vector<SlotIndex>& returnSlots() const { return returnSlots_; }
+
+    /**
+     * @brief Number of PROC nodes (range of CompiledNode::procIndex)
+     */
+    size_t procNodeCount() const { return procNodeCount_; }
+    
+    /**
+     * @brief Input (>>) bindings of a PROC node
+     */
+    BindingRange inputBindings(const CompiledNode& node) const {
+        const CompiledBinding* first = bindings_.data() + node.bindingBegin;
+        return {first, first + node.inputCount};
+    }
+    
+    /**
+     * @brief Output (<<) bindings of a PROC node
+     */
+    BindingRange outputBindings(const CompiledNode& node) const {
+        const CompiledBinding* first = bindings_.data() + node.bindingBegin + node.inputCount;
+        return {first, first + node.outputCount};
+    }
+    
+    /**
+     * @brief Entry targets of the branches of a PAR node, in connection order
+     */
+    BranchRange branches(const CompiledNode& node) const {
+        const CompiledTarget* first = branches_.data() + node.branchBegin;
+        return {first, first + node.branchCount};
+    }
+    
+    /**
+     * @brief Slots that may still be read after a PROC node: what an execution suspended at it must keep
+     *
+     * Empty for other kinds of nodes.
+     */
+    SlotRange liveAfter(const CompiledNode& node) const {
+        const SlotIndex* first = liveSlots_.data() + node.liveBegin;
+        return {first, first + node.liveCount};
+    }
+    
+    /**
+     * @brief Get error name by error index
+     */
+    const std::string& errorName(uint32_t index) const { return symbols_->name(errors_[index]); }
+    Symbol errorSymbol(uint32_t index) const { return errors_[index]; }
+
+    /**
+     * @brief Find the capture target for an error raised by a node
+     * @return Target or nullptr if the node does not capture this error
+     */
+    const CompiledTarget* findErrorTarget(const CompiledNode& node, Symbol error) const;
+    const CompiledTarget* findErrorTarget(const CompiledNode& node, const std::string& error) const;
+
+    /**
+     * @brief Problems not covered by FlowAST::validate (duplicate IDs, ambiguous ports, bad expressions,
+     *        ASSIGN expressions whose type contradicts the declared type)
+     */
+    const std::vector<std::string>& diagnostics() const { return diagnostics_; }
+
+    const CompileStats& stats() const { return stats_; }
+
+private:
+    std::unique_ptr<FlowAST> ast_;
+    std::vector<CompiledNode> nodes_;
+    std::vector<CompiledErrorEdge> errorEdges_;
+    std::vector<CompiledBinding> bindings_;
+    std::vector<CompiledTarget> branches_;          // PAR branch entries
+    std::vector<SlotIndex> liveSlots_;              // live after PROC nodes
+    size_t procNodeCount_ = 0;
+    std::shared_ptr<SymbolTable> symbols_;
+    std::vector<Symbol> errors_;                    // by error index
+    std::unordered_map<Symbol, NodeIndex> nodeIndex_;
+    SlotTable slots_;
+    std::vector<SlotIndex> paramSlots_;
+    std::vector<SlotIndex> returnSlots_;
+    CompiledTarget entry_;
+    std::vector<std::string> diagnostics_;
+    CompileStats stats_;
+
+    CompiledTarget resolveTarget(const std::string& toNode);
+    std::optional<NodeIndex> lookupNode(const std::string& id) const;
+    uint32_t internError(Symbol name);
+    void parseExpression(CompiledNode& node, const std::string& expression);
+    void compileTypedExpressions();
+    void layoutNodes();
+    void analyzeLiveness();
+    
+    template<typename Visit>
+    void forEachSuccessor(const CompiledNode& node, Visit&& visit) const;
+};
+
+// Implementation (header-only)
+
+inline SlotIndex SlotTable::add(const std::string& name) {
+    auto inserted = index_.emplace(name, static_cast<SlotIndex>(names_.size()));
+    if (inserted.second) {
+        names_.push_back(name);
+    }
+    return inserted.first->second;
+}
+
+inline std::optional<SlotIndex> SlotTable::find(const std::string& name) const {
+    auto it = index_.find(name);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+inline CompiledFlow::CompiledFlow(std::unique_ptr<FlowAST> ast, std::shared_ptr<SymbolTable> symbols)
+    : ast_(std::move(ast)), symbols_(std::move(symbols)) {
+    if (!ast_) {
+        ast_ = std::make_unique<FlowAST>();
+    }
+    if (!symbols_) {
+        symbols_ = std::make_shared<SymbolTable>();
+    }
+
+    // Pass 1: assign dense node indices and variable slots
+    for (const auto& param : ast_->parameters) {
+        paramSlots_.push_back(slots_.add(param.name));
+    }
+    for (const auto& ret : ast_->returnValues) {
+        returnSlots_.push_back(slots_.add(ret.name));
+    }
+    
+    nodes_.reserve(ast_->nodes.size());
+    for (const auto& node : ast_->nodes) {
+        Symbol id = symbols_->intern(node->id);
+        auto inserted = nodeIndex_.emplace(id, static_cast<NodeIndex>(nodes_.size()));
+        if (!inserted.second) {
+            diagnostics_.push_back("Duplicate node ID: " + node->id);
+            continue;
+        }
+        CompiledNode compiled;
+        compiled.kind = node->kind;
+        compiled.source = node.get();
+        compiled.id = id;
+        if (node->kind == NodeKind::Assign) {
+            parseExpression(compiled, compiled.asAssign().expression);
+            compiled.slot = slots_.add(compiled.asAssign().variableName);
+        } else if (node->kind == NodeKind::Cond) {
+            parseExpression(compiled, compiled.asCond().condition);
+        } else if (node->kind == NodeKind::Proc) {
+            compiled.procIndex = static_cast<uint32_t>(procNodeCount_++);
+            compiled.bindingBegin = static_cast<uint32_t>(bindings_.size());
+            for (bool outputs : {false, true}) {
+                for (const auto& binding : compiled.asProc().bindings) {
+                    if (binding.isOutput == outputs) {
+                        bindings_.push_back({slots_.add(binding.localVar), &binding.procParam});
+                    }
+                }
+            }
+            for (const auto& binding : compiled.asProc().bindings) {
+                ++(binding.isOutput ? compiled.outputCount : compiled.inputCount);
+            }
+        }
+        nodes_.push_back(std::move(compiled));
+    }
+
+    compileTypedExpressions();
+
+    // Pass 2: resolve connections, grouping error edges per node
+    std::vector<std::vector<CompiledErrorEdge>> errorEdgesByNode(nodes_.size());
+    std::vector<std::vector<CompiledTarget>> branchesByNode(nodes_.size());
+    bool hasEntry = false;
+    for (const auto& conn : ast_->connections) {
+        CompiledTarget target = resolveTarget(conn.toNode);
+
+        if (conn.fromNode == "START") {
+            if (hasEntry) {
+                diagnostics_.push_back("Flow has more than one START connection");
+            } else {
+                entry_ = target;
+                hasEntry = true;
+            }
+            continue;
+        }
+
+        auto fromIndex = lookupNode(conn.fromNode);
+        if (!fromIndex) {
+            continue; // reported by FlowAST::validate
+        }
+
+        CompiledNode& from = nodes_[*fromIndex];
+        CompiledTarget* port = nullptr;
+        if (from.kind == NodeKind::Par && conn.fromPort.empty()) {
+            branchesByNode[*fromIndex].push_back(target);
+            continue;
+        }
+        if (conn.fromPort.empty()) {
+            port = &from.next;
+        } else if (from.kind == NodeKind::Cond && conn.fromPort == "Y") {
+            port = &from.yes;
+        } else if (from.kind == NodeKind::Cond && conn.fromPort == "N") {
+            port = &from.no;
+        }
+
+        if (port) {
+            if (port->kind != TargetKind::None) {
+                diagnostics_.push_back("Multiple connections from " + conn.fromNode +
+                    (conn.fromPort.empty() ? "" : "." + conn.fromPort));
+            } else {
+                *port = target;
+            }
+        } else {
+            errorEdgesByNode[*fromIndex].push_back({symbols_->intern(conn.fromPort), target});
+        }
+    }
+
+    // Pass 3: flatten the edge and branch tables
+    for (NodeIndex i = 0; i < nodes_.size(); ++i) {
+        CompiledNode& node = nodes_[i];
+        if (node.kind == NodeKind::Cond) {
+            if (node.yes.kind == TargetKind::None) node.yes = node.next;
+            if (node.no.kind == TargetKind::None) node.no = node.next;
+        }
+        if (node.kind == NodeKind::Par) {
+            if (branchesByNode[i].empty()) {
+                diagnostics_.push_back("PAR node " + node.source->id + " has no branches");
+            }
+            node.branchBegin = static_cast<uint32_t>(branches_.size());
+            node.branchCount = static_cast<uint32_t>(branchesByNode[i].size());
+            branches_.insert(branches_.end(), branchesByNode[i].begin(), branchesByNode[i].end());
+        }
+        node.errorEdgeBegin = static_cast<uint32_t>(errorEdges_.size());
+        node.errorEdgeCount = static_cast<uint32_t>(errorEdgesByNode[i].size());
+        errorEdges_.insert(errorEdges_.end(), errorEdgesByNode[i].begin(), errorEdgesByNode[i].end());
+    }
+
+    // Pass 4: drop dead nodes and fuse straight-line blocks
+    layoutNodes();
+    
+    // Pass 5: variables live after PROC nodes
+    analyzeLiveness();
+}
+
+inline std::optional<NodeIndex> CompiledFlow::findNodeIndex(const std::string& id) const {
+    return lookupNode(id);
+}
+
+inline std::optional<NodeIndex> CompiledFlow::lookupNode(const std::string& id) const {
+    // Names that were never interned cannot be node IDs of this flow
+    auto symbol = symbols_->find(id);
+    if (!symbol) {
+        return std::nullopt;
+    }
+    auto it = nodeIndex_.find(*symbol);
+    if (it == nodeIndex_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+inline const CompiledTarget* CompiledFlow::findErrorTarget(const CompiledNode& node, Symbol error) const {
+    for (uint32_t i = 0; i < node.errorEdgeCount; ++i) {
+        const auto& edge = errorEdges_[node.errorEdgeBegin + i];
+        if (edge.error == error) {
+            return &edge.target;
+        }
+    }
+    return nullptr;
+}
+
+inline const CompiledTarget* CompiledFlow::findErrorTarget(const CompiledNode& node, const std::string& error) const {
+    if (node.errorEdgeCount == 0) {
+        return nullptr;
+    }
+    auto symbol = symbols_->find(error);
+    return symbol ? findErrorTarget(node, *symbol) : nullptr;
+}
+
+inline CompiledTarget CompiledFlow::resolveTarget(const std::string& toNode) {
+    if (toNode == "END") {
+        return {TargetKind::End, 0};
+    }
+    if (auto index = lookupNode(toNode)) {
+        return {TargetKind::Node, *index};
+    }
+    // Anything else is an error emission; undeclared names are reported by FlowAST::validate
+    return {TargetKind::Error, internError(symbols_->intern(toNode))};
+}
+
+inline void CompiledFlow::parseExpression(CompiledNode& node, const std::string& expression) {
+    try {
+        node.expression = ExpressionKit::Expression::Parse(expression);
+    } catch (const ExpressionKit::ExprException& e) {
+        // Left unparsed: executing the node reports the error like an uncached evaluation would
+        diagnostics_.push_back("Invalid expression in node " + node.source->id + ": " + e.what());
+    }
+}
+
+namespace detail {
+
+inline StaticType staticTypeOf(ValueType type) {
+    switch (type) {
+        case ValueType::Number: return StaticType::Number;
+        case ValueType::Boolean: return StaticType::Boolean;
+        default: return StaticType::Unknown;
+    }
+}
+
+inline const char* staticTypeName(StaticType type) {
+    return type == StaticType::Number ? "Number" : type == StaticType::Boolean ? "Boolean" : "unknown";
+}
+
+} // namespace detail
+
+inline void CompiledFlow::compileTypedExpressions() {
+    // A slot has a static type if every declaration and ASSIGN agrees on it and no PROC
+    // writes it; values are still checked when the typed code loads them
+    struct Scope : TypedExpression::Scope {
+        const SlotTable& slots;
+        std::vector<StaticType> types;
+        std::vector<bool> declared;
+
+        explicit Scope(const SlotTable& table) : slots(table), types(table.size()), declared(table.size()) {}
+
+        void declare(SlotIndex slot, StaticType type) {
+            if (declared[slot] && types[slot] != type) {
+                type = StaticType::Unknown;
+            }
+            types[slot] = type;
+            declared[slot] = true;
+        }
+
+        std::optional<uint32_t> slot(std::string_view name) const override { return slots.find(std::string(name)); }
+        StaticType type(uint32_t slot) const override { return types[slot]; }
+    };
+
+    Scope scope(slots_);
+    for (const auto& param : ast_->parameters) {
+        scope.declare(*slots_.find(param.name), detail::staticTypeOf(param.type.type));
+    }
+    for (size_t i = 0; i < returnSlots_.size(); ++i) {
+        scope.declare(returnSlots_[i], detail::staticTypeOf(ast_->returnValues[i].type.type));
+    }
+    for (const auto& node : nodes_) {
+        if (node.kind == NodeKind::Assign) {
+            scope.declare(node.slot, detail::staticTypeOf(node.asAssign().targetType.type));
+        } else if (node.kind == NodeKind::Proc) {
+            for (const CompiledBinding& binding : outputBindings(node)) {
+                scope.declare(binding.slot, StaticType::Unknown);
+            }
+        }
+    }
+
+    for (auto& node : nodes_) {
+        if (!node.expression) {
+            continue; // reported as invalid expression
+        }
+        if (node.kind == NodeKind::Assign) {
+            const AssignNode& assign = node.asAssign();
+            StaticType declared = detail::staticTypeOf(assign.targetType.type);
+            StaticType actual = TypedExpression::inferType(assign.expression, scope);
+            if (actual != StaticType::Unknown &&
+                (assign.targetType.type == ValueType::String || (declared != StaticType::Unknown && declared != actual))) {
+                diagnostics_.push_back("Type mismatch in node " + assign.id + ": " + assign.variableName +
+                                       " is declared " + assign.targetType.toString() + " but the expression is " +
+                                       detail::staticTypeName(actual));
+                continue;
+            }
+            if (declared != StaticType::Unknown) {
+                node.typed = TypedExpression::compile(assign.expression, scope, declared);
+            }
+        } else if (node.kind == NodeKind::Cond) {
+            // Conditions without a static type (a bare variable) are expected to be Boolean
+            const std::string& condition = node.asCond().condition;
+            StaticType type = TypedExpression::inferType(condition, scope);
+            node.typed = TypedExpression::compile(condition, scope,
+                                                  type == StaticType::Unknown ? StaticType::Boolean : type);
+        }
+    }
+}
+
+template<typename Visit>
+inline void CompiledFlow::forEachSuccessor(const CompiledNode& node, Visit&& visit) const {
+    if (node.kind == NodeKind::Cond) {
+        // The port a constant condition never takes may lead to a dropped node
+        if (node.typed && node.typed->isConstant()) {
+            visit(node.typed->code()[0].value != 0 ? node.yes : node.no);
+        } else {
+            visit(node.yes);
+            visit(node.no);
+        }
+    } else if (node.kind == NodeKind::Par) {
+        for (uint32_t i = 0; i < node.branchCount; ++i) {
+            visit(branches_[node.branchBegin + i]);
+        }
+    } else {
+        visit(node.next);
+    }
+    for (uint32_t i = 0; i < node.errorEdgeCount; ++i) {
+        visit(errorEdges_[node.errorEdgeBegin + i].target);
+    }
+}
+
+inline void CompiledFlow::layoutNodes() {
+    stats_.sourceNodes = nodes_.size();
+
+    // Reachability and predecessor counts from START
+    std::vector<bool> reachable(nodes_.size(), entry_.kind == TargetKind::None);
+    std::vector<uint32_t> predecessors(nodes_.size());
+    if (entry_.isNode()) {
+        ++predecessors[entry_.index];
+        reachable[entry_.index] = true;
+        std::vector<NodeIndex> pending{entry_.index};
+        while (!pending.empty()) {
+            NodeIndex index = pending.back();
+            pending.pop_back();
+            forEachSuccessor(nodes_[index], [&](const CompiledTarget& target) {
+                if (target.isNode() && !reachable[target.index]) {
+                    reachable[target.index] = true;
+                    pending.push_back(target.index);
+                }
+            });
+        }
+    }
+    for (NodeIndex i = 0; i < nodes_.size(); ++i) {
+        if (reachable[i]) {
+            forEachSuccessor(nodes_[i], [&](const CompiledTarget& target) {
+                if (target.isNode()) {
+                    ++predecessors[target.index];
+                }
+            });
+        } else {
+            stats_.deadNodeIds.push_back(nodes_[i].source->id);
+        }
+    }
+    stats_.deadNodes = stats_.deadNodeIds.size();
+
+    // An ASSIGN continues the block of its predecessor if it has no other way in
+    auto fusesWithNext = [&](const CompiledNode& node) {
+        return node.kind == NodeKind::Assign && node.next.isNode() && nodes_[node.next.index].kind == NodeKind::Assign &&
+               predecessors[node.next.index] == 1 && node.next.index != static_cast<NodeIndex>(&node - nodes_.data());
+    };
+    std::vector<bool> continuesBlock(nodes_.size(), false);
+    for (NodeIndex i = 0; i < nodes_.size(); ++i) {
+        if (reachable[i] && fusesWithNext(nodes_[i])) {
+            continuesBlock[nodes_[i].next.index] = true;
+        }
+    }
+
+    // Declaration order, with each block laid out behind its first node
+    std::vector<NodeIndex> order;
+    std::vector<NodeIndex> remap(nodes_.size(), static_cast<NodeIndex>(-1));
+    auto place = [&](NodeIndex index) {
+        while (remap[index] == static_cast<NodeIndex>(-1)) {
+            remap[index] = static_cast<NodeIndex>(order.size());
+            order.push_back(index);
+            if (!fusesWithNext(nodes_[index])) {
+                break;
+            }
+            index = nodes_[index].next.index;
+        }
+    };
+    for (bool cycles : {false, true}) {
+        for (NodeIndex i = 0; i < nodes_.size(); ++i) {
+            // Second round: blocks closed into a loop have no first node
+            if (reachable[i] && (cycles || !continuesBlock[i])) {
+                place(i);
+            }
+        }
+    }
+
+    std::vector<CompiledNode> nodes;
+    std::vector<CompiledErrorEdge> errorEdges;
+    nodes.reserve(order.size());
+    auto rewrite = [&remap](CompiledTarget& target) {
+        if (target.isNode()) {
+            target.index = remap[target.index];
+        }
+    };
+    for (NodeIndex index : order) {
+        CompiledNode node = std::move(nodes_[index]);
+        rewrite(node.next);
+        rewrite(node.yes);
+        rewrite(node.no);
+        uint32_t begin = static_cast<uint32_t>(errorEdges.size());
+        for (uint32_t i = 0; i < node.errorEdgeCount; ++i) {
+            errorEdges.push_back(errorEdges_[node.errorEdgeBegin + i]);
+            rewrite(errorEdges.back().target);
+        }
+        node.errorEdgeBegin = begin;
+        nodes.push_back(std::move(node));
+    }
+    for (auto& branch : branches_) {
+        rewrite(branch);
+    }
+    rewrite(entry_);
+    nodes_ = std::move(nodes);
+    errorEdges_ = std::move(errorEdges);
+
+    nodeIndex_.clear();
+    for (NodeIndex i = 0; i < nodes_.size(); ++i) {
+        nodeIndex_.emplace(nodes_[i].id, i);
+    }
+
+    // Block lengths, counted from each node to the end of its block
+    for (NodeIndex i = static_cast<NodeIndex>(nodes_.size()); i-- > 0;) {
+        CompiledNode& node = nodes_[i];
+        if (node.kind == NodeKind::Assign && node.next.isNode() && node.next.index == i + 1 &&
+            nodes_[i + 1].kind == NodeKind::Assign && predecessors[order[i + 1]] == 1) {
+            node.blockLength = nodes_[i + 1].blockLength + 1;
+            ++stats_.fusedNodes;
+        }
+    }
+    for (NodeIndex i = 0; i < nodes_.size(); i += nodes_[i].blockLength) {
+        stats_.blocks += nodes_[i].blockLength > 1;
+    }
+    for (const auto& node : nodes_) {
+        if (node.typed) {
+            ++stats_.typedExpressions;
+            stats_.constantExpressions += node.typed->isConstant();
+        }
+    }
+}
+
+namespace detail {
+
+/**
+ * @brief Call visit(name) for every identifier of an expression that could name a variable
+ *
+ * Dotted names (player.health) are visited whole and by each prefix. String
+ * literals are scanned like the rest, which only adds names.
+ */
+template<typename Visit>
+inline void forEachIdentifier(std::string_view text, Visit&& visit) {
+    auto isStart = [](unsigned char c) { return std::isalpha(c) || c == '_' || c >= 0x80; };
+    size_t i = 0;
+    while (i < text.size()) {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (std::isdigit(c)) {
+            // Numbers, including suffixes such as 1e5 that are no names
+            while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '.')) {
+                ++i;
+            }
+        } else if (isStart(c)) {
+            size_t begin = i;
+            while (i < text.size() && (isStart(static_cast<unsigned char>(text[i])) ||
+                                       std::isdigit(static_cast<unsigned char>(text[i])) || text[i] == '.')) {
+                if (text[i] == '.') {
+                    visit(text.substr(begin, i - begin));
+                }
+                ++i;
+            }
+            visit(text.substr(begin, i - begin));
+        } else {
+            ++i;
+        }
+    }
+}
+
+} // namespace detail
+
+inline void CompiledFlow::analyzeLiveness() {
+    const size_t count = nodes_.size();
+    const size_t words = (slots_.size() + 63) / 64;
+    auto add = [](uint64_t* set, SlotIndex slot) { set[slot / 64] |= uint64_t(1) << (slot % 64); };
+    auto contains = [](const uint64_t* set, SlotIndex slot) { return (set[slot / 64] >> (slot % 64)) & 1; };
+
+    // Reads of every node; an ASSIGN also overwrites its slot. PROC outputs are
+    // only written if the procedure returns them, so they overwrite nothing.
+    std::vector<uint64_t> uses(count * words);
+    std::vector<uint64_t> returns(words);
+    for (SlotIndex slot : returnSlots_) {
+        add(returns.data(), slot);
+    }
+    for (NodeIndex i = 0; i < count; ++i) {
+        const CompiledNode& node = nodes_[i];
+        uint64_t* nodeUses = uses.data() + i * words;
+        if (node.kind == NodeKind::Assign || node.kind == NodeKind::Cond) {
+            const std::string& text = node.kind == NodeKind::Assign ? node.asAssign().expression : node.asCond().condition;
+            detail::forEachIdentifier(text, [&](std::string_view name) {
+                if (auto slot = slots_.find(std::string(name))) {
+                    add(nodeUses, *slot);
+                }
+            });
+        } else if (node.kind == NodeKind::Proc) {
+            for (const CompiledBinding& binding : inputBindings(node)) {
+                add(nodeUses, binding.slot);
+            }
+        }
+    }
+
+    // Predecessors, to revisit the nodes whose live set may grow
+    std::vector<uint32_t> predecessorBegin(count + 1);
+    for (const auto& node : nodes_) {
+        forEachSuccessor(node, [&](const CompiledTarget& target) {
+            if (target.isNode()) {
+                ++predecessorBegin[target.index + 1];
+            }
+        });
+    }
+    for (NodeIndex i = 0; i < count; ++i) {
+        predecessorBegin[i + 1] += predecessorBegin[i];
+    }
+    std::vector<NodeIndex> predecessors(predecessorBegin[count]);
+    std::vector<uint32_t> filled(predecessorBegin.begin(), predecessorBegin.end() - 1);
+    for (NodeIndex i = 0; i < count; ++i) {
+        forEachSuccessor(nodes_[i], [&](const CompiledTarget& target) {
+            if (target.isNode()) {
+                predecessors[filled[target.index]++] = i;
+            }
+        });
+    }
+
+    // Live on entry: uses | (live after & ~overwritten), iterated to a fixed point
+    std::vector<uint64_t> live(count * words);
+    std::vector<uint64_t> after(words);
+    auto collectLiveAfter = [&](const CompiledNode& node) {
+        std::fill(after.begin(), after.end(), 0);
+        forEachSuccessor(node, [&](const CompiledTarget& target) {
+            // END (also a port without a connection) hands back the RETURNS; an error emission nothing
+            const uint64_t* successor = target.isNode() ? live.data() + target.index * words
+                                      : target.kind == TargetKind::Error ? nullptr : returns.data();
+            if (successor) {
+                for (size_t w = 0; w < words; ++w) {
+                    after[w] |= successor[w];
+                }
+            }
+        });
+    };
+    std::vector<NodeIndex> pending(count);
+    std::vector<bool> queued(count, true);
+    for (NodeIndex i = 0; i < count; ++i) {
+        pending[i] = i;  // popped from the back: later nodes first
+    }
+    while (!pending.empty()) {
+        NodeIndex index = pending.back();
+        pending.pop_back();
+        queued[index] = false;
+        const CompiledNode& node = nodes_[index];
+        collectLiveAfter(node);
+        if (node.kind == NodeKind::Assign) {
+            after[node.slot / 64] &= ~(uint64_t(1) << (node.slot % 64));
+        }
+        bool changed = false;
+        uint64_t* nodeLive = live.data() + index * words;
+        const uint64_t* nodeUses = uses.data() + index * words;
+        for (size_t w = 0; w < words; ++w) {
+            uint64_t value = nodeUses[w] | after[w];
+            changed |= value != nodeLive[w];
+            nodeLive[w] = value;
+        }
+        if (changed) {
+            for (uint32_t p = predecessorBegin[index]; p < predecessorBegin[index + 1]; ++p) {
+                if (!queued[predecessors[p]]) {
+                    queued[predecessors[p]] = true;
+                    pending.push_back(predecessors[p]);
+                }
+            }
+        }
+    }
+
+    for (auto& node : nodes_) {
+        if (node.kind != NodeKind::Proc) {
+            continue;
+        }
+        collectLiveAfter(node);
+        node.liveBegin = static_cast<uint32_t>(liveSlots_.size());
+        for (SlotIndex slot = 0; slot < slots_.size(); ++slot) {
+            if (contains(after.data(), slot)) {
+                liveSlots_.push_back(slot);
+            }
+        }
+        node.liveCount = static_cast<uint32_t>(liveSlots_.size() - node.liveBegin);
+        
+        // A variable bound to several inputs is only moved into the last of them
+        CompiledBinding* first = bindings_.data() + node.bindingBegin;
+        for (CompiledBinding* binding = first; binding != first + node.inputCount; ++binding) {
+            binding->lastUse = !contains(after.data(), binding->slot) &&
+                std::none_of(binding + 1, first + node.inputCount,
+                             [binding](const CompiledBinding& other) { return other.slot == binding->slot; });
+            stats_.lastUseInputs += binding->lastUse;
+        }
+    }
+}
+
+inline uint32_t CompiledFlow::internError(Symbol name) {
+    for (uint32_t i = 0; i < errors_.size(); ++i) {
+        if (errors_[i] == name) {
+            return i;
+        }
+    }
+    errors_.push_back(name);
+    return static_cast<uint32_t>(errors_.size() - 1);
+}
+
+} // namespace FlowGraph
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+
+namespace FlowGraph {
+
+/**
+ * @brief Lock-free intrusive multi-producer/single-consumer queue
+ *
+ * Producers push nodes with a single CAS on the list head; the consumer takes
+ * the whole list with one exchange and restores FIFO order, so a busy consumer
+ * drains completions in batches without any lock. Node must provide a
+ * `Node* next` member. A node may be pushed again only after it was drained;
+ * the queue never allocates or frees nodes.
+ */
+template<typename Node>
+class CompletionQueue {
+public:
+    CompletionQueue() = default;
+    CompletionQueue(const CompletionQueue&) = delete;
+    CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+    /**
+     * @brief Push a node (any thread)
+     */
+    void push(Node* node) noexcept {
+        Node* head = head_.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!head_.compare_exchange_weak(head, node, std::memory_order_seq_cst, std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Take all queued nodes (consumer thread only)
+     * @return Nodes in push order linked through next, or nullptr if empty
+     */
+    Node* popAll() noexcept {
+        Node* list = head_.exchange(nullptr, std::memory_order_acquire);
+        Node* ordered = nullptr;
+        while (list) {
+            Node* next = list->next;
+            list->next = ordered;
+            ordered = list;
+            list = next;
+        }
+        return ordered;
+    }
+
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_seq_cst) == nullptr;
+    }
+
+private:
+    std::atomic<Node*> head_{nullptr};
+};
+
+} // namespace FlowGraph
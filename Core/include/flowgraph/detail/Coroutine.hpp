@@ -0,0 +1,253 @@
+#pragma once
+
+/**
+ * @file Coroutine.hpp
+ * @brief Optional C++20 coroutine front-end for async PROCs and flow execution
+ *
+ * Only available when the compiler supports C++20 coroutines; under C++17
+ * this header is empty.
+ */
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+
+#define FLOWGRAPH_HAS_COROUTINES 1
+
+#include "Engine.hpp"
+#include "Scheduler.hpp"
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace FlowGraph {
+
+/**
+ * @brief Lazily started coroutine producing a value of type T
+ *
+ * The coroutine body runs when the task is awaited (or start() is called) and
+ * the awaiting coroutine is resumed by symmetric transfer when it finishes.
+ * Exceptions escaping the body are rethrown to the awaiter. A
+ * FlowTask<ParameterMap> can also run as the body of a PROC call
+ * (runAsProc()).
+ */
+template<typename T>
+class FlowTask {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+        ProcCompletionCallback* procCallback = nullptr;   // set by runAsProc()
+
+        FlowTask get_return_object() {
+            return FlowTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                promise_type& promise = handle.promise();
+                if constexpr (std::is_same_v<T, ParameterMap>) {
+                    if (ProcCompletionCallback* callback = promise.procCallback) {
+                        // A PROC body frees its own frame, then completes the call
+                        ProcResult result = promise.procResult();
+                        handle.destroy();
+                        (*callback)(result);
+                        return std::noop_coroutine();
+                    }
+                }
+                auto continuation = promise.continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        template<typename U>
+        void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+
+        void unhandled_exception() { error = std::current_exception(); }
+
+        ProcResult procResult() {
+            if (error) {
+                try {
+                    std::rethrow_exception(error);
+                } catch (const std::exception& e) {
+                    return ProcResult::completedError(e.what());
+                }
+            }
+            return ProcResult::completedSuccess(std::move(*value));
+        }
+    };
+
+    FlowTask(FlowTask&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    FlowTask& operator=(FlowTask&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    FlowTask(const FlowTask&) = delete;
+    FlowTask& operator=(const FlowTask&) = delete;
+
+    ~FlowTask() { destroy(); }
+
+    /**
+     * @brief Run the coroutine from non-coroutine code (until its first suspension)
+     */
+    void start() {
+        if (handle_ && !handle_.done()) {
+            handle_.resume();
+        }
+    }
+
+    bool done() const { return !handle_ || handle_.done(); }
+
+    /**
+     * @brief Run the task as the body of a PROC call, completing callback when it finishes
+     *
+     * The task gives up its frame, which frees itself once the body has
+     * finished; exceptions escaping the body become PROC errors.
+     */
+    void runAsProc(ProcCompletionCallback& callback) {
+        static_assert(std::is_same_v<T, ParameterMap>, "A PROC body returns a ParameterMap");
+        auto handle = std::exchange(handle_, nullptr);
+        handle.promise().procCallback = &callback;
+        handle.resume();
+    }
+
+    /**
+     * @brief Result of a finished task (rethrows an exception from the body)
+     */
+    T& result() {
+        if (handle_.promise().error) {
+            std::rethrow_exception(handle_.promise().error);
+        }
+        return *handle_.promise().value;
+    }
+
+    // Awaitable interface
+    bool await_ready() const noexcept { return done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume() { return std::move(result()); }
+
+private:
+    explicit FlowTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    void destroy() {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+/**
+ * @brief Start a coroutine PROC, which reports through its callback when it finishes
+ *
+ * The input parameters are the calling node's, which the execution keeps
+ * until the PROC has completed, and the callable lives in the engine's
+ * registry, so coroutine PROCs may take their parameters by reference and
+ * capture state in a lambda even while suspended.
+ */
+template<typename Fn>
+void runProcTask(Fn& fn, const ParameterMap& params, ProcCompletionCallback& callback) {
+    FlowTask<ParameterMap> task = fn(params);
+    task.runAsProc(callback);
+}
+
+/**
+ * @brief Invoker of a coroutine PROC; callables too large for the invoker are allocated once
+ */
+template<typename Fn>
+ProcInvoker makeProcTaskInvoker(Fn fn) {
+    if constexpr (sizeof(Fn) <= 48 && std::is_nothrow_move_constructible_v<Fn>) {
+        return [fn = std::move(fn)](const ParameterMap& params, ProcCompletionCallback& callback) mutable {
+            runProcTask(fn, params, callback);
+        };
+    } else {
+        return [fn = std::make_unique<Fn>(std::move(fn))](const ParameterMap& params, ProcCompletionCallback& callback) {
+            runProcTask(*fn, params, callback);
+        };
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Register a PROC implemented as a coroutine
+ *
+ * @param fn Callable with signature FlowTask<ParameterMap>(const ParameterMap&).
+ *        A coroutine that finishes without suspending completes the PROC
+ *        synchronously; otherwise the flow suspends and is resumed by
+ *        FlowScheduler once the coroutine returns. Exceptions become PROC errors.
+ */
+template<typename Fn>
+void registerCoroutineProcedure(Engine& engine, const std::string& name, Fn fn) {
+    engine.registerProcedureInvoker(name, detail::makeProcTaskInvoker(std::move(fn)));
+}
+
+/**
+ * @brief Awaitable execution of a flow on a FlowScheduler
+ *
+ * The awaiting coroutine is resumed with the ExecutionResult on the
+ * scheduler's executor thread (inside FlowScheduler::poll()/run()), or not
+ * suspended at all if the flow finishes synchronously.
+ */
+class FlowExecution {
+public:
+    FlowExecution(FlowScheduler& scheduler, const Flow& flow, ParameterMap params)
+        : scheduler_(scheduler), flow_(flow), params_(std::move(params)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+        awaiting_ = awaiting;
+        scheduler_.submit(flow_, params_, [this](FlowScheduler::TaskId, const ExecutionResult& result) {
+            result_ = result;
+            if (submitted_) {
+                awaiting_.resume();
+            }
+        });
+        submitted_ = true;
+        return !result_.has_value(); // finished synchronously: continue without suspending
+    }
+
+    ExecutionResult await_resume() { return std::move(*result_); }
+
+private:
+    FlowScheduler& scheduler_;
+    Flow flow_;
+    ParameterMap params_;
+    std::coroutine_handle<> awaiting_;
+    std::optional<ExecutionResult> result_;
+    bool submitted_ = false;
+};
+
+/**
+ * @brief Execute a flow from a coroutine: co_await executeAsync(scheduler, flow, params)
+ */
+inline FlowExecution executeAsync(FlowScheduler& scheduler, const Flow& flow, ParameterMap params = {}) {
+    return FlowExecution(scheduler, flow, std::move(params));
+}
+
+} // namespace FlowGraph
+
+#endif // C++20 coroutines
@@ -1,14 +1,30 @@
 #pragma once
 
 #include "AST.hpp"
+#include "ColumnBatch.hpp"
+#include "CompiledFlow.hpp"
+#include "ProcBatcher.hpp"
+#include "ProcCache.hpp"
+#include "Profiler.hpp"
 #include "Types.hpp"
 #include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <filesystem>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <functional>
 #include <limits>
 #include <cmath>
 #include <iostream>
-#include <typeinfo>
 #include "ExpressionKit.hpp"
 
 namespace FlowGraph {
@@ -18,21 +34,23 @@ class Engine;
 class Flow;
 class ExecutionContext;
 class DebugExecutionContext;
+struct SubflowLink;
+
+namespace detail {
+class ColumnExecutor;
+}
 
 /**
  * @brief ExpressionKit Environment adapter for FlowGraph ExecutionContext
+ *
+ * Reads variables straight from the context's slot storage, nothing is copied
+ * when variables change.
  */
 class ExpressionEnvironment : public ExpressionKit::IEnvironment {
 public:
-    explicit ExpressionEnvironment(const ParameterMap& variables) : variables_(variables) {}
+    explicit ExpressionEnvironment(const ExecutionContext& context) : context_(context) {}
     
-    ExpressionKit::Value Get(const std::string& name) override {
-        auto it = variables_.find(name);
-        if (it == variables_.end()) {
-            throw ExpressionKit::ExprException("Variable not found: " + name);
-        }
-        return it->second; // Direct return since Value is now ExpressionKit::Value
-    }
+    ExpressionKit::Value Get(const std::string& name) override;
     
     ExpressionKit::Value Call(const std::string& name, const std::vector<ExpressionKit::Value>& args) override {
         // First try standard mathematical functions
@@ -46,12 +64,8 @@ public:
         throw ExpressionKit::ExprException("Unknown function: " + name);
     }
     
-    void updateVariables(const ParameterMap& variables) {
-        variables_ = variables;
-    }
-    
 private:
-    ParameterMap variables_;
+    const ExecutionContext& context_;
 };
 
 /**
@@ -60,12 +74,83 @@ private:
 enum class ExecutionState {
     NotStarted,      // Execution not started
     Running,         // Currently executing
-    Paused,          // Paused for debugging
+    Paused,          // Paused for debugging, or by an execution budget
     WaitingAsync,    // Waiting for async PROC completion
     Completed,       // Completed successfully
     Error            // Stopped due to error
 };
 
+/**
+ * @brief Lazy, read-only view of an execution context's variables
+ *
+ * Nothing is copied until a variable is read; the view is valid while the
+ * context exists and reflects its current values.
+ */
+class VariableView {
+public:
+    VariableView() = default;
+    explicit VariableView(const ExecutionContext& context) : context_(&context) {}
+    
+    /**
+     * @return The variable's value, or nullptr if it is not set
+     */
+    const Value* find(const std::string& name) const;
+    
+    /**
+     * @brief Call visit(name, value) for every set variable
+     */
+    template<typename Visitor>
+    void forEach(Visitor&& visit) const;
+    
+    /**
+     * @brief Copy all set variables
+     */
+    ParameterMap snapshot() const;
+    
+private:
+    const ExecutionContext* context_ = nullptr;
+};
+
+/**
+ * @brief Parked contexts of an ExecutionContextPool whose pending PROC has completed
+ *
+ * The thread completing the PROC reports the context here, so the pool only
+ * looks at contexts that may have become free. Shared with the parked
+ * contexts, which may outlive the pool.
+ */
+class ParkingLot {
+public:
+    void report(ExecutionContext* context) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!closed_) {
+            ready_.push_back(context);
+        }
+    }
+    
+    /**
+     * @brief Move the reported contexts into ready, leaving the lot empty
+     */
+    void take(std::vector<ExecutionContext*>& ready) {
+        ready.clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready.swap(ready_);
+    }
+    
+    /**
+     * @brief Ignore reports from now on (the pool is gone)
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        ready_.clear();
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<ExecutionContext*> ready_;
+    bool closed_ = false;
+};
+
 /**
  * @brief Debug step result
  */
@@ -73,7 +158,9 @@ struct DebugStepResult {
     ExecutionState state = ExecutionState::Running;
     std::string currentNodeId;
     std::string error;
-    ParameterMap localVariables;
+    VariableView variables;         // variables of the frame running currentNodeId
+    ParameterMap localVariables;    // snapshot, only filled by DebugExecutionContext::getCurrentState()
+    bool atBreakpoint = false;      // paused before a node with a breakpoint
     bool flowCompleted = false;
     bool waitingForAsync = false;  // true if waiting for async PROC
     std::string asyncProcName;     // name of PROC being waited for
@@ -92,44 +179,177 @@ using DebugCallback = std::function<void(const DebugStepResult&)>;
 
 /**
  * @brief Execution context for a single flow execution with debugging support
+ *
+ * Variables live in a flat slot vector. Slots of a CompiledFlow are resolved at
+ * compile time; names that are only seen at run time get additional slots.
  */
 class ExecutionContext {
 public:
-    ExecutionContext(const FlowAST& ast) : ast_(ast) {
-        initializeExpressionEnvironment();
+    ExecutionContext(const FlowAST& ast) : ast_(ast), program_(nullptr), slots_(nullptr), expressionEnv_(*this) {
+        setAsyncResumeHandler(nullptr);
+    }
+    
+    explicit ExecutionContext(const CompiledFlow& program)
+        : ast_(program.ast()), program_(&program), slots_(&program.slots()), expressionEnv_(*this) {
+        values_.resize(slots_->size());
+        assigned_.resize(slots_->size(), false);
+        procInputs_.resize(program.procNodeCount());
+        setAsyncResumeHandler(nullptr);
+    }
+    
+    ExecutionContext(const ExecutionContext&) = delete;
+    ExecutionContext& operator=(const ExecutionContext&) = delete;
+    
+    /**
+     * @brief Prepare the context for another execution of the same flow
+     *
+     * All variables become unassigned and the debug/async state is cleared.
+     * Slot storage, run-time slots and string buffers are kept, so executing
+     * the same flow again does not allocate for variable storage.
+     */
+    void reset() {
+        std::fill(assigned_.begin(), assigned_.end(), false);
+        state_ = ExecutionState::NotStarted;
+        currentNode_ = NoSymbol;
+        currentNodeName_.clear();
+        waitingAsyncProc_.clear();
+        debugCallback_ = nullptr;
+        procCallback_.SetTiming(false);
+        procCallback_.Reset();
+        callStack_.clear();
+        pausedTarget_ = {};
+        branchExit_ = {};
     }
     
+    /**
+     * @brief Compiled flow this context was created for (nullptr for AST-only contexts)
+     */
+    const CompiledFlow* getProgram() const { return program_; }
+    
     // Variable management
     void setVariable(const std::string& name, const Value& value) {
-        variables_[name] = value;
-        updateExpressionEnvironment();
+        setVariable(resolveSlot(name), value);
+    }
+    
+    void setVariable(SlotIndex slot, const Value& value) {
+        values_[slot] = value;
+        assigned_[slot] = true;
+    }
+    
+    void setVariable(SlotIndex slot, Value&& value) {
+        values_[slot] = std::move(value);
+        assigned_[slot] = true;
     }
     
     Value getVariable(const std::string& name) const {
-        auto it = variables_.find(name);
-        if (it == variables_.end()) {
+        const Value* value = findVariable(name);
+        if (!value) {
             throw FlowGraphError(FlowGraphError::Type::Runtime, "Variable not found: " + name);
         }
-        return it->second;
+        return *value;
     }
     
     bool hasVariable(const std::string& name) const {
-        return variables_.find(name) != variables_.end();
+        return findVariable(name) != nullptr;
+    }
+    
+    /**
+     * @brief Look up a variable without copying it
+     * @return Pointer into slot storage, or nullptr if the variable is not set
+     */
+    const Value* findVariable(const std::string& name) const {
+        auto slot = findSlot(name);
+        if (!slot || !assigned_[*slot]) {
+            return nullptr;
+        }
+        return &values_[*slot];
+    }
+    
+    const Value* findVariable(SlotIndex slot) const {
+        return assigned_[slot] ? &values_[slot] : nullptr;
     }
     
     // Parameter binding
     void bindParameters(const ParameterMap& params) {
         for (const auto& [name, value] : params) {
-            variables_[name] = value;
+            setVariable(name, value);
+        }
+    }
+    
+    /**
+     * @brief Leave RETURNS in slot storage instead of copying them into ExecutionResult
+     *
+     * Finished executions then report empty returnValues; read the values
+     * with findVariable(getProgram()->returnSlots()[i]) until the next
+     * execution. Kept across reset().
+     */
+    void setKeepReturnValues(bool keep) { keepReturnValues_ = keep; }
+    bool keepsReturnValues() const { return keepReturnValues_; }
+    
+    /**
+     * @brief Drop variables the rest of the execution does not read (see CompiledFlow::liveAfter())
+     *
+     * PROC inputs that are the last use of their variable are moved instead
+     * of copied, an execution suspended on an async PROC releases every
+     * variable not live after it (in all sub-flow frames), and RETURNS are
+     * moved into the result. The context's variables are then incomplete
+     * once an execution ran, so leave it off for contexts that are inspected.
+     * Kept across reset(); contexts returned to a pool are switched back off.
+     */
+    void setReleaseDeadValues(bool release) { releaseDeadValues_ = release; }
+    bool releasesDeadValues() const { return releaseDeadValues_; }
+    
+    /**
+     * @brief Move a variable's value out, leaving the variable unassigned
+     */
+    Value takeVariable(SlotIndex slot) {
+        assigned_[slot] = false;
+        return std::move(values_[slot]);
+    }
+    
+    /**
+     * @brief Unassign every compiled variable outside live (ascending), freeing string storage
+     */
+    void releaseVariablesExcept(SlotRange live) {
+        const SlotIndex* next = live.begin();
+        for (SlotIndex slot = 0; slot < compiledSlotCount(); ++slot) {
+            if (next != live.end() && *next == slot) {
+                ++next;
+            } else if (assigned_[slot]) {
+                assigned_[slot] = false;
+                Value released = std::move(values_[slot]);
+            }
         }
-        updateExpressionEnvironment();
     }
     
     ParameterMap extractReturnValues() const {
         ParameterMap returnValues;
+        if (program_) {
+            const auto& slots = program_->returnSlots();
+            for (size_t i = 0; i < slots.size(); ++i) {
+                if (const Value* value = findVariable(slots[i])) {
+                    returnValues[ast_.returnValues[i].name] = *value;
+                }
+            }
+            return returnValues;
+        }
         for (const auto& retVal : ast_.returnValues) {
-            if (hasVariable(retVal.name)) {
-                returnValues[retVal.name] = getVariable(retVal.name);
+            if (const Value* value = findVariable(retVal.name)) {
+                returnValues[retVal.name] = *value;
+            }
+        }
+        return returnValues;
+    }
+    
+    /**
+     * @brief Move the RETURNS out of a compiled context into a result map
+     */
+    ParameterMap takeReturnValues() {
+        ParameterMap returnValues;
+        const auto& slots = program_->returnSlots();
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (assigned_[slots[i]]) {
+                returnValues[ast_.returnValues[i].name] = takeVariable(slots[i]);
             }
         }
         return returnValues;
@@ -138,20 +358,58 @@ public:
     // Expression evaluation
     Value evaluateExpression(const std::string& expression) {
         try {
-            auto result = ExpressionKit::Expression::Eval(expression, expressionEnv_.get());
+            auto result = ExpressionKit::Expression::Eval(expression, &expressionEnv_);
             return result; // Direct return since Value is now ExpressionKit::Value
         } catch (const ExpressionKit::ExprException& e) {
             throw FlowGraphError(FlowGraphError::Type::Runtime, "Expression evaluation error: " + std::string(e.what()));
         }
     }
     
+    Value evaluateExpression(const ExpressionKit::ASTNode& expression) {
+        try {
+            return expression.evaluate(&expressionEnv_);
+        } catch (const ExpressionKit::ExprException& e) {
+            throw FlowGraphError(FlowGraphError::Type::Runtime, "Expression evaluation error: " + std::string(e.what()));
+        }
+    }
+    
     // Debugging support
+    
+    /**
+     * @brief Record the node being executed by its interned ID (CompiledNode::id)
+     */
+    void setCurrentNode(Symbol nodeId) { currentNode_ = nodeId; }
+    
     void setCurrentNode(const std::string& nodeId) {
-        currentNodeId_ = nodeId;
+        if (program_) {
+            currentNode_ = program_->symbols().intern(nodeId);
+        } else {
+            currentNodeName_ = nodeId;
+        }
+    }
+    
+    const std::string& getCurrentNode() const {
+        return program_ ? program_->symbols().name(currentNode_) : currentNodeName_;
+    }
+    
+    Symbol getCurrentNodeSymbol() const { return currentNode_; }
+    ParameterMap getLocalVariables() const {
+        ParameterMap variables;
+        forEachVariable([&variables](const std::string& name, const Value& value) { variables[name] = value; });
+        return variables;
     }
     
-    const std::string& getCurrentNode() const { return currentNodeId_; }
-    ParameterMap getLocalVariables() const { return variables_; }
+    /**
+     * @brief Call visit(name, value) for every set variable, without copying
+     */
+    template<typename Visitor>
+    void forEachVariable(Visitor&& visit) const {
+        for (SlotIndex slot = 0; slot < values_.size(); ++slot) {
+            if (assigned_[slot]) {
+                visit(slotName(slot), values_[slot]);
+            }
+        }
+    }
     ExecutionState getState() const { return state_; }
     void setState(ExecutionState state) { state_ = state; }
     
@@ -171,264 +429,1564 @@ public:
     const std::string& getWaitingAsyncProc() const { return waitingAsyncProc_; }
     bool isWaitingForAsync() const { return state_ == ExecutionState::WaitingAsync; }
     
-    // Debug callback
-    void setDebugCallback(DebugCallback callback) { debugCallback_ = callback; }
-    void notifyDebugger() const {
-        if (debugCallback_) {
-            DebugStepResult result;
-            result.state = state_;
-            result.currentNodeId = currentNodeId_;
-            result.localVariables = variables_;
-            result.flowCompleted = (state_ == ExecutionState::Completed);
-            result.waitingForAsync = isWaitingForAsync();
-            result.asyncProcName = waitingAsyncProc_;
-            debugCallback_(result);
-        }
-    }
-    
-private:
-    const FlowAST& ast_;
-    ParameterMap variables_;
-    std::unique_ptr<ExpressionEnvironment> expressionEnv_;
-    
-    // Debug state
-    ExecutionState state_ = ExecutionState::NotStarted;
-    std::string currentNodeId_;
-    DebugCallback debugCallback_;
-    
-    // Async state
-    std::string waitingAsyncProc_;
-    
-    void initializeExpressionEnvironment() {
-        expressionEnv_ = std::make_unique<ExpressionEnvironment>(variables_);
-    }
-    
-    void updateExpressionEnvironment() {
-        if (expressionEnv_) {
-            expressionEnv_->updateVariables(variables_);
-        }
-    }
-};
-
-/**
- * @brief Debug-enabled execution context
- */
-class DebugExecutionContext {
-public:
-    DebugExecutionContext(std::unique_ptr<ExecutionContext> context) : context_(std::move(context)) {}
-    
     /**
-     * @brief Step to next node
+     * @brief True while an async PROC may still complete into this context or one of its PAR branches
+     *
+     * Such a context must not be reset, reused or destroyed.
      */
-    DebugStepResult step() {
-        // TODO: Implement step execution logic
-        return DebugStepResult(ExecutionState::NotStarted, "");
+    bool hasPendingProc() const {
+        if (isWaitingForAsync() && !procCallback_.IsResolved()) {
+            return true;
+        }
+        if (branches_) {
+            for (const auto& branch : branches_->contexts) {
+                if (branch->hasPendingProc()) {
+                    return true;
+                }
+            }
+        }
+        return false;
     }
     
     /**
-     * @brief Continue execution until completion or breakpoint
+     * @brief Handler notified when a suspended PROC call of this context completes
+     *
+     * Invoked exactly once per suspension, on the thread that completes the
+     * PROC; it must hand the notification over to the thread that resumes the
+     * execution.
      */
-    ExecutionResult run() {
-        // TODO: Implement run execution logic
-        return ExecutionResult("Debug execution not yet implemented");
-    }
+    using AsyncResumeHandler = InplaceFunction<void()>;
     
-    /**
-     * @brief Pause execution
-     */
-    void pause() {
-        stepMode_ = true;
+    void setAsyncResumeHandler(AsyncResumeHandler handler) {
+        procCallback_.SetResumeHandler([this]() {
+            reportIfParked();
+            if (resumeHandler_) {
+                resumeHandler_();
+            }
+        });
+        resumeHandler_ = std::move(handler);
     }
     
     /**
-     * @brief Get current execution state
+     * @brief Report this context to lot whenever a PROC completes into it (see ExecutionContextPool)
+     *
+     * Called with the context's pending PROC outstanding; completions may
+     * report it from then on.
      */
-    DebugStepResult getCurrentState() const {
-        return createStepResult();
+    void park(std::shared_ptr<ParkingLot> lot) {
+        parkingLot_ = std::move(lot);
+        parked_.store(true, std::memory_order_release);
     }
     
     /**
-     * @brief Get local variables
+     * @brief Stop reporting; the context must no longer have a pending PROC
      */
-    ParameterMap getLocalVariables() const {
-        return context_->getLocalVariables();
+    void unpark() {
+        // Reset() waits for a completing thread still inside a handler that reports this context
+        procCallback_.Reset();
+        if (branches_) {
+            for (auto& branch : branches_->contexts) {
+                branch->procCallback_.Reset();
+            }
+        }
+        parked_.store(false, std::memory_order_relaxed);
+        parkingLot_.reset();
     }
     
     /**
-     * @brief Set variable value during debugging
+     * @brief Reset and return the context-owned completion callback for the next PROC call
+     *
+     * The callback lives as long as the context, so async PROCs may keep a
+     * reference to it until they complete.
      */
-    void setVariable(const std::string& name, const Value& value) {
-        context_->setVariable(name, value);
+    ProcCompletionCallback& beginProcCall() {
+        procCallback_.Reset();
+        return procCallback_;
     }
     
-    /**
-     * @brief Check if execution is paused
-     */
-    bool isPaused() const {
-        return context_->getState() == ExecutionState::Paused;
-    }
+    ProcCompletionCallback& getProcCallback() { return procCallback_; }
     
     /**
-     * @brief Check if execution is completed
+     * @brief Input parameter map kept per PROC node and reused across calls
      */
-    bool isCompleted() const {
-        return context_->getState() == ExecutionState::Completed;
-    }
+    struct ProcInputs {
+        ParameterMap params;
+        std::vector<Value*> values;   // one per input binding, pointing into params
+        uint64_t cacheKey = 0;        // ProcResultCache key of the values, pure PROCs only
+    };
     
-private:
-    std::unique_ptr<ExecutionContext> context_;
-    bool stepMode_ = false;
-    
-    DebugStepResult createStepResult() const {
-        DebugStepResult result;
-        result.state = context_->getState();
-        result.currentNodeId = context_->getCurrentNode();
-        result.localVariables = context_->getLocalVariables();
-        result.flowCompleted = isCompleted();
-        return result;
-    }
-};
-
-/**
- * @brief Loaded and ready-to-execute flow with debugging support
- */
-class Flow {
-public:
-    Flow(std::unique_ptr<FlowAST> ast, Engine* engine = nullptr) 
-        : ast_(std::move(ast)), engine_(engine) {}
+    ProcInputs& getProcInputs(uint32_t procIndex) { return procInputs_[procIndex]; }
     
     /**
-     * @brief Execute the flow with given parameters
+     * @brief Drop the input values held for every PROC node except keep
+     *
+     * The parameter maps keep their keys, so the next call of a node only
+     * assigns its values again.
      */
-    ExecutionResult execute(const ParameterMap& params = {});
+    void releaseProcInputs(const ProcInputs* keep = nullptr) {
+        for (auto& inputs : procInputs_) {
+            if (&inputs == keep) {
+                continue;
+            }
+            if (inputs.values.empty()) {
+                inputs.params.clear();   // built without bindings, rebuilt by the next call
+            }
+            for (Value* value : inputs.values) {
+                *value = Value();
+            }
+        }
+    }
     
     /**
-     * @brief Create a debug execution context for step-by-step execution
-     * @param params Input parameters
-     * @return Debug context for controlled execution
+     * @brief Node to continue from once the pending async PROC completes
      */
-    std::unique_ptr<DebugExecutionContext> createDebugContext(const ParameterMap& params = {});
+    void setSuspendedNode(NodeIndex node) { suspendedNode_ = node; }
+    NodeIndex getSuspendedNode() const { return suspendedNode_; }
     
     /**
-     * @brief Get flow metadata
+     * @brief Node to continue from once Flow::executeFor() used up its budget (state Paused)
      */
-    const std::string& getTitle() const { return ast_->title; }
-    const std::vector<Parameter>& getParameters() const { return ast_->parameters; }
-    const std::vector<ReturnValue>& getReturnValues() const { return ast_->returnValues; }
+    void setPausedTarget(CompiledTarget target) { pausedTarget_ = target; }
+    CompiledTarget getPausedTarget() const { return pausedTarget_; }
     
     /**
-     * @brief Validate flow structure
+     * @brief Sub-flow call (PROC other.flow) in progress
+     *
+     * The call stack lives in the context the execution was started with;
+     * callee frames run in contexts owned by their caller's context.
      */
-    std::vector<std::string> validate() const {
-        return ast_->validate();
-    }
+    struct CallFrame {
+        std::shared_ptr<const SubflowLink> link;  // callee and its bindings, pinned for the call
+        ExecutionContext* context;                // callee variables
+        NodeIndex callNode;                       // PROC node in the caller
+    };
     
-private:
-    std::unique_ptr<FlowAST> ast_;
-    Engine* engine_;  // Engine reference for PROC execution
+    void pushCallFrame(CallFrame frame) { callStack_.push_back(std::move(frame)); }
     
-    // Method declarations - implementations after Engine class
-    ExecutionResult executeInternal(ExecutionContext& context);
-    FlowNode* findStartNode(ExecutionContext& context);
-    std::string getNextNode(const std::string& currentNode, ExecutionContext& context);
-    void executeAssignNode(const AssignNode& node, ExecutionContext& context);
-    std::string executeCondNode(const CondNode& node, ExecutionContext& context);
-    void executeProcNode(const ProcNode& node, ExecutionContext& context);
-    void handleProcResult(const ProcResult& result, const ProcNode& node, ExecutionContext& context);
-};
-
-/**
- * @brief Main execution engine
- */
-class Engine {
-public:
-    Engine() {
-        registerBuiltinProcedures();
+    CallFrame popCallFrame() {
+        CallFrame frame = std::move(callStack_.back());
+        callStack_.pop_back();
+        return frame;
     }
     
-    ~Engine() = default;
+    /**
+     * @brief Innermost sub-flow call, nullptr while the started flow itself runs
+     */
+    const CallFrame* topCallFrame() const { return callStack_.empty() ? nullptr : &callStack_.back(); }
+    size_t callDepth() const { return callStack_.size(); }
     
     /**
-     * @brief Register external procedure with full definition
+     * @brief Sub-flow calls in progress, outermost first
      */
-    void registerProcedure(const std::string& name, const ProcDefinition& procDef) {
-        procedures_[name] = procDef;
-    }
+    const std::vector<CallFrame>& callFrames() const { return callStack_; }
     
     /**
-     * @brief Register external procedure with implementation only (for backward compatibility)
+     * @brief Reset and return the context for the sub-flow called by a PROC node
+     *
+     * Created on the first call and reused afterwards, so repeated sub-flow
+     * calls do not allocate variable storage. The program is only observed:
+     * a context left behind by a module that was replaced and freed since is
+     * created anew.
      */
-    void registerProcedure(const std::string& name, ExternalProcedure proc) {
-        ProcDefinition def;
-        def.title = name;
-        def.implementation = proc;
-        procedures_[name] = def;
+    ExecutionContext& subflowContext(uint32_t procIndex, const std::shared_ptr<const CompiledFlow>& program) {
+        if (subflowContexts_.size() < procInputs_.size()) {
+            subflowContexts_.resize(procInputs_.size());
+            subflowPrograms_.resize(procInputs_.size());
+        }
+        auto& context = subflowContexts_[procIndex];
+        if (!context || subflowPrograms_[procIndex].lock() != program) {
+            context = std::make_unique<ExecutionContext>(*program);
+            subflowPrograms_[procIndex] = program;
+        } else {
+            context->reset();
+        }
+        return *context;
     }
     
     /**
-     * @brief Register legacy synchronous procedure (for backward compatibility)
+     * @brief Branches of the PAR node a context is executing
+     *
+     * Every branch runs in a context of its own, started on a copy of the
+     * variables, so branches neither see nor race on each other's writes. A
+     * branch that suspends on an async PROC signals the started context when
+     * the PROC completes; the executor then continues the branch. Branch
+     * contexts are created by the first PAR and reused afterwards.
      */
-    void registerLegacyProcedure(const std::string& name, LegacyExternalProcedure proc) {
-        // Wrap legacy procedure in new async interface
-        auto asyncWrapper = [proc](const ParameterMap& params, ProcCompletionCallback& callback) -> void {
-            try {
-                // Execute synchronously
-                ParameterMap result = proc(params);
-                callback(ProcResult::completedSuccess(std::move(result)));
-            } catch (const std::exception& e) {
-                callback(ProcResult::completedError(e.what()));
+    struct ParallelBranches {
+        std::vector<std::unique_ptr<ExecutionContext>> contexts;   // may hold more than the current PAR uses
+        std::vector<bool> settled;            // per branch of the current PAR: reached a JOIN, failed, or
+                                              // abandoned after another branch failed
+        std::vector<uint32_t> writers;        // by slot: branch whose write is merged, used by mergeBranches()
+        ExecutionContext* root = nullptr;     // started context, its callback signals completed branch PROCs
+        std::atomic<bool> signalled{true};    // root signalled since the executor last looked at the branches
+        std::atomic<uint32_t> inFlight{0};    // suspended branches whose signal() has not returned yet
+        std::optional<NodeIndex> join;        // JOIN the settled branches reached
+        CompiledTarget emitted;               // first error emitted by a branch
+        std::exception_ptr failure;           // first branch that failed otherwise
+        
+        /**
+         * @brief Resume handler of the branch contexts: wake the executor once per look at the branches
+         */
+        void signal() {
+            if (!signalled.exchange(true, std::memory_order_acq_rel)) {
+                root->getProcCallback()(ProcResult::completedSuccess());
             }
-        };
+            root->reportIfParked();   // a parked root is free once its last branch completed
+            // Last access of the completing thread; the PAR does not finish before it
+            inFlight.fetch_sub(1, std::memory_order_release);
+        }
         
-        registerProcedure(name, asyncWrapper);
-    }
+        bool failed() const { return failure || emitted.kind != TargetKind::None; }
+    };
     
     /**
-     * @brief Create a flow from AST
+     * @brief Prepare branch contexts for a PAR node, each holding a copy of this context's variables
+     * @param root Context the execution was started with
      */
-    Flow createFlow(std::unique_ptr<FlowAST> ast) {
-        return Flow(std::move(ast), this);
+    ParallelBranches& beginBranches(size_t count, ExecutionContext& root) {
+        if (!branches_) {
+            branches_ = std::make_unique<ParallelBranches>();
+        }
+        ParallelBranches& branches = *branches_;
+        while (branches.contexts.size() < count) {
+            auto context = std::make_unique<ExecutionContext>(*program_);
+            context->isBranch_ = true;
+            context->setAsyncResumeHandler([&branches]() { branches.signal(); });
+            branches.contexts.push_back(std::move(context));
+        }
+        branches.settled.assign(count, false);
+        branches.root = &root;
+        branches.signalled.store(true, std::memory_order_relaxed);
+        branches.inFlight.store(0, std::memory_order_relaxed);
+        branches.join.reset();
+        branches.emitted = {};
+        branches.failure = nullptr;
+        for (size_t i = 0; i < count; ++i) {
+            ExecutionContext* context = branches.contexts[i].get();
+            context->reset();
+            context->values_ = values_;
+            context->assigned_ = assigned_;
+            context->dynamicSlots_ = dynamicSlots_;
+            context->releaseDeadValues_ = root.releaseDeadValues_;
+            context->procCallback_.SetTiming(root.procCallback_.IsTimed());
+            context->state_ = ExecutionState::Running;
+        }
+        return branches;
     }
     
+    ParallelBranches& branches() { return *branches_; }
+    
     /**
-     * @brief Get registered procedure definition
+     * @brief Apply the variable writes of settled branches
+     *
+     * A branch wrote a variable if its value differs from the one the branch
+     * started with. Two branches writing different values to one variable is
+     * an error.
      */
-    const ProcDefinition& getProcedureDefinition(const std::string& name) const {
-        auto it = procedures_.find(name);
-        if (it == procedures_.end()) {
-            throw FlowGraphError(FlowGraphError::Type::Runtime, "Procedure not found: " + name);
-        }
-        return it->second;
-    }
+    void mergeBranches(const std::string& parId);
     
     /**
-     * @brief Get registered procedure implementation
+     * @brief Whether this context runs a branch of a PAR node
      */
-    ExternalProcedure getProcedure(const std::string& name) const {
-        const auto& def = getProcedureDefinition(name);
-        return def.implementation;
-    }
+    bool isBranch() const { return isBranch_; }
     
     /**
-     * @brief Check if procedure is registered
+     * @brief Where a branch stopped: its JOIN node, an error emission, or END / a dead end
      */
-    bool hasProcedure(const std::string& name) const {
-        return procedures_.find(name) != procedures_.end();
-    }
+    const CompiledTarget& getBranchExit() const { return branchExit_; }
+    void setBranchExit(CompiledTarget target) { branchExit_ = target; }
+    
+    // Debug callback
+    void setDebugCallback(DebugCallback callback) { debugCallback_ = callback; }
     
     /**
-     * @brief Get all registered procedure names
+     * @brief Report the current node to the debug callback, with a lazy view of the variables
      */
-    std::vector<std::string> getRegisteredProcedures() const {
-        std::vector<std::string> names;
-        for (const auto& [name, def] : procedures_) {
-            names.push_back(name);
+    void notifyDebugger() const {
+        if (debugCallback_) {
+            DebugStepResult result;
+            result.state = state_;
+            result.currentNodeId = getCurrentNode();
+            result.variables = VariableView(*this);
+            result.flowCompleted = (state_ == ExecutionState::Completed);
+            result.waitingForAsync = isWaitingForAsync();
+            result.asyncProcName = waitingAsyncProc_;
+            debugCallback_(result);
+        }
+    }
+    
+private:
+    const FlowAST& ast_;
+    const CompiledFlow* program_;   // may be null
+    const SlotTable* slots_;        // compile-time slots, may be null
+    SlotTable dynamicSlots_;        // names first seen at run time, after the compiled slots
+    std::vector<Value> values_;
+    std::vector<bool> assigned_;
+    bool keepReturnValues_ = false;
+    bool releaseDeadValues_ = false;
+    ExpressionEnvironment expressionEnv_;
+    
+    // Debug state
+    ExecutionState state_ = ExecutionState::NotStarted;
+    Symbol currentNode_ = NoSymbol;
+    std::string currentNodeName_;   // AST-only contexts have no symbol table
+    DebugCallback debugCallback_;
+    
+    // Async state; what the callback's handler reads is declared before it,
+    // so it outlives the callback's wait for a running handler
+    std::string waitingAsyncProc_;
+    NodeIndex suspendedNode_ = 0;
+    CompiledTarget pausedTarget_;
+    AsyncResumeHandler resumeHandler_;
+    std::shared_ptr<ParkingLot> parkingLot_;   // set while released to a pool, see park()
+    std::atomic<bool> parked_{false};
+    ProcCompletionCallback procCallback_;
+    std::vector<ProcInputs> procInputs_;
+    
+    // Sub-flow calls
+    std::vector<CallFrame> callStack_;
+    std::vector<std::unique_ptr<ExecutionContext>> subflowContexts_;  // by procIndex
+    std::vector<std::weak_ptr<const CompiledFlow>> subflowPrograms_;  // programs of subflowContexts_
+    
+    // PAR branches
+    std::unique_ptr<ParallelBranches> branches_;
+    bool isBranch_ = false;
+    CompiledTarget branchExit_;
+    
+    void reportIfParked() {
+        if (parked_.load(std::memory_order_acquire)) {
+            parkingLot_->report(this);
+        }
+    }
+    
+    size_t compiledSlotCount() const { return slots_ ? slots_->size() : 0; }
+    
+    std::optional<SlotIndex> findSlot(const std::string& name) const {
+        if (slots_) {
+            if (auto slot = slots_->find(name)) {
+                return slot;
+            }
+        }
+        if (auto slot = dynamicSlots_.find(name)) {
+            return static_cast<SlotIndex>(compiledSlotCount() + *slot);
+        }
+        return std::nullopt;
+    }
+    
+    SlotIndex resolveSlot(const std::string& name) {
+        if (auto slot = findSlot(name)) {
+            return *slot;
+        }
+        SlotIndex slot = static_cast<SlotIndex>(compiledSlotCount() + dynamicSlots_.add(name));
+        values_.emplace_back();
+        assigned_.push_back(false);
+        return slot;
+    }
+    
+    const std::string& slotName(SlotIndex slot) const {
+        size_t compiled = compiledSlotCount();
+        return slot < compiled ? slots_->name(slot) : dynamicSlots_.name(static_cast<SlotIndex>(slot - compiled));
+    }
+};
+
+inline ExpressionKit::Value ExpressionEnvironment::Get(const std::string& name) {
+    const Value* value = context_.findVariable(name);
+    if (!value) {
+        throw ExpressionKit::ExprException("Variable not found: " + name);
+    }
+    return *value;
+}
+
+inline void ExecutionContext::mergeBranches(const std::string& parId) {
+    ParallelBranches& branches = *branches_;
+    constexpr uint32_t NoWriter = std::numeric_limits<uint32_t>::max();
+    branches.writers.assign(values_.size(), NoWriter);
+    for (uint32_t i = 0; i < branches.settled.size(); ++i) {
+        const ExecutionContext& branch = *branches.contexts[i];
+        for (SlotIndex slot = 0; slot < values_.size(); ++slot) {
+            // Branches cannot unassign a variable, an unassigned slot is unchanged
+            if (!branch.assigned_[slot] || (assigned_[slot] && sameValue(values_[slot], branch.values_[slot]))) {
+                continue;
+            }
+            uint32_t& writer = branches.writers[slot];
+            if (writer != NoWriter && !sameValue(branches.contexts[writer]->values_[slot], branch.values_[slot])) {
+                throw FlowGraphError(FlowGraphError::Type::Runtime,
+                    "Branches of PAR " + parId + " write different values to " + slotName(slot));
+            }
+            writer = i;
+        }
+    }
+    for (SlotIndex slot = 0; slot < values_.size(); ++slot) {
+        if (branches.writers[slot] != NoWriter) {
+            setVariable(slot, std::move(branches.contexts[branches.writers[slot]]->values_[slot]));
+        }
+    }
+}
+
+inline const Value* VariableView::find(const std::string& name) const {
+    return context_ ? context_->findVariable(name) : nullptr;
+}
+
+template<typename Visitor>
+inline void VariableView::forEach(Visitor&& visit) const {
+    if (context_) {
+        context_->forEachVariable(std::forward<Visitor>(visit));
+    }
+}
+
+inline ParameterMap VariableView::snapshot() const {
+    return context_ ? context_->getLocalVariables() : ParameterMap{};
+}
+
+/**
+ * @brief Execution hooks of the release path
+ *
+ * Flow's executor is instantiated per hook policy. With this policy every
+ * debug branch is compiled out: no per-node current-node tracking, no
+ * callback checks, and fused ASSIGN blocks run as one step.
+ */
+struct NoDebugHooks {
+    static constexpr bool enabled = false;
+    
+    bool beforeNode(const CompiledFlow&, const CompiledNode&, ExecutionContext&, CompiledTarget) { return false; }
+    void afterNode(const CompiledFlow&, const CompiledNode&) {}
+    void procResumed(const CompiledFlow&, const CompiledNode&, const ProcCompletionCallback&) {}
+    void procCacheLookup(const CompiledFlow&, const CompiledNode&, bool) {}
+};
+
+/**
+ * @brief How much one Flow::executeFor() call may run: a number of nodes, a point in time, or both
+ */
+struct ExecutionBudget {
+    using Clock = std::chrono::steady_clock;
+    
+    size_t maxSteps = 0;                          // nodes to execute, 0 for no limit
+    std::optional<Clock::time_point> deadline;    // no node is started after it
+    
+    static ExecutionBudget steps(size_t count) {
+        ExecutionBudget budget;
+        budget.maxSteps = count;
+        return budget;
+    }
+    
+    static ExecutionBudget until(Clock::time_point deadline) {
+        ExecutionBudget budget;
+        budget.deadline = deadline;
+        return budget;
+    }
+    
+    bool unlimited() const { return maxSteps == 0 && !deadline; }
+};
+
+/**
+ * @brief Execution hooks of a budgeted execution: pause once the budget is used up
+ *
+ * Wraps the hooks the execution runs with otherwise (release or profiling).
+ * Every node is a step, fused ASSIGN blocks included; a PAR node runs with
+ * its branches as one step. The node a call starts with always runs, so
+ * every call makes progress.
+ */
+template<typename Inner>
+class BudgetHooks {
+public:
+    static constexpr bool enabled = true;
+    
+    BudgetHooks(const ExecutionBudget& budget, Inner& inner) : budget_(budget), inner_(inner) {}
+    
+    BudgetHooks(const BudgetHooks&) = delete;
+    BudgetHooks& operator=(const BudgetHooks&) = delete;
+    
+    bool beforeNode(const CompiledFlow& program, const CompiledNode& node, ExecutionContext& frame,
+                    CompiledTarget target) {
+        if (steps_ > 0 && exhausted()) {
+            pausedAt_ = target;
+            return true;
+        }
+        ++steps_;
+        return inner_.beforeNode(program, node, frame, target);
+    }
+    
+    void afterNode(const CompiledFlow& program, const CompiledNode& node) { inner_.afterNode(program, node); }
+    
+    void procResumed(const CompiledFlow& program, const CompiledNode& node, const ProcCompletionCallback& callback) {
+        inner_.procResumed(program, node, callback);
+    }
+    
+    void procCacheLookup(const CompiledFlow& program, const CompiledNode& node, bool hit) {
+        inner_.procCacheLookup(program, node, hit);
+    }
+    
+    /**
+     * @brief Hooks the branches of a PAR node run with; branches are never paused
+     */
+    Inner& inner() { return inner_; }
+    
+    /**
+     * @brief Node the execution paused before
+     */
+    CompiledTarget pausedAt() const { return pausedAt_; }
+    
+    size_t steps() const { return steps_; }
+    
+private:
+    const ExecutionBudget& budget_;
+    Inner& inner_;
+    size_t steps_ = 0;
+    CompiledTarget pausedAt_;
+    
+    bool exhausted() const {
+        return (budget_.maxSteps != 0 && steps_ >= budget_.maxSteps) ||
+               (budget_.deadline && ExecutionBudget::Clock::now() >= *budget_.deadline);
+    }
+};
+
+/**
+ * @brief Thread-safe pool of reusable execution contexts for one compiled flow
+ *
+ * Released contexts are reset and handed out again by acquire(), so a flow
+ * executed at a high rate reuses the same variable storage instead of
+ * building a new context per execution. A context released while an async
+ * PROC may still complete into it is parked until the PROC has completed;
+ * one whose PROC never completes is not freed, not even with the pool.
+ * Completions report parked contexts to a ParkingLot, so acquire() only
+ * looks at those instead of every parked context.
+ */
+class ExecutionContextPool {
+public:
+    explicit ExecutionContextPool(std::shared_ptr<const CompiledFlow> program)
+        : program_(std::move(program)), lot_(std::make_shared<ParkingLot>()) {}
+    
+    ~ExecutionContextPool() {
+        lot_->close();
+        for (auto& [raw, context] : parked_) {
+            if (context->hasPendingProc()) {
+                context.release();   // the pending PROC still holds its callback
+            }
+        }
+    }
+    
+    ExecutionContextPool(const ExecutionContextPool&) = delete;
+    ExecutionContextPool& operator=(const ExecutionContextPool&) = delete;
+    
+    /**
+     * @brief Take a context from the pool, creating one if the pool is empty
+     */
+    std::unique_ptr<ExecutionContext> acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            reclaimReported();
+            if (!available_.empty()) {
+                auto context = std::move(available_.back());
+                available_.pop_back();
+                return context;
+            }
+        }
+        return std::make_unique<ExecutionContext>(*program_);
+    }
+    
+    /**
+     * @brief Reset a context and return it to the pool
+     * @throws FlowGraphError if the context was created for a different flow
+     */
+    void release(std::unique_ptr<ExecutionContext> context) {
+        if (!context) {
+            return;
+        }
+        if (context->getProgram() != program_.get()) {
+            throw FlowGraphError(FlowGraphError::Type::Runtime, "Execution context belongs to a different flow");
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (context->hasPendingProc()) {
+            // The pending PROC may still complete into it
+            ExecutionContext* parked = context.get();
+            parked->park(lot_);
+            parked_.emplace(parked, std::move(context));
+            if (!parked->hasPendingProc()) {
+                lot_->report(parked);   // completed before it was parked
+            }
+            return;
+        }
+        recycle(std::move(context));
+    }
+    
+    /**
+     * @brief Number of idle contexts held by the pool
+     */
+    size_t available() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return available_.size();
+    }
+    
+    /**
+     * @brief Number of released contexts still waiting for an async PROC
+     */
+    size_t parked() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return parked_.size();
+    }
+    
+private:
+    std::shared_ptr<const CompiledFlow> program_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ExecutionContext>> available_;
+    std::unordered_map<ExecutionContext*, std::unique_ptr<ExecutionContext>> parked_;
+    std::shared_ptr<ParkingLot> lot_;
+    std::vector<ExecutionContext*> reported_;
+    
+    void recycle(std::unique_ptr<ExecutionContext> context) {
+        context->setAsyncResumeHandler(nullptr);
+        context->setKeepReturnValues(false);
+        context->setReleaseDeadValues(false);
+        context->reset();
+        available_.push_back(std::move(context));
+    }
+    
+    void reclaimReported() {
+        lot_->take(reported_);
+        for (ExecutionContext* context : reported_) {
+            // Reports may be repeated or stale; a PAR node's root stays parked until its last branch completed
+            auto parked = parked_.find(context);
+            if (parked != parked_.end() && !context->hasPendingProc()) {
+                std::unique_ptr<ExecutionContext> owned = std::move(parked->second);
+                parked_.erase(parked);
+                owned->unpark();
+                recycle(std::move(owned));
+            }
+        }
+    }
+};
+
+/**
+ * @brief Resolved sub-flow call of a PROC node (PROC auth/login.flow)
+ *
+ * Bindings are precompiled to slot pairs, so a call copies values between
+ * the caller's and the callee's contexts without building parameter maps.
+ */
+struct SubflowLink {
+    struct Transfer {
+        SlotIndex from;
+        SlotIndex to;
+        const std::string* name;   // callee variable without a compiled slot, set by name
+    };
+    
+    std::shared_ptr<const Flow> callee;
+    std::vector<Transfer> inputs;   // caller slot -> callee slot (>> bindings)
+    std::vector<Transfer> outputs;  // callee RETURNS slot -> caller slot (<< bindings)
+};
+
+/**
+ * @brief Sub-flow links of a flow's PROC nodes, shared by copies of the flow
+ *
+ * Links are published atomically while modules are (re)linked. A call
+ * frame holds on to the link it entered, and the link to its callee, so a
+ * replaced link and module live as long as calls still run in them.
+ */
+class SubflowTable {
+public:
+    explicit SubflowTable(std::vector<bool> moduleCalls)
+        : links_(moduleCalls.size()), moduleCalls_(std::move(moduleCalls)) {}
+    
+    std::shared_ptr<const SubflowLink> find(uint32_t procIndex) const {
+        return std::atomic_load(&links_[procIndex]);
+    }
+    
+    /**
+     * @brief True if the PROC node names a module (a .flow path)
+     */
+    bool isModuleCall(uint32_t procIndex) const { return moduleCalls_[procIndex]; }
+    
+    void publish(uint32_t procIndex, std::shared_ptr<const SubflowLink> link) {
+        std::atomic_store(&links_[procIndex], std::move(link));
+    }
+    
+    /**
+     * @brief Drop every link, breaking reference cycles between modules that call each other
+     */
+    void clear() {
+        for (auto& link : links_) {
+            std::atomic_store(&link, std::shared_ptr<const SubflowLink>());
+        }
+    }
+    
+private:
+    std::vector<std::shared_ptr<const SubflowLink>> links_;
+    std::vector<bool> moduleCalls_;
+};
+
+/**
+ * @brief What a PROC node calls: the procedure's invoker and, for pure procedures, its result cache
+ */
+struct ProcHandle {
+    const ProcInvoker* invoker = nullptr;
+    ProcResultCache* cache = nullptr;
+    ProcFunction function = nullptr;   // called instead of the invoker when set
+    
+    explicit operator bool() const { return invoker != nullptr; }
+    
+    void invoke(const ParameterMap& params, ProcCompletionCallback& callback) const {
+        if (function) {
+            function(params, callback);
+        } else {
+            (*invoker)(params, callback);
+        }
+    }
+};
+
+/**
+ * @brief A registered procedure, immutable once published
+ *
+ * The invoker may point into the entry (definition, legacy function,
+ * batcher), so entries are never moved.
+ */
+struct ProcEntry {
+    ProcDefinition definition;
+    LegacyExternalProcedure legacy;  // set for legacy procedures
+    ProcInvoker invoker;             // what PROC nodes call
+    ProcFunction function = nullptr; // set for plain functions, which PROC nodes call directly
+    std::unique_ptr<ProcResultCache> cache;  // set for pure procedures
+    std::unique_ptr<ProcBatcher> batcher;    // set for batched procedures
+};
+
+/**
+ * @brief Registry slot of one procedure name
+ *
+ * A slot keeps its address for the life of the engine and holds the current
+ * entry of its name, or none while the name is not registered. Flows resolve
+ * their PROC names to slots once, on construction; registering the name
+ * later, or again, publishes a new entry that the next call picks up.
+ */
+class ProcSlot {
+public:
+    const ProcEntry* entry() const { return entry_.load(std::memory_order_acquire); }
+    
+    ProcHandle handle() const {
+        const ProcEntry* current = entry();
+        return current ? ProcHandle{&current->invoker, current->cache.get(), current->function} : ProcHandle();
+    }
+    
+private:
+    friend class Engine;
+    std::atomic<const ProcEntry*> entry_{nullptr};
+};
+
+/**
+ * @brief Loaded and ready-to-execute flow with debugging support
+ *
+ * The AST is compiled into a CompiledFlow on construction; copies of a Flow
+ * share the same immutable compiled program and execution context pool.
+ *
+ * Thread safety: a Flow and its compiled program are immutable after
+ * construction, so execute(), executeBatch() and the other const members may
+ * be called concurrently. The Engine must outlive the Flow. Procedures may be
+ * registered while flows execute: calls already made finish on the entry they
+ * started with, later ones use the new one. PROC implementations are called
+ * concurrently and must be thread-safe themselves.
+ */
+class Flow {
+public:
+    /**
+     * @brief Compile a flow, binding its PROC nodes to the engine's procedures
+     *
+     * Procedures registered later are looked up by name when the node runs;
+     * validate() reports procedures that are still missing.
+     */
+    Flow(std::unique_ptr<FlowAST> ast, Engine* engine = nullptr);
+    
+    /**
+     * @brief Maximum nesting of sub-flow calls, deeper (runaway recursive) calls fail
+     */
+    static constexpr size_t MaxCallDepth = 256;
+    
+    /**
+     * @brief Execute the flow with given parameters
+     */
+    ExecutionResult execute(const ParameterMap& params = {}) const;
+    
+    /**
+     * @brief Execute the flow in a caller-owned context
+     *
+     * The context is reset before parameters are bound and keeps the final
+     * variable values afterwards. It must come from acquireContext() or be
+     * constructed from getProgram().
+     */
+    ExecutionResult execute(ExecutionContext& context, const ParameterMap& params = {}) const;
+    
+    /**
+     * @brief Start an execution that may suspend on async PROCs
+     *
+     * Runs until the flow finishes or a PROC does not complete synchronously.
+     * In the latter case the context is left waiting (isWaitingForAsync()) and
+     * resume() continues the execution after the PROC's callback fired.
+     * Starting the context again before that fails, since the pending PROC
+     * still holds the context's callback. FlowScheduler drives this for many
+     * executions at once.
+     *
+     * @return Result of the finished execution, or std::nullopt if suspended
+     */
+    std::optional<ExecutionResult> start(ExecutionContext& context, const ParameterMap& params = {}) const;
+    
+    /**
+     * @brief Start an execution whose variables are set by a callback instead of a parameter map
+     *
+     * bind(context) runs once the context is reset, e.g. to set PARAMS by
+     * slot (CompiledFlow::paramSlots()) without building a ParameterMap.
+     * Otherwise the same as start().
+     */
+    template<typename Bind>
+    std::optional<ExecutionResult> startBinding(ExecutionContext& context, Bind&& bind) const;
+    
+    /**
+     * @brief Continue a suspended execution at the node after its PROC
+     * @return Result of the finished execution, or std::nullopt if it suspended
+     *         again or the pending PROC has not completed yet
+     */
+    std::optional<ExecutionResult> resume(ExecutionContext& context) const;
+    
+    /**
+     * @brief Run an execution until it finishes or its budget is used up
+     *
+     * Continues the context where it stopped: a context paused by an earlier
+     * call continues with its next node, one waiting for an async PROC
+     * resumes once the PROC completed. Any other context starts a new
+     * execution with params. When the budget is used up the context is left
+     * Paused, ready for the next call - e.g. in the next frame of a game loop.
+     * Every node counts as a step, and at least one node runs per call.
+     *
+     * @return Result of the finished execution, or std::nullopt if it paused
+     *         (getState() is Paused) or waits for an async PROC
+     */
+    std::optional<ExecutionResult> executeFor(ExecutionContext& context, const ExecutionBudget& budget,
+                                              const ParameterMap& params = {}) const;
+    
+    /**
+     * @brief Execute the flow once for every parameter set
+     * @param batch Parameter sets; results are returned in the same order
+     * @param threadCount Worker threads, 0 uses the hardware concurrency and
+     *        1 runs the whole batch on the calling thread
+     */
+    std::vector<ExecutionResult> executeBatch(const std::vector<ParameterMap>& batch, size_t threadCount = 1) const;
+    
+    /**
+     * @brief Execute the flow once for every lane of a columnar batch
+     *
+     * Variables are bound from the columns of the same name. ASSIGN and COND
+     * nodes with typed code run as one loop per instruction over a chunk of
+     * lanes, and a COND splits the chunk's lane mask between its ports instead
+     * of branching per lane. A lane leaves the columnar path wherever the
+     * typed code would leave the decision to ExpressionKit, or at a node
+     * without typed code, a PROC or a PAR. From that node on it runs on the
+     * scalar path, so every lane ends as execute() would end. Columnar nodes
+     * are not profiled.
+     *
+     * @param threadCount Worker threads, as for executeBatch()
+     * @return Number and Boolean RETURNS of the lanes that succeeded, and the errors of the others
+     */
+    ColumnBatchResult executeColumns(const ColumnBatch& batch, size_t threadCount = 1) const;
+    
+    /**
+     * @brief Take a reusable execution context from this flow's pool
+     */
+    std::unique_ptr<ExecutionContext> acquireContext() const { return contextPool_->acquire(); }
+    
+    /**
+     * @brief Return a context obtained from acquireContext() to the pool
+     *
+     * A context still waiting for an async PROC is kept aside until the PROC
+     * completes, so a late completion never lands in a freed or reused context.
+     */
+    void releaseContext(std::unique_ptr<ExecutionContext> context) const { contextPool_->release(std::move(context)); }
+    
+    /**
+     * @brief Create a debug execution context for step-by-step execution
+     * @param params Input parameters
+     * @return Debug context for controlled execution
+     */
+    std::unique_ptr<DebugExecutionContext> createDebugContext(const ParameterMap& params = {}) const;
+    
+    /**
+     * @brief Get flow metadata
+     */
+    const std::string& getTitle() const { return program_->ast().title; }
+    const std::vector<Parameter>& getParameters() const { return program_->ast().parameters; }
+    const std::vector<ReturnValue>& getReturnValues() const { return program_->ast().returnValues; }
+    
+    /**
+     * @brief Get the compiled execution program
+     */
+    const CompiledFlow& getProgram() const { return *program_; }
+    
+    /**
+     * @brief Validate flow structure
+     */
+    std::vector<std::string> validate() const;
+    
+    /**
+     * @brief PROC nodes naming a procedure that is not registered, like validate() reports them
+     *
+     * Module calls are left to the link step (see linkModules()).
+     */
+    std::vector<std::string> missingProcedures() const;
+    
+    /**
+     * @brief Link PROC nodes naming a module (PROC auth/login.flow) to the engine's modules
+     *
+     * Linked calls run natively: the callee executes on a call-frame stack of
+     * the same execution, with no parameter maps and no nested execute().
+     * References are resolved relative to moduleName's directory, then from
+     * the library root. Flows link on construction and on first call as
+     * well; FlowGraphEngine::loadDirectory() relinks every module once all
+     * are registered. Copies of the flow share the links.
+     *
+     * @return Module references that could not be resolved
+     */
+    std::vector<std::string> linkModules(const std::string& moduleName = "") const;
+    
+    /**
+     * @brief Profile executions of this flow, overriding the engine's profiler
+     *
+     * Pass nullptr to fall back to the engine's profiler. Not synchronized
+     * with running executions; set it before the flow is shared.
+     */
+    void setProfiler(std::shared_ptr<Profiler> profiler) { profiler_ = std::move(profiler); }
+    
+private:
+    std::shared_ptr<const CompiledFlow> program_;
+    std::shared_ptr<ExecutionContextPool> contextPool_;
+    Engine* engine_;  // Engine reference for PROC execution
+    std::shared_ptr<const std::vector<const ProcSlot*>> procSlots_;  // by CompiledNode::procIndex, null for modules
+    std::shared_ptr<SubflowTable> subflows_;
+    std::shared_ptr<Profiler> profiler_;
+    
+    Profiler* activeProfiler() const;
+    ProcHandle resolveProcedure(const CompiledNode& node) const;
+    std::shared_ptr<const SubflowLink> findSubflow(const CompiledNode& node) const;
+    void releaseParkedValues(ExecutionContext& context, const CompiledNode& suspended) const;
+    void releaseMovedInputs(const CompiledNode& node, ExecutionContext& context) const;
+    // Method declarations - implementations after Engine class
+    friend class Engine;
+    friend class DebugExecutionContext;
+    friend class detail::ColumnExecutor;
+    
+    template<typename Hooks>
+    std::optional<ExecutionResult> startWith(ExecutionContext& context, const ParameterMap& params, Hooks& hooks) const;
+    template<typename Bind, typename Hooks>
+    std::optional<ExecutionResult> bindAndRun(ExecutionContext& context, Bind& bind, Hooks& hooks) const;
+    template<typename Hooks>
+    std::optional<ExecutionResult> continueWith(ExecutionContext& context, const ParameterMap& params,
+                                                Hooks& hooks) const;
+    template<typename Hooks>
+    std::optional<ExecutionResult> executeInternal(ExecutionContext& context, Hooks& hooks) const;
+    template<typename Hooks>
+    std::optional<ExecutionResult> resumeWith(ExecutionContext& context, Hooks& hooks) const;
+    template<typename Hooks>
+    std::optional<ExecutionResult> run(ExecutionContext& context, CompiledTarget target, Hooks& hooks) const;
+    static bool evaluateTyped(const CompiledNode& node, const ExecutionContext& context, Value& result);
+    void executeAssignNode(const CompiledNode& node, ExecutionContext& context) const;
+    CompiledTarget executeCondNode(const CompiledNode& node, ExecutionContext& context) const;
+    template<typename Hooks>
+    CompiledTarget executeProcNode(const CompiledNode& node, ExecutionContext& context, ExecutionContext& root,
+                                   Hooks& hooks) const;
+    CompiledTarget handleProcResult(const ProcResult& result, const CompiledNode& node, ExecutionContext& context) const;
+    CompiledTarget applyProcOutputs(const ParameterMap& values, const CompiledNode& node, ExecutionContext& context) const;
+    ExecutionContext& enterSubflow(const CompiledNode& node, NodeIndex callNode,
+                                   std::shared_ptr<const SubflowLink> link, ExecutionContext& caller,
+                                   ExecutionContext& root) const;
+    CompiledTarget returnFromSubflow(const ExecutionContext::CallFrame& frame, CompiledTarget target,
+                                     ExecutionContext& caller) const;
+    template<typename Hooks>
+    CompiledTarget executeParNode(const CompiledNode& node, ExecutionContext& context, ExecutionContext& root,
+                                  Hooks& hooks) const;
+    template<typename Hooks>
+    CompiledTarget joinBranches(const CompiledNode& node, ExecutionContext& context, ExecutionContext& root,
+                                Hooks& hooks) const;
+    void settleBranch(const CompiledNode& node, ExecutionContext::ParallelBranches& branches, size_t branch) const;
+    CompiledTarget finishBranches(const CompiledNode& node, ExecutionContext& context) const;
+};
+
+/**
+ * @brief Debug-enabled execution of a flow: stepping, breakpoints and callbacks
+ *
+ * Runs the flow through the debug instantiation of Flow's executor, which
+ * records the current node, reports every node to the debug callback and runs
+ * fused ASSIGN blocks one node at a time. Steps into sub-flow calls; a PAR node
+ * and its branches run as one step. Breakpoints name nodes of the debugged
+ * flow. pause() may be called from another thread while run() executes.
+ */
+class DebugExecutionContext {
+public:
+    DebugExecutionContext(Flow flow, std::unique_ptr<ExecutionContext> context);
+    
+    /**
+     * @brief Execute the next node and pause before the one after it
+     */
+    DebugStepResult step();
+    
+    /**
+     * @brief Continue execution until completion, a breakpoint or pause()
+     *
+     * An execution waiting for an async PROC continues once the PROC's
+     * callback fired; until then the result reports waitingForAsync.
+     */
+    DebugStepResult run();
+    
+    /**
+     * @brief Pause execution before the next node
+     */
+    void pause() {
+        hooks_.pauseRequested.store(true, std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief Pause before a node of the debugged flow whenever it is reached
+     */
+    void addBreakpoint(const std::string& nodeId);
+    void removeBreakpoint(const std::string& nodeId);
+    void clearBreakpoints() { hooks_.breakpoints.clear(); }
+    bool hasBreakpoint(const std::string& nodeId) const;
+    
+    /**
+     * @brief Called before every node with the node's ID and a lazy view of the variables
+     */
+    void setDebugCallback(DebugCallback callback) { hooks_.callback = std::move(callback); }
+    
+    /**
+     * @brief Get current execution state, including a snapshot of the variables
+     */
+    DebugStepResult getCurrentState() const {
+        DebugStepResult result = createStepResult();
+        result.localVariables = result.variables.snapshot();
+        return result;
+    }
+    
+    /**
+     * @brief Get local variables
+     */
+    ParameterMap getLocalVariables() const {
+        return context_->getLocalVariables();
+    }
+    
+    /**
+     * @brief Set variable value during debugging
+     */
+    void setVariable(const std::string& name, const Value& value) {
+        context_->setVariable(name, value);
+    }
+    
+    /**
+     * @brief Check if execution is paused
+     */
+    bool isPaused() const {
+        return context_->getState() == ExecutionState::Paused;
+    }
+    
+    /**
+     * @brief Check if execution is completed
+     */
+    bool isCompleted() const {
+        return context_->getState() == ExecutionState::Completed;
+    }
+    
+    /**
+     * @brief True once the flow completed or failed
+     */
+    bool isFinished() const { return result_.has_value(); }
+    
+    /**
+     * @brief Result of the finished execution
+     */
+    const std::optional<ExecutionResult>& getResult() const { return result_; }
+    
+private:
+    struct Hooks {
+        static constexpr bool enabled = true;
+        
+        const CompiledFlow* program = nullptr;     // flow the breakpoints belong to
+        std::unordered_set<Symbol> breakpoints;
+        DebugCallback callback;
+        std::atomic<bool> pauseRequested{false};
+        bool stepping = false;
+        bool resumed = false;       // continuing from a pause: run the paused node first
+        size_t executed = 0;        // nodes started by the current step() or run()
+        bool atBreakpoint = false;
+        CompiledTarget pausedAt;
+        
+        bool beforeNode(const CompiledFlow& nodeProgram, const CompiledNode& node, ExecutionContext& frame,
+                        CompiledTarget target);
+        void afterNode(const CompiledFlow&, const CompiledNode&) {}
+        void procResumed(const CompiledFlow&, const CompiledNode&, const ProcCompletionCallback&) {}
+        void procCacheLookup(const CompiledFlow&, const CompiledNode&, bool) {}
+    };
+    
+    Flow flow_;
+    std::unique_ptr<ExecutionContext> context_;
+    Hooks hooks_;
+    std::optional<ExecutionResult> result_;
+    
+    DebugStepResult advance(bool stepping);
+    
+    const ExecutionContext& currentFrame() const {
+        const auto* frame = context_->topCallFrame();
+        return frame ? *frame->context : *context_;
+    }
+    
+    DebugStepResult createStepResult() const {
+        const ExecutionContext& frame = currentFrame();
+        DebugStepResult result;
+        result.state = context_->getState();
+        result.currentNodeId = frame.getCurrentNode();
+        result.variables = VariableView(frame);
+        result.atBreakpoint = isPaused() && hooks_.atBreakpoint;
+        result.flowCompleted = isCompleted();
+        result.waitingForAsync = context_->isWaitingForAsync();
+        result.asyncProcName = context_->getWaitingAsyncProc();
+        if (result_ && !result_->success) {
+            result.error = result_->error;
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief Main execution engine
+ */
+class Engine {
+public:
+    Engine() {
+        registerBuiltinProcedures();
+    }
+    
+    ~Engine() {
+        // Modules calling each other hold one another through their links
+        for (const auto& [name, module] : modules_) {
+            module->subflows_->clear();
+        }
+        for (const auto& replaced : replacedModules_) {
+            if (auto module = replaced.lock()) {
+                module->subflows_->clear();
+            }
+        }
+    }
+    
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+    
+    /**
+     * @brief Register external procedure with full definition
+     *
+     * Registration is thread-safe, also while flows of the engine execute;
+     * lookups never lock. A replaced procedure is kept alive with the engine
+     * because calls in flight may still use it.
+     *
+     * An implementation holding a plain function is called directly. Any
+     * other callable stays inside its std::function, so each call also goes
+     * through std::function's dispatch; register functions known at compile
+     * time with registerProcedure<&fn>() to avoid that.
+     */
+    void registerProcedure(const std::string& name, const ProcDefinition& procDef) {
+        auto entry = std::make_unique<ProcEntry>();
+        entry->definition = procDef;
+        if (procDef.pure) {
+            entry->cache = std::make_unique<ProcResultCache>(procDef.cacheCapacity, procDef.cacheTtl);
+        }
+        const ExternalProcedure* implementation = &entry->definition.implementation;
+        if (const ProcFunction* function = implementation->target<ProcFunction>()) {
+            entry->function = *function;
+        }
+        entry->invoker = [implementation](const ParameterMap& params, ProcCompletionCallback& callback) {
+            (*implementation)(params, callback);
+        };
+        publishProcedure(name, std::move(entry));
+    }
+    
+    /**
+     * @brief Register external procedure with implementation only (for backward compatibility)
+     */
+    void registerProcedure(const std::string& name, ExternalProcedure proc) {
+        ProcDefinition def;
+        def.title = name;
+        def.implementation = std::move(proc);
+        registerProcedure(name, def);
+    }
+    
+    /**
+     * @brief Register a procedure whose concurrent calls are coalesced into batches
+     *
+     * Calls from executions in flight together (e.g. under a FlowScheduler)
+     * reach the implementation as one batch; see ProcBatcher. Unless the
+     * window is zero, calls complete on the batcher's thread, so flows using
+     * the procedure must be run with start()/resume() or a scheduler.
+     */
+    void registerBatchedProcedure(const std::string& name, const BatchedProcDefinition& procDef) {
+        auto entry = std::make_unique<ProcEntry>();
+        entry->batcher = std::make_unique<ProcBatcher>(procDef.implementation, procDef.maxBatchSize, procDef.window);
+        entry->definition = ProcDefinition(procDef.title, procDef.parameters, procDef.returnValues, procDef.errors, nullptr);
+        ProcBatcher* batcher = entry->batcher.get();
+        entry->invoker = [batcher](const ParameterMap& params, ProcCompletionCallback& callback) {
+            batcher->call(params, callback);
+        };
+        entry->definition.implementation = [batcher](const ParameterMap& params, ProcCompletionCallback& callback) {
+            batcher->call(params, callback);
+        };
+        publishProcedure(name, std::move(entry));
+    }
+    
+    /**
+     * @brief Register a procedure known at compile time, dispatched without type erasure
+     *
+     * Fn is a function with either the async signature
+     * `void(const ParameterMap&, ProcCompletionCallback&)` or the legacy
+     * signature `ParameterMap(const ParameterMap&)`:
+     * @code
+     * engine.registerProcedure<&myProc>("my_proc");
+     * @endcode
+     */
+    template<auto Fn>
+    void registerProcedure(const std::string& name) {
+        using FnType = decltype(Fn);
+        auto entry = std::make_unique<ProcEntry>();
+        entry->definition.title = name;
+        if constexpr (std::is_invocable_v<FnType, const ParameterMap&, ProcCompletionCallback&>) {
+            entry->function = &callProcedure<Fn>;
+        } else {
+            static_assert(std::is_invocable_r_v<ParameterMap, FnType, const ParameterMap&>,
+                          "Procedure must be void(const ParameterMap&, ProcCompletionCallback&) or ParameterMap(const ParameterMap&)");
+            entry->function = &callLegacyProcedure<Fn>;
+        }
+        // PROC nodes call the function itself; the invoker serves findProcedureInvoker()
+        entry->definition.implementation = entry->function;
+        entry->invoker = entry->function;
+        publishProcedure(name, std::move(entry));
+    }
+    
+    /**
+     * @brief Register a procedure by the invoker PROC nodes call, bypassing std::function
+     *
+     * For front-ends that wrap their own callables, such as
+     * registerCoroutineProcedure(). getProcedure() hands out a std::function
+     * calling the invoker.
+     */
+    void registerProcedureInvoker(const std::string& name, ProcInvoker invoker) {
+        auto entry = std::make_unique<ProcEntry>();
+        entry->definition.title = name;
+        entry->invoker = std::move(invoker);
+        const ProcInvoker* direct = &entry->invoker;
+        entry->definition.implementation = [direct](const ParameterMap& params, ProcCompletionCallback& callback) {
+            (*direct)(params, callback);
+        };
+        publishProcedure(name, std::move(entry));
+    }
+    
+    /**
+     * @brief Register legacy synchronous procedure (for backward compatibility)
+     */
+    void registerLegacyProcedure(const std::string& name, LegacyExternalProcedure proc) {
+        auto entry = std::make_unique<ProcEntry>();
+        entry->definition.title = name;
+        entry->legacy = std::move(proc);
+        
+        // Dispatch straight to the legacy function; the async wrapper is only
+        // built for callers of getProcedure()
+        const LegacyExternalProcedure* legacy = &entry->legacy;
+        entry->invoker = [legacy](const ParameterMap& params, ProcCompletionCallback& callback) {
+            invokeLegacy(*legacy, params, callback);
+        };
+        entry->definition.implementation = [legacy](const ParameterMap& params, ProcCompletionCallback& callback) {
+            invokeLegacy(*legacy, params, callback);
+        };
+        publishProcedure(name, std::move(entry));
+    }
+    
+    /**
+     * @brief Create a flow from AST
+     * @throws FlowGraphError (Runtime) if it calls procedures that are not registered, see setStrictProcedures()
+     */
+    Flow createFlow(std::unique_ptr<FlowAST> ast) {
+        Flow flow(std::move(ast), this);
+        checkProcedures(flow);
+        return flow;
+    }
+    
+    /**
+     * @brief Whether loading a flow that calls unregistered procedures fails
+     *
+     * On by default, so a missing procedure is reported when the flow is
+     * created or loaded rather than when its PROC node runs. Turn it off to
+     * register procedures after the flows calling them; Flow::validate()
+     * then lists what is still missing.
+     */
+    void setStrictProcedures(bool strict) { strictProcedures_.store(strict, std::memory_order_relaxed); }
+    bool strictProcedures() const { return strictProcedures_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Reject a flow calling unregistered procedures, unless strictProcedures() is off
+     * @throws FlowGraphError (Runtime) listing every missing procedure
+     */
+    void checkProcedures(const Flow& flow) const {
+        if (!strictProcedures()) {
+            return;
+        }
+        auto missing = flow.missingProcedures();
+        if (!missing.empty()) {
+            std::string message = missing[0];
+            for (size_t i = 1; i < missing.size(); ++i) {
+                message += "; " + missing[i];
+            }
+            throw FlowGraphError(FlowGraphError::Type::Runtime, message);
+        }
+    }
+    
+    /**
+     * @brief Get registered procedure definition
+     */
+    const ProcDefinition& getProcedureDefinition(const std::string& name) const {
+        const ProcEntry* entry = findEntry(name);
+        if (!entry) {
+            throw FlowGraphError(FlowGraphError::Type::Runtime, "Procedure not found: " + name);
+        }
+        return entry->definition;
+    }
+    
+    /**
+     * @brief Get the engine-side invoker of a procedure
+     * @return Invoker or nullptr if the procedure is not registered; stays
+     *         valid as long as the engine, also once the procedure is replaced
+     */
+    const ProcInvoker* findProcedureInvoker(const std::string& name) const {
+        const ProcEntry* entry = findEntry(name);
+        return entry ? &entry->invoker : nullptr;
+    }
+    
+    /**
+     * @brief Get the invoker and result cache of a procedure, valid like findProcedureInvoker()
+     */
+    ProcHandle findProcedureHandle(const std::string& name) const {
+        const ProcSlot* slot = findSlot(name);
+        return slot ? slot->handle() : ProcHandle();
+    }
+    
+    /**
+     * @brief Registry slot of a procedure name, created empty if the name is not registered yet
+     *
+     * Flows resolve their PROC nodes with it on construction; the slot stays
+     * valid as long as the engine.
+     */
+    const ProcSlot* getProcedureSlot(const std::string& name) {
+        if (const ProcSlot* slot = findSlot(name)) {
+            return slot;
+        }
+        std::lock_guard<std::mutex> lock(proceduresMutex_);
+        return &slotLocked(name);
+    }
+    
+    /**
+     * @brief Result cache of a pure procedure, nullptr if it is not pure or not registered
+     */
+    ProcResultCache* getProcedureCache(const std::string& name) const {
+        const ProcEntry* entry = findEntry(name);
+        return entry ? entry->cache.get() : nullptr;
+    }
+    
+    /**
+     * @brief Get registered procedure implementation
+     */
+    ExternalProcedure getProcedure(const std::string& name) const {
+        const auto& def = getProcedureDefinition(name);
+        return def.implementation;
+    }
+    
+    /**
+     * @brief Check if procedure is registered
+     */
+    bool hasProcedure(const std::string& name) const {
+        return findEntry(name) != nullptr;
+    }
+    
+    /**
+     * @brief Get all registered procedure names
+     */
+    std::vector<std::string> getRegisteredProcedures() const {
+        std::vector<std::string> names;
+        for (const auto& [name, slot] : *std::atomic_load(&procedures_)) {
+            if (slot->entry()) {
+                names.push_back(name);
+            }
+        }
+        return names;
+    }
+    
+    /**
+     * @brief Register a flow as a module that PROC nodes can reference by path (e.g. auth/login.flow)
+     *
+     * Thread-safe; replaces a module of the same name. A replaced module is
+     * freed once no flow linked to it and no call running in it holds it.
+     * One whose calls lead back to itself holds itself, and is only freed
+     * with the engine.
+     */
+    void registerModule(const std::string& name, Flow flow) {
+        std::shared_ptr<const Flow> module = std::make_shared<const Flow>(std::move(flow));
+        std::lock_guard<std::mutex> lock(modulesMutex_);
+        modules_[name].swap(module);
+        if (module) {
+            replacedModules_.erase(std::remove_if(replacedModules_.begin(), replacedModules_.end(),
+                                                  [](const auto& replaced) { return replaced.expired(); }),
+                                   replacedModules_.end());
+            replacedModules_.push_back(module);
+        }
+    }
+    
+    /**
+     * @brief Find a registered module
+     */
+    std::optional<Flow> findModule(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(modulesMutex_);
+        auto it = modules_.find(name);
+        if (it == modules_.end()) {
+            return std::nullopt;
+        }
+        return *it->second;
+    }
+    
+    /**
+     * @brief Resolve a module reference to the registered flow
+     * @return Module flow, or nullptr if there is none
+     */
+    std::shared_ptr<const Flow> resolveModule(const std::string& callerModule, const std::string& reference) const {
+        std::lock_guard<std::mutex> lock(modulesMutex_);
+        auto it = findModuleLocked(callerModule, reference);
+        return it == modules_.end() ? nullptr : it->second;
+    }
+    
+    /**
+     * @brief Resolve a module reference made from another module
+     *
+     * The reference is looked up relative to the calling module's directory
+     * first, then as a path from the library root.
+     *
+     * @return Name of the registered module, empty if there is none
+     */
+    std::string resolveModuleName(const std::string& callerModule, const std::string& reference) const {
+        std::lock_guard<std::mutex> lock(modulesMutex_);
+        auto it = findModuleLocked(callerModule, reference);
+        return it == modules_.end() ? std::string() : it->first;
+    }
+    
+    /**
+     * @brief Symbol table shared by the flows of this engine
+     */
+    const std::shared_ptr<SymbolTable>& getSymbolTable() const { return symbols_; }
+    
+    /**
+     * @brief Profile every flow of this engine; nullptr turns profiling off
+     *
+     * Unprofiled executions take the same path as before. Change the profiler
+     * only while no flow of the engine is executing.
+     */
+    void setProfiler(std::shared_ptr<Profiler> profiler) { profiler_ = std::move(profiler); }
+    Profiler* getProfiler() const { return profiler_.get(); }
+    
+    std::vector<std::string> getRegisteredModules() const {
+        std::lock_guard<std::mutex> lock(modulesMutex_);
+        std::vector<std::string> names;
+        names.reserve(modules_.size());
+        for (const auto& [name, flow] : modules_) {
+            names.push_back(name);
         }
         return names;
     }
     
 private:
-    std::unordered_map<std::string, ProcDefinition> procedures_;
+    // Procedure registry, read without locking: the name map is copied on
+    // write and published atomically, and so is each slot's entry. A replaced
+    // map is freed as soon as its last reader lets go of it. Replaced entries
+    // stay alive with the engine, since running calls and the definitions
+    // handed out may still refer to them; their batchers are stopped, though.
+    using ProcMap = std::unordered_map<std::string, ProcSlot*>;
+    std::shared_ptr<const ProcMap> procedures_ = std::make_shared<const ProcMap>();
+    std::deque<ProcSlot> procSlots_;                            // stable addresses
+    std::vector<std::unique_ptr<const ProcEntry>> procEntries_; // current and replaced
+    std::mutex proceduresMutex_;                                // serializes writers
+    
+    std::shared_ptr<SymbolTable> symbols_ = std::make_shared<SymbolTable>();
+    std::shared_ptr<Profiler> profiler_;
+    std::atomic<bool> strictProcedures_{true};
+    
+    using ModuleMap = std::unordered_map<std::string, std::shared_ptr<const Flow>>;
+    ModuleMap modules_;
+    std::vector<std::weak_ptr<const Flow>> replacedModules_;  // to break their cycles on destruction
+    mutable std::mutex modulesMutex_;
+    
+    const ProcSlot* findSlot(const std::string& name) const {
+        std::shared_ptr<const ProcMap> map = std::atomic_load(&procedures_);
+        auto it = map->find(name);
+        return it == map->end() ? nullptr : it->second;
+    }
+    
+    const ProcEntry* findEntry(const std::string& name) const {
+        const ProcSlot* slot = findSlot(name);
+        return slot ? slot->entry() : nullptr;
+    }
+    
+    ProcSlot& slotLocked(const std::string& name) {
+        const ProcMap& current = *procedures_;  // only writers store, under proceduresMutex_
+        auto it = current.find(name);
+        if (it != current.end()) {
+            return *it->second;
+        }
+        ProcSlot& slot = procSlots_.emplace_back();
+        auto map = std::make_shared<ProcMap>(current);
+        map->emplace(name, &slot);
+        std::atomic_store(&procedures_, std::shared_ptr<const ProcMap>(std::move(map)));
+        return slot;
+    }
+    
+    void publishProcedure(const std::string& name, std::unique_ptr<ProcEntry> entry) {
+        const ProcEntry* replaced = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(proceduresMutex_);
+            ProcSlot& slot = slotLocked(name);
+            procEntries_.push_back(std::move(entry));
+            replaced = slot.entry_.exchange(procEntries_.back().get(), std::memory_order_acq_rel);
+        }
+        // Calls already queued still run; later calls reaching the old entry run on the calling thread
+        if (replaced && replaced->batcher) {
+            replaced->batcher->stop();
+        }
+    }
+    
+    ModuleMap::const_iterator findModuleLocked(const std::string& callerModule, const std::string& reference) const {
+        std::filesystem::path relative = std::filesystem::path(callerModule).parent_path() / reference;
+        for (const auto& candidate : {relative.lexically_normal().generic_string(),
+                                      std::filesystem::path(reference).lexically_normal().generic_string()}) {
+            auto it = modules_.find(candidate);
+            if (it != modules_.end()) {
+                return it;
+            }
+        }
+        return modules_.end();
+    }
+    
+    template<auto Fn>
+    static void callProcedure(const ParameterMap& params, ProcCompletionCallback& callback) {
+        Fn(params, callback);
+    }
+    
+    template<auto Fn>
+    static void callLegacyProcedure(const ParameterMap& params, ProcCompletionCallback& callback) {
+        try {
+            callback(ProcResult::completedSuccess(Fn(params)));
+        } catch (const std::exception& e) {
+            callback(ProcResult::completedError(e.what()));
+        }
+    }
+    
+    static void invokeLegacy(const LegacyExternalProcedure& proc, const ParameterMap& params, ProcCompletionCallback& callback) {
+        try {
+            // Execute synchronously
+            callback(ProcResult::completedSuccess(proc(params)));
+        } catch (const std::exception& e) {
+            callback(ProcResult::completedError(e.what()));
+        }
+    }
     
     // Built-in procedures
     void registerBuiltinProcedures() {
@@ -436,179 +1994,1304 @@ private:
         registerLegacyProcedure("log", builtinLog);
     }
     
-    // Built-in procedure implementations
-    static ParameterMap builtinPrint(const ParameterMap& params) {
-        for (const auto& [name, value] : params) {
-            std::cout << name << ": " << value.toString() << std::endl;
+    // Built-in procedure implementations
+    static ParameterMap builtinPrint(const ParameterMap& params) {
+        for (const auto& [name, value] : params) {
+            std::cout << name << ": " << value.toString() << std::endl;
+        }
+        return {};
+    }
+    
+    static ParameterMap builtinLog(const ParameterMap& params) {
+        // Similar to print but could log to file in real implementation
+        return builtinPrint(params);
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief Columnar interpreter of Flow::executeColumns(), one per worker thread
+ *
+ * Runs a chunk of lanes at a time, with a column per variable slot. Every
+ * node has a mask of the lanes waiting to run it; the waiting node with the
+ * lowest index runs next, for all of its lanes at once. Lanes that went
+ * apart at a COND, or looped a different number of times, run together
+ * again once they wait at the same node.
+ */
+class ColumnExecutor {
+public:
+    static constexpr size_t ChunkLanes = 256;
+    
+    ColumnExecutor(const Flow& flow, const ColumnBatch& batch, const std::vector<Column*>& returns);
+    ~ColumnExecutor();
+    
+    ColumnExecutor(const ColumnExecutor&) = delete;
+    ColumnExecutor& operator=(const ColumnExecutor&) = delete;
+    
+    /**
+     * @brief Execute lanes [first, first + count) of the batch, count <= ChunkLanes
+     */
+    void runChunk(size_t first, size_t count);
+    
+    std::vector<std::pair<size_t, std::string>> errors;   // failed lanes of all chunks run
+    size_t scalarLanes = 0;
+    
+private:
+    const Flow& flow_;
+    const CompiledFlow& program_;
+    const std::vector<Column*>& returns_;                            // by RETURNS entry
+    std::vector<std::pair<SlotIndex, const Column*>> inputs_;        // columns of compiled variables
+    std::vector<std::pair<const std::string*, const Column*>> namedInputs_;  // others, bound on the scalar path
+    std::unique_ptr<ExecutionContext> scalar_;
+    
+    size_t first_ = 0;
+    size_t count_ = 0;
+    NodeIndex lowest_ = 0;              // no node below it has waiting lanes
+    std::vector<double> values_;        // ChunkLanes per slot
+    std::vector<StaticType> types_;
+    std::vector<uint8_t> pending_;      // ChunkLanes per node: lane waits to run the node
+    std::vector<uint8_t> waiting_;      // per node: any lane pending
+    std::vector<uint8_t> active_;       // lanes running the current node
+    std::vector<uint8_t> fallback_;     // lanes of the current node leaving the columnar path
+    std::vector<uint8_t> taken_;        // lanes sent to one port
+    std::vector<double> stack_;
+    
+    void runNode(NodeIndex index);
+    void send(CompiledTarget target, const uint8_t* lanes);
+    void finishLane(size_t lane);
+    void runScalar(size_t lane, NodeIndex node);
+};
+
+} // namespace detail
+
+// Flow method implementations (after Engine class definition)
+
+inline Flow::Flow(std::unique_ptr<FlowAST> ast, Engine* engine)
+    : program_(std::make_shared<const CompiledFlow>(std::move(ast), engine ? engine->getSymbolTable() : nullptr)),
+      contextPool_(std::make_shared<ExecutionContextPool>(program_)),
+      engine_(engine) {
+    // Every procedure name resolves to its registry slot now, registered or
+    // not, so calls never look up names. Module references get a slot only
+    // if a procedure of that name is registered, which then shadows the module.
+    auto slots = std::make_shared<std::vector<const ProcSlot*>>(program_->procNodeCount());
+    std::vector<bool> moduleCalls(program_->procNodeCount(), false);
+    for (NodeIndex i = 0; i < program_->nodeCount(); ++i) {
+        const CompiledNode& node = program_->node(i);
+        if (node.kind == NodeKind::Proc) {
+            const std::string& name = node.asProc().procedureName;
+            moduleCalls[node.procIndex] = std::filesystem::path(name).extension() == ".flow";
+            if (engine_) {
+                (*slots)[node.procIndex] = moduleCalls[node.procIndex] && !engine_->hasProcedure(name)
+                    ? nullptr : engine_->getProcedureSlot(name);
+            }
+        }
+    }
+    procSlots_ = std::move(slots);
+    subflows_ = std::make_shared<SubflowTable>(std::move(moduleCalls));
+    linkModules();
+}
+
+inline std::vector<std::string> Flow::linkModules(const std::string& moduleName) const {
+    std::vector<std::string> missing;
+    for (NodeIndex i = 0; i < program_->nodeCount(); ++i) {
+        const CompiledNode& node = program_->node(i);
+        if (node.kind != NodeKind::Proc || !subflows_->isModuleCall(node.procIndex)) {
+            continue;
+        }
+        const std::string& name = node.asProc().procedureName;
+        std::shared_ptr<const Flow> callee = engine_ ? engine_->resolveModule(moduleName, name) : nullptr;
+        if (!callee) {
+            missing.push_back(name);
+            continue;
+        }
+        
+        auto link = std::make_shared<SubflowLink>();
+        link->callee = std::move(callee);
+        const CompiledFlow& target = link->callee->getProgram();
+        for (const auto& binding : program_->inputBindings(node)) {
+            auto slot = target.slots().find(*binding.procParam);
+            link->inputs.push_back({binding.slot, slot ? *slot : 0, slot ? nullptr : binding.procParam});
+        }
+        // Like a PROC result, a sub-flow only hands back its RETURNS
+        const auto& returns = target.ast().returnValues;
+        for (const auto& binding : program_->outputBindings(node)) {
+            for (size_t r = 0; r < returns.size(); ++r) {
+                if (returns[r].name == *binding.procParam) {
+                    link->outputs.push_back({target.returnSlots()[r], binding.slot, nullptr});
+                    break;
+                }
+            }
+        }
+        subflows_->publish(node.procIndex, std::move(link));
+    }
+    return missing;
+}
+
+inline std::vector<std::string> Flow::validate() const {
+    auto errors = program_->ast().validate();
+    const auto& diagnostics = program_->diagnostics();
+    errors.insert(errors.end(), diagnostics.begin(), diagnostics.end());
+    if (engine_) {
+        for (NodeIndex i = 0; i < program_->nodeCount(); ++i) {
+            const CompiledNode& node = program_->node(i);
+            if (node.kind == NodeKind::Proc && !findSubflow(node) && !resolveProcedure(node)) {
+                errors.push_back((subflows_->isModuleCall(node.procIndex) ? "Module not found: " : "Procedure not found: ") +
+                                 node.asProc().procedureName + " (node " + node.source->id + ")");
+            }
+        }
+    }
+    return errors;
+}
+
+inline std::vector<std::string> Flow::missingProcedures() const {
+    std::vector<std::string> missing;
+    if (engine_) {
+        for (NodeIndex i = 0; i < program_->nodeCount(); ++i) {
+            const CompiledNode& node = program_->node(i);
+            if (node.kind == NodeKind::Proc && !subflows_->isModuleCall(node.procIndex) && !resolveProcedure(node)) {
+                missing.push_back("Procedure not found: " + node.asProc().procedureName + " (node " + node.source->id + ")");
+            }
+        }
+    }
+    return missing;
+}
+
+inline ProcHandle Flow::resolveProcedure(const CompiledNode& node) const {
+    if (const ProcSlot* slot = (*procSlots_)[node.procIndex]) {
+        return slot->handle();
+    }
+    // Module reference, unless a procedure of that name was registered since
+    return engine_->findProcedureHandle(node.asProc().procedureName);
+}
+
+inline void Flow::releaseParkedValues(ExecutionContext& context, const CompiledNode& suspended) const {
+    // Each frame keeps what is live after the node it waits at: its sub-flow call, or the suspended PROC
+    const CompiledFlow* program = program_.get();
+    ExecutionContext* frame = &context;
+    for (const auto& call : context.callFrames()) {
+        frame->releaseVariablesExcept(program->liveAfter(program->node(call.callNode)));
+        frame->releaseProcInputs();
+        program = &call.link->callee->getProgram();
+        frame = call.context;
+    }
+    frame->releaseVariablesExcept(program->liveAfter(suspended));
+    // The suspended PROC may still read its parameters until it completes
+    frame->releaseProcInputs(&frame->getProcInputs(suspended.procIndex));
+}
+
+inline void Flow::releaseMovedInputs(const CompiledNode& node, ExecutionContext& context) const {
+    // Values moved in on their last use are referenced by nothing else once the PROC has resolved
+    auto& inputs = context.getProcInputs(node.procIndex);
+    BindingRange bindings = program_->inputBindings(node);
+    if (inputs.values.size() != bindings.size()) {
+        return;   // inputs were copied into a rebuilt map
+    }
+    Value* const* value = inputs.values.data();
+    for (const auto& binding : bindings) {
+        if (binding.lastUse) {
+            **value = Value();
+        }
+        ++value;
+    }
+}
+
+inline std::shared_ptr<const SubflowLink> Flow::findSubflow(const CompiledNode& node) const {
+    if (!subflows_->isModuleCall(node.procIndex)) {
+        return nullptr;
+    }
+    if (auto link = subflows_->find(node.procIndex)) {
+        return link;
+    }
+    if (!engine_ || resolveProcedure(node)) {
+        return nullptr;
+    }
+    // Module registered after the flow was created
+    linkModules();
+    return subflows_->find(node.procIndex);
+}
+
+inline ExecutionResult Flow::execute(const ParameterMap& params) const {
+    auto context = contextPool_->acquire();
+    context->setReleaseDeadValues(true);  // nobody sees the context's variables
+    ExecutionResult result = execute(*context, params);
+    contextPool_->release(std::move(context));
+    return result;
+}
+
+inline std::vector<ExecutionResult> Flow::executeBatch(const std::vector<ParameterMap>& batch, size_t threadCount) const {
+    std::vector<ExecutionResult> results(batch.size());
+    if (threadCount == 0) {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, batch.size());
+    
+    // Workers claim small chunks so uneven flow run times still balance out
+    constexpr size_t chunkSize = 16;
+    std::atomic<size_t> nextIndex{0};
+    auto worker = [&]() {
+        auto context = contextPool_->acquire();
+        context->setReleaseDeadValues(true);
+        for (;;) {
+            size_t begin = nextIndex.fetch_add(chunkSize, std::memory_order_relaxed);
+            if (begin >= batch.size()) {
+                break;
+            }
+            size_t end = std::min(begin + chunkSize, batch.size());
+            for (size_t i = begin; i < end; ++i) {
+                results[i] = execute(*context, batch[i]);
+                if (context->hasPendingProc()) {
+                    // The pending PROC still holds its callback; the pool keeps it until then
+                    contextPool_->release(std::move(context));
+                    context = contextPool_->acquire();
+                    context->setReleaseDeadValues(true);
+                }
+            }
+        }
+        contextPool_->release(std::move(context));
+    };
+    
+    if (threadCount <= 1) {
+        worker();
+        return results;
+    }
+    
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return results;
+}
+
+inline ColumnBatchResult Flow::executeColumns(const ColumnBatch& batch, size_t threadCount) const {
+    ColumnBatchResult result;
+    result.returns = ColumnBatch(batch.lanes());
+    std::vector<Column*> returns;
+    for (const auto& returnValue : program_->ast().returnValues) {
+        returns.push_back(&result.returns.column(returnValue.name));
+    }
+    
+    size_t chunkCount = (batch.lanes() + detail::ColumnExecutor::ChunkLanes - 1) / detail::ColumnExecutor::ChunkLanes;
+    if (threadCount == 0) {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, chunkCount);
+    
+    std::atomic<size_t> nextChunk{0};
+    std::mutex mutex;
+    auto worker = [&]() {
+        detail::ColumnExecutor executor(*this, batch, returns);
+        for (;;) {
+            size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= chunkCount) {
+                break;
+            }
+            size_t first = chunk * detail::ColumnExecutor::ChunkLanes;
+            executor.runChunk(first, std::min(detail::ColumnExecutor::ChunkLanes, batch.lanes() - first));
         }
-        return {};
-    }
+        std::lock_guard<std::mutex> lock(mutex);
+        result.errors.insert(result.errors.end(), executor.errors.begin(), executor.errors.end());
+        result.scalarLanes += executor.scalarLanes;
+    };
     
-    static ParameterMap builtinLog(const ParameterMap& params) {
-        // Similar to print but could log to file in real implementation
-        return builtinPrint(params);
+    if (threadCount <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (size_t i = 1; i < threadCount; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
     }
-};
+    std::sort(result.errors.begin(), result.errors.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    return result;
+}
 
-// Flow method implementations (after Engine class definition)
+inline ExecutionResult Flow::execute(ExecutionContext& context, const ParameterMap& params) const {
+    auto result = start(context, params);
+    if (!result) {
+        // For non-interactive execution, we can't handle async operations;
+        // they need FlowScheduler (or start/resume with an event loop)
+        return ExecutionResult("Async PROC execution not supported in synchronous mode");
+    }
+    return std::move(*result);
+}
+
+inline std::optional<ExecutionResult> Flow::start(ExecutionContext& context, const ParameterMap& params) const {
+    if (Profiler* profiler = activeProfiler()) {
+        ProfilingHooks hooks(*profiler);
+        return startWith(context, params, hooks);
+    }
+    NoDebugHooks hooks;
+    return startWith(context, params, hooks);
+}
+
+template<typename Bind>
+inline std::optional<ExecutionResult> Flow::startBinding(ExecutionContext& context, Bind&& bind) const {
+    if (Profiler* profiler = activeProfiler()) {
+        ProfilingHooks hooks(*profiler);
+        return bindAndRun(context, bind, hooks);
+    }
+    NoDebugHooks hooks;
+    return bindAndRun(context, bind, hooks);
+}
 
-inline ExecutionResult Flow::execute(const ParameterMap& params) {
+template<typename Hooks>
+inline std::optional<ExecutionResult> Flow::startWith(ExecutionContext& context, const ParameterMap& params,
+                                                      Hooks& hooks) const {
+    auto bind = [&params](ExecutionContext& target) { target.bindParameters(params); };
+    return bindAndRun(context, bind, hooks);
+}
+
+template<typename Bind, typename Hooks>
+inline std::optional<ExecutionResult> Flow::bindAndRun(ExecutionContext& context, Bind& bind, Hooks& hooks) const {
     try {
-        ExecutionContext context(*ast_);
-        context.bindParameters(params);
-        return executeInternal(context);
+        if (context.getProgram() != program_.get()) {
+            throw FlowGraphError(FlowGraphError::Type::Runtime, "Execution context belongs to a different flow");
+        }
+        if (context.hasPendingProc()) {
+            // Resetting would re-arm the callback the pending PROC still holds
+            throw FlowGraphError(FlowGraphError::Type::Runtime, "Execution context is still waiting for an async PROC");
+        }
+        context.reset();
+        bind(context);
+        if (activeProfiler()) {
+            context.getProcCallback().SetTiming(true);
+        }
+        return executeInternal(context, hooks);
     } catch (const FlowGraphError& e) {
         return ExecutionResult(e.message());
     }
 }
 
-inline std::unique_ptr<DebugExecutionContext> Flow::createDebugContext(const ParameterMap& params) {
-    auto context = std::make_unique<ExecutionContext>(*ast_);
-    context->bindParameters(params);
-    return std::make_unique<DebugExecutionContext>(std::move(context));
+inline std::optional<ExecutionResult> Flow::executeFor(ExecutionContext& context, const ExecutionBudget& budget,
+                                                       const ParameterMap& params) const {
+    auto withBudget = [&](auto& inner) -> std::optional<ExecutionResult> {
+        if (budget.unlimited()) {
+            return continueWith(context, params, inner);
+        }
+        BudgetHooks<std::remove_reference_t<decltype(inner)>> hooks(budget, inner);
+        auto result = continueWith(context, params, hooks);
+        if (!result && context.getState() == ExecutionState::Paused) {
+            context.setPausedTarget(hooks.pausedAt());
+        }
+        return result;
+    };
+    if (Profiler* profiler = activeProfiler()) {
+        ProfilingHooks hooks(*profiler);
+        return withBudget(hooks);
+    }
+    NoDebugHooks hooks;
+    return withBudget(hooks);
+}
+
+template<typename Hooks>
+inline std::optional<ExecutionResult> Flow::continueWith(ExecutionContext& context, const ParameterMap& params,
+                                                         Hooks& hooks) const {
+    switch (context.getState()) {
+        case ExecutionState::WaitingAsync:
+            return resumeWith(context, hooks);
+        case ExecutionState::Paused:
+            if (context.getProgram() != program_.get()) {
+                return ExecutionResult("Execution context belongs to a different flow");
+            }
+            context.setState(ExecutionState::Running);
+            return run(context, context.getPausedTarget(), hooks);
+        default:
+            return startWith(context, params, hooks);
+    }
+}
+
+inline Profiler* Flow::activeProfiler() const {
+    if (profiler_) {
+        return profiler_.get();
+    }
+    return engine_ ? engine_->getProfiler() : nullptr;
+}
+
+inline std::optional<ExecutionResult> Flow::resume(ExecutionContext& context) const {
+    if (Profiler* profiler = activeProfiler()) {
+        ProfilingHooks hooks(*profiler);
+        return resumeWith(context, hooks);
+    }
+    NoDebugHooks hooks;
+    return resumeWith(context, hooks);
 }
 
-inline ExecutionResult Flow::executeInternal(ExecutionContext& context) {
+template<typename Hooks>
+inline std::optional<ExecutionResult> Flow::resumeWith(ExecutionContext& context, Hooks& hooks) const {
+    if (context.getProgram() != program_.get()) {
+        return ExecutionResult("Execution context belongs to a different flow");
+    }
+    if (!context.isWaitingForAsync()) {
+        return ExecutionResult("Execution is not waiting for an async PROC");
+    }
+    if (!context.getProcCallback().IsResolved()) {
+        return std::nullopt;
+    }
+    
     try {
+        // The suspended PROC belongs to the innermost sub-flow call, if any
+        const Flow* flow = this;
+        ExecutionContext* frameContext = &context;
+        if (const auto* frame = context.topCallFrame()) {
+            flow = frame->link->callee.get();
+            frameContext = frame->context;
+        }
+        context.clearAsyncWait();
         context.setState(ExecutionState::Running);
-        
-        // Simple sequential execution of nodes for now
-        // In a real implementation, this would follow the flow connections
-        for (const auto& node : ast_->nodes) {
-            if (auto assign = dynamic_cast<const AssignNode*>(node.get())) {
-                executeAssignNode(*assign, context);
-            } else if (auto cond = dynamic_cast<const CondNode*>(node.get())) {
-                executeCondNode(*cond, context);
-            } else if (auto proc = dynamic_cast<const ProcNode*>(node.get())) {
-                executeProcNode(*proc, context);
+        const CompiledNode& node = flow->program_->node(context.getSuspendedNode());
+        frameContext->setCurrentNode(node.id);
+        if (node.kind == NodeKind::Par) {
+            // A branch's PROC completed: continue the branches, suspend again until all reached the JOIN
+            CompiledTarget target = flow->joinBranches(node, *frameContext, context, hooks);
+            if (context.isWaitingForAsync()) {
+                return std::nullopt;
+            }
+            return run(context, target, hooks);
+        }
+        if constexpr (Hooks::enabled) {
+            hooks.procResumed(*flow->program_, node, context.getProcCallback());
+        }
+        CompiledTarget next = flow->handleProcResult(context.getProcCallback().GetResult(), node, *frameContext);
+        if (context.releasesDeadValues()) {
+            flow->releaseMovedInputs(node, *frameContext);
+        }
+        return run(context, next, hooks);
+    } catch (const std::exception& e) {
+        context.setState(ExecutionState::Error);
+        if (context.isBranch()) {
+            throw;
+        }
+        return ExecutionResult("Execution error: " + std::string(e.what()));
+    }
+}
+
+inline std::unique_ptr<DebugExecutionContext> Flow::createDebugContext(const ParameterMap& params) const {
+    auto context = std::make_unique<ExecutionContext>(*program_);
+    context->bindParameters(params);
+    return std::make_unique<DebugExecutionContext>(*this, std::move(context));
+}
+
+template<typename Hooks>
+inline std::optional<ExecutionResult> Flow::executeInternal(ExecutionContext& context, Hooks& hooks) const {
+    context.setState(ExecutionState::Running);
+    
+    CompiledTarget target = program_->entry();
+    if (target.kind == TargetKind::None) {
+        context.setState(ExecutionState::Error);
+        return ExecutionResult("Flow must have a START connection");
+    }
+    return run(context, target, hooks);
+}
+
+template<typename Hooks>
+inline std::optional<ExecutionResult> Flow::run(ExecutionContext& context, CompiledTarget target, Hooks& hooks) const {
+    // Innermost frame: this flow on the started context, or the callee of a sub-flow call
+    const Flow* flow = this;
+    ExecutionContext* frameContext = &context;
+    if (const auto* frame = context.topCallFrame()) {
+        flow = frame->link->callee.get();
+        frameContext = frame->context;
+    }
+    // Only recorded as the frame's current node where execution stops (suspension, error)
+    const CompiledNode* current = nullptr;
+    
+    try {
+        for (;;) {
+            // Follow the compiled edge table until END, error emission or a dead end
+            while (target.kind == TargetKind::Node) {
+                const CompiledFlow& program = *flow->program_;
+                const CompiledNode& node = program.node(target.index);
+                current = &node;
+                if constexpr (Hooks::enabled) {
+                    frameContext->setCurrentNode(node.id);
+                    if (hooks.beforeNode(program, node, *frameContext, target)) {
+                        context.setState(ExecutionState::Paused);
+                        return std::nullopt;
+                    }
+                }
                 
-                // Handle async PROC execution
-                if (context.isWaitingForAsync()) {
-                    // For non-interactive execution, we can't handle async operations
-                    // This would need to be handled at a higher level with event loops
-                    return ExecutionResult("Async PROC execution not supported in synchronous mode");
+                switch (node.kind) {
+                    case NodeKind::Assign: {
+                        // Straight-line block: the fused ASSIGNs behind this one run without dispatch
+                        // (debugging runs them one node at a time)
+                        const CompiledNode* last = Hooks::enabled ? &node : &node + (node.blockLength - 1);
+                        for (const CompiledNode* assign = &node; assign <= last; ++assign) {
+                            flow->executeAssignNode(*assign, *frameContext);
+                        }
+                        target = last->next;
+                        break;
+                    }
+                    case NodeKind::Cond:
+                        target = flow->executeCondNode(node, *frameContext);
+                        break;
+                    case NodeKind::Proc: {
+                        NodeIndex procIndex = target.index;
+                        if (std::shared_ptr<const SubflowLink> link = flow->findSubflow(node)) {
+                            // Sub-flow call: push a frame and continue in the callee
+                            const Flow* callee = link->callee.get();
+                            frameContext = &flow->enterSubflow(node, procIndex, std::move(link), *frameContext, context);
+                            flow = callee;
+                            target = flow->program_->entry();
+                            if (target.kind == TargetKind::None) {
+                                throw FlowGraphError(FlowGraphError::Type::Runtime,
+                                    "Flow must have a START connection: " + node.asProc().procedureName);
+                            }
+                            break;
+                        }
+                        target = flow->executeProcNode(node, *frameContext, context, hooks);
+                        
+                        // Async PROC: suspend here, resume() continues after the callback fired
+                        if (context.isWaitingForAsync()) {
+                            frameContext->setCurrentNode(node.id);
+                            context.setSuspendedNode(procIndex);
+                            if (context.releasesDeadValues()) {
+                                releaseParkedValues(context, node);
+                            }
+                            if constexpr (Hooks::enabled) {
+                                hooks.afterNode(program, node);
+                            }
+                            return std::nullopt;
+                        }
+                        break;
+                    }
+                    case NodeKind::Par: {
+                        NodeIndex parIndex = target.index;
+                        target = flow->executeParNode(node, *frameContext, context, hooks);
+                        
+                        // Branches waiting for async PROCs: suspend here until all reached the JOIN
+                        if (context.isWaitingForAsync()) {
+                            frameContext->setCurrentNode(node.id);
+                            context.setSuspendedNode(parIndex);
+                            if constexpr (Hooks::enabled) {
+                                hooks.afterNode(program, node);
+                            }
+                            return std::nullopt;
+                        }
+                        break;
+                    }
+                    case NodeKind::Join:
+                        // End of a PAR branch; reached any other way, a JOIN just continues
+                        if (frameContext == &context && context.isBranch()) {
+                            context.setBranchExit(target);
+                            context.setState(ExecutionState::Completed);
+                            return ExecutionResult(ParameterMap());
+                        }
+                        target = node.next;
+                        break;
+                }
+                if constexpr (Hooks::enabled) {
+                    hooks.afterNode(program, node);
                 }
             }
+            
+            if (!context.topCallFrame()) {
+                break;
+            }
+            
+            // The callee finished: pop its frame and continue after the calling PROC node
+            ExecutionContext::CallFrame finished = context.popCallFrame();
+            const auto* caller = context.topCallFrame();
+            flow = caller ? caller->link->callee.get() : this;
+            frameContext = caller ? caller->context : &context;
+            target = flow->returnFromSubflow(finished, target, *frameContext);
+        }
+        
+        if (context.isBranch()) {
+            // Left its PAR without reaching a JOIN; the PAR node reports it
+            context.setBranchExit(target);
+            context.setState(target.kind == TargetKind::Error ? ExecutionState::Error : ExecutionState::Completed);
+            return ExecutionResult(ParameterMap());
+        }
+        
+        if (target.kind == TargetKind::Error) {
+            // Error emission: the flow terminates with the emitted error name
+            context.setState(ExecutionState::Error);
+            return ExecutionResult(program_->errorName(target.index));
         }
         
         context.setState(ExecutionState::Completed);
-        return ExecutionResult(context.extractReturnValues());
+        if (context.keepsReturnValues()) {
+            return ExecutionResult(ParameterMap());
+        }
+        return ExecutionResult(context.releasesDeadValues() ? context.takeReturnValues() : context.extractReturnValues());
     } catch (const std::exception& e) {
+        if (current) {
+            frameContext->setCurrentNode(current->id);
+        }
         context.setState(ExecutionState::Error);
+        if (context.isBranch()) {
+            throw; // fails the PAR node, reported by the started context
+        }
         return ExecutionResult("Execution error: " + std::string(e.what()));
     }
 }
 
-inline FlowNode* Flow::findStartNode(ExecutionContext& context) {
-    // TODO: Find the node connected from START
-    (void)context;  // Suppress unused parameter warning
-    return nullptr;
-}
-
-inline std::string Flow::getNextNode(const std::string& currentNode, ExecutionContext& context) {
-    // TODO: Find next node based on connections
-    (void)currentNode;  // Suppress unused parameter warning
-    (void)context;      // Suppress unused parameter warning
-    return "END";
+inline bool Flow::evaluateTyped(const CompiledNode& node, const ExecutionContext& context, Value& result) {
+    return node.typed && node.typed->evaluate([&context](SlotIndex slot) { return context.findVariable(slot); }, result);
 }
 
-inline void Flow::executeAssignNode(const AssignNode& node, ExecutionContext& context) {
-    // Use ExpressionKit to evaluate the expression
-    Value result = context.evaluateExpression(node.expression);
-    context.setVariable(node.variableName, result);
+inline void Flow::executeAssignNode(const CompiledNode& node, ExecutionContext& context) const {
+    const AssignNode& assign = node.asAssign();
+    // Typed code first; it leaves unset variables, unexpected types and errors to the
+    // expression tree parsed at compile time (the text is only re-parsed when it failed
+    // to compile, to report the error)
+    Value result;
+    if (!evaluateTyped(node, context, result)) {
+        result = node.expression ? context.evaluateExpression(*node.expression)
+                                 : context.evaluateExpression(assign.expression);
+    }
+    context.setVariable(node.slot, std::move(result));
 }
 
-inline std::string Flow::executeCondNode(const CondNode& node, ExecutionContext& context) {
-    // Use ExpressionKit to evaluate the condition
-    Value result = context.evaluateExpression(node.condition);
-    bool condition = result.asBoolean(); // Use ExpressionKit's asBoolean method
-    
-    // Find connections based on condition result
-    auto connections = ast_->getConnectionsFrom(node.id);
-    for (const auto& conn : connections) {
-        if ((condition && conn.fromPort == "Y") || 
-            (!condition && conn.fromPort == "N") ||
-            conn.fromPort.empty()) {
-            return conn.toNode;
-        }
+inline CompiledTarget Flow::executeCondNode(const CompiledNode& node, ExecutionContext& context) const {
+    // Typed code first, then the condition tree parsed at compile time
+    Value result;
+    if (!evaluateTyped(node, context, result)) {
+        result = node.expression ? context.evaluateExpression(*node.expression)
+                                 : context.evaluateExpression(node.asCond().condition);
     }
+    bool condition = result.asBoolean(); // Use ExpressionKit's asBoolean method
     
-    // Default to END if no matching connection found
-    return "END";
+    // Y/N ports were resolved at compile time (falling back to the default port)
+    return condition ? node.yes : node.no;
 }
 
-inline void Flow::executeProcNode(const ProcNode& node, ExecutionContext& context) {
+template<typename Hooks>
+inline CompiledTarget Flow::executeProcNode(const CompiledNode& node, ExecutionContext& context, ExecutionContext& root,
+                                            Hooks& hooks) const {
+    const ProcNode& proc = node.asProc();
+    
     if (!engine_) {
         throw FlowGraphError(FlowGraphError::Type::Runtime, "No engine available for PROC execution");
     }
     
-    if (!engine_->hasProcedure(node.procedureName)) {
-        throw FlowGraphError(FlowGraphError::Type::Runtime, "Procedure not found: " + node.procedureName);
+    ProcHandle procedure = resolveProcedure(node);
+    if (!procedure) {
+        throw FlowGraphError(FlowGraphError::Type::Runtime,
+            (subflows_->isModuleCall(node.procIndex) ? "Module not found: " : "Procedure not found: ") + proc.procedureName);
     }
     
-    // Prepare input parameters from bindings
-    ParameterMap inputParams;
-    for (const auto& binding : node.bindings) {
-        if (!binding.isOutput) { // Input binding (>>)
-            if (context.hasVariable(binding.localVar)) {
-                inputParams[binding.procParam] = context.getVariable(binding.localVar);
+    // Prepare input parameters from the precompiled bindings (>>), reusing the
+    // node's parameter map so steady-state calls neither hash nor allocate
+    auto& inputs = context.getProcInputs(node.procIndex);
+    BindingRange bindings = program_->inputBindings(node);
+    if (inputs.values.size() != bindings.size()) {
+        inputs.params.clear();
+        inputs.values.clear();
+        for (const auto& binding : bindings) {
+            inputs.values.push_back(&inputs.params[*binding.procParam]);
+        }
+    }
+    bool allAssigned = std::all_of(bindings.begin(), bindings.end(), [&context](const CompiledBinding& binding) {
+        return context.findVariable(binding.slot) != nullptr;
+    });
+    const bool release = allAssigned && root.releasesDeadValues();
+    if (allAssigned) {
+        // The last use of a variable hands its value over (strings included) instead of copying it
+        size_t i = 0;
+        for (const auto& binding : bindings) {
+            if (release && binding.lastUse) {
+                *inputs.values[i++] = context.takeVariable(binding.slot);
+            } else {
+                *inputs.values[i++] = *context.findVariable(binding.slot);
+            }
+        }
+    } else {
+        // Unassigned variables are left out of the parameters; rebuild the map on the next call
+        inputs.params.clear();
+        inputs.values.clear();
+        for (const auto& binding : bindings) {
+            if (const Value* value = context.findVariable(binding.slot)) {
+                inputs.params[*binding.procParam] = *value;
             }
         }
     }
+    const ParameterMap& inputParams = inputs.params;
     
-    // Execute the PROC with new callback pattern
-    auto procedure = engine_->getProcedure(node.procedureName);
-    
-    context.setCurrentNode(node.id);
+    // Pure PROC: answer from its result cache when every input is bound. On a
+    // miss, handleProcResult() caches a successful result under the same key.
+    if (procedure.cache && allAssigned) {
+        inputs.cacheKey = ProcResultCache::hash(inputs.values);
+        auto cached = procedure.cache->find(inputs.cacheKey, inputs.values);
+        if constexpr (Hooks::enabled) {
+            hooks.procCacheLookup(*program_, node, cached != nullptr);
+        }
+        if (cached) {
+            if (release) {
+                releaseMovedInputs(node, context);
+            }
+            return applyProcOutputs(*cached, node, context);
+        }
+    }
     
-    // Create callback object as suggested in the comment
-    ProcCompletionCallback procCallback;
+    // The started context owns the callback (also inside sub-flow calls), so it
+    // outlives this call for async PROCs and the scheduler sees the suspension
+    ProcCompletionCallback& procCallback = root.beginProcCall();
     
     // Call the injected function with params and callback, handling exceptions
     try {
-        procedure(inputParams, procCallback);
+        procedure.invoke(inputParams, procCallback);
     } catch (const std::exception& e) {
         // Convert exception to error result
         procCallback(ProcResult::completedError(e.what()));
     }
     
-    // Check if callback was resolved immediately (synchronous case)
-    if (procCallback.IsResolved()) {
+    // Synchronous completion, or completed on another thread before we could suspend
+    if (procCallback.IsResolved() || !procCallback.Suspend()) {
         // Synchronous completion - get result and continue
-        ProcResult result = procCallback.GetResult();
-        handleProcResult(result, node, context);
-    } else {
-        // Asynchronous execution - mark context as waiting (hang)
-        context.setWaitingForAsync(node.procedureName);
-        
-        // Set up async callback for when the result becomes available
-        procCallback.SetAsyncCallback([this, node, &context](const ProcResult& result) {
-            handleProcResult(result, node, context);
-        });
-        
-        // In a real async execution environment, execution would pause here
-        // For this implementation, we indicate that async execution is needed
+        CompiledTarget next = handleProcResult(procCallback.GetResult(), node, context);
+        if (release) {
+            releaseMovedInputs(node, context);
+        }
+        return next;
     }
+    
+    // Asynchronous execution - mark context as waiting (hang)
+    root.setWaitingForAsync(proc.procedureName);
+    return node.next;
 }
 
-inline void Flow::handleProcResult(const ProcResult& result, const ProcNode& node, ExecutionContext& context) {
+inline CompiledTarget Flow::handleProcResult(const ProcResult& result, const CompiledNode& node, ExecutionContext& context) const {
     if (!result.success) {
+        // Error capture port (e.g. 10.USER_NOT_FOUND -> 100)
+        if (const CompiledTarget* capture = program_->findErrorTarget(node, result.error)) {
+            context.clearAsyncWait();
+            return *capture;
+        }
         throw FlowGraphError(FlowGraphError::Type::Runtime, 
             "PROC execution failed: " + result.error);
     }
     
-    // Map output parameters from bindings
-    for (const auto& binding : node.bindings) {
-        if (binding.isOutput) { // Output binding (<<)
-            auto it = result.returnValues.find(binding.procParam);
-            if (it != result.returnValues.end()) {
-                context.setVariable(binding.localVar, it->second);
-            }
+    if (ProcResultCache* cache = resolveProcedure(node).cache) {
+        // Inputs are still bound as they were for the call, also after a suspension
+        auto& inputs = context.getProcInputs(node.procIndex);
+        if (inputs.values.size() == program_->inputBindings(node).size()) {
+            cache->insert(inputs.cacheKey, inputs.values, result.returnValues);
+        }
+    }
+    return applyProcOutputs(result.returnValues, node, context);
+}
+
+inline CompiledTarget Flow::applyProcOutputs(const ParameterMap& values, const CompiledNode& node,
+                                             ExecutionContext& context) const {
+    // Map output parameters from bindings (<<)
+    for (const auto& binding : program_->outputBindings(node)) {
+        auto it = values.find(*binding.procParam);
+        if (it != values.end()) {
+            context.setVariable(binding.slot, it->second);
         }
     }
     
     // Clear async wait if it was set
     context.clearAsyncWait();
+    return node.next;
+}
+
+inline ExecutionContext& Flow::enterSubflow(const CompiledNode& node, NodeIndex callNode,
+                                           std::shared_ptr<const SubflowLink> link, ExecutionContext& caller,
+                                           ExecutionContext& root) const {
+    if (root.callDepth() >= MaxCallDepth) {
+        throw FlowGraphError(FlowGraphError::Type::Runtime,
+            "Sub-flow call depth exceeded: " + node.asProc().procedureName);
+    }
+    
+    // Bind the inputs (>>) slot to slot; unassigned variables stay unset in the callee.
+    // Links hold the node's input bindings in order, so the last use of a variable is moved.
+    ExecutionContext& callee = caller.subflowContext(node.procIndex, link->callee->program_);
+    const CompiledBinding* binding = program_->inputBindings(node).begin();
+    for (const auto& transfer : link->inputs) {
+        const bool move = binding++->lastUse && root.releasesDeadValues();
+        if (const Value* value = caller.findVariable(transfer.from)) {
+            Value input = move ? caller.takeVariable(transfer.from) : *value;
+            if (transfer.name) {
+                callee.setVariable(*transfer.name, std::move(input));
+            } else {
+                callee.setVariable(transfer.to, std::move(input));
+            }
+        }
+    }
+    callee.setState(ExecutionState::Running);
+    root.pushCallFrame({std::move(link), &callee, callNode});
+    return callee;
+}
+
+inline CompiledTarget Flow::returnFromSubflow(const ExecutionContext::CallFrame& frame, CompiledTarget target,
+                                              ExecutionContext& caller) const {
+    const CompiledNode& node = program_->node(frame.callNode);
+    const SubflowLink& link = *frame.link;
+    frame.context->setState(target.kind == TargetKind::Error ? ExecutionState::Error : ExecutionState::Completed);
+    
+    if (target.kind == TargetKind::Error) {
+        // An error emitted by the callee is caught like a PROC error (e.g. 10.USER_NOT_FOUND -> 100)
+        const CompiledFlow& callee = *link.callee->program_;
+        const CompiledTarget* capture = &callee.symbols() == &program_->symbols()
+            ? program_->findErrorTarget(node, callee.errorSymbol(target.index))
+            : program_->findErrorTarget(node, callee.errorName(target.index)); // module of another engine
+        if (capture) {
+            return *capture;
+        }
+        throw FlowGraphError(FlowGraphError::Type::Runtime, "PROC execution failed: " + callee.errorName(target.index));
+    }
+    
+    // Map the callee's RETURNS to the caller's variables (<<)
+    for (const auto& transfer : link.outputs) {
+        if (const Value* value = frame.context->findVariable(transfer.from)) {
+            caller.setVariable(transfer.to, *value);
+        }
+    }
+    return node.next;
+}
+
+namespace detail {
+
+/**
+ * @brief Call body(hooks) with the hook policy the branches of a PAR node run with
+ *
+ * Copyable policies (release, profiling) get a copy of their own, so a branch
+ * does not disturb the PAR node's own per-node state; the debugger's policy
+ * is not copyable and its branches run on the release path.
+ */
+template<typename Hooks, typename Body>
+inline void withBranchHooks(Hooks& hooks, Body&& body) {
+    if constexpr (std::is_copy_constructible_v<Hooks>) {
+        Hooks branchHooks(hooks);
+        body(branchHooks);
+    } else {
+        NoDebugHooks branchHooks;
+        body(branchHooks);
+    }
+}
+
+// Budgets pause the started execution only, its branches run with the hooks the budget wraps
+template<typename Inner, typename Body>
+inline void withBranchHooks(BudgetHooks<Inner>& hooks, Body&& body) {
+    withBranchHooks(hooks.inner(), std::forward<Body>(body));
+}
+
+} // namespace detail
+
+template<typename Hooks>
+inline CompiledTarget Flow::executeParNode(const CompiledNode& node, ExecutionContext& context, ExecutionContext& root,
+                                           Hooks& hooks) const {
+    BranchRange entries = program_->branches(node);
+    auto& branches = context.beginBranches(entries.size(), root);
+    
+    // Start every branch; each runs until it reaches the JOIN or suspends on an
+    // async PROC, so the async PROCs of all branches are in flight together
+    detail::withBranchHooks(hooks, [&](auto& branchHooks) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            ExecutionContext& branch = *branches.contexts[i];
+            try {
+                if (run(branch, entries.begin()[i], branchHooks)) {
+                    settleBranch(node, branches, i);
+                } else {
+                    branches.inFlight.fetch_add(1, std::memory_order_relaxed);
+                }
+            } catch (...) {
+                branches.failure = std::current_exception();
+                branches.settled[i] = true;
+            }
+            if (branches.failed()) {
+                // Branches not started yet are abandoned
+                for (size_t rest = i + 1; rest < entries.size(); ++rest) {
+                    branches.settled[rest] = true;
+                }
+                break;
+            }
+        }
+    });
+    return joinBranches(node, context, root, hooks);
+}
+
+template<typename Hooks>
+inline CompiledTarget Flow::joinBranches(const CompiledNode& node, ExecutionContext& context, ExecutionContext& root,
+                                         Hooks& hooks) const {
+    auto& branches = context.branches();
+    for (;;) {
+        // Branches signal through the root callback only after signalled is cleared,
+        // so nothing else touches it while it is reset
+        root.beginProcCall();
+        branches.signalled.store(false, std::memory_order_release);
+        
+        const ExecutionContext* waiting = nullptr;
+        detail::withBranchHooks(hooks, [&](auto& branchHooks) {
+            for (size_t i = 0; i < branches.settled.size(); ++i) {
+                ExecutionContext& branch = *branches.contexts[i];
+                if (branches.settled[i]) {
+                    continue;
+                }
+                if (!branch.getProcCallback().IsResolved()) {
+                    waiting = &branch;
+                    continue;
+                }
+                if (branches.failed()) {
+                    branches.settled[i] = true; // its PROC is done, the branch is not continued
+                    continue;
+                }
+                try {
+                    if (resumeWith(branch, branchHooks)) {
+                        settleBranch(node, branches, i);
+                    } else {
+                        branches.inFlight.fetch_add(1, std::memory_order_relaxed);
+                        waiting = &branch;
+                    }
+                } catch (...) {
+                    branches.failure = std::current_exception();
+                    branches.settled[i] = true;
+                }
+            }
+        });
+        
+        if (!waiting) {
+            return finishBranches(node, context);
+        }
+        if (root.getProcCallback().Suspend()) {
+            root.setWaitingForAsync(waiting->getWaitingAsyncProc());
+            return node.next;
+        }
+        // A branch PROC completed while the others were looked at: go round again
+    }
+}
+
+inline void Flow::settleBranch(const CompiledNode& node, ExecutionContext::ParallelBranches& branches,
+                               size_t branch) const {
+    branches.settled[branch] = true;
+    const CompiledTarget& exit = branches.contexts[branch]->getBranchExit();
+    if (exit.kind == TargetKind::Error) {
+        if (!branches.failed()) {
+            branches.emitted = exit;
+        }
+    } else if (!exit.isNode()) {
+        branches.failure = std::make_exception_ptr(FlowGraphError(FlowGraphError::Type::Runtime,
+            "Branch of PAR " + node.source->id + " ended before reaching a JOIN"));
+    } else if (branches.join && *branches.join != exit.index) {
+        branches.failure = std::make_exception_ptr(FlowGraphError(FlowGraphError::Type::Runtime,
+            "Branches of PAR " + node.source->id + " reach different JOIN nodes"));
+    } else {
+        branches.join = exit.index;
+    }
+}
+
+inline CompiledTarget Flow::finishBranches(const CompiledNode& node, ExecutionContext& context) const {
+    auto& branches = context.branches();
+    // A branch seen as resolved may still be signalling from the thread that completed it
+    while (branches.inFlight.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+    if (branches.failure) {
+        std::rethrow_exception(branches.failure);
+    }
+    if (branches.emitted.kind == TargetKind::Error) {
+        // An error emitted by a branch can be caught on the PAR node (e.g. 20.TIMEOUT -> 100)
+        const CompiledTarget* capture = program_->findErrorTarget(node, program_->errorSymbol(branches.emitted.index));
+        return capture ? *capture : branches.emitted;
+    }
+    if (!branches.join) {
+        throw FlowGraphError(FlowGraphError::Type::Runtime, "PAR node " + node.source->id + " has no branches");
+    }
+    context.mergeBranches(node.source->id);
+    return program_->node(*branches.join).next;
+}
+
+namespace detail {
+
+inline ColumnExecutor::ColumnExecutor(const Flow& flow, const ColumnBatch& batch, const std::vector<Column*>& returns)
+    : flow_(flow), program_(flow.getProgram()), returns_(returns) {
+    for (const auto& [name, column] : batch.columns()) {
+        if (auto slot = program_.slots().find(name)) {
+            inputs_.emplace_back(*slot, &column);
+        } else {
+            namedInputs_.emplace_back(&name, &column);
+        }
+    }
+    values_.resize(program_.slots().size() * ChunkLanes);
+    types_.resize(program_.slots().size() * ChunkLanes);
+    pending_.resize(program_.nodeCount() * ChunkLanes);
+    waiting_.resize(program_.nodeCount());
+    active_.resize(ChunkLanes);
+    fallback_.resize(ChunkLanes);
+    taken_.resize(ChunkLanes);
+    stack_.resize(TypedExpression::MaxStackDepth * ChunkLanes);
+}
+
+inline ColumnExecutor::~ColumnExecutor() {
+    if (scalar_) {
+        flow_.releaseContext(std::move(scalar_));
+    }
+}
+
+inline void ColumnExecutor::runChunk(size_t first, size_t count) {
+    first_ = first;
+    count_ = count;
+    std::fill(types_.begin(), types_.end(), StaticType::Unknown);
+    for (const auto& [slot, column] : inputs_) {
+        std::copy_n(column->values.begin() + static_cast<std::ptrdiff_t>(first), count, &values_[slot * ChunkLanes]);
+        std::copy_n(column->types.begin() + static_cast<std::ptrdiff_t>(first), count, &types_[slot * ChunkLanes]);
+    }
+    
+    CompiledTarget entry = program_.entry();
+    if (entry.kind == TargetKind::None) {
+        for (size_t i = 0; i < count; ++i) {
+            errors.emplace_back(first + i, "Flow must have a START connection");
+        }
+        return;
+    }
+    lowest_ = static_cast<NodeIndex>(program_.nodeCount());
+    std::fill_n(active_.begin(), count, 1);
+    send(entry, active_.data());
+    while (lowest_ < program_.nodeCount()) {
+        if (!waiting_[lowest_]) {
+            ++lowest_;
+            continue;
+        }
+        NodeIndex index = lowest_;
+        waiting_[index] = 0;
+        uint8_t* lanes = &pending_[index * ChunkLanes];
+        std::copy_n(lanes, count, active_.begin());
+        std::fill_n(lanes, count, 0);
+        runNode(index);
+    }
+}
+
+inline void ColumnExecutor::runNode(NodeIndex index) {
+    const CompiledNode& node = program_.node(index);
+    const size_t count = count_;
+    const uint8_t* active = active_.data();
+    
+    bool columnar = node.typed && (node.kind == NodeKind::Assign ||
+                                   (node.kind == NodeKind::Cond && node.typed->type() == StaticType::Boolean));
+    if (node.kind == NodeKind::Join) {
+        // Outside a PAR branch a JOIN just continues
+        send(node.next, active);
+        return;
+    }
+    if (!columnar) {
+        for (size_t i = 0; i < count; ++i) {
+            if (active[i]) {
+                runScalar(i, index);
+            }
+        }
+        return;
+    }
+    
+    uint8_t* fallback = fallback_.data();
+    uint8_t* taken = taken_.data();
+    const double* result = stack_.data();
+    std::fill_n(fallback, count, 0);
+    node.typed->evaluateLanes([this](uint32_t slot) {
+        return std::make_pair(&values_[slot * ChunkLanes], &types_[slot * ChunkLanes]);
+    }, count, stack_.data(), fallback);
+    
+    if (node.kind == NodeKind::Assign) {
+        double* values = &values_[node.slot * ChunkLanes];
+        StaticType* types = &types_[node.slot * ChunkLanes];
+        StaticType type = node.typed->type();
+        for (size_t i = 0; i < count; ++i) {
+            taken[i] = active[i] & (fallback[i] ^ 1);
+            values[i] = taken[i] ? result[i] : values[i];
+            types[i] = taken[i] ? type : types[i];
+        }
+        send(node.next, taken);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            taken[i] = active[i] & (fallback[i] ^ 1) & (result[i] != 0);
+        }
+        send(node.yes, taken);
+        for (size_t i = 0; i < count; ++i) {
+            taken[i] = active[i] & (fallback[i] ^ 1) & (result[i] == 0);
+        }
+        send(node.no, taken);
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (active[i] && fallback[i]) {
+            runScalar(i, index);
+        }
+    }
+}
+
+inline void ColumnExecutor::send(CompiledTarget target, const uint8_t* lanes) {
+    switch (target.kind) {
+        case TargetKind::Node: {
+            uint8_t* pending = &pending_[target.index * ChunkLanes];
+            uint8_t any = 0;
+            for (size_t i = 0; i < count_; ++i) {
+                pending[i] |= lanes[i];
+                any |= lanes[i];
+            }
+            if (any) {
+                waiting_[target.index] = 1;
+                lowest_ = std::min(lowest_, target.index);
+            }
+            break;
+        }
+        case TargetKind::Error:
+            for (size_t i = 0; i < count_; ++i) {
+                if (lanes[i]) {
+                    errors.emplace_back(first_ + i, program_.errorName(target.index));
+                }
+            }
+            break;
+        default:
+            // END, or a port without connection
+            for (size_t i = 0; i < count_; ++i) {
+                if (lanes[i]) {
+                    finishLane(i);
+                }
+            }
+            break;
+    }
+}
+
+inline void ColumnExecutor::finishLane(size_t lane) {
+    const auto& slots = program_.returnSlots();
+    for (size_t r = 0; r < slots.size(); ++r) {
+        size_t entry = slots[r] * ChunkLanes + lane;
+        if (types_[entry] != StaticType::Unknown) {
+            returns_[r]->set(first_ + lane, values_[entry], types_[entry]);
+        }
+    }
+}
+
+inline void ColumnExecutor::runScalar(size_t lane, NodeIndex node) {
+    ++scalarLanes;
+    if (!scalar_) {
+        scalar_ = flow_.acquireContext();
+    }
+    ExecutionContext& context = *scalar_;
+    context.reset();
+    size_t batchLane = first_ + lane;
+    for (const auto& [name, column] : namedInputs_) {
+        if (column->isSet(batchLane)) {
+            context.setVariable(*name, column->value(batchLane));
+        }
+    }
+    for (SlotIndex slot = 0; slot < program_.slots().size(); ++slot) {
+        size_t entry = slot * ChunkLanes + lane;
+        if (types_[entry] == StaticType::Boolean) {
+            context.setVariable(slot, Value(values_[entry] != 0));
+        } else if (types_[entry] == StaticType::Number) {
+            context.setVariable(slot, Value(values_[entry]));
+        }
+    }
+    context.setState(ExecutionState::Running);
+    
+    NoDebugHooks hooks;
+    auto result = flow_.run(context, CompiledTarget{TargetKind::Node, node}, hooks);
+    if (!result) {
+        // As in execute(); the pool parks the context until the async PROC completes
+        flow_.releaseContext(std::move(scalar_));
+        errors.emplace_back(batchLane, "Async PROC execution not supported in synchronous mode");
+        return;
+    }
+    if (!result->success) {
+        errors.emplace_back(batchLane, std::move(result->error));
+        return;
+    }
+    const auto& returnValues = program_.ast().returnValues;
+    for (size_t r = 0; r < returnValues.size(); ++r) {
+        auto it = result->returnValues.find(returnValues[r].name);
+        if (it == result->returnValues.end()) {
+            continue;
+        }
+        if (it->second.isNumber()) {
+            returns_[r]->set(batchLane, it->second.asNumber(), StaticType::Number);
+        } else if (it->second.isBoolean()) {
+            returns_[r]->set(batchLane, it->second.asBoolean() ? 1 : 0, StaticType::Boolean);
+        }
+    }
+}
+
+} // namespace detail
+
+inline DebugExecutionContext::DebugExecutionContext(Flow flow, std::unique_ptr<ExecutionContext> context)
+    : flow_(std::move(flow)), context_(std::move(context)) {
+    hooks_.program = &flow_.getProgram();
+}
+
+inline bool DebugExecutionContext::Hooks::beforeNode(const CompiledFlow& nodeProgram, const CompiledNode& node,
+                                                     ExecutionContext& frame, CompiledTarget target) {
+    if (!std::exchange(resumed, false)) {
+        atBreakpoint = &nodeProgram == program && breakpoints.count(node.id) > 0;
+        bool requested = pauseRequested.exchange(false, std::memory_order_relaxed);
+        if (atBreakpoint || requested || (stepping && executed > 0)) {
+            pausedAt = target;
+            return true;
+        }
+    }
+    ++executed;
+    if (callback) {
+        DebugStepResult result(frame.getState(), frame.getCurrentNode());
+        result.variables = VariableView(frame);
+        callback(result);
+    }
+    return false;
+}
+
+inline DebugStepResult DebugExecutionContext::step() {
+    return advance(true);
+}
+
+inline DebugStepResult DebugExecutionContext::run() {
+    return advance(false);
+}
+
+inline DebugStepResult DebugExecutionContext::advance(bool stepping) {
+    if (result_) {
+        return createStepResult();
+    }
+    hooks_.stepping = stepping;
+    hooks_.executed = 0;
+    
+    std::optional<ExecutionResult> result;
+    switch (context_->getState()) {
+        case ExecutionState::NotStarted:
+            result = flow_.executeInternal(*context_, hooks_);
+            break;
+        case ExecutionState::Paused:
+            hooks_.resumed = true;
+            context_->setState(ExecutionState::Running);
+            result = flow_.run(*context_, hooks_.pausedAt, hooks_);
+            break;
+        case ExecutionState::WaitingAsync:
+            if (!context_->getProcCallback().IsResolved()) {
+                return createStepResult(); // not completed yet
+            }
+            hooks_.executed = 1; // the PROC node itself, a step ends before the node after it
+            result = flow_.resumeWith(*context_, hooks_);
+            break;
+        default:
+            break;
+    }
+    result_ = std::move(result);
+    return createStepResult();
+}
+
+inline void DebugExecutionContext::addBreakpoint(const std::string& nodeId) {
+    hooks_.breakpoints.insert(hooks_.program->symbols().intern(nodeId));
+}
+
+inline void DebugExecutionContext::removeBreakpoint(const std::string& nodeId) {
+    if (auto symbol = hooks_.program->symbols().find(nodeId)) {
+        hooks_.breakpoints.erase(*symbol);
+    }
+}
+
+inline bool DebugExecutionContext::hasBreakpoint(const std::string& nodeId) const {
+    auto symbol = hooks_.program->symbols().find(nodeId);
+    return symbol && hooks_.breakpoints.count(*symbol) > 0;
 }
 
-} // namespace FlowGraph
\ No newline at end of file
+} // namespace FlowGraph
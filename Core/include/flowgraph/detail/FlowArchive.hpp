@@ -0,0 +1,372 @@
+#pragma once
+
+#include "AST.hpp"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace FlowGraph {
+
+/**
+ * @brief Versioned binary serialization of a flow (.flowc)
+ *
+ * Layout (all integers little-endian uint32):
+ *
+ *     header   magic "FLWC", version, string count, string bytes, table words
+ *     offsets  string count + 1 offsets into the string data
+ *     table    title, comment, file name, parameter/return/error/node and
+ *              connection records; strings are referenced by index
+ *     strings  interned string data, each distinct string stored once
+ *
+ * Loading a mapped .flowc needs no lexing: strings are read in place and the
+ * tables map one to one onto the AST, which is then compiled in a single
+ * pass. Expressions are stored as source text because ExpressionKit trees
+ * have no serialized form; they are parsed once at compile time as usual.
+ */
+class FlowArchive {
+public:
+    static constexpr uint32_t Version = 1;
+
+    /**
+     * @brief True if the data starts with the .flowc magic
+     */
+    static bool isArchive(std::string_view data) noexcept;
+
+    static std::string serialize(const FlowAST& ast);
+
+    /**
+     * @brief Rebuild the AST stored in a .flowc image
+     * @throws FlowGraphError (Parse) if the data is truncated, corrupt or of another version
+     */
+    static std::unique_ptr<FlowAST> deserialize(std::string_view data, const std::string& filename = "");
+
+    /**
+     * @brief Write a .flowc file (replaced atomically)
+     * @throws FlowGraphError (IO) if the file cannot be written
+     */
+    static void save(const FlowAST& ast, const std::string& filepath);
+
+private:
+    static constexpr char Magic[4] = {'F', 'L', 'W', 'C'};
+    static constexpr size_t HeaderWords = 5;
+
+    class Writer;
+    class Reader;
+};
+
+// Implementation (header-only)
+
+class FlowArchive::Writer {
+public:
+    void word(uint32_t value) { table_.push_back(value); }
+    void count(size_t value) { word(static_cast<uint32_t>(value)); }
+
+    void string(const std::string& text) {
+        auto inserted = index_.emplace(text, static_cast<uint32_t>(strings_.size()));
+        if (inserted.second) {
+            strings_.push_back(inserted.first->first);
+        }
+        word(inserted.first->second);
+    }
+
+    std::string finish() const {
+        size_t stringBytes = 0;
+        for (auto text : strings_) {
+            stringBytes += text.size();
+        }
+
+        std::string out;
+        out.reserve(4 * (HeaderWords + strings_.size() + 1 + table_.size()) + stringBytes);
+        out.append(Magic, sizeof(Magic));
+        append(out, Version);
+        append(out, static_cast<uint32_t>(strings_.size()));
+        append(out, static_cast<uint32_t>(stringBytes));
+        append(out, static_cast<uint32_t>(table_.size()));
+
+        uint32_t offset = 0;
+        append(out, offset);
+        for (auto text : strings_) {
+            offset += static_cast<uint32_t>(text.size());
+            append(out, offset);
+        }
+        for (uint32_t value : table_) {
+            append(out, value);
+        }
+        for (auto text : strings_) {
+            out.append(text.data(), text.size());
+        }
+        return out;
+    }
+
+private:
+    std::vector<uint32_t> table_;
+    std::unordered_map<std::string, uint32_t> index_;   // node-based: keys stay put
+    std::vector<std::string_view> strings_;             // views of the index keys
+
+    static void append(std::string& out, uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            out.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+};
+
+class FlowArchive::Reader {
+public:
+    explicit Reader(std::string_view data) : data_(data) {
+        if (!isArchive(data) || data.size() < 4 * HeaderWords) {
+            fail("not a compiled flow");
+        }
+        uint32_t version = at(1);
+        if (version != Version) {
+            fail("unsupported version " + std::to_string(version));
+        }
+        stringCount_ = at(2);
+        uint32_t stringBytes = at(3);
+        tableWords_ = at(4);
+
+        offsetsBegin_ = HeaderWords;
+        tableBegin_ = offsetsBegin_ + static_cast<size_t>(stringCount_) + 1;
+        stringsBegin_ = 4 * (tableBegin_ + static_cast<size_t>(tableWords_));
+        if (stringsBegin_ + stringBytes != data.size()) {
+            fail("size mismatch");
+        }
+        uint32_t previous = 0;
+        for (uint32_t i = 0; i <= stringCount_; ++i) {
+            uint32_t offset = at(offsetsBegin_ + i);
+            if (offset < previous || offset > stringBytes || (i == 0 && offset != 0)) {
+                fail("bad string table");
+            }
+            previous = offset;
+        }
+        cursor_ = tableBegin_;
+    }
+
+    uint32_t word() {
+        if (cursor_ >= tableBegin_ + tableWords_) {
+            fail("truncated table");
+        }
+        return at(cursor_++);
+    }
+
+    std::string_view string() {
+        uint32_t index = word();
+        if (index >= stringCount_) {
+            fail("bad string reference");
+        }
+        uint32_t begin = at(offsetsBegin_ + index);
+        uint32_t end = at(offsetsBegin_ + index + 1);
+        return data_.substr(stringsBegin_ + begin, end - begin);
+    }
+
+    std::string text() { return std::string(string()); }
+
+    TypeInfo type() {
+        uint32_t value = word();
+        if (value > static_cast<uint32_t>(ValueType::String)) {
+            fail("bad type");
+        }
+        return TypeInfo(static_cast<ValueType>(value));
+    }
+
+    bool finished() const { return cursor_ == tableBegin_ + tableWords_; }
+
+    [[noreturn]] static void fail(const std::string& reason) {
+        throw FlowGraphError(FlowGraphError::Type::Parse, "Invalid compiled flow: " + reason);
+    }
+
+private:
+    std::string_view data_;
+    uint32_t stringCount_ = 0;
+    uint32_t tableWords_ = 0;
+    size_t offsetsBegin_ = 0;
+    size_t tableBegin_ = 0;
+    size_t stringsBegin_ = 0;
+    size_t cursor_ = 0;
+
+    uint32_t at(size_t index) const {
+        if (4 * index + 4 > data_.size()) {
+            fail("truncated data");
+        }
+        const auto* bytes = reinterpret_cast<const unsigned char*>(data_.data()) + 4 * index;
+        return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+    }
+};
+
+inline bool FlowArchive::isArchive(std::string_view data) noexcept {
+    return data.size() >= sizeof(Magic) && std::memcmp(data.data(), Magic, sizeof(Magic)) == 0;
+}
+
+inline std::string FlowArchive::serialize(const FlowAST& ast) {
+    Writer out;
+    out.string(ast.title);
+    out.string(ast.comment);
+    out.string(ast.location.filename);
+
+    for (const auto* list : {&ast.parameters, &ast.returnValues}) {
+        out.count(list->size());
+        for (const auto& param : *list) {
+            out.string(param.name);
+            out.word(static_cast<uint32_t>(param.type.type));
+            out.word(param.type.optional ? 1 : 0);
+            out.string(param.comment);
+        }
+    }
+
+    out.count(ast.errors.size());
+    for (const auto& error : ast.errors) {
+        out.string(error.name);
+        out.string(error.comment);
+    }
+
+    out.count(ast.nodes.size());
+    for (const auto& node : ast.nodes) {
+        out.word(static_cast<uint32_t>(node->kind));
+        out.string(node->id);
+        out.string(node->comment);
+        out.count(node->location.line);
+        out.count(node->location.column);
+        switch (node->kind) {
+            case NodeKind::Assign: {
+                const auto& assign = static_cast<const AssignNode&>(*node);
+                out.word(static_cast<uint32_t>(assign.targetType.type));
+                out.string(assign.variableName);
+                out.string(assign.expression);
+                break;
+            }
+            case NodeKind::Cond:
+                out.string(static_cast<const CondNode&>(*node).condition);
+                break;
+            case NodeKind::Proc: {
+                const auto& proc = static_cast<const ProcNode&>(*node);
+                out.string(proc.procedureName);
+                out.count(proc.bindings.size());
+                for (const auto& binding : proc.bindings) {
+                    out.string(binding.localVar);
+                    out.string(binding.procParam);
+                    out.word(binding.isOutput ? 1 : 0);
+                }
+                break;
+            }
+            case NodeKind::Par:
+            case NodeKind::Join:
+                break;
+        }
+    }
+
+    out.count(ast.connections.size());
+    for (const auto& conn : ast.connections) {
+        out.string(conn.fromNode);
+        out.string(conn.toNode);
+        out.string(conn.fromPort);
+        out.string(conn.toPort);
+    }
+    return out.finish();
+}
+
+inline std::unique_ptr<FlowAST> FlowArchive::deserialize(std::string_view data, const std::string& filename) {
+    Reader in(data);
+    auto ast = FlowAST::withArena(2 * data.size());
+    ast->title = in.text();
+    ast->comment = in.text();
+    std::string sourceName = in.text();   // file the archive was compiled from
+    ast->location = Location(filename.empty() ? sourceName : filename, 1, 1);
+
+    for (auto* list : {&ast->parameters, &ast->returnValues}) {
+        uint32_t count = in.word();
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string name = in.text();
+            TypeInfo type = in.type();
+            type.optional = in.word() != 0;
+            list->emplace_back(name, type, in.text());
+        }
+    }
+
+    uint32_t errorCount = in.word();
+    for (uint32_t i = 0; i < errorCount; ++i) {
+        std::string name = in.text();
+        ast->errors.emplace_back(name, in.text());
+    }
+
+    uint32_t nodeCount = in.word();
+    for (uint32_t i = 0; i < nodeCount; ++i) {
+        uint32_t kind = in.word();
+        std::string id = in.text();
+        std::string comment = in.text();
+        uint32_t line = in.word();
+        uint32_t column = in.word();
+        Location location(ast->location.filename, line, column);
+
+        FlowNodePtr node;
+        switch (static_cast<NodeKind>(kind)) {
+            case NodeKind::Assign: {
+                TypeInfo type = in.type();
+                std::string variable = in.text();
+                node = ast->makeNode<AssignNode>(id, type, variable, in.text(), location);
+                break;
+            }
+            case NodeKind::Cond:
+                node = ast->makeNode<CondNode>(id, in.text(), location);
+                break;
+            case NodeKind::Proc: {
+                auto proc = ast->makeNode<ProcNode>(id, in.text(), location);
+                uint32_t bindingCount = in.word();
+                for (uint32_t b = 0; b < bindingCount; ++b) {
+                    std::string local = in.text();
+                    std::string param = in.text();
+                    proc->addBinding(local, param, in.word() != 0);
+                }
+                node = std::move(proc);
+                break;
+            }
+            case NodeKind::Par:
+                node = ast->makeNode<ParNode>(id, location);
+                break;
+            case NodeKind::Join:
+                node = ast->makeNode<JoinNode>(id, location);
+                break;
+            default:
+                Reader::fail("bad node kind");
+        }
+        node->comment = std::move(comment);
+        ast->nodes.push_back(std::move(node));
+    }
+
+    uint32_t connectionCount = in.word();
+    for (uint32_t i = 0; i < connectionCount; ++i) {
+        std::string from = in.text();
+        std::string to = in.text();
+        std::string fromPort = in.text();
+        ast->connections.emplace_back(from, to, fromPort, in.text());
+    }
+
+    if (!in.finished()) {
+        Reader::fail("trailing data");
+    }
+    return ast;
+}
+
+inline void FlowArchive::save(const FlowAST& ast, const std::string& filepath) {
+    std::string image = serialize(ast);
+    std::string temporary = filepath + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(image.data(), static_cast<std::streamsize>(image.size()));
+        if (!out) {
+            throw FlowGraphError(FlowGraphError::Type::IO, "Cannot write file: " + filepath);
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, filepath, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        throw FlowGraphError(FlowGraphError::Type::IO, "Cannot write file: " + filepath);
+    }
+}
+
+} // namespace FlowGraph
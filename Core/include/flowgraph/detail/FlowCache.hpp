@@ -0,0 +1,216 @@
+#pragma once
+
+#include "Parser.hpp"
+#include "FlowArchive.hpp"
+#include "Engine.hpp"
+#include "SourceFile.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+
+namespace FlowGraph {
+
+/**
+ * @brief Cache of compiled flows keyed by source path and content hash
+ *
+ * Loading a file whose contents are unchanged hands back the cached Flow -
+ * copies share the immutable CompiledFlow, its context pool and resolved PROC
+ * handles - so a module reloaded or referenced by many parents is parsed and
+ * compiled once. Files are memory-mapped and hashed on every load, which is
+ * far cheaper than parsing and, unlike modification times, never misses an
+ * edit. In-memory sources are cached by content as well. Both .flow text and
+ * precompiled .flowc files are accepted.
+ *
+ * Safe to use from several threads; parsing happens outside the lock.
+ */
+class FlowCache {
+public:
+    explicit FlowCache(Engine& engine) : engine_(engine) {}
+
+    FlowCache(const FlowCache&) = delete;
+    FlowCache& operator=(const FlowCache&) = delete;
+
+    /**
+     * @brief Load a flow file, reusing the cached flow if its contents are unchanged
+     * @throws FlowGraphError (IO) if the file cannot be read, (Parse) on syntax errors
+     */
+    Flow loadFile(const std::string& filepath) { return load(filepath, false); }
+
+    /**
+     * @brief Like loadFile(), but only accepts precompiled .flowc files
+     */
+    Flow loadCompiledFile(const std::string& filepath) { return load(filepath, true); }
+
+    /**
+     * @brief Parse flow source, reusing the cached flow for identical content and name
+     */
+    Flow parse(std::string_view content, const std::string& name = "");
+
+    /**
+     * @brief Drop the cached flow of a file
+     * @return True if the file was cached
+     */
+    bool invalidate(const std::string& filepath);
+
+    void clear();
+
+    /**
+     * @brief Number of cached flows (files and in-memory sources)
+     */
+    size_t size() const;
+
+    /**
+     * @brief Loads served from the cache / loads that had to parse
+     */
+    size_t hits() const;
+    size_t misses() const;
+
+    /**
+     * @brief 64-bit FNV-1a hash of flow source
+     */
+    static uint64_t contentHash(std::string_view content) noexcept;
+
+private:
+    struct FileEntry {
+        uint64_t hash;
+        size_t size;
+        Flow flow;
+    };
+
+    struct SourceEntry {
+        std::string content;  // kept to rule out hash collisions
+        std::string name;
+        Flow flow;
+    };
+
+    Engine& engine_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, FileEntry> files_;           // by normalized path
+    std::unordered_multimap<uint64_t, SourceEntry> sources_;     // by content hash
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+
+    Flow load(const std::string& filepath, bool compiledOnly);
+    static std::string normalize(const std::string& filepath);
+};
+
+// Implementation (header-only)
+
+inline Flow FlowCache::load(const std::string& filepath, bool compiledOnly) {
+    std::string key = normalize(filepath);
+    SourceFile file = SourceFile::open(filepath);
+    std::string_view content = file.view();
+    bool compiled = FlowArchive::isArchive(content);
+    if (compiledOnly && !compiled) {
+        throw FlowGraphError(FlowGraphError::Type::Parse, "Not a compiled flow: " + filepath);
+    }
+    uint64_t hash = contentHash(content);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = files_.find(key);
+        if (it != files_.end() && it->second.hash == hash && it->second.size == content.size()) {
+            ++hits_;
+            return it->second.flow;
+        }
+    }
+
+    std::unique_ptr<FlowAST> ast;
+    if (compiled) {
+        ast = FlowArchive::deserialize(content, filepath);
+    } else {
+        Parser parser;
+        ast = parser.parse(content, filepath);
+    }
+    Flow flow(std::move(ast), &engine_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++misses_;
+    auto it = files_.find(key);
+    if (it != files_.end() && it->second.hash == hash && it->second.size == content.size()) {
+        return it->second.flow; // another thread loaded the same contents meanwhile
+    }
+    files_.insert_or_assign(key, FileEntry{hash, content.size(), flow});
+    return flow;
+}
+
+inline Flow FlowCache::parse(std::string_view content, const std::string& name) {
+    uint64_t hash = contentHash(content);
+    auto lookup = [&]() -> std::optional<Flow> {
+        auto range = sources_.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.content == content && it->second.name == name) {
+                return it->second.flow;
+            }
+        }
+        return std::nullopt;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto cached = lookup()) {
+            ++hits_;
+            return *cached;
+        }
+    }
+
+    Parser parser;
+    Flow flow(parser.parse(content, name), &engine_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++misses_;
+    if (auto cached = lookup()) {
+        return *cached;
+    }
+    sources_.emplace(hash, SourceEntry{std::string(content), name, flow});
+    return flow;
+}
+
+inline bool FlowCache::invalidate(const std::string& filepath) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return files_.erase(normalize(filepath)) > 0;
+}
+
+inline void FlowCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_.clear();
+    sources_.clear();
+}
+
+inline size_t FlowCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return files_.size() + sources_.size();
+}
+
+inline size_t FlowCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+inline size_t FlowCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+inline uint64_t FlowCache::contentHash(std::string_view content) noexcept {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : content) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline std::string FlowCache::normalize(const std::string& filepath) {
+    // Different spellings of one file ("a.flow", "./a.flow") share an entry
+    std::error_code error;
+    auto canonical = std::filesystem::weakly_canonical(filepath, error);
+    return error ? filepath : canonical.string();
+}
+
+} // namespace FlowGraph
@@ -0,0 +1,396 @@
+#pragma once
+
+#include "Engine.hpp"
+#include "FlowCache.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+namespace FlowGraph {
+
+/**
+ * @brief Shared, atomically replaceable reference to the current version of a flow
+ *
+ * Copies of a handle refer to the same slot. get() pins the version that is
+ * current at the time of the call: an execution started on it runs to the
+ * end on that version even if a new one is published meanwhile, and the old
+ * version is freed when the last execution holding it finishes. publish()
+ * swaps the slot with one atomic store, so readers never block.
+ */
+class FlowHandle {
+public:
+    FlowHandle() = default;
+    explicit FlowHandle(Flow flow) : state_(std::make_shared<State>()) {
+        store(std::make_shared<const Flow>(std::move(flow)));
+    }
+
+    /**
+     * @brief Current version of the flow
+     */
+    std::shared_ptr<const Flow> get() const { return load(); }
+
+    /**
+     * @brief Number of versions published so far, starting at 1
+     */
+    uint64_t version() const { return state_->version.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Make a new version current; executions already running keep theirs
+     */
+    void publish(Flow flow) {
+        store(std::make_shared<const Flow>(std::move(flow)));
+        state_->version.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief Execute the current version
+     */
+    ExecutionResult execute(const ParameterMap& params = {}) const { return load()->execute(params); }
+
+    explicit operator bool() const { return state_ != nullptr; }
+
+private:
+    struct State {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        std::atomic<std::shared_ptr<const Flow>> current;
+#else
+        std::shared_ptr<const Flow> current;  // accessed through std::atomic_load/atomic_store only
+#endif
+        std::atomic<uint64_t> version{1};
+    };
+
+    std::shared_ptr<State> state_;
+
+    std::shared_ptr<const Flow> load() const {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        return state_->current.load(std::memory_order_acquire);
+#else
+        return std::atomic_load_explicit(&state_->current, std::memory_order_acquire);
+#endif
+    }
+
+    void store(std::shared_ptr<const Flow> flow) {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        state_->current.store(std::move(flow), std::memory_order_release);
+#else
+        std::atomic_store_explicit(&state_->current, std::move(flow), std::memory_order_release);
+#endif
+    }
+};
+
+/**
+ * @brief Watches flow files and publishes recompiled versions while flows keep running
+ *
+ * Every watched file has a FlowHandle. poll() compares each file's
+ * modification time and size with the last look and reloads changed files
+ * through the FlowCache, so only modules whose contents actually changed are
+ * parsed and compiled. A new version is published only if it parses and
+ * validates; otherwise the old one stays current and the error handler is
+ * told why. Watched modules (see FlowGraphEngine::loadDirectory) are
+ * re-registered with the engine and every registered module and watched flow
+ * is relinked, so new calls into a reloaded module reach the new version
+ * while calls already running finish on the old one. Flows that are not
+ * watched keep the module versions they were linked to until their
+ * linkModules() is called.
+ *
+ * start() polls on a background thread; poll() can be called directly
+ * instead. A replaced version is freed once no linked flow or running call
+ * holds it any more (see Engine::registerModule).
+ */
+class FlowReloader {
+public:
+    using ErrorHandler = std::function<void(const std::string& path, const std::string& message)>;
+
+    FlowReloader(FlowCache& cache, Engine& engine) : cache_(cache), engine_(engine) {}
+    ~FlowReloader() { stop(); }
+
+    FlowReloader(const FlowReloader&) = delete;
+    FlowReloader& operator=(const FlowReloader&) = delete;
+
+    /**
+     * @brief Load a flow file and watch it for changes
+     *
+     * Watching a file that is already watched returns its existing handle.
+     *
+     * @param moduleName Module name the file is registered under, empty for a plain flow
+     * @throws FlowGraphError (IO) if the file cannot be read, (Parse) on syntax errors
+     */
+    FlowHandle watch(const std::string& filepath, const std::string& moduleName = "");
+
+    /**
+     * @brief Watch a file whose flow has already been loaded
+     *
+     * If the file is already watched, flow is published to its handle unless
+     * it is the current version.
+     */
+    FlowHandle watch(const std::string& filepath, Flow flow, const std::string& moduleName = "");
+
+    /**
+     * @brief Stop watching a file; its handle keeps the last version
+     * @return True if the file was watched
+     */
+    bool unwatch(const std::string& filepath);
+
+    /**
+     * @brief Handle of a watched module
+     */
+    std::optional<FlowHandle> findModule(const std::string& moduleName) const;
+
+    /**
+     * @brief Reload every watched file that changed since the last poll
+     * @return Number of flows that got a new version
+     */
+    size_t poll();
+
+    /**
+     * @brief Poll on a background thread every interval until stop()
+     *
+     * start() and stop() must not be called concurrently with each other.
+     */
+    void start(std::chrono::milliseconds interval = std::chrono::milliseconds(500));
+    void stop();
+    bool isRunning() const { return thread_.joinable(); }
+
+    /**
+     * @brief Receive load and validation errors of changed files
+     *
+     * Called from the polling thread while the watch list is locked; it must
+     * not call back into the reloader. Set it before start().
+     */
+    void setErrorHandler(ErrorHandler handler) { errorHandler_ = std::move(handler); }
+
+    size_t size() const;
+
+private:
+    struct FileStamp {
+        std::filesystem::file_time_type modified{};
+        uintmax_t size = 0;
+        bool exists = false;
+
+        bool operator==(const FileStamp& other) const {
+            return exists == other.exists && modified == other.modified && size == other.size;
+        }
+        bool operator!=(const FileStamp& other) const { return !(*this == other); }
+    };
+
+    struct Watch {
+        std::string path;
+        std::string moduleName;
+        FileStamp stamp;
+        FlowHandle handle;
+    };
+
+    FlowCache& cache_;
+    Engine& engine_;
+    ErrorHandler errorHandler_;
+
+    mutable std::mutex mutex_;  // watch list; held for a whole poll
+    std::unordered_map<std::string, Watch> watches_;  // by normalized path
+
+    std::thread thread_;
+    std::mutex threadMutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+
+    std::optional<Flow> reload(const Watch& watch);
+    void publishLocked(Watch& watch, Flow flow);
+    void relinkLocked();
+    void report(const std::string& path, const std::string& message) const;
+    static FileStamp stampOf(const std::string& filepath);
+    static std::string normalize(const std::string& filepath);
+};
+
+// Implementation (header-only)
+
+inline FlowHandle FlowReloader::watch(const std::string& filepath, const std::string& moduleName) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = watches_.find(normalize(filepath));
+        if (it != watches_.end()) {
+            return it->second.handle;
+        }
+    }
+    // Stamp before loading so an edit racing the load is picked up by the next poll
+    FileStamp stamp = stampOf(filepath);
+    Flow flow = cache_.loadFile(filepath);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto inserted = watches_.emplace(normalize(filepath), Watch{filepath, moduleName, stamp, FlowHandle(flow)});
+    return inserted.first->second.handle;
+}
+
+inline FlowHandle FlowReloader::watch(const std::string& filepath, Flow flow, const std::string& moduleName) {
+    FileStamp stamp = stampOf(filepath);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = watches_.find(normalize(filepath));
+    if (it == watches_.end()) {
+        it = watches_.emplace(normalize(filepath), Watch{filepath, moduleName, stamp, FlowHandle(flow)}).first;
+    } else if (&it->second.handle.get()->getProgram() != &flow.getProgram()) {
+        it->second.stamp = stamp;
+        it->second.handle.publish(std::move(flow));
+    }
+    return it->second.handle;
+}
+
+inline bool FlowReloader::unwatch(const std::string& filepath) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return watches_.erase(normalize(filepath)) > 0;
+}
+
+inline std::optional<FlowHandle> FlowReloader::findModule(const std::string& moduleName) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [key, watch] : watches_) {
+        if (watch.moduleName == moduleName) {
+            return watch.handle;
+        }
+    }
+    return std::nullopt;
+}
+
+inline size_t FlowReloader::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return watches_.size();
+}
+
+inline size_t FlowReloader::poll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t reloaded = 0;
+    bool modulesChanged = false;
+    for (auto& [key, watch] : watches_) {
+        FileStamp stamp = stampOf(watch.path);
+        if (stamp == watch.stamp) {
+            continue;
+        }
+        watch.stamp = stamp;
+        if (!stamp.exists) {
+            report(watch.path, "cannot read file, keeping the loaded version");
+            continue;
+        }
+        std::optional<Flow> flow = reload(watch);
+        if (!flow) {
+            continue;
+        }
+        modulesChanged = modulesChanged || !watch.moduleName.empty();
+        publishLocked(watch, std::move(*flow));
+        ++reloaded;
+    }
+    if (modulesChanged) {
+        relinkLocked();
+    }
+    return reloaded;
+}
+
+inline std::optional<Flow> FlowReloader::reload(const Watch& watch) {
+    try {
+        Flow flow = cache_.loadFile(watch.path);
+        if (&flow.getProgram() == &watch.handle.get()->getProgram()) {
+            return std::nullopt; // touched, contents unchanged
+        }
+        auto errors = flow.getProgram().ast().validate();
+        const auto& diagnostics = flow.getProgram().diagnostics();
+        errors.insert(errors.end(), diagnostics.begin(), diagnostics.end());
+        for (const auto& message : errors) {
+            report(watch.path, message);
+        }
+        if (!errors.empty()) {
+            return std::nullopt;
+        }
+        return flow;
+    } catch (const FlowGraphError& e) {
+        std::string message = e.what();
+        if (e.location() && e.location()->line > 0) {
+            message = std::to_string(e.location()->line) + ":" + std::to_string(e.location()->column) + ": " + message;
+        }
+        report(watch.path, message);
+    } catch (const std::exception& e) {
+        report(watch.path, e.what());
+    }
+    return std::nullopt;
+}
+
+inline void FlowReloader::publishLocked(Watch& watch, Flow flow) {
+    if (!watch.moduleName.empty()) {
+        // Registered and linked before it becomes current, so no call through
+        // the handle sees it without its module links
+        engine_.registerModule(watch.moduleName, flow);
+        flow.linkModules(watch.moduleName);
+    }
+    watch.handle.publish(std::move(flow));
+}
+
+inline void FlowReloader::relinkLocked() {
+    // Point calls into reloaded modules at the new versions. Links are
+    // published atomically; calls that already resolved theirs finish on the
+    // version they started with.
+    for (const auto& name : engine_.getRegisteredModules()) {
+        if (auto module = engine_.findModule(name)) {
+            module->linkModules(name);
+        }
+    }
+    for (const auto& [key, watch] : watches_) {
+        if (watch.moduleName.empty()) {
+            watch.handle.get()->linkModules();
+        }
+    }
+}
+
+inline void FlowReloader::start(std::chrono::milliseconds interval) {
+    stop();
+    stopping_ = false;
+    thread_ = std::thread([this, interval]() {
+        std::unique_lock<std::mutex> lock(threadMutex_);
+        while (!wake_.wait_for(lock, interval, [this]() { return stopping_; })) {
+            lock.unlock();
+            poll();
+            lock.lock();
+        }
+    });
+}
+
+inline void FlowReloader::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(threadMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+}
+
+inline void FlowReloader::report(const std::string& path, const std::string& message) const {
+    if (errorHandler_) {
+        errorHandler_(path, message);
+    }
+}
+
+inline FlowReloader::FileStamp FlowReloader::stampOf(const std::string& filepath) {
+    FileStamp stamp;
+    std::error_code error;
+    stamp.modified = std::filesystem::last_write_time(filepath, error);
+    if (error) {
+        return stamp;
+    }
+    stamp.size = std::filesystem::file_size(filepath, error);
+    stamp.exists = !error;
+    return stamp;
+}
+
+inline std::string FlowReloader::normalize(const std::string& filepath) {
+    std::error_code error;
+    auto canonical = std::filesystem::weakly_canonical(filepath, error);
+    return error ? filepath : canonical.string();
+}
+
+} // namespace FlowGraph
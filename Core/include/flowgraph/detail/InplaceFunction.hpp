@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace FlowGraph {
+
+template<typename Signature, std::size_t Capacity = 64>
+class InplaceFunction;
+
+/**
+ * @brief Move-only callable wrapper with a fixed inline buffer
+ *
+ * Like std::function, but the callable is always stored inside the object
+ * and never on the heap: callables larger than Capacity are rejected at
+ * compile time. The default capacity holds a std::function as well, so
+ * existing std::function values can be passed where an InplaceFunction is
+ * expected. Calling an empty InplaceFunction throws std::bad_function_call.
+ */
+template<typename R, typename... Args, std::size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+    InplaceFunction() noexcept = default;
+    InplaceFunction(std::nullptr_t) noexcept {}
+
+    template<typename F,
+             typename Fn = std::decay_t<F>,
+             typename = std::enable_if_t<!std::is_same_v<Fn, InplaceFunction> &&
+                                         std::is_invocable_r_v<R, Fn&, Args...>>>
+    InplaceFunction(F&& callable) {
+        static_assert(sizeof(Fn) <= Capacity, "Callable does not fit into the InplaceFunction buffer");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "Callable is over-aligned for InplaceFunction");
+        static_assert(std::is_nothrow_move_constructible_v<Fn>, "InplaceFunction requires nothrow-movable callables");
+        if constexpr (std::is_pointer_v<Fn> || std::is_member_pointer_v<Fn> || IsStdFunction<Fn>::value) {
+            if (!callable) {
+                return; // null function pointers and empty std::function stay empty
+            }
+        }
+        ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(callable));
+        invoke_ = &invokeImpl<Fn>;
+        manage_ = &manageImpl<Fn>;
+    }
+
+    InplaceFunction(InplaceFunction&& other) noexcept { moveFrom(other); }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    InplaceFunction(const InplaceFunction&) = delete;
+    InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+    ~InplaceFunction() { reset(); }
+
+    explicit operator bool() const noexcept { return invoke_ != nullptr; }
+
+    R operator()(Args... args) const {
+        if (!invoke_) {
+            throw std::bad_function_call();
+        }
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+private:
+    template<typename T> struct IsStdFunction : std::false_type {};
+    template<typename S> struct IsStdFunction<std::function<S>> : std::true_type {};
+    
+    using Invoker = R (*)(void*, Args&&...);
+    using Manager = void (*)(void* destination, void* source) noexcept; // move-construct (if destination) and destroy source
+
+    alignas(std::max_align_t) mutable unsigned char storage_[Capacity];
+    Invoker invoke_ = nullptr;
+    Manager manage_ = nullptr;
+
+    template<typename Fn>
+    static R invokeImpl(void* storage, Args&&... args) {
+        return (*static_cast<Fn*>(storage))(std::forward<Args>(args)...);
+    }
+
+    template<typename Fn>
+    static void manageImpl(void* destination, void* source) noexcept {
+        Fn* callable = static_cast<Fn*>(source);
+        if (destination) {
+            ::new (destination) Fn(std::move(*callable));
+        }
+        callable->~Fn();
+    }
+
+    void moveFrom(InplaceFunction& other) noexcept {
+        if (other.manage_) {
+            other.manage_(storage_, other.storage_);
+            invoke_ = other.invoke_;
+            manage_ = other.manage_;
+            other.invoke_ = nullptr;
+            other.manage_ = nullptr;
+        }
+    }
+
+    void reset() noexcept {
+        if (manage_) {
+            manage_(nullptr, storage_);
+            invoke_ = nullptr;
+            manage_ = nullptr;
+        }
+    }
+};
+
+} // namespace FlowGraph
@@ -1,11 +1,12 @@
 #pragma once
 
 #include "AST.hpp"
+#include "SourceFile.hpp"
 #include <string>
-#include <istream>
+#include <string_view>
 #include <memory>
 #include <cctype>
-#include <algorithm>
+#include <cstdint>
 
 namespace FlowGraph {
 
@@ -18,7 +19,7 @@ enum class TokenType {
     String,
     Number,
     Boolean,
-    
+
     // Keywords
     Title,
     Params,
@@ -28,12 +29,14 @@ enum class TokenType {
     Flow,
     Start,
     End,
-    
+
     // Node types
     Proc,
     Assign,
     Cond,
-    
+    Par,
+    Join,
+
     // Operators and symbols
     Arrow,          // ->
     InputBinding,   // >>
@@ -41,11 +44,11 @@ enum class TokenType {
     Dot,           // .
     Colon,         // :
     Question,      // ?
-    
+
     // Comments
     LineComment,   // //
     BlockComment,  // /* */
-    
+
     // Special
     Newline,
     EOF_Token,
@@ -54,38 +57,80 @@ enum class TokenType {
 
 /**
  * @brief Single token
+ *
+ * The text is a view into the source buffer the lexer was created on (string
+ * literals without their quotes), so tokens never allocate and are only valid
+ * while that buffer is alive.
  */
 struct Token {
-    TokenType type;
-    std::string text;
-    Location location;
-    
-    Token(TokenType t, const std::string& txt, Location loc = {})
-        : type(t), text(txt), location(loc) {}
+    TokenType type = TokenType::Invalid;
+    std::string_view text;
+    size_t offset = 0;   // start of the token in the source, including any quote
+    uint32_t line = 0;
+    uint32_t column = 0;
 };
 
 /**
  * @brief Lexical analyzer for FlowGraph files
+ *
+ * Works in a single pass over a non-owning view of the source and keeps one
+ * token of lookahead, so peekToken() never re-lexes.
  */
 class Lexer {
 public:
     Lexer() = default;
-    explicit Lexer(const std::string& content, const std::string& filename = "");
-    
+    explicit Lexer(std::string_view source, std::string_view filename = {});
+
+    /**
+     * @brief Consume and return the next token
+     */
     Token nextToken();
-    Token peekToken();
-    bool hasMoreTokens() const;
-    
-    Location getCurrentLocation() const;
-    
+
+    /**
+     * @brief The token nextToken() will return next
+     */
+    const Token& peekToken() const { return lookahead_; }
+
+    bool hasMoreTokens() const { return lookahead_.type != TokenType::EOF_Token; }
+
+    /**
+     * @brief Location of the next token
+     */
+    Location getCurrentLocation() const { return locationOf(lookahead_); }
+    Location locationOf(const Token& token) const;
+
+    /**
+     * @brief Raw source from the start of a token to the end of its line
+     *
+     * Used for expressions, which are handed to ExpressionKit verbatim. A
+     * trailing comment and surrounding whitespace are excluded. `from` must be
+     * the token last returned by nextToken(); lexing continues after the slice.
+     */
+    std::string_view readRestOfLine(const Token& from);
+
+    /**
+     * @brief Raw source from the start of a token up to the next whitespace
+     *
+     * Used for PROC names, which may be paths such as auth/login.flow. Same
+     * contract as readRestOfLine().
+     */
+    std::string_view readWord(const Token& from);
+
 private:
-    std::string content_;
-    std::string filename_;
+    std::string_view source_;
+    std::string_view filename_;
     size_t position_ = 0;
-    size_t line_ = 1;
-    size_t column_ = 1;
-    
-    char currentChar() const;
+    uint32_t line_ = 1;
+    uint32_t column_ = 1;
+    Token lookahead_ = Token{TokenType::EOF_Token, {}, 0, 0, 0};
+
+    Token lex();
+    Token makeToken(TokenType type, size_t start, uint32_t line, uint32_t column,
+                    size_t textBegin, size_t textEnd) const;
+    void rewindTo(const Token& token);
+    void skipTo(size_t position);
+
+    char currentChar() const { return isAtEnd() ? '\0' : source_[position_]; }
     char peekChar(size_t offset = 1) const;
     void advance();
     void skipWhitespace();
@@ -94,7 +139,8 @@ private:
     Token readIdentifier();
     Token readLineComment();
     Token readBlockComment();
-    bool isAtEnd() const;
+    bool isAtEnd() const { return position_ >= source_.size(); }
+    [[noreturn]] void error(const char* message, uint32_t line, uint32_t column) const;
 };
 
 /**
@@ -103,26 +149,35 @@ private:
 class Parser {
 public:
     Parser() = default;
-    
+
     /**
      * @brief Parse FlowGraph from string content
      */
-    std::unique_ptr<FlowAST> parse(const std::string& content, const std::string& filename = "");
-    
+    std::unique_ptr<FlowAST> parse(std::string_view content, std::string_view filename = {});
+
     /**
-     * @brief Parse FlowGraph from file
+     * @brief Parse FlowGraph from file (memory-mapped where supported)
+     * @throws FlowGraphError (IO) if the file cannot be read, (Parse) on syntax errors
      */
     std::unique_ptr<FlowAST> parseFile(const std::string& filepath);
-    
+
 private:
     Lexer lexer_;
-    Token currentToken_{TokenType::Invalid, ""};
-    
+    Token currentToken_;
+    std::string_view filename_;
+
+    // Leading comment block waiting to be attached to the next element
+    size_t commentBegin_ = 0;
+    size_t commentEnd_ = 0;
+    bool hasComment_ = false;
+    bool atLineStart_ = true;
+    std::string_view source_;
+
     void advance();
     bool match(TokenType type);
     bool check(TokenType type) const;
-    Token consume(TokenType type, const std::string& errorMessage);
-    
+    Token consume(TokenType type, const char* errorMessage);
+
     // Parsing methods
     std::unique_ptr<FlowAST> parseFlow();
     void parseTitle(FlowAST& ast);
@@ -131,42 +186,55 @@ private:
     void parseErrors(FlowAST& ast);
     void parseNodes(FlowAST& ast);
     void parseFlow(FlowAST& ast);
-    
-    std::unique_ptr<FlowNode> parseNode();
-    std::unique_ptr<AssignNode> parseAssignNode(const std::string& id);
-    std::unique_ptr<CondNode> parseCondNode(const std::string& id);
-    std::unique_ptr<ProcNode> parseProcNode(const std::string& id);
-    
+
+    FlowNodePtr parseNode(FlowAST& ast);
+    NodePtr<AssignNode> parseAssignNode(FlowAST& ast, const std::string& id, Location location);
+    NodePtr<CondNode> parseCondNode(FlowAST& ast, const std::string& id, Location location);
+    NodePtr<ProcNode> parseProcNode(FlowAST& ast, const std::string& id, Location location);
+
     FlowConnection parseConnection();
     Parameter parseParameter();
     TypeInfo parseType();
-    
+
     // Helper methods
-    void skipComments();
+    bool atSectionEnd() const;
+    void skipNewlines();
+    void endOfLine();
+    std::string parseExpression(const char* what);
     std::string collectComment();
-    
+
     // Error handling
-    void error(const std::string& message);
+    [[noreturn]] void error(const std::string& message);
     void warning(const std::string& message);
 };
 
-// Minimal parser implementation (header-only)
+// Implementation (header-only)
 
-inline std::unique_ptr<FlowAST> Parser::parse(const std::string& content, const std::string& filename) {
+inline std::unique_ptr<FlowAST> Parser::parse(std::string_view content, std::string_view filename) {
     lexer_ = Lexer(content, filename);
+    source_ = content;
+    filename_ = filename;
+    hasComment_ = false;
+    atLineStart_ = true;
     advance();
     return parseFlow();
 }
 
-inline std::unique_ptr<FlowAST> Parser::parseFile(const std::string& /*filepath*/) {
-    // For now, just return empty AST for file parsing
-    // Full implementation would read file and call parse()
-    return std::make_unique<FlowAST>();
+inline std::unique_ptr<FlowAST> Parser::parseFile(const std::string& filepath) {
+    SourceFile file = SourceFile::open(filepath);
+    return parse(file.view(), filepath);
 }
 
 inline std::unique_ptr<FlowAST> Parser::parseFlow() {
-    auto ast = std::make_unique<FlowAST>();
-    
+    // Nodes go into one arena; a node takes a few times the bytes of its source line
+    auto ast = FlowAST::withArena(4 * source_.size());
+    ast->location = Location(std::string(filename_), 1, 1);
+
+    skipNewlines();
+    if (hasComment_) {
+        ast->comment = collectComment(); // file-level comment
+    }
+
     while (currentToken_.type != TokenType::EOF_Token) {
         switch (currentToken_.type) {
             case TokenType::Title:
@@ -187,105 +255,232 @@ inline std::unique_ptr<FlowAST> Parser::parseFlow() {
             case TokenType::Flow:
                 parseFlow(*ast);
                 break;
-            default:
-                advance(); // Skip unknown tokens
+            case TokenType::Newline:
+                advance();
                 break;
+            default:
+                error("Expected section header, found '" + std::string(currentToken_.text) + "'");
         }
     }
-    
+
     return ast;
 }
 
 inline void Parser::parseTitle(FlowAST& ast) {
     advance(); // consume TITLE
-    if (currentToken_.type == TokenType::Colon) {
-        advance(); // consume :
-        
-        // Read the rest of the line as title
-        std::string title;
-        while (currentToken_.type != TokenType::Newline && 
-               currentToken_.type != TokenType::EOF_Token) {
-            if (!title.empty()) {
-                title += " ";
-            }
-            title += currentToken_.text;
-            advance();
-        }
-        ast.title = title;
+    consume(TokenType::Colon, "Expected ':' after TITLE");
+    if (!check(TokenType::Newline) && !check(TokenType::EOF_Token)) {
+        ast.title = std::string(lexer_.readRestOfLine(currentToken_));
+        advance();
     }
+    endOfLine();
 }
 
-inline void Parser::parseParams(FlowAST& /*ast*/) {
+inline void Parser::parseParams(FlowAST& ast) {
     advance(); // consume PARAMS
-    if (currentToken_.type == TokenType::Colon) {
-        advance(); // consume :
-        // For now, skip parameters parsing
-        while (currentToken_.type != TokenType::Returns && 
-               currentToken_.type != TokenType::Errors &&
-               currentToken_.type != TokenType::Nodes && 
-               currentToken_.type != TokenType::Flow &&
-               currentToken_.type != TokenType::EOF_Token) {
-            advance();
-        }
+    consume(TokenType::Colon, "Expected ':' after PARAMS");
+    endOfLine();
+    while (skipNewlines(), !atSectionEnd()) {
+        ast.parameters.push_back(parseParameter());
+        endOfLine();
     }
 }
 
-inline void Parser::parseReturns(FlowAST& /*ast*/) {
+inline void Parser::parseReturns(FlowAST& ast) {
     advance(); // consume RETURNS
-    if (currentToken_.type == TokenType::Colon) {
-        advance(); // consume :
-        // For now, skip returns parsing
-        while (currentToken_.type != TokenType::Errors &&
-               currentToken_.type != TokenType::Nodes && 
-               currentToken_.type != TokenType::Flow &&
-               currentToken_.type != TokenType::EOF_Token) {
-            advance();
-        }
+    consume(TokenType::Colon, "Expected ':' after RETURNS");
+    endOfLine();
+    while (skipNewlines(), !atSectionEnd()) {
+        ast.returnValues.push_back(parseParameter());
+        endOfLine();
     }
 }
 
 inline void Parser::parseErrors(FlowAST& ast) {
     advance(); // consume ERRORS
-    if (currentToken_.type == TokenType::Colon) {
-        advance(); // consume :
-        
-        // Parse error names
-        while (currentToken_.type == TokenType::Identifier || currentToken_.type == TokenType::Newline) {
-            if (currentToken_.type == TokenType::Identifier) {
-                ast.errors.emplace_back(currentToken_.text);
-                advance();
-            } else {
-                advance(); // skip newlines
-            }
-        }
+    consume(TokenType::Colon, "Expected ':' after ERRORS");
+    endOfLine();
+    while (skipNewlines(), !atSectionEnd()) {
+        std::string comment = collectComment();
+        Token name = consume(TokenType::Identifier, "Expected error name");
+        ast.errors.emplace_back(std::string(name.text), comment);
+        endOfLine();
     }
 }
 
-inline void Parser::parseNodes(FlowAST& /*ast*/) {
+inline void Parser::parseNodes(FlowAST& ast) {
     advance(); // consume NODES
-    if (currentToken_.type == TokenType::Colon) {
-        advance(); // consume :
-        // For now, skip nodes parsing
-        while (currentToken_.type != TokenType::Flow &&
-               currentToken_.type != TokenType::EOF_Token) {
-            advance();
-        }
+    consume(TokenType::Colon, "Expected ':' after NODES");
+    endOfLine();
+    while (skipNewlines(), !atSectionEnd()) {
+        ast.nodes.push_back(parseNode(ast));
+        endOfLine();
     }
 }
 
-inline void Parser::parseFlow(FlowAST& /*ast*/) {
+inline void Parser::parseFlow(FlowAST& ast) {
     advance(); // consume FLOW
-    if (currentToken_.type == TokenType::Colon) {
-        advance(); // consume :
-        // For now, skip flow parsing
-        while (currentToken_.type != TokenType::EOF_Token) {
+    consume(TokenType::Colon, "Expected ':' after FLOW");
+    endOfLine();
+    while (skipNewlines(), !atSectionEnd()) {
+        ast.connections.push_back(parseConnection());
+        endOfLine();
+    }
+}
+
+inline FlowNodePtr Parser::parseNode(FlowAST& ast) {
+    std::string comment = collectComment();
+    if (!check(TokenType::Number) && !check(TokenType::Identifier)) {
+        error("Expected node ID");
+    }
+    Location location = lexer_.locationOf(currentToken_);
+    std::string id(currentToken_.text);
+    advance();
+
+    FlowNodePtr node;
+    switch (currentToken_.type) {
+        case TokenType::Assign:
+            advance();
+            node = parseAssignNode(ast, id, std::move(location));
+            break;
+        case TokenType::Cond:
+            advance();
+            node = parseCondNode(ast, id, std::move(location));
+            break;
+        case TokenType::Proc:
             advance();
+            node = parseProcNode(ast, id, std::move(location));
+            break;
+        case TokenType::Par:
+            advance();
+            node = ast.makeNode<ParNode>(id, std::move(location));
+            break;
+        case TokenType::Join:
+            advance();
+            node = ast.makeNode<JoinNode>(id, std::move(location));
+            break;
+        default:
+            error("Expected node type (PROC, ASSIGN, COND, PAR or JOIN) for node " + id);
+    }
+    node->comment = std::move(comment);
+    return node;
+}
+
+inline NodePtr<AssignNode> Parser::parseAssignNode(FlowAST& ast, const std::string& id, Location location) {
+    TypeInfo type = parseType();
+    Token variable = consume(TokenType::Identifier, "Expected variable name in ASSIGN");
+    std::string expression = parseExpression("ASSIGN");
+    return ast.makeNode<AssignNode>(id, type, std::string(variable.text), expression, std::move(location));
+}
+
+inline NodePtr<CondNode> Parser::parseCondNode(FlowAST& ast, const std::string& id, Location location) {
+    std::string condition = parseExpression("COND");
+    return ast.makeNode<CondNode>(id, condition, std::move(location));
+}
+
+inline NodePtr<ProcNode> Parser::parseProcNode(FlowAST& ast, const std::string& id, Location location) {
+    if (!check(TokenType::Identifier) && !check(TokenType::Dot)) { // "../shared/log.flow" starts with a dot
+        error("Expected procedure name in PROC");
+    }
+    std::string name(lexer_.readWord(currentToken_));
+    advance();
+
+    auto node = ast.makeNode<ProcNode>(id, name, std::move(location));
+    while (check(TokenType::Identifier)) {
+        Token local = currentToken_;
+        advance();
+        bool isOutput = check(TokenType::OutputBinding);
+        if (!isOutput && !check(TokenType::InputBinding)) {
+            error("Expected '>>' or '<<' after '" + std::string(local.text) + "'");
+        }
+        advance();
+
+        bool literal = check(TokenType::String) || check(TokenType::Number) || check(TokenType::Boolean);
+        if (!check(TokenType::Identifier) && !(literal && !isOutput)) {
+            error("Expected parameter name after '" + std::string(local.text) + (isOutput ? "<<'" : ">>'"));
         }
+        node->addBinding(std::string(local.text), std::string(currentToken_.text), isOutput);
+        advance();
+    }
+    return node;
+}
+
+inline FlowConnection Parser::parseConnection() {
+    auto endpoint = [this](bool isSource, std::string& node, std::string& port) {
+        TokenType terminal = isSource ? TokenType::Start : TokenType::End;
+        if (!check(terminal) && !check(TokenType::Number) && !check(TokenType::Identifier)) {
+            error(isSource ? "Expected source node in connection" : "Expected target node in connection");
+        }
+        node = std::string(currentToken_.text);
+        advance();
+        if (match(TokenType::Dot)) {
+            port = std::string(consume(TokenType::Identifier, "Expected port name after '.'").text);
+        }
+    };
+
+    std::string fromNode, fromPort, toNode, toPort;
+    endpoint(true, fromNode, fromPort);
+    consume(TokenType::Arrow, "Expected '->' in connection");
+    endpoint(false, toNode, toPort);
+    return FlowConnection(fromNode, toNode, fromPort, toPort);
+}
+
+inline Parameter Parser::parseParameter() {
+    std::string comment = collectComment();
+    TypeInfo type = parseType();
+    Token name = consume(TokenType::Identifier, "Expected parameter name");
+    if (match(TokenType::Question)) {
+        type.optional = true;
+    }
+    return Parameter(std::string(name.text), type, comment);
+}
+
+inline TypeInfo Parser::parseType() {
+    if (check(TokenType::Identifier) && currentToken_.text.size() == 1) {
+        switch (currentToken_.text[0]) {
+            // Backward compatibility: "I" and "F" both map to Number
+            case 'N': case 'I': case 'F': advance(); return TypeInfo(ValueType::Number);
+            case 'B': advance(); return TypeInfo(ValueType::Boolean);
+            case 'S': advance(); return TypeInfo(ValueType::String);
+            default: break;
+        }
+    }
+    error("Invalid type: " + std::string(currentToken_.text));
+}
+
+inline std::string Parser::parseExpression(const char* what) {
+    if (check(TokenType::Newline) || check(TokenType::EOF_Token)) {
+        error(std::string("Expected expression in ") + what);
     }
+    std::string expression(lexer_.readRestOfLine(currentToken_));
+    advance();
+    return expression;
 }
 
 inline void Parser::advance() {
-    currentToken_ = lexer_.nextToken();
+    for (;;) {
+        currentToken_ = lexer_.nextToken();
+        if (currentToken_.type == TokenType::LineComment || currentToken_.type == TokenType::BlockComment) {
+            // Only comments on a line of their own describe the next element
+            if (atLineStart_) {
+                if (!hasComment_) {
+                    commentBegin_ = currentToken_.offset;
+                }
+                commentEnd_ = currentToken_.offset + currentToken_.text.size();
+                hasComment_ = true;
+            }
+            continue;
+        }
+        if (currentToken_.type == TokenType::Newline) {
+            if (atLineStart_ && lexer_.peekToken().type == TokenType::Newline) {
+                hasComment_ = false; // a blank line detaches the comment
+            }
+            atLineStart_ = true;
+        } else {
+            atLineStart_ = false;
+        }
+        return;
+    }
 }
 
 inline bool Parser::match(TokenType type) {
@@ -300,113 +495,242 @@ inline bool Parser::check(TokenType type) const {
     return currentToken_.type == type;
 }
 
-inline Token Parser::consume(TokenType type, const std::string& errorMessage) {
+inline Token Parser::consume(TokenType type, const char* errorMessage) {
     if (check(type)) {
         Token token = currentToken_;
         advance();
         return token;
     }
     error(errorMessage);
-    return currentToken_;
+}
+
+inline bool Parser::atSectionEnd() const {
+    switch (currentToken_.type) {
+        case TokenType::EOF_Token:
+            return true;
+        case TokenType::Title:
+        case TokenType::Params:
+        case TokenType::Returns:
+        case TokenType::Errors:
+        case TokenType::Nodes:
+        case TokenType::Flow:
+            return lexer_.peekToken().type == TokenType::Colon;
+        default:
+            return false;
+    }
+}
+
+inline void Parser::skipNewlines() {
+    while (check(TokenType::Newline)) {
+        advance();
+    }
+}
+
+inline void Parser::endOfLine() {
+    if (!check(TokenType::Newline) && !check(TokenType::EOF_Token)) {
+        error("Unexpected '" + std::string(currentToken_.text) + "'");
+    }
+    hasComment_ = false;
+    advance();
 }
 
 inline void Parser::error(const std::string& message) {
-    throw FlowGraphError(FlowGraphError::Type::Parse, message, currentToken_.location);
+    throw FlowGraphError(FlowGraphError::Type::Parse, message, lexer_.locationOf(currentToken_));
 }
 
 inline void Parser::warning(const std::string& /*message*/) {
     // For now, just ignore warnings
 }
 
-inline void Parser::skipComments() {
-    // Implementation for skipping comments
-}
-
 inline std::string Parser::collectComment() {
-    // Implementation for collecting comments
-    return "";
+    if (!hasComment_) {
+        return {};
+    }
+    hasComment_ = false;
+
+    // Strip comment markers line by line: "//", "/*", "*/" and the leading "*" of block lines
+    std::string result;
+    std::string_view block = source_.substr(commentBegin_, commentEnd_ - commentBegin_);
+    while (!block.empty()) {
+        size_t newline = block.find('\n');
+        std::string_view line = block.substr(0, newline);
+        block = newline == std::string_view::npos ? std::string_view() : block.substr(newline + 1);
+
+        auto trim = [](std::string_view text) {
+            size_t begin = text.find_first_not_of(" \t\r");
+            size_t end = text.find_last_not_of(" \t\r");
+            return begin == std::string_view::npos ? std::string_view() : text.substr(begin, end - begin + 1);
+        };
+        line = trim(line);
+        if (line.substr(0, 2) == "//" || line.substr(0, 2) == "/*") {
+            line.remove_prefix(2);
+        }
+        if (line.size() >= 2 && line.substr(line.size() - 2) == "*/") {
+            line.remove_suffix(2);
+        }
+        line = trim(line);
+        if (!line.empty() && line[0] == '*') {
+            line = trim(line.substr(1));
+        }
+        if (!line.empty()) {
+            if (!result.empty()) {
+                result += '\n';
+            }
+            result.append(line.data(), line.size());
+        }
+    }
+    return result;
 }
 
-// Minimal Lexer implementation
-inline Lexer::Lexer(const std::string& content, const std::string& filename) 
-    : content_(content), filename_(filename) {}
+// Lexer implementation
+
+inline Lexer::Lexer(std::string_view source, std::string_view filename)
+    : source_(source), filename_(filename) {
+    lookahead_ = lex();
+}
 
 inline Token Lexer::nextToken() {
-    if (content_.empty()) {
-        return Token(TokenType::EOF_Token, "");
+    Token token = lookahead_;
+    if (token.type != TokenType::EOF_Token) {
+        lookahead_ = lex();
     }
-    
+    return token;
+}
+
+inline Location Lexer::locationOf(const Token& token) const {
+    return Location(std::string(filename_), token.line, token.column);
+}
+
+inline std::string_view Lexer::readRestOfLine(const Token& from) {
+    rewindTo(from);
+    size_t end = position_;
+    size_t scan = position_;
+    char quote = '\0';
+    while (scan < source_.size() && source_[scan] != '\n') {
+        char c = source_[scan];
+        if (quote) {
+            if (c == '\\' && scan + 1 < source_.size() && source_[scan + 1] != '\n') {
+                ++scan;
+            } else if (c == quote) {
+                quote = '\0';
+            }
+        } else if (c == '"') {
+            quote = c;
+        } else if (c == '/' && scan + 1 < source_.size() && (source_[scan + 1] == '/' || source_[scan + 1] == '*')) {
+            break; // trailing comment
+        }
+        ++scan;
+        if (c != ' ' && c != '\t' && c != '\r') {
+            end = scan;
+        }
+    }
+    std::string_view text = source_.substr(position_, end - position_);
+    skipTo(end);
+    lookahead_ = lex();
+    return text;
+}
+
+inline std::string_view Lexer::readWord(const Token& from) {
+    rewindTo(from);
+    size_t end = position_;
+    while (end < source_.size() && !std::isspace(static_cast<unsigned char>(source_[end]))) {
+        if (source_[end] == '/' && end + 1 < source_.size() && (source_[end + 1] == '/' || source_[end + 1] == '*')) {
+            break;
+        }
+        ++end;
+    }
+    std::string_view text = source_.substr(position_, end - position_);
+    skipTo(end);
+    lookahead_ = lex();
+    return text;
+}
+
+inline void Lexer::rewindTo(const Token& token) {
+    position_ = token.offset;
+    line_ = token.line;
+    column_ = token.column;
+}
+
+inline void Lexer::skipTo(size_t position) {
+    // Callers never skip across a newline, so only the column moves
+    column_ += static_cast<uint32_t>(position - position_);
+    position_ = position;
+}
+
+inline Token Lexer::makeToken(TokenType type, size_t start, uint32_t line, uint32_t column,
+                              size_t textBegin, size_t textEnd) const {
+    Token token;
+    token.type = type;
+    token.text = source_.substr(textBegin, textEnd - textBegin);
+    token.offset = start;
+    token.line = line;
+    token.column = column;
+    return token;
+}
+
+inline Token Lexer::lex() {
     skipWhitespace();
-    
+
+    size_t start = position_;
+    uint32_t line = line_;
+    uint32_t column = column_;
+
     if (isAtEnd()) {
-        return Token(TokenType::EOF_Token, "");
+        return makeToken(TokenType::EOF_Token, start, line, column, start, start);
     }
-    
+
     char c = currentChar();
-    
-    // Handle specific patterns
-    if (c == '\n') {
-        advance();
-        return Token(TokenType::Newline, "\n");
-    }
-    
-    if (c == ':') {
-        advance();
-        return Token(TokenType::Colon, ":");
-    }
-    
-    if (c == '"') {
-        return readString();
+    char next = peekChar();
+    auto single = [&](TokenType type, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            advance();
+        }
+        return makeToken(type, start, line, column, start, position_);
+    };
+
+    switch (c) {
+        case '\n': return single(TokenType::Newline, 1);
+        case ':': return single(TokenType::Colon, 1);
+        case '.': return single(TokenType::Dot, 1);
+        case '?': return single(TokenType::Question, 1);
+        case '"': return readString();
+        case '-':
+            if (next == '>') return single(TokenType::Arrow, 2);
+            break;
+        case '>':
+            if (next == '>') return single(TokenType::InputBinding, 2);
+            break;
+        case '<':
+            if (next == '<') return single(TokenType::OutputBinding, 2);
+            break;
+        case '/':
+            if (next == '/') return readLineComment();
+            if (next == '*') return readBlockComment();
+            break;
+        default:
+            break;
     }
-    
-    if (std::isdigit(c)) {
+
+    unsigned char uc = static_cast<unsigned char>(c);
+    if (std::isdigit(uc)) {
         return readNumber();
     }
-    
-    if (std::isalpha(c) || c == '_') {
+    if (std::isalpha(uc) || c == '_' || uc >= 0x80) {
         return readIdentifier();
     }
-    
-    // Skip unknown characters
-    advance();
-    return nextToken();
-}
-
-inline Token Lexer::peekToken() {
-    size_t savePos = position_;
-    size_t saveLine = line_;
-    size_t saveCol = column_;
-    
-    Token token = nextToken();
-    
-    position_ = savePos;
-    line_ = saveLine;
-    column_ = saveCol;
-    
-    return token;
-}
-
-inline bool Lexer::hasMoreTokens() const {
-    return !isAtEnd();
-}
-
-inline Location Lexer::getCurrentLocation() const {
-    return Location(filename_, line_, column_);
-}
 
-inline char Lexer::currentChar() const {
-    if (isAtEnd()) return '\0';
-    return content_[position_];
+    // Anything else is a single-character token the parser rejects where it matters
+    return single(TokenType::Invalid, 1);
 }
 
 inline char Lexer::peekChar(size_t offset) const {
-    if (position_ + offset >= content_.length()) return '\0';
-    return content_[position_ + offset];
+    if (position_ + offset >= source_.size()) return '\0';
+    return source_[position_ + offset];
 }
 
 inline void Lexer::advance() {
     if (!isAtEnd()) {
-        if (content_[position_] == '\n') {
+        if (source_[position_] == '\n') {
             line_++;
             column_ = 1;
         } else {
@@ -417,73 +741,119 @@ inline void Lexer::advance() {
 }
 
 inline void Lexer::skipWhitespace() {
-    while (!isAtEnd() && std::isspace(currentChar()) && currentChar() != '\n') {
+    while (!isAtEnd() && currentChar() != '\n' && std::isspace(static_cast<unsigned char>(currentChar()))) {
         advance();
     }
 }
 
 inline Token Lexer::readString() {
+    size_t start = position_;
+    uint32_t line = line_;
+    uint32_t column = column_;
     advance(); // skip opening quote
-    std::string value;
-    
+
+    size_t textBegin = position_;
     while (!isAtEnd() && currentChar() != '"') {
-        value += currentChar();
+        if (currentChar() == '\n') {
+            error("Unterminated string literal", line, column);
+        }
+        if (currentChar() == '\\' && peekChar() != '\n') {
+            advance();
+        }
         advance();
     }
-    
-    if (!isAtEnd()) {
-        advance(); // skip closing quote
+    if (isAtEnd()) {
+        error("Unterminated string literal", line, column);
     }
-    
-    return Token(TokenType::String, value);
+    size_t textEnd = position_;
+    advance(); // skip closing quote
+
+    return makeToken(TokenType::String, start, line, column, textBegin, textEnd);
 }
 
 inline Token Lexer::readNumber() {
-    std::string value;
-    
-    while (!isAtEnd() && (std::isdigit(currentChar()) || currentChar() == '.')) {
-        value += currentChar();
+    size_t start = position_;
+    uint32_t line = line_;
+    uint32_t column = column_;
+
+    while (std::isdigit(static_cast<unsigned char>(currentChar()))) {
+        advance();
+    }
+    // A '.' only continues the number when a digit follows, so "10.Y" is node 10, port Y
+    if (currentChar() == '.' && std::isdigit(static_cast<unsigned char>(peekChar()))) {
         advance();
+        while (std::isdigit(static_cast<unsigned char>(currentChar()))) {
+            advance();
+        }
     }
-    
-    return Token(TokenType::Number, value);
+
+    return makeToken(TokenType::Number, start, line, column, start, position_);
 }
 
 inline Token Lexer::readIdentifier() {
-    std::string value;
-    
-    while (!isAtEnd() && (std::isalnum(currentChar()) || currentChar() == '_')) {
-        value += currentChar();
+    size_t start = position_;
+    uint32_t line = line_;
+    uint32_t column = column_;
+
+    while (!isAtEnd()) {
+        unsigned char c = static_cast<unsigned char>(currentChar());
+        if (!std::isalnum(c) && c != '_' && c < 0x80) {
+            break;
+        }
         advance();
     }
-    
+
+    std::string_view value = source_.substr(start, position_ - start);
+    TokenType type = TokenType::Identifier;
+
     // Check for keywords
-    if (value == "TITLE") return Token(TokenType::Title, value);
-    if (value == "PARAMS") return Token(TokenType::Params, value);
-    if (value == "RETURNS") return Token(TokenType::Returns, value);
-    if (value == "ERRORS") return Token(TokenType::Errors, value);
-    if (value == "NODES") return Token(TokenType::Nodes, value);
-    if (value == "FLOW") return Token(TokenType::Flow, value);
-    if (value == "START") return Token(TokenType::Start, value);
-    if (value == "END") return Token(TokenType::End, value);
-    if (value == "PROC") return Token(TokenType::Proc, value);
-    if (value == "ASSIGN") return Token(TokenType::Assign, value);
-    if (value == "COND") return Token(TokenType::Cond, value);
-    if (value == "true" || value == "false") return Token(TokenType::Boolean, value);
-    
-    return Token(TokenType::Identifier, value);
+    if (value == "TITLE") type = TokenType::Title;
+    else if (value == "PARAMS") type = TokenType::Params;
+    else if (value == "RETURNS") type = TokenType::Returns;
+    else if (value == "ERRORS") type = TokenType::Errors;
+    else if (value == "NODES") type = TokenType::Nodes;
+    else if (value == "FLOW") type = TokenType::Flow;
+    else if (value == "START") type = TokenType::Start;
+    else if (value == "END") type = TokenType::End;
+    else if (value == "PROC") type = TokenType::Proc;
+    else if (value == "ASSIGN") type = TokenType::Assign;
+    else if (value == "COND") type = TokenType::Cond;
+    else if (value == "PAR") type = TokenType::Par;
+    else if (value == "JOIN") type = TokenType::Join;
+    else if (value == "true" || value == "false") type = TokenType::Boolean;
+
+    return makeToken(type, start, line, column, start, position_);
 }
 
 inline Token Lexer::readLineComment() {
-    return Token(TokenType::LineComment, "");
+    size_t start = position_;
+    uint32_t line = line_;
+    uint32_t column = column_;
+    while (!isAtEnd() && currentChar() != '\n') {
+        advance();
+    }
+    return makeToken(TokenType::LineComment, start, line, column, start, position_);
 }
 
 inline Token Lexer::readBlockComment() {
-    return Token(TokenType::BlockComment, "");
+    size_t start = position_;
+    uint32_t line = line_;
+    uint32_t column = column_;
+    advance();
+    advance(); // skip "/*"
+    while (!(currentChar() == '*' && peekChar() == '/')) {
+        if (isAtEnd()) {
+            error("Unterminated block comment", line, column);
+        }
+        advance();
+    }
+    advance();
+    advance(); // skip "*/"
+    return makeToken(TokenType::BlockComment, start, line, column, start, position_);
 }
 
-inline bool Lexer::isAtEnd() const {
-    return position_ >= content_.length();
+inline void Lexer::error(const char* message, uint32_t line, uint32_t column) const {
+    throw FlowGraphError(FlowGraphError::Type::Parse, message, Location(std::string(filename_), line, column));
 }
 
-} // namespace FlowGraph
\ No newline at end of file
+} // namespace FlowGraph
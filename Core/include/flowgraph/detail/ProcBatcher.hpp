@@ -0,0 +1,160 @@
+#pragma once
+
+#include "Types.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace FlowGraph {
+
+/**
+ * @brief Coalesces calls of a batched procedure made by concurrent executions
+ *
+ * A call is queued and its execution suspends like on any async PROC. The
+ * first call of a batch opens a window; when it closes, or as soon as
+ * maxBatchSize calls are queued, a flusher thread passes all queued
+ * parameter sets to the implementation in one call and completes every
+ * waiting ProcCompletionCallback with its result. With a zero window each
+ * call runs right away on the calling thread as a batch of one.
+ *
+ * The flusher thread is started by the first queued call. Stopping or
+ * destroying the batcher runs the calls still queued, so no execution is
+ * left waiting.
+ */
+class ProcBatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ProcBatcher(BatchProcedure implementation, size_t maxBatchSize, std::chrono::microseconds window)
+        : implementation_(std::move(implementation)), maxBatchSize_(std::max<size_t>(1, maxBatchSize)),
+          window_(window) {}
+
+    ~ProcBatcher();
+
+    ProcBatcher(const ProcBatcher&) = delete;
+    ProcBatcher& operator=(const ProcBatcher&) = delete;
+
+    /**
+     * @brief Queue a call; callback is completed when its batch has run
+     */
+    void call(const ParameterMap& params, ProcCompletionCallback& callback);
+
+    /**
+     * @brief Run the queued calls and join the flusher thread
+     *
+     * Calls made afterwards run right away on the calling thread, as with a
+     * zero window.
+     */
+    void stop();
+
+private:
+    BatchProcedure implementation_;
+    size_t maxBatchSize_;
+    std::chrono::microseconds window_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<ParameterMap> params_;                 // queued calls
+    std::vector<ProcCompletionCallback*> callbacks_;
+    Clock::time_point deadline_;                       // window of the oldest queued call
+    bool stopping_ = false;
+    std::thread thread_;
+
+    void flushLoop();
+    void dispatch(std::vector<ParameterMap>& params, std::vector<ProcCompletionCallback*>& callbacks) const;
+};
+
+// Implementation (header-only)
+
+inline ProcBatcher::~ProcBatcher() {
+    stop();
+}
+
+inline void ProcBatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+inline void ProcBatcher::call(const ParameterMap& params, ProcCompletionCallback& callback) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (window_.count() == 0 || stopping_) {
+        lock.unlock();
+        std::vector<ParameterMap> batch{params};
+        std::vector<ProcCompletionCallback*> callbacks{&callback};
+        dispatch(batch, callbacks);
+        return;
+    }
+
+    if (params_.empty()) {
+        deadline_ = Clock::now() + window_;
+    }
+    params_.push_back(params);
+    callbacks_.push_back(&callback);
+    if (!thread_.joinable()) {
+        thread_ = std::thread([this]() { flushLoop(); });
+    }
+    bool wake = params_.size() == 1 || params_.size() >= maxBatchSize_;
+    lock.unlock();
+    if (wake) {
+        wake_.notify_one();
+    }
+}
+
+inline void ProcBatcher::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this]() { return stopping_ || !params_.empty(); });
+        if (params_.empty()) {
+            return; // stopping
+        }
+        wake_.wait_until(lock, deadline_, [this]() { return stopping_ || params_.size() >= maxBatchSize_; });
+
+        std::vector<ParameterMap> batch;
+        std::vector<ProcCompletionCallback*> callbacks;
+        if (params_.size() <= maxBatchSize_) {
+            batch.swap(params_);
+            callbacks.swap(callbacks_);
+        } else {
+            // Calls beyond a full batch have waited as long as the first: they go next, without a new window
+            batch.assign(std::make_move_iterator(params_.begin()),
+                         std::make_move_iterator(params_.begin() + static_cast<std::ptrdiff_t>(maxBatchSize_)));
+            callbacks.assign(callbacks_.begin(), callbacks_.begin() + static_cast<std::ptrdiff_t>(maxBatchSize_));
+            params_.erase(params_.begin(), params_.begin() + static_cast<std::ptrdiff_t>(maxBatchSize_));
+            callbacks_.erase(callbacks_.begin(), callbacks_.begin() + static_cast<std::ptrdiff_t>(maxBatchSize_));
+        }
+        lock.unlock();
+        dispatch(batch, callbacks);
+        lock.lock();
+    }
+}
+
+inline void ProcBatcher::dispatch(std::vector<ParameterMap>& params, std::vector<ProcCompletionCallback*>& callbacks) const {
+    std::vector<ProcResult> results;
+    try {
+        results = implementation_(params);
+        if (results.size() != params.size()) {
+            results.assign(params.size(), ProcResult::completedError(
+                "Batched procedure returned " + std::to_string(results.size()) + " results for " +
+                std::to_string(params.size()) + " calls"));
+        }
+    } catch (const std::exception& e) {
+        results.assign(params.size(), ProcResult::completedError(e.what()));
+    }
+    for (size_t i = 0; i < callbacks.size(); ++i) {
+        (*callbacks[i])(results[i]);
+    }
+}
+
+} // namespace FlowGraph
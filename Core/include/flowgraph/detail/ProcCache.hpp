@@ -0,0 +1,228 @@
+#pragma once
+
+#include "Types.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace FlowGraph {
+
+/**
+ * @brief Results of a pure PROC keyed by its bound input values
+ *
+ * Entries are spread over independently locked shards by key, so executions
+ * on different threads rarely contend; each shard evicts its least recently
+ * used entry when full. A key is the hash of the input values in binding
+ * order, and the values themselves are kept to rule out hash collisions.
+ * Cached return values are shared and never modified, so a hit hands them
+ * out without copying the map.
+ *
+ * Only registered procedures are cached, not sub-flow calls. Whether a
+ * module is pure depends on every PROC it reaches, and those can be
+ * re-registered or relinked while flows run, so the engine cannot vouch for
+ * a cached sub-flow result. Pure PROCs called inside a sub-flow still hit
+ * their own caches.
+ */
+class ProcResultCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param capacity Total number of entries, split evenly over the shards
+     * @param ttl How long an entry stays valid, zero for until evicted
+     */
+    explicit ProcResultCache(size_t capacity, std::chrono::milliseconds ttl = std::chrono::milliseconds(0),
+                             size_t shardCount = 16);
+
+    ProcResultCache(const ProcResultCache&) = delete;
+    ProcResultCache& operator=(const ProcResultCache&) = delete;
+
+    /**
+     * @brief Hash of input values, in binding order
+     */
+    static uint64_t hash(const std::vector<Value*>& inputs) noexcept;
+
+    /**
+     * @brief Cached return values for the inputs, or nullptr on a miss or expired entry
+     */
+    std::shared_ptr<const ParameterMap> find(uint64_t key, const std::vector<Value*>& inputs);
+
+    /**
+     * @brief Cache return values, replacing an entry with the same key
+     */
+    void insert(uint64_t key, const std::vector<Value*>& inputs, ParameterMap values);
+
+    void clear();
+    size_t size() const;
+
+    /**
+     * @brief Lookups answered from the cache / lookups that found nothing usable
+     */
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    struct Entry {
+        uint64_t key;
+        std::vector<Value> inputs;
+        std::shared_ptr<const ParameterMap> values;
+        Clock::time_point expires;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries;   // most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> byKey;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    size_t shardCapacity_;
+    std::chrono::milliseconds ttl_;
+    std::vector<Shard> shards_;
+
+    Shard& shardOf(uint64_t key) { return shards_[(key >> 32) % shards_.size()]; }
+    static bool sameInputs(const std::vector<Value>& cached, const std::vector<Value*>& inputs);
+};
+
+// Implementation (header-only)
+
+inline ProcResultCache::ProcResultCache(size_t capacity, std::chrono::milliseconds ttl, size_t shardCount)
+    : ttl_(ttl), shards_(std::max<size_t>(1, std::min(shardCount, capacity))) {
+    shardCapacity_ = std::max<size_t>(1, (capacity + shards_.size() - 1) / shards_.size());
+}
+
+inline uint64_t ProcResultCache::hash(const std::vector<Value*>& inputs) noexcept {
+    // FNV-1a over a type tag and the payload of every value
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const Value* value : inputs) {
+        unsigned char tag;
+        if (value->isNumber()) {
+            tag = 1;
+            double number = value->asNumber();
+            if (number == 0) {
+                number = 0; // -0 and 0 compare equal
+            }
+            uint64_t bits;
+            std::memcpy(&bits, &number, sizeof(bits));
+            mix(&tag, 1);
+            mix(&bits, sizeof(bits));
+        } else if (value->isBoolean()) {
+            tag = value->asBoolean() ? 3 : 2;
+            mix(&tag, 1);
+        } else {
+            tag = 4;
+            const std::string& text = value->asString();
+            uint64_t size = text.size();
+            mix(&tag, 1);
+            mix(&size, sizeof(size));
+            mix(text.data(), text.size());
+        }
+    }
+    return hash;
+}
+
+inline bool ProcResultCache::sameInputs(const std::vector<Value>& cached, const std::vector<Value*>& inputs) {
+    if (cached.size() != inputs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < cached.size(); ++i) {
+        if (!sameValue(cached[i], *inputs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline std::shared_ptr<const ParameterMap> ProcResultCache::find(uint64_t key, const std::vector<Value*>& inputs) {
+    Shard& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.byKey.find(key);
+    if (it == shard.byKey.end() || !sameInputs(it->second->inputs, inputs)) {
+        ++shard.misses;
+        return nullptr;
+    }
+    if (ttl_.count() > 0 && Clock::now() >= it->second->expires) {
+        shard.entries.erase(it->second);
+        shard.byKey.erase(it);
+        ++shard.misses;
+        return nullptr;
+    }
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    ++shard.hits;
+    return it->second->values;
+}
+
+inline void ProcResultCache::insert(uint64_t key, const std::vector<Value*>& inputs, ParameterMap values) {
+    Entry entry{key, {}, std::make_shared<const ParameterMap>(std::move(values)), {}};
+    entry.inputs.reserve(inputs.size());
+    for (const Value* value : inputs) {
+        entry.inputs.push_back(*value);
+    }
+    if (ttl_.count() > 0) {
+        entry.expires = Clock::now() + ttl_;
+    }
+
+    Shard& shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.byKey.find(key);
+    if (it != shard.byKey.end()) {
+        shard.entries.erase(it->second);
+        shard.byKey.erase(it);
+    } else if (shard.entries.size() >= shardCapacity_) {
+        shard.byKey.erase(shard.entries.back().key);
+        shard.entries.pop_back();
+    }
+    shard.entries.push_front(std::move(entry));
+    shard.byKey.emplace(key, shard.entries.begin());
+}
+
+inline void ProcResultCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+        shard.byKey.clear();
+    }
+}
+
+inline size_t ProcResultCache::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.entries.size();
+    }
+    return total;
+}
+
+inline uint64_t ProcResultCache::hits() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.hits;
+    }
+    return total;
+}
+
+inline uint64_t ProcResultCache::misses() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.misses;
+    }
+    return total;
+}
+
+} // namespace FlowGraph
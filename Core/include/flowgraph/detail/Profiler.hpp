@@ -0,0 +1,567 @@
+#pragma once
+
+#include "CompiledFlow.hpp"
+#include "Types.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace FlowGraph {
+
+class ExecutionContext;
+
+/**
+ * @brief Flat copy of everything a Profiler recorded
+ */
+struct ProfileStats {
+    /**
+     * @brief Number of async latency buckets; bucket 0 holds latencies below 1 us,
+     *        bucket i latencies below 2^i us, the last one everything above
+     */
+    static constexpr size_t LatencyBuckets = 32;
+
+    struct Node {
+        std::string flow;          // flow title
+        std::string node;          // node ID
+        NodeKind kind = NodeKind::Assign;
+        std::string procedure;     // PROC nodes only
+        uint64_t visits = 0;
+        uint64_t totalNanos = 0;   // for PROC nodes the call, up to suspension for async PROCs
+    };
+
+    struct Procedure {
+        std::string name;
+        uint64_t calls = 0;
+        uint64_t totalNanos = 0;
+        uint64_t asyncCalls = 0;          // calls that suspended the execution
+        uint64_t asyncTotalNanos = 0;     // dispatch to ProcCompletionCallback resolution
+        std::array<uint64_t, LatencyBuckets> asyncLatency{};
+        uint64_t cacheHits = 0;           // calls of a pure PROC answered from its result cache
+        uint64_t cacheMisses = 0;         // calls of a pure PROC that ran the implementation
+
+        /**
+         * @brief Upper bound (exclusive, in microseconds) of async latencies below the given fraction
+         * @param fraction E.g. 0.99 for the 99th percentile
+         */
+        uint64_t asyncLatencyPercentileMicros(double fraction) const;
+    };
+
+    std::vector<Node> nodes;              // by total time, most expensive first
+    std::vector<Procedure> procedures;    // by total time, most expensive first
+    uint64_t traceEvents = 0;
+    uint64_t droppedTraceEvents = 0;      // beyond Profiler::Options::maxTraceEvents
+
+    static size_t latencyBucket(uint64_t nanos);
+};
+
+namespace detail {
+
+/**
+ * @brief Append-only list with one writer and lock-free concurrent readers
+ *
+ * Items are published in chunks of fixed size, so their addresses are stable
+ * and readers never see a partially initialized item.
+ */
+template<typename T, size_t ChunkSize = 64>
+class AppendOnlyList {
+public:
+    AppendOnlyList() = default;
+    AppendOnlyList(const AppendOnlyList&) = delete;
+    AppendOnlyList& operator=(const AppendOnlyList&) = delete;
+
+    ~AppendOnlyList() {
+        Chunk* chunk = head_.load(std::memory_order_relaxed);
+        while (chunk) {
+            Chunk* next = chunk->next.load(std::memory_order_relaxed);
+            delete chunk;
+            chunk = next;
+        }
+    }
+
+    /**
+     * @brief Append an item, initialized by init(item) before it becomes visible (writer only)
+     */
+    template<typename Init>
+    T& append(Init&& init) {
+        if (!tail_ || tail_->count.load(std::memory_order_relaxed) == ChunkSize) {
+            auto* chunk = new Chunk();
+            if (tail_) {
+                tail_->next.store(chunk, std::memory_order_release);
+            } else {
+                head_.store(chunk, std::memory_order_release);
+            }
+            tail_ = chunk;
+        }
+        size_t index = tail_->count.load(std::memory_order_relaxed);
+        T& item = tail_->items[index];
+        init(item);
+        tail_->count.store(index + 1, std::memory_order_release);
+        return item;
+    }
+
+    template<typename Visitor>
+    void forEach(Visitor&& visit) const {
+        for (Chunk* chunk = head_.load(std::memory_order_acquire); chunk;
+             chunk = chunk->next.load(std::memory_order_acquire)) {
+            size_t count = chunk->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; ++i) {
+                visit(chunk->items[i]);
+            }
+        }
+    }
+
+private:
+    struct Chunk {
+        std::array<T, ChunkSize> items;
+        std::atomic<size_t> count{0};
+        std::atomic<Chunk*> next{nullptr};
+    };
+
+    std::atomic<Chunk*> head_{nullptr};
+    Chunk* tail_ = nullptr;
+};
+
+/**
+ * @brief Counters of one node on one thread; only the owning thread writes them
+ */
+struct ProfileNodeEntry {
+    std::string flow;
+    std::string node;
+    std::string procedure;
+    NodeKind kind = NodeKind::Assign;
+    std::atomic<uint64_t> visits{0};
+    std::atomic<uint64_t> nanos{0};
+    std::atomic<uint64_t> asyncCalls{0};
+    std::atomic<uint64_t> asyncNanos{0};
+    std::array<std::atomic<uint64_t>, ProfileStats::LatencyBuckets> latency{};
+    std::atomic<uint64_t> cacheHits{0};
+    std::atomic<uint64_t> cacheMisses{0};
+
+    // Single writer: plain load and store, no read-modify-write needed
+    static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+struct ProfileTraceEvent {
+    const ProfileNodeEntry* entry = nullptr;
+    int64_t start = 0;        // nanoseconds since the profiler was created
+    int64_t duration = 0;
+    bool async = false;       // dispatch to resolution of an async PROC
+};
+
+/**
+ * @brief Storage of one thread, written without locks by that thread
+ */
+class ProfileThread {
+public:
+    ProfileThread(std::thread::id thread, uint32_t index) : thread_(thread), index_(index) {}
+
+    std::thread::id thread() const { return thread_; }
+    uint32_t index() const { return index_; }
+
+    ProfileNodeEntry& entry(const CompiledFlow& program, const CompiledNode& node) {
+        // Keyed by node address: nodes of a compiled program never move
+        auto it = entryByNode_.find(&node);
+        if (it != entryByNode_.end()) {
+            return *it->second;
+        }
+        ProfileNodeEntry& entry = nodes_.append([&](ProfileNodeEntry& item) {
+            item.flow = program.ast().title;
+            item.node = node.source->id;
+            item.kind = node.kind;
+            if (node.kind == NodeKind::Proc) {
+                item.procedure = node.asProc().procedureName;
+            }
+        });
+        entryByNode_.emplace(&node, &entry);
+        return entry;
+    }
+
+    void trace(const ProfileNodeEntry& entry, int64_t start, int64_t duration, bool async, size_t limit) {
+        if (events_.load(std::memory_order_relaxed) >= limit) {
+            ProfileNodeEntry::add(dropped_, 1);
+            return;
+        }
+        trace_.append([&](ProfileTraceEvent& event) { event = {&entry, start, duration, async}; });
+        events_.store(events_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    const AppendOnlyList<ProfileNodeEntry>& nodes() const { return nodes_; }
+    const AppendOnlyList<ProfileTraceEvent, 1024>& events() const { return trace_; }
+    uint64_t eventCount() const { return events_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    ProfileThread* next = nullptr;   // list of all threads of a profiler
+
+private:
+    std::thread::id thread_;
+    uint32_t index_;
+    AppendOnlyList<ProfileNodeEntry> nodes_;
+    AppendOnlyList<ProfileTraceEvent, 1024> trace_;
+    std::atomic<uint64_t> events_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::unordered_map<const CompiledNode*, ProfileNodeEntry*> entryByNode_;   // owner only
+};
+
+} // namespace detail
+
+/**
+ * @brief Opt-in execution profiler
+ *
+ * Attach it with Engine::setProfiler() or Flow::setProfiler(). Profiled
+ * executions run through a separate instantiation of the executor that times
+ * every node (fused blocks are run node by node) and, through the completion
+ * callback, measures async PROCs from dispatch to resolution. Unprofiled
+ * executions are unaffected.
+ *
+ * Each thread records into its own storage without locks or shared writes;
+ * snapshot() and the exporters may run concurrently with recording. With
+ * Options::trace every node visit is also kept as a trace event, up to
+ * maxTraceEvents per thread. Profiled flows must outlive the profiler's use.
+ */
+class Profiler {
+public:
+    struct Options {
+        bool trace = false;                  // keep individual node visits for the Chrome trace
+        size_t maxTraceEvents = 1 << 20;     // per thread
+    };
+
+    Profiler() : Profiler(Options()) {}
+    explicit Profiler(Options options);
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    /**
+     * @brief Aggregate the counters of all threads
+     */
+    ProfileStats snapshot() const;
+
+    /**
+     * @brief Write the trace events in Chrome trace format (chrome://tracing, Perfetto)
+     *
+     * The aggregated statistics are included under "flowgraphStats".
+     */
+    void writeChromeTrace(std::ostream& out) const;
+
+    /**
+     * @throws FlowGraphError (IO) if the file cannot be written
+     */
+    void saveChromeTrace(const std::string& filepath) const;
+
+    const Options& options() const { return options_; }
+
+    /**
+     * @brief Storage of the calling thread, created on first use
+     */
+    detail::ProfileThread& thread();
+
+    /**
+     * @brief Nanoseconds since the profiler was created
+     */
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch_).count();
+    }
+
+    int64_t toTime(std::chrono::steady_clock::time_point time) const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch_).count();
+    }
+
+private:
+    Options options_;
+    uint64_t id_;
+    std::chrono::steady_clock::time_point epoch_;
+    std::atomic<detail::ProfileThread*> threads_{nullptr};
+    std::atomic<uint32_t> threadCount_{0};
+
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+};
+
+/**
+ * @brief Executor hooks of profiled executions (see Flow and NoDebugHooks)
+ */
+class ProfilingHooks {
+public:
+    static constexpr bool enabled = true;
+
+    explicit ProfilingHooks(Profiler& profiler) : profiler_(profiler), thread_(profiler.thread()) {}
+
+    bool beforeNode(const CompiledFlow&, const CompiledNode&, ExecutionContext&, CompiledTarget) {
+        start_ = profiler_.now();
+        return false;
+    }
+
+    void afterNode(const CompiledFlow& program, const CompiledNode& node) {
+        int64_t end = profiler_.now();
+        auto& entry = thread_.entry(program, node);
+        detail::ProfileNodeEntry::add(entry.visits, 1);
+        detail::ProfileNodeEntry::add(entry.nanos, static_cast<uint64_t>(end - start_));
+        if (profiler_.options().trace) {
+            thread_.trace(entry, start_, end - start_, false, profiler_.options().maxTraceEvents);
+        }
+    }
+
+    void procResumed(const CompiledFlow& program, const CompiledNode& node, const ProcCompletionCallback& callback) {
+        if (!callback.IsTimed()) {
+            return; // started without profiling
+        }
+        int64_t start = profiler_.toTime(callback.DispatchedAt());
+        int64_t latency = std::max<int64_t>(0, profiler_.toTime(callback.ResolvedAt()) - start);
+        auto& entry = thread_.entry(program, node);
+        detail::ProfileNodeEntry::add(entry.asyncCalls, 1);
+        detail::ProfileNodeEntry::add(entry.asyncNanos, static_cast<uint64_t>(latency));
+        detail::ProfileNodeEntry::add(entry.latency[ProfileStats::latencyBucket(static_cast<uint64_t>(latency))], 1);
+        if (profiler_.options().trace) {
+            thread_.trace(entry, start, latency, true, profiler_.options().maxTraceEvents);
+        }
+    }
+
+    void procCacheLookup(const CompiledFlow& program, const CompiledNode& node, bool hit) {
+        auto& entry = thread_.entry(program, node);
+        detail::ProfileNodeEntry::add(hit ? entry.cacheHits : entry.cacheMisses, 1);
+    }
+
+private:
+    Profiler& profiler_;
+    detail::ProfileThread& thread_;
+    int64_t start_ = 0;
+};
+
+// Implementation (header-only)
+
+inline size_t ProfileStats::latencyBucket(uint64_t nanos) {
+    uint64_t micros = nanos / 1000;
+    size_t bucket = 0;
+    while (micros && bucket + 1 < LatencyBuckets) {
+        micros >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+inline uint64_t ProfileStats::Procedure::asyncLatencyPercentileMicros(double fraction) const {
+    uint64_t total = 0;
+    for (uint64_t count : asyncLatency) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LatencyBuckets; ++i) {
+        seen += asyncLatency[i];
+        if (static_cast<double>(seen) >= fraction * static_cast<double>(total)) {
+            return uint64_t(1) << i;
+        }
+    }
+    return uint64_t(1) << (LatencyBuckets - 1);
+}
+
+inline Profiler::Profiler(Options options)
+    : options_(options), id_(nextId()), epoch_(std::chrono::steady_clock::now()) {}
+
+inline Profiler::~Profiler() {
+    detail::ProfileThread* thread = threads_.load(std::memory_order_acquire);
+    while (thread) {
+        detail::ProfileThread* next = thread->next;
+        delete thread;
+        thread = next;
+    }
+}
+
+inline detail::ProfileThread& Profiler::thread() {
+    // Profiler IDs are never reused, so a stale cache entry cannot match
+    struct Cache {
+        uint64_t profiler = 0;
+        detail::ProfileThread* thread = nullptr;
+    };
+    thread_local Cache cache;
+    if (cache.profiler == id_) {
+        return *cache.thread;
+    }
+
+    std::thread::id self = std::this_thread::get_id();
+    detail::ProfileThread* head = threads_.load(std::memory_order_acquire);
+    for (detail::ProfileThread* thread = head; thread; thread = thread->next) {
+        if (thread->thread() == self) {
+            cache = {id_, thread};
+            return *thread;
+        }
+    }
+    auto* thread = new detail::ProfileThread(self, threadCount_.fetch_add(1, std::memory_order_relaxed));
+    thread->next = head;
+    while (!threads_.compare_exchange_weak(thread->next, thread, std::memory_order_release, std::memory_order_acquire)) {
+    }
+    cache = {id_, thread};
+    return *thread;
+}
+
+inline ProfileStats Profiler::snapshot() const {
+    ProfileStats stats;
+    std::map<std::tuple<std::string, std::string>, size_t> nodeIndex;
+    std::map<std::string, size_t> procedureIndex;
+
+    for (auto* thread = threads_.load(std::memory_order_acquire); thread; thread = thread->next) {
+        thread->nodes().forEach([&](const detail::ProfileNodeEntry& entry) {
+            auto key = std::make_tuple(entry.flow, entry.node);
+            auto it = nodeIndex.find(key);
+            if (it == nodeIndex.end()) {
+                it = nodeIndex.emplace(key, stats.nodes.size()).first;
+                ProfileStats::Node node;
+                node.flow = entry.flow;
+                node.node = entry.node;
+                node.kind = entry.kind;
+                node.procedure = entry.procedure;
+                stats.nodes.push_back(std::move(node));
+            }
+            ProfileStats::Node& node = stats.nodes[it->second];
+            uint64_t visits = entry.visits.load(std::memory_order_relaxed);
+            uint64_t nanos = entry.nanos.load(std::memory_order_relaxed);
+            node.visits += visits;
+            node.totalNanos += nanos;
+
+            if (entry.kind != NodeKind::Proc) {
+                return;
+            }
+            auto procedure = procedureIndex.find(entry.procedure);
+            if (procedure == procedureIndex.end()) {
+                procedure = procedureIndex.emplace(entry.procedure, stats.procedures.size()).first;
+                stats.procedures.emplace_back();
+                stats.procedures.back().name = entry.procedure;
+            }
+            ProfileStats::Procedure& proc = stats.procedures[procedure->second];
+            proc.calls += visits;
+            proc.totalNanos += nanos;
+            proc.asyncCalls += entry.asyncCalls.load(std::memory_order_relaxed);
+            proc.asyncTotalNanos += entry.asyncNanos.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < ProfileStats::LatencyBuckets; ++i) {
+                proc.asyncLatency[i] += entry.latency[i].load(std::memory_order_relaxed);
+            }
+            proc.cacheHits += entry.cacheHits.load(std::memory_order_relaxed);
+            proc.cacheMisses += entry.cacheMisses.load(std::memory_order_relaxed);
+        });
+        stats.traceEvents += thread->eventCount();
+        stats.droppedTraceEvents += thread->dropped();
+    }
+
+    std::stable_sort(stats.nodes.begin(), stats.nodes.end(),
+                     [](const auto& a, const auto& b) { return a.totalNanos > b.totalNanos; });
+    std::stable_sort(stats.procedures.begin(), stats.procedures.end(),
+                     [](const auto& a, const auto& b) { return a.totalNanos > b.totalNanos; });
+    return stats;
+}
+
+namespace detail {
+
+inline void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    static const char* hex = "0123456789abcdef";
+                    out << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+inline const char* nodeKindName(NodeKind kind) {
+    switch (kind) {
+        case NodeKind::Assign: return "ASSIGN";
+        case NodeKind::Cond: return "COND";
+        case NodeKind::Par: return "PAR";
+        case NodeKind::Join: return "JOIN";
+        default: return "PROC";
+    }
+}
+
+} // namespace detail
+
+inline void Profiler::writeChromeTrace(std::ostream& out) const {
+    // Chrome trace timestamps are microseconds
+    auto micros = [](int64_t nanos) { return static_cast<double>(nanos) / 1000.0; };
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (auto* thread = threads_.load(std::memory_order_acquire); thread; thread = thread->next) {
+        thread->events().forEach([&](const detail::ProfileTraceEvent& event) {
+            const auto& entry = *event.entry;
+            out << (first ? "" : ",") << "\n{\"name\":";
+            first = false;
+            if (event.async) {
+                detail::writeJsonString(out, entry.procedure + " (async)");
+            } else {
+                detail::writeJsonString(out, entry.node + " " + detail::nodeKindName(entry.kind) +
+                                             (entry.procedure.empty() ? "" : " " + entry.procedure));
+            }
+            out << ",\"cat\":";
+            detail::writeJsonString(out, entry.flow);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->index() << ",\"ts\":" << micros(event.start)
+                << ",\"dur\":" << micros(event.duration) << "}";
+        });
+    }
+
+    ProfileStats stats = snapshot();
+    out << "\n],\"flowgraphStats\":{\"nodes\":[";
+    for (size_t i = 0; i < stats.nodes.size(); ++i) {
+        const auto& node = stats.nodes[i];
+        out << (i ? "," : "") << "\n{\"flow\":";
+        detail::writeJsonString(out, node.flow);
+        out << ",\"node\":";
+        detail::writeJsonString(out, node.node);
+        out << ",\"kind\":\"" << detail::nodeKindName(node.kind) << "\",\"visits\":" << node.visits
+            << ",\"totalNanos\":" << node.totalNanos << "}";
+    }
+    out << "\n],\"procedures\":[";
+    for (size_t i = 0; i < stats.procedures.size(); ++i) {
+        const auto& proc = stats.procedures[i];
+        out << (i ? "," : "") << "\n{\"name\":";
+        detail::writeJsonString(out, proc.name);
+        out << ",\"calls\":" << proc.calls << ",\"totalNanos\":" << proc.totalNanos
+            << ",\"asyncCalls\":" << proc.asyncCalls << ",\"asyncTotalNanos\":" << proc.asyncTotalNanos
+            << ",\"cacheHits\":" << proc.cacheHits << ",\"cacheMisses\":" << proc.cacheMisses
+            << ",\"asyncLatencyMicros\":[";
+        for (size_t b = 0; b < ProfileStats::LatencyBuckets; ++b) {
+            out << (b ? "," : "") << proc.asyncLatency[b];
+        }
+        out << "]}";
+    }
+    out << "\n],\"recordedEvents\":" << stats.traceEvents << ",\"droppedTraceEvents\":" << stats.droppedTraceEvents
+        << "}}\n";
+}
+
+inline void Profiler::saveChromeTrace(const std::string& filepath) const {
+    std::ofstream out(filepath);
+    if (!out) {
+        throw FlowGraphError(FlowGraphError::Type::IO, "Cannot write file: " + filepath);
+    }
+    writeChromeTrace(out);
+    if (!out) {
+        throw FlowGraphError(FlowGraphError::Type::IO, "Cannot write file: " + filepath);
+    }
+}
+
+} // namespace FlowGraph
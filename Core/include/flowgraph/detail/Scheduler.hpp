@@ -0,0 +1,255 @@
+#pragma once
+
+#include "Engine.hpp"
+#include "CompletionQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace FlowGraph {
+
+/**
+ * @brief Cooperative scheduler for flow executions that suspend on async PROCs
+ *
+ * Executions submitted to the scheduler run on the executor thread (the thread
+ * calling submit(), poll() and run()) until they finish or hit a PROC that does
+ * not complete synchronously. A suspended execution costs only its
+ * ExecutionContext, holding just the variables still live after the PROC (see
+ * ExecutionContext::setReleaseDeadValues()); when the PROC's completion
+ * callback fires - from any thread - the execution is pushed onto a lock-free
+ * completion queue and resumed at the node after the PROC on the next poll().
+ * Thousands of in-flight executions can thus share one thread.
+ *
+ * With a time slice (setTimeSlice()) executions run at most that many nodes
+ * before the next ready execution gets its turn, so flows that loop for a
+ * long time neither block the executor nor starve each other. runFrame()
+ * then shares a per-frame time budget round-robin over the ready
+ * executions; those not finished when it is used up continue next frame.
+ *
+ * submit(), poll(), run(), runFrame() and inFlight() must be called from the
+ * executor thread only. PROC completions may arrive from any thread; they take
+ * a lock only to wake an executor blocked in run(). The scheduler must not be
+ * destroyed while executions are in flight.
+ */
+class FlowScheduler {
+public:
+    using TaskId = uint64_t;
+    using CompletionHandler = std::function<void(TaskId, const ExecutionResult&)>;
+
+    FlowScheduler() = default;
+
+    FlowScheduler(const FlowScheduler&) = delete;
+    FlowScheduler& operator=(const FlowScheduler&) = delete;
+
+    /**
+     * @brief Start executing a flow
+     *
+     * The flow runs until it finishes or suspends on an async PROC. If it
+     * finishes synchronously, onComplete is called before submit() returns.
+     * With a time slice the execution is only queued; it starts on the next
+     * poll(), run() or runFrame().
+     *
+     * @param flow Flow to execute (copied; copies share the compiled program)
+     * @param params Input parameters
+     * @param onComplete Called on the executor thread with the final result
+     * @return Identifier of the execution
+     */
+    TaskId submit(const Flow& flow, const ParameterMap& params = {}, CompletionHandler onComplete = {});
+
+    /**
+     * @brief Resume every execution whose pending PROC has completed
+     *
+     * With a time slice, queued and paused executions run as well, in slices,
+     * until each has finished or suspends on an async PROC.
+     *
+     * @return Number of executions that finished during this call
+     */
+    size_t poll();
+    
+    /**
+     * @brief Like poll(), but start no node once budget has passed
+     *
+     * Executions take turns in slices, in the order they became ready; an
+     * execution paused at the end of a frame keeps its place in the queue.
+     * Without a time slice the first ready execution may use the whole budget.
+     *
+     * @return Number of executions that finished during this call
+     */
+    size_t runFrame(std::chrono::steady_clock::duration budget);
+    
+    /**
+     * @brief Nodes an execution runs before the next ready execution's turn, 0 (the default) for no limit
+     */
+    void setTimeSlice(size_t steps) { timeSlice_ = steps; }
+    size_t getTimeSlice() const { return timeSlice_; }
+
+    /**
+     * @brief Block until all in-flight executions have finished
+     *
+     * Waits for PROC completions and resumes executions as they arrive.
+     * Async PROCs must complete on other threads, otherwise this never returns.
+     *
+     * @return Number of executions that finished during this call
+     */
+    size_t run();
+
+    /**
+     * @brief Number of executions that have not finished: suspended on async PROCs, paused or queued
+     */
+    size_t inFlight() const { return tasks_.size(); }
+    
+    /**
+     * @brief Number of executions ready to run: queued, paused, or whose pending PROC has completed
+     */
+    size_t ready() const { return ready_.size(); }
+
+private:
+    // Completion queue entry, embedded in its task
+    struct Completion {
+        Completion* next = nullptr;
+        TaskId task = 0;
+    };
+
+    struct Task {
+        Flow flow;
+        std::unique_ptr<ExecutionContext> context;
+        CompletionHandler onComplete;
+        Completion completion;
+        ParameterMap params;   // until a queued execution starts
+    };
+
+    std::unordered_map<TaskId, Task> tasks_;   // node-based: tasks keep their address
+    CompletionQueue<Completion> completions_;
+    std::deque<TaskId> ready_;                 // run in this order by drain()
+    TaskId nextTaskId_ = 1;
+    size_t timeSlice_ = 0;
+
+    // Wake-up of an executor blocked in run(); producers only lock while it waits
+    std::atomic<bool> waiting_{false};
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+
+    void notify(Completion* completion);
+    void collectCompletions();
+    size_t drain(std::optional<std::chrono::steady_clock::time_point> deadline);
+    void finish(std::unordered_map<TaskId, Task>::iterator it, ExecutionResult result);
+};
+
+// Implementation (header-only)
+
+inline FlowScheduler::TaskId FlowScheduler::submit(const Flow& flow, const ParameterMap& params, CompletionHandler onComplete) {
+    TaskId id = nextTaskId_++;
+    auto it = tasks_.emplace(id, Task{flow, flow.acquireContext(), std::move(onComplete), {}, {}}).first;
+    Task& task = it->second;
+    task.completion.task = id;
+
+    Completion* completion = &task.completion;
+    task.context->setAsyncResumeHandler([this, completion]() { notify(completion); });
+    task.context->setReleaseDeadValues(true);   // parked executions keep only their live variables
+
+    if (timeSlice_ != 0) {
+        task.params = params;
+        ready_.push_back(id);
+        return id;
+    }
+    auto result = task.flow.start(*task.context, params);
+    if (result) {
+        finish(it, std::move(*result));
+    }
+    return id;
+}
+
+inline void FlowScheduler::notify(Completion* completion) {
+    completions_.push(completion);
+    if (waiting_.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wake_.notify_one();
+    }
+}
+
+inline size_t FlowScheduler::poll() {
+    return drain(std::nullopt);
+}
+
+inline size_t FlowScheduler::runFrame(std::chrono::steady_clock::duration budget) {
+    return drain(std::chrono::steady_clock::now() + budget);
+}
+
+inline size_t FlowScheduler::run() {
+    size_t finished = 0;
+    while (!tasks_.empty()) {
+        if (ready_.empty() && completions_.empty()) {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            waiting_.store(true, std::memory_order_seq_cst);
+            wake_.wait(lock, [this] { return !completions_.empty(); });
+            waiting_.store(false, std::memory_order_relaxed);
+        }
+        finished += drain(std::nullopt);
+    }
+    return finished;
+}
+
+inline void FlowScheduler::collectCompletions() {
+    Completion* completion = completions_.popAll();
+    while (completion) {
+        // Read the link first: once the task runs it may finish (freeing the node) or suspend again (re-pushing it)
+        Completion* next = completion->next;
+        ready_.push_back(completion->task);
+        completion = next;
+    }
+}
+
+inline size_t FlowScheduler::drain(std::optional<std::chrono::steady_clock::time_point> deadline) {
+    ExecutionBudget slice;
+    slice.maxSteps = timeSlice_;
+    slice.deadline = deadline;
+
+    size_t finished = 0;
+    collectCompletions();
+    while (!ready_.empty()) {
+        if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+            break;
+        }
+        TaskId id = ready_.front();
+        ready_.pop_front();
+        auto it = tasks_.find(id);
+        if (it == tasks_.end()) {
+            continue;
+        }
+        Task& task = it->second;
+        auto result = task.flow.executeFor(*task.context, slice, task.params);
+        if (result) {
+            finish(it, std::move(*result));
+            ++finished;
+        } else {
+            task.params.clear();   // started
+            if (task.context->getState() == ExecutionState::Paused) {
+                ready_.push_back(id);   // slice used up: the other ready executions go first
+            }
+        }
+        if (deadline) {
+            collectCompletions();   // PROCs completing during the frame still get their turn in it
+        }
+    }
+    return finished;
+}
+
+inline void FlowScheduler::finish(std::unordered_map<TaskId, Task>::iterator it, ExecutionResult result) {
+    // Remove the task first, the completion handler may submit new executions
+    TaskId id = it->first;
+    Task task = std::move(it->second);
+    tasks_.erase(it);
+    task.context->setAsyncResumeHandler(nullptr);
+    task.flow.releaseContext(std::move(task.context));
+    if (task.onComplete) {
+        task.onComplete(id, result);
+    }
+}
+
+} // namespace FlowGraph
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Types.hpp"
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FLOWGRAPH_HAS_MMAP 1
+#endif
+
+namespace FlowGraph {
+
+/**
+ * @brief Read-only contents of a .flow source file
+ *
+ * On POSIX systems the file is memory-mapped, so loading a module costs no
+ * copy and no heap allocation; elsewhere (and for in-memory sources) the text
+ * is held in a string. view() stays valid for the lifetime of the object,
+ * including across moves.
+ */
+class SourceFile {
+public:
+    SourceFile() = default;
+
+    /**
+     * @brief Open and map a file
+     * @throws FlowGraphError (IO) if the file cannot be read
+     */
+    static SourceFile open(const std::string& filepath);
+
+    /**
+     * @brief Wrap source text that is already in memory
+     */
+    static SourceFile fromString(std::string content);
+
+    SourceFile(SourceFile&& other) noexcept { moveFrom(other); }
+
+    SourceFile& operator=(SourceFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    ~SourceFile() { release(); }
+
+    std::string_view view() const noexcept { return std::string_view(data_, size_); }
+    size_t size() const noexcept { return size_; }
+
+    /**
+     * @brief True if the contents are mapped from the file rather than copied
+     */
+    bool isMapped() const noexcept { return mapped_; }
+
+private:
+    const char* data_ = "";
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::string owned_;
+
+    void moveFrom(SourceFile& other) noexcept;
+    void release() noexcept;
+};
+
+// Implementation (header-only)
+
+inline SourceFile SourceFile::open(const std::string& filepath) {
+#ifdef FLOWGRAPH_HAS_MMAP
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw FlowGraphError(FlowGraphError::Type::IO, "Cannot open file: " + filepath);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw FlowGraphError(FlowGraphError::Type::IO, "Cannot read file: " + filepath);
+    }
+
+    SourceFile file;
+    if (info.st_size > 0) {
+        void* mapping = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            file.data_ = static_cast<const char*>(mapping);
+            file.size_ = static_cast<size_t>(info.st_size);
+            file.mapped_ = true;
+        }
+    }
+    ::close(fd);
+    if (file.mapped_ || info.st_size == 0) {
+        return file;
+    }
+    // Not mappable (e.g. a pipe or special file): fall back to reading it
+#endif
+    std::ifstream stream(filepath, std::ios::binary);
+    if (!stream) {
+        throw FlowGraphError(FlowGraphError::Type::IO, "Cannot open file: " + filepath);
+    }
+    std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    if (stream.bad()) {
+        throw FlowGraphError(FlowGraphError::Type::IO, "Cannot read file: " + filepath);
+    }
+    return fromString(std::move(content));
+}
+
+inline SourceFile SourceFile::fromString(std::string content) {
+    SourceFile file;
+    file.owned_ = std::move(content);
+    file.data_ = file.owned_.data();
+    file.size_ = file.owned_.size();
+    return file;
+}
+
+inline void SourceFile::moveFrom(SourceFile& other) noexcept {
+    mapped_ = other.mapped_;
+    size_ = other.size_;
+    if (mapped_) {
+        data_ = other.data_;
+    } else {
+        owned_ = std::move(other.owned_);
+        data_ = owned_.data(); // a moved short string no longer lives in other's buffer
+    }
+    other.data_ = "";
+    other.size_ = 0;
+    other.mapped_ = false;
+}
+
+inline void SourceFile::release() noexcept {
+#ifdef FLOWGRAPH_HAS_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = "";
+    size_ = 0;
+    mapped_ = false;
+    owned_.clear();
+}
+
+} // namespace FlowGraph
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace FlowGraph {
+
+/**
+ * @brief Interned name: node ID, error or port name, procedure or variable name
+ *
+ * Symbols of one SymbolTable compare equal exactly when their names do.
+ */
+using Symbol = uint32_t;
+
+/**
+ * @brief Symbol of the empty name, valid in every table
+ */
+constexpr Symbol NoSymbol = 0;
+
+/**
+ * @brief Append-only table of interned names
+ *
+ * Each Engine owns one table shared by all flows compiled for it, so node
+ * IDs, error names and the like are stored once per engine and compared as
+ * integers, also across flows (e.g. an error emitted by a sub-flow and the
+ * caller's capture port). Safe to use from several threads: lookups of known
+ * names only take a shared lock. Names stay valid as long as the table.
+ */
+class SymbolTable {
+public:
+    SymbolTable() { intern(""); }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    /**
+     * @brief Symbol of a name, adding the name if it is new
+     */
+    Symbol intern(std::string_view name);
+
+    /**
+     * @brief Symbol of a known name, without adding it
+     */
+    std::optional<Symbol> find(std::string_view name) const;
+
+    const std::string& name(Symbol symbol) const;
+
+    size_t size() const;
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> names_;                        // stable addresses
+    std::unordered_map<std::string_view, Symbol> index_;   // views of names_
+};
+
+// Implementation (header-only)
+
+inline Symbol SymbolTable::intern(std::string_view name) {
+    if (auto symbol = find(name)) {
+        return *symbol;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+        return it->second; // interned by another thread meanwhile
+    }
+    Symbol symbol = static_cast<Symbol>(names_.size());
+    names_.emplace_back(name);
+    index_.emplace(names_.back(), symbol);
+    return symbol;
+}
+
+inline std::optional<Symbol> SymbolTable::find(std::string_view name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = index_.find(name);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+inline const std::string& SymbolTable::name(Symbol symbol) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return names_[symbol];
+}
+
+inline size_t SymbolTable::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return names_.size();
+}
+
+} // namespace FlowGraph
@@ -0,0 +1,685 @@
+#pragma once
+
+#include "Types.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace FlowGraph {
+
+namespace detail {
+class TypedEmitter;
+}
+
+/**
+ * @brief Static type of a compiled expression: Number, Boolean or not known
+ */
+enum class StaticType : uint8_t {
+    Unknown,
+    Number,
+    Boolean
+};
+
+/**
+ * @brief Number/Boolean expression compiled to typed stack code
+ *
+ * Covers literals, variables, unary - and !, + - * /, comparisons, == and !=,
+ * && || and the ternary operator on Number and Boolean operands. Literal
+ * subexpressions are folded at compile time. The code works on raw doubles
+ * (booleans as 0/1), so evaluation does no variant dispatch and no string
+ * conversion.
+ *
+ * The fast path never decides anything ExpressionKit would decide
+ * differently: all operands are evaluated, and if a variable is unset or
+ * holds another type than the code expects, or a division by zero occurs,
+ * evaluate() returns false and the caller evaluates the ExpressionKit tree
+ * instead. Expressions outside the subset (strings, function calls, %)
+ * are not compiled at all.
+ */
+class TypedExpression {
+public:
+    enum class Op : uint8_t {
+        PushNumber,     // number literal (also folded constants)
+        PushBoolean,
+        LoadNumber,     // variable slot, must hold a Number
+        LoadBoolean,    // variable slot, must hold a Boolean
+        Negate,
+        Not,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Equal,          // operands of the same static type
+        NotEqual,
+        And,
+        Or,
+        Select          // condition ? a : b, operands evaluated eagerly
+    };
+
+    struct Instruction {
+        Op op;
+        uint32_t slot = 0;    // Load*
+        double value = 0;     // Push*
+    };
+
+    /**
+     * @brief Maximum evaluation stack depth; deeper expressions are not compiled
+     */
+    static constexpr size_t MaxStackDepth = 32;
+
+    /**
+     * @brief Variable information the compiler needs from the flow
+     *
+     * slot(name) returns the compiled slot of a variable, type(slot) its
+     * declared type (Unknown if it is not declared consistently).
+     */
+    struct Scope {
+        virtual ~Scope() = default;
+        virtual std::optional<uint32_t> slot(std::string_view name) const = 0;
+        virtual StaticType type(uint32_t slot) const = 0;
+    };
+
+    /**
+     * @brief Compile an expression
+     * @param expected Type the result must have (e.g. the ASSIGN target's declared
+     *        type), Unknown to use the expression's own type
+     * @return Compiled expression, or std::nullopt if the expression is outside the
+     *         supported subset or its type is not known
+     */
+    static std::optional<TypedExpression> compile(std::string_view text, const Scope& scope,
+                                                  StaticType expected = StaticType::Unknown);
+
+    /**
+     * @brief Static type of the expression as written, without compiling it
+     * @return Unknown if it cannot be determined or the expression is outside the subset
+     */
+    static StaticType inferType(std::string_view text, const Scope& scope);
+
+    StaticType type() const { return type_; }
+    const std::vector<Instruction>& code() const { return code_; }
+
+    /**
+     * @brief True if the whole expression was folded to a constant
+     */
+    bool isConstant() const { return code_.size() == 1 && code_[0].op <= Op::PushBoolean; }
+
+    /**
+     * @brief Evaluate with variables from findVariable(slot) -> const Value* (null if unset)
+     * @return False if the generic evaluator must decide (see class description)
+     */
+    template<typename Lookup>
+    bool evaluate(Lookup&& findVariable, Value& result) const;
+
+    /**
+     * @brief Evaluate for count lanes of columnar variables at once
+     *
+     * column(slot) returns the slot's lane values (booleans as 0/1) and their
+     * types, Unknown where the variable is unset, as a pair of pointers. Every
+     * instruction is one loop over all lanes, which the compiler can
+     * vectorize. The result is left in the first count entries of stack, which
+     * must hold MaxStackDepth * count doubles. fallback[lane] is set to 1 for
+     * the lanes where evaluate() would return false; other entries are left as
+     * they are.
+     */
+    template<typename Columns>
+    void evaluateLanes(Columns&& column, size_t count, double* stack, uint8_t* fallback) const;
+
+private:
+    struct Node;
+    class Parser;
+    friend class detail::TypedEmitter;
+
+    std::vector<Instruction> code_;
+    StaticType type_ = StaticType::Unknown;
+
+    static std::unique_ptr<Node> parse(std::string_view text, const Scope& scope);
+};
+
+// Implementation (header-only)
+
+struct TypedExpression::Node {
+    Op op;
+    StaticType type = StaticType::Unknown;
+    uint32_t slot = 0;                   // variables
+    double value = 0;                    // literals
+    std::unique_ptr<Node> operands[3];
+
+    bool isLiteral() const { return op == Op::PushNumber || op == Op::PushBoolean; }
+    bool isVariable() const { return op == Op::LoadNumber; } // variables are typed when emitted
+};
+
+/**
+ * Recursive descent over the supported subset, with the usual C precedence:
+ * ?: < || < && < == != < relational < + - < * / < unary
+ */
+class TypedExpression::Parser {
+public:
+    Parser(std::string_view text, const Scope& scope) : text_(text), scope_(scope) {}
+
+    std::unique_ptr<Node> parse() {
+        auto node = ternary();
+        skipSpace();
+        return node && position_ == text_.size() ? std::move(node) : nullptr;
+    }
+
+private:
+    std::string_view text_;
+    const Scope& scope_;
+    size_t position_ = 0;
+
+    void skipSpace() {
+        while (position_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[position_]))) {
+            ++position_;
+        }
+    }
+
+    bool eat(std::string_view token) {
+        skipSpace();
+        if (text_.compare(position_, token.size(), token) != 0) {
+            return false;
+        }
+        // "<" must not match "<=", "!" not "!=" and so on
+        if (token.size() == 1 && position_ + 1 < text_.size() && text_[position_ + 1] == '=' &&
+            (token == "<" || token == ">" || token == "!")) {
+            return false;
+        }
+        position_ += token.size();
+        return true;
+    }
+
+    static std::unique_ptr<Node> make(Op op, StaticType type, std::unique_ptr<Node> a = nullptr,
+                                      std::unique_ptr<Node> b = nullptr, std::unique_ptr<Node> c = nullptr) {
+        if ((op != Op::PushNumber && op != Op::PushBoolean && op != Op::LoadNumber && !a)) {
+            return nullptr;
+        }
+        auto node = std::make_unique<Node>();
+        node->op = op;
+        node->type = type;
+        node->operands[0] = std::move(a);
+        node->operands[1] = std::move(b);
+        node->operands[2] = std::move(c);
+        return node;
+    }
+
+    std::unique_ptr<Node> binary(Op op, StaticType type, std::unique_ptr<Node> left, std::unique_ptr<Node> right) {
+        return left && right ? make(op, type, std::move(left), std::move(right)) : nullptr;
+    }
+
+    std::unique_ptr<Node> ternary() {
+        auto condition = logicalOr();
+        if (!condition || !eat("?")) {
+            return condition;
+        }
+        auto yes = ternary();
+        if (!yes || !eat(":")) {
+            return nullptr;
+        }
+        auto no = ternary();
+        if (!no) {
+            return nullptr;
+        }
+        StaticType type = yes->type == no->type ? yes->type : StaticType::Unknown;
+        return make(Op::Select, type, std::move(condition), std::move(yes), std::move(no));
+    }
+
+    std::unique_ptr<Node> logicalOr() {
+        auto left = logicalAnd();
+        while (left && eat("||")) {
+            left = binary(Op::Or, StaticType::Boolean, std::move(left), logicalAnd());
+        }
+        return left;
+    }
+
+    std::unique_ptr<Node> logicalAnd() {
+        auto left = equality();
+        while (left && eat("&&")) {
+            left = binary(Op::And, StaticType::Boolean, std::move(left), equality());
+        }
+        return left;
+    }
+
+    std::unique_ptr<Node> equality() {
+        auto left = relational();
+        while (left) {
+            if (eat("==")) {
+                left = binary(Op::Equal, StaticType::Boolean, std::move(left), relational());
+            } else if (eat("!=")) {
+                left = binary(Op::NotEqual, StaticType::Boolean, std::move(left), relational());
+            } else {
+                break;
+            }
+        }
+        return left;
+    }
+
+    std::unique_ptr<Node> relational() {
+        auto left = additive();
+        while (left) {
+            Op op;
+            if (eat("<=")) op = Op::LessEqual;
+            else if (eat(">=")) op = Op::GreaterEqual;
+            else if (eat("<")) op = Op::Less;
+            else if (eat(">")) op = Op::Greater;
+            else break;
+            left = binary(op, StaticType::Boolean, std::move(left), additive());
+        }
+        return left;
+    }
+
+    std::unique_ptr<Node> additive() {
+        auto left = multiplicative();
+        while (left) {
+            if (eat("+")) {
+                left = binary(Op::Add, StaticType::Number, std::move(left), multiplicative());
+            } else if (eat("-")) {
+                left = binary(Op::Subtract, StaticType::Number, std::move(left), multiplicative());
+            } else {
+                break;
+            }
+        }
+        return left;
+    }
+
+    std::unique_ptr<Node> multiplicative() {
+        auto left = unary();
+        while (left) {
+            if (eat("*")) {
+                left = binary(Op::Multiply, StaticType::Number, std::move(left), unary());
+            } else if (eat("/")) {
+                left = binary(Op::Divide, StaticType::Number, std::move(left), unary());
+            } else {
+                break;
+            }
+        }
+        return left;
+    }
+
+    std::unique_ptr<Node> unary() {
+        if (eat("-")) {
+            return make(Op::Negate, StaticType::Number, unary());
+        }
+        if (eat("!")) {
+            return make(Op::Not, StaticType::Boolean, unary());
+        }
+        return primary();
+    }
+
+    std::unique_ptr<Node> primary() {
+        skipSpace();
+        if (position_ >= text_.size()) {
+            return nullptr;
+        }
+        char c = text_[position_];
+        if (c == '(') {
+            ++position_;
+            auto inner = ternary();
+            return inner && eat(")") ? std::move(inner) : nullptr;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            return number();
+        }
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t begin = position_;
+            while (position_ < text_.size() &&
+                   (std::isalnum(static_cast<unsigned char>(text_[position_])) || text_[position_] == '_' ||
+                    text_[position_] == '.')) {
+                ++position_;
+            }
+            std::string_view name = text_.substr(begin, position_ - begin);
+            if (name == "true" || name == "false") {
+                auto node = make(Op::PushBoolean, StaticType::Boolean);
+                node->value = name == "true" ? 1 : 0;
+                return node;
+            }
+            skipSpace();
+            if (position_ < text_.size() && text_[position_] == '(') {
+                return nullptr; // function call
+            }
+            auto slot = scope_.slot(name);
+            if (!slot) {
+                return nullptr; // not a compiled variable (or a keyword of the expression language)
+            }
+            auto node = make(Op::LoadNumber, scope_.type(*slot));
+            node->slot = *slot;
+            return node;
+        }
+        return nullptr; // strings and anything else
+    }
+
+    std::unique_ptr<Node> number() {
+        // Plain decimal literals only (digits, optionally a fraction)
+        size_t begin = position_;
+        while (position_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[position_]))) {
+            ++position_;
+        }
+        if (position_ < text_.size() && text_[position_] == '.') {
+            ++position_;
+            size_t fraction = position_;
+            while (position_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[position_]))) {
+                ++position_;
+            }
+            if (position_ == fraction) {
+                return nullptr;
+            }
+        }
+        if (position_ < text_.size() && (std::isalpha(static_cast<unsigned char>(text_[position_])) ||
+                                         text_[position_] == '.' || text_[position_] == '_')) {
+            return nullptr; // exponents, suffixes
+        }
+        std::string literal(text_.substr(begin, position_ - begin));
+        auto node = make(Op::PushNumber, StaticType::Number);
+        node->value = std::strtod(literal.c_str(), nullptr);
+        return node;
+    }
+};
+
+namespace detail {
+
+/**
+ * Type checks the tree against what each operator needs, folds literal
+ * subexpressions and emits the stack code. Returns false if the expression
+ * cannot be compiled.
+ */
+class TypedEmitter {
+public:
+    using Node = TypedExpression::Node;
+    using Op = TypedExpression::Op;
+
+    std::vector<TypedExpression::Instruction> code;
+
+    bool emit(Node& node, StaticType expected, size_t depth = 1) {
+        if (depth > TypedExpression::MaxStackDepth) {
+            return false;
+        }
+        StaticType type = node.type;
+        if (expected != StaticType::Unknown) {
+            if (type != StaticType::Unknown && type != expected) {
+                return false;
+            }
+            type = expected;
+        }
+        if (type == StaticType::Unknown) {
+            return false;
+        }
+
+        if (node.isLiteral()) {
+            code.push_back({node.op, 0, node.value});
+            return true;
+        }
+        if (node.isVariable()) {
+            code.push_back({type == StaticType::Number ? Op::LoadNumber : Op::LoadBoolean, node.slot, 0});
+            return true;
+        }
+
+        Node* a = node.operands[0].get();
+        Node* b = node.operands[1].get();
+        Node* c = node.operands[2].get();
+        size_t begin = code.size();
+        bool ok = true;
+        switch (node.op) {
+            case Op::Negate:
+                ok = emit(*a, StaticType::Number, depth);
+                break;
+            case Op::Not:
+                ok = emit(*a, StaticType::Boolean, depth);
+                break;
+            case Op::Add: case Op::Subtract: case Op::Multiply: case Op::Divide:
+            case Op::Less: case Op::LessEqual: case Op::Greater: case Op::GreaterEqual:
+                ok = emit(*a, StaticType::Number, depth) && emit(*b, StaticType::Number, depth + 1);
+                break;
+            case Op::And: case Op::Or:
+                ok = emit(*a, StaticType::Boolean, depth) && emit(*b, StaticType::Boolean, depth + 1);
+                break;
+            case Op::Equal: case Op::NotEqual: {
+                // Both sides must have one known type; mixed comparisons are left to ExpressionKit
+                StaticType operand = a->type != StaticType::Unknown ? a->type : b->type;
+                ok = operand != StaticType::Unknown && emit(*a, operand, depth) && emit(*b, operand, depth + 1);
+                break;
+            }
+            case Op::Select:
+                ok = emit(*a, StaticType::Boolean, depth) && emit(*b, type, depth + 1) && emit(*c, type, depth + 2);
+                break;
+            default:
+                ok = false;
+        }
+        if (!ok) {
+            return false;
+        }
+        code.push_back({node.op, 0, 0});
+        fold(begin);
+        return true;
+    }
+
+private:
+    static bool isPush(const TypedExpression::Instruction& instruction) {
+        return instruction.op == Op::PushNumber || instruction.op == Op::PushBoolean;
+    }
+
+    // Replace an operator whose operands are all literals by its result
+    void fold(size_t begin) {
+        const auto& op = code.back();
+        size_t operands = code.size() - 1 - begin;
+        for (size_t i = begin; i + 1 < code.size(); ++i) {
+            if (!isPush(code[i])) {
+                return;
+            }
+        }
+        double stack[3] = {};
+        for (size_t i = 0; i < operands && i < 3; ++i) {
+            stack[i] = code[begin + i].value;
+        }
+        double x = stack[0], y = stack[1];
+        double result;
+        bool boolean = false;
+        switch (op.op) {
+            case Op::Negate: result = -x; break;
+            case Op::Not: result = x == 0; boolean = true; break;
+            case Op::Add: result = x + y; break;
+            case Op::Subtract: result = x - y; break;
+            case Op::Multiply: result = x * y; break;
+            case Op::Divide:
+                if (y == 0) {
+                    return; // left to run time, where ExpressionKit reports it
+                }
+                result = x / y;
+                break;
+            case Op::Less: result = x < y; boolean = true; break;
+            case Op::LessEqual: result = x <= y; boolean = true; break;
+            case Op::Greater: result = x > y; boolean = true; break;
+            case Op::GreaterEqual: result = x >= y; boolean = true; break;
+            case Op::Equal: result = x == y; boolean = true; break;
+            case Op::NotEqual: result = x != y; boolean = true; break;
+            case Op::And: result = x != 0 && y != 0; boolean = true; break;
+            case Op::Or: result = x != 0 || y != 0; boolean = true; break;
+            case Op::Select: {
+                auto chosen = code[begin + (x != 0 ? 1 : 2)];
+                code.resize(begin);
+                code.push_back(chosen);
+                return;
+            }
+            default:
+                return;
+        }
+        code.resize(begin);
+        code.push_back({boolean ? Op::PushBoolean : Op::PushNumber, 0, result});
+    }
+};
+
+} // namespace detail
+
+inline std::unique_ptr<TypedExpression::Node> TypedExpression::parse(std::string_view text, const Scope& scope) {
+    return Parser(text, scope).parse();
+}
+
+inline std::optional<TypedExpression> TypedExpression::compile(std::string_view text, const Scope& scope,
+                                                               StaticType expected) {
+    auto root = parse(text, scope);
+    if (!root) {
+        return std::nullopt;
+    }
+    detail::TypedEmitter emitter;
+    StaticType type = expected != StaticType::Unknown ? expected : root->type;
+    if (!emitter.emit(*root, type)) {
+        return std::nullopt;
+    }
+    TypedExpression expression;
+    expression.code_ = std::move(emitter.code);
+    expression.type_ = type;
+    return expression;
+}
+
+inline StaticType TypedExpression::inferType(std::string_view text, const Scope& scope) {
+    auto root = parse(text, scope);
+    return root ? root->type : StaticType::Unknown;
+}
+
+template<typename Lookup>
+inline bool TypedExpression::evaluate(Lookup&& findVariable, Value& result) const {
+    double stack[MaxStackDepth];
+    size_t top = 0;
+    for (const Instruction& instruction : code_) {
+        switch (instruction.op) {
+            case Op::PushNumber:
+            case Op::PushBoolean:
+                stack[top++] = instruction.value;
+                break;
+            case Op::LoadNumber: {
+                const Value* value = findVariable(instruction.slot);
+                if (!value || !value->isNumber()) {
+                    return false;
+                }
+                stack[top++] = value->asNumber();
+                break;
+            }
+            case Op::LoadBoolean: {
+                const Value* value = findVariable(instruction.slot);
+                if (!value || !value->isBoolean()) {
+                    return false;
+                }
+                stack[top++] = value->asBoolean() ? 1 : 0;
+                break;
+            }
+            case Op::Negate: stack[top - 1] = -stack[top - 1]; break;
+            case Op::Not: stack[top - 1] = stack[top - 1] == 0; break;
+            case Op::Add: --top; stack[top - 1] += stack[top]; break;
+            case Op::Subtract: --top; stack[top - 1] -= stack[top]; break;
+            case Op::Multiply: --top; stack[top - 1] *= stack[top]; break;
+            case Op::Divide:
+                --top;
+                if (stack[top] == 0) {
+                    return false;
+                }
+                stack[top - 1] /= stack[top];
+                break;
+            case Op::Less: --top; stack[top - 1] = stack[top - 1] < stack[top]; break;
+            case Op::LessEqual: --top; stack[top - 1] = stack[top - 1] <= stack[top]; break;
+            case Op::Greater: --top; stack[top - 1] = stack[top - 1] > stack[top]; break;
+            case Op::GreaterEqual: --top; stack[top - 1] = stack[top - 1] >= stack[top]; break;
+            case Op::Equal: --top; stack[top - 1] = stack[top - 1] == stack[top]; break;
+            case Op::NotEqual: --top; stack[top - 1] = stack[top - 1] != stack[top]; break;
+            case Op::And: --top; stack[top - 1] = stack[top - 1] != 0 && stack[top] != 0; break;
+            case Op::Or: --top; stack[top - 1] = stack[top - 1] != 0 || stack[top] != 0; break;
+            case Op::Select:
+                top -= 2;
+                stack[top - 1] = stack[top - 1] != 0 ? stack[top] : stack[top + 1];
+                break;
+        }
+    }
+    result = type_ == StaticType::Boolean ? Value(stack[0] != 0) : Value(stack[0]);
+    return true;
+}
+
+namespace detail {
+
+// One operator of TypedExpression::evaluateLanes(): pops the top operand column into the one below it
+template<typename Operator>
+inline void applyLanes(double*& top, size_t count, Operator apply) {
+    top -= count;
+    double* x = top - count;
+    const double* y = top;
+    for (size_t i = 0; i < count; ++i) {
+        x[i] = apply(x[i], y[i]);
+    }
+}
+
+} // namespace detail
+
+template<typename Columns>
+inline void TypedExpression::evaluateLanes(Columns&& column, size_t count, double* stack, uint8_t* fallback) const {
+    double* top = stack;   // next free operand column
+    for (const Instruction& instruction : code_) {
+        switch (instruction.op) {
+            case Op::PushNumber:
+            case Op::PushBoolean:
+                std::fill(top, top + count, instruction.value);
+                top += count;
+                break;
+            case Op::LoadNumber:
+            case Op::LoadBoolean: {
+                auto [values, types] = column(instruction.slot);
+                StaticType expected = instruction.op == Op::LoadNumber ? StaticType::Number : StaticType::Boolean;
+                for (size_t i = 0; i < count; ++i) {
+                    top[i] = values[i];
+                    fallback[i] |= types[i] != expected;
+                }
+                top += count;
+                break;
+            }
+            case Op::Negate: {
+                double* x = top - count;
+                for (size_t i = 0; i < count; ++i) {
+                    x[i] = -x[i];
+                }
+                break;
+            }
+            case Op::Not: {
+                double* x = top - count;
+                for (size_t i = 0; i < count; ++i) {
+                    x[i] = x[i] == 0;
+                }
+                break;
+            }
+            case Op::Add: detail::applyLanes(top, count, [](double x, double y) { return x + y; }); break;
+            case Op::Subtract: detail::applyLanes(top, count, [](double x, double y) { return x - y; }); break;
+            case Op::Multiply: detail::applyLanes(top, count, [](double x, double y) { return x * y; }); break;
+            case Op::Divide: {
+                const double* y = top - count;
+                for (size_t i = 0; i < count; ++i) {
+                    fallback[i] |= y[i] == 0;
+                }
+                detail::applyLanes(top, count, [](double x, double y) { return x / y; });
+                break;
+            }
+            case Op::Less: detail::applyLanes(top, count, [](double x, double y) { return double(x < y); }); break;
+            case Op::LessEqual: detail::applyLanes(top, count, [](double x, double y) { return double(x <= y); }); break;
+            case Op::Greater: detail::applyLanes(top, count, [](double x, double y) { return double(x > y); }); break;
+            case Op::GreaterEqual: detail::applyLanes(top, count, [](double x, double y) { return double(x >= y); }); break;
+            case Op::Equal: detail::applyLanes(top, count, [](double x, double y) { return double(x == y); }); break;
+            case Op::NotEqual: detail::applyLanes(top, count, [](double x, double y) { return double(x != y); }); break;
+            case Op::And: detail::applyLanes(top, count, [](double x, double y) { return double(x != 0 && y != 0); }); break;
+            case Op::Or: detail::applyLanes(top, count, [](double x, double y) { return double(x != 0 || y != 0); }); break;
+            case Op::Select: {
+                top -= 2 * count;
+                double* condition = top - count;
+                const double* yes = top;
+                const double* no = top + count;
+                for (size_t i = 0; i < count; ++i) {
+                    condition[i] = condition[i] != 0 ? yes[i] : no[i];
+                }
+                break;
+            }
+        }
+    }
+}
+
+} // namespace FlowGraph
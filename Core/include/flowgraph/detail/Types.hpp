@@ -1,10 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <optional>
 #include <functional>
+#include <thread>
+#include "InplaceFunction.hpp"
 #include "ExpressionKit.hpp"
 
 namespace FlowGraph {
@@ -93,10 +98,23 @@ struct ProcResult {
 
 /**
  * @brief Callback object for async PROC completion that can track resolution status
+ *
+ * The PROC may complete it from any thread. The engine hands the execution
+ * over with Suspend(): the resume handler is invoked exactly once, and only
+ * for completions that arrive after Suspend() - a completion racing with the
+ * PROC call returning is taken synchronously instead.
+ *
+ * Once IsResolved() is true the engine may go on with the execution while
+ * the completing thread is still running the resume handler, so Reset(),
+ * SetResumeHandler() and the destructor wait for the handler to return.
  */
 class ProcCompletionCallback {
 public:
     ProcCompletionCallback() = default;
+    ~ProcCompletionCallback() { WaitForHandler(); }
+    
+    ProcCompletionCallback(const ProcCompletionCallback&) = delete;
+    ProcCompletionCallback& operator=(const ProcCompletionCallback&) = delete;
     
     /**
      * @brief Call the callback with a result
@@ -104,17 +122,26 @@ public:
      */
     void operator()(const ProcResult& result) {
         result_ = result;
-        resolved_ = true;
+        if (timed_) {
+            resolvedAt_ = std::chrono::steady_clock::now();
+        }
+        // Nothing may reset or destroy the callback before RESOLVED is published
         if (callback_) {
-            callback_(result);
+            callback_(result_);
         }
+        uint8_t previous = flags_.fetch_or(RESOLVED | HANDLING, std::memory_order_acq_rel);
+        if ((previous & SUSPENDED) && resumeHandler_) {
+            resumeHandler_();
+        }
+        // Last access of the completing thread
+        flags_.fetch_and(static_cast<uint8_t>(~HANDLING), std::memory_order_release);
     }
     
     /**
      * @brief Check if the callback has been resolved (called)
      * @return true if the callback was called
      */
-    bool IsResolved() const { return resolved_; }
+    bool IsResolved() const { return (flags_.load(std::memory_order_acquire) & RESOLVED) != 0; }
     
     /**
      * @brief Get the result (only valid if IsResolved() returns true)
@@ -126,17 +153,77 @@ public:
      * @brief Set an optional async callback for when the result is available
      * @param callback Function to call when result is available
      */
-    void SetAsyncCallback(std::function<void(const ProcResult&)> callback) {
-        callback_ = callback;
-        if (resolved_ && callback_) {
+    void SetAsyncCallback(InplaceFunction<void(const ProcResult&)> callback) {
+        callback_ = std::move(callback);
+        if (IsResolved() && callback_) {
             callback_(result_);
         }
     }
+    
+    /**
+     * @brief Set the engine-side handler that resumes a suspended execution
+     *
+     * Must be installed before the PROC is called; it runs on the completing thread.
+     */
+    void SetResumeHandler(InplaceFunction<void()> handler) {
+        WaitForHandler();
+        resumeHandler_ = std::move(handler);
+    }
+    
+    /**
+     * @brief Mark the pending PROC call as suspended
+     * @return false if the PROC completed in the meantime (handle it synchronously);
+     *         true if the resume handler will be invoked on completion
+     */
+    bool Suspend() {
+        uint8_t previous = flags_.fetch_or(SUSPENDED, std::memory_order_acq_rel);
+        if (previous & RESOLVED) {
+            WaitForHandler();
+            return false;
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Clear the result so the callback object can be reused for another call
+     *
+     * The async callback and resume handler stay installed.
+     */
+    void Reset() {
+        WaitForHandler();
+        flags_.store(0, std::memory_order_relaxed);
+        result_ = ProcResult();
+        if (timed_) {
+            dispatchedAt_ = std::chrono::steady_clock::now();
+        }
+    }
+    
+    /**
+     * @brief Record when calls are dispatched (Reset) and resolved, for profiling
+     */
+    void SetTiming(bool enabled) { timed_ = enabled; }
+    bool IsTimed() const { return timed_; }
+    std::chrono::steady_clock::time_point DispatchedAt() const { return dispatchedAt_; }
+    std::chrono::steady_clock::time_point ResolvedAt() const { return resolvedAt_; }
 
 private:
-    bool resolved_ = false;
+    static constexpr uint8_t RESOLVED = 1;
+    static constexpr uint8_t SUSPENDED = 2;
+    static constexpr uint8_t HANDLING = 4;   // completing thread still inside operator()
+    
+    void WaitForHandler() const {
+        while (flags_.load(std::memory_order_acquire) & HANDLING) {
+            std::this_thread::yield();
+        }
+    }
+    
+    std::atomic<uint8_t> flags_{0};
     ProcResult result_;
-    std::function<void(const ProcResult&)> callback_;
+    bool timed_ = false;
+    std::chrono::steady_clock::time_point dispatchedAt_;
+    std::chrono::steady_clock::time_point resolvedAt_;
+    InplaceFunction<void(const ProcResult&)> callback_;
+    InplaceFunction<void()> resumeHandler_;
 };
 
 /**
@@ -150,6 +237,16 @@ private:
  */
 using ExternalProcedure = std::function<void(const ParameterMap&, ProcCompletionCallback&)>;
 
+/**
+ * @brief Non-allocating callable used by the engine to dispatch PROC calls
+ */
+using ProcInvoker = InplaceFunction<void(const ParameterMap&, ProcCompletionCallback&)>;
+
+/**
+ * @brief Plain function a PROC call can be dispatched to without type erasure
+ */
+using ProcFunction = void (*)(const ParameterMap&, ProcCompletionCallback&);
+
 /**
  * @brief PROC definition structure similar to flow file headers
  */
@@ -160,6 +257,14 @@ struct ProcDefinition {
     std::vector<std::string> errors;      // Possible error types
     ExternalProcedure implementation;     // The actual implementation
     
+    // A pure PROC returns the same values for the same inputs and has no side
+    // effects, so successful results are cached by input (see ProcResultCache).
+    // Sub-flow calls (PROC module.flow) are never cached; the pure PROCs they
+    // reach are.
+    bool pure = false;
+    size_t cacheCapacity = 1024;            // cached results of a pure PROC
+    std::chrono::milliseconds cacheTtl{0};  // lifetime of a cached result, 0 = until evicted
+    
     ProcDefinition() = default;
     ProcDefinition(const std::string& t, 
                    std::vector<Parameter> params, 
@@ -170,6 +275,28 @@ struct ProcDefinition {
           errors(std::move(errs)), implementation(std::move(impl)) {}
 };
 
+/**
+ * @brief Procedure answering many calls at once: one result per parameter set, in order
+ */
+using BatchProcedure = std::function<std::vector<ProcResult>(const std::vector<ParameterMap>&)>;
+
+/**
+ * @brief Definition of a procedure whose concurrent calls are coalesced into batches
+ *
+ * Calls arriving within window of the first pending call, or until
+ * maxBatchSize calls are pending, are passed to the implementation together
+ * (see ProcBatcher).
+ */
+struct BatchedProcDefinition {
+    std::string title;
+    std::vector<Parameter> parameters;
+    std::vector<ReturnValue> returnValues;
+    std::vector<std::string> errors;
+    BatchProcedure implementation;
+    size_t maxBatchSize = 64;
+    std::chrono::microseconds window{1000};  // 0 = no coalescing, every call runs as a batch of one
+};
+
 /**
  * @brief Legacy external procedure function signature (synchronous only)
  * For backward compatibility with existing synchronous PROCs
@@ -235,6 +362,11 @@ Value createValue(double value);   // For Number type (unified number semantics)
 Value createValue(bool value);     // For Boolean type semantics
 Value createValue(const std::string& value); // For String type semantics
 
+/**
+ * @brief Whether two values have the same type and value
+ */
+bool sameValue(const Value& a, const Value& b);
+
 // Implementation (header-only)
 
 inline ValueType getValueType(const Value& value) {
@@ -248,6 +380,16 @@ inline ValueType getValueType(const Value& value) {
     throw FlowGraphError(FlowGraphError::Type::Type, "Unknown ExpressionKit value type");
 }
 
+inline bool sameValue(const Value& a, const Value& b) {
+    if (a.isNumber()) {
+        return b.isNumber() && a.asNumber() == b.asNumber();
+    }
+    if (a.isBoolean()) {
+        return b.isBoolean() && a.asBoolean() == b.asBoolean();
+    }
+    return a.isString() && b.isString() && a.asString() == b.asString();
+}
+
 inline Value createValue(double value) {
     return Value(value);
 }
@@ -25,12 +25,14 @@ let package = Package(
             publicHeadersPath: "include",
             cxxSettings: [
                 .define("FLOWGRAPH_SWIFT_PACKAGE"),
+                // The core headers include ExpressionKit.hpp, which must be on the include path as well
+                .headerSearchPath("../../Core/include"),
                 .unsafeFlags(["-std=c++17"])
             ]
         ),
         .target(
             name: "FlowGraph",
-            dependencies: [],
+            dependencies: ["CFlowGraph"],
             path: "Swift/FlowGraph"
         ),
         .testTarget(
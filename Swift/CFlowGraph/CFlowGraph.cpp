@@ -1,31 +1,482 @@
 #include "CFlowGraph.h"
-// TODO: Implementation will be added when C++ core is complete
+#include "flowgraph/FlowGraph.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using FlowGraph::ExecutionContext;
+using FlowGraph::ExecutionResult;
+using FlowGraph::Flow;
+using FlowGraph::ParameterMap;
+using FlowGraph::Value;
+
+struct FlowGraphEngine {
+    FlowGraph::FlowGraphEngine engine;
+    std::string error;
+    bool failed = false;
+};
+
+struct FlowGraphFlow {
+    Flow flow;
+};
+
+struct FlowGraphCall {
+    const ParameterMap& inputs;
+    FlowGraph::ProcCompletionCallback& callback;
+    ParameterMap outputs;
+    mutable std::vector<std::unique_ptr<std::string>> strings;   // inputs handed out as C strings
+};
+
+namespace {
+
+const char* const AsyncNotSupported = "Async PROC execution not supported in synchronous mode";
+
+Value importValue(const FlowGraphValue& value) {
+    switch (value.type) {
+        case FLOWGRAPH_VALUE_BOOLEAN:
+            return FlowGraph::createValue(value.boolean);
+        case FLOWGRAPH_VALUE_STRING:
+            return FlowGraph::createValue(value.string ? std::string(value.string, value.length) : std::string());
+        default:
+            return FlowGraph::createValue(value.number);
+    }
+}
+
+FlowGraphParameterInfo describe(const FlowGraph::Parameter& parameter) {
+    FlowGraphParameterInfo info{parameter.name.c_str(), parameter.comment.c_str(), FLOWGRAPH_VALUE_NUMBER,
+                                parameter.type.optional};
+    switch (parameter.type.type) {
+        case FlowGraph::ValueType::Boolean:
+            info.type = FLOWGRAPH_VALUE_BOOLEAN;
+            break;
+        case FlowGraph::ValueType::String:
+            info.type = FLOWGRAPH_VALUE_STRING;
+            break;
+        default:
+            break;
+    }
+    return info;
+}
+
+// storage keeps its capacity, so exporting the same return again does not allocate
+void exportValue(const Value* value, FlowGraphValue& out, std::string& storage) {
+    out = FlowGraphValue{};
+    if (!value) {
+        out.type = FLOWGRAPH_VALUE_NONE;
+    } else if (value->isNumber()) {
+        out.type = FLOWGRAPH_VALUE_NUMBER;
+        out.number = value->asNumber();
+    } else if (value->isBoolean()) {
+        out.type = FLOWGRAPH_VALUE_BOOLEAN;
+        out.boolean = value->asBoolean();
+    } else {
+        storage.assign(value->asString());
+        out.type = FLOWGRAPH_VALUE_STRING;
+        out.string = storage.c_str();
+        out.length = storage.size();
+    }
+}
+
+// Start an execution with PARAMS bound by position, straight into their slots
+std::optional<ExecutionResult> startPositional(const Flow& flow, ExecutionContext& context,
+                                               const FlowGraphValue* params, size_t paramCount) {
+    return flow.startBinding(context, [&flow, params, paramCount](ExecutionContext& target) {
+        const auto& slots = flow.getProgram().paramSlots();
+        size_t count = std::min(paramCount, slots.size());
+        for (size_t i = 0; i < count; ++i) {
+            if (params[i].type != FLOWGRAPH_VALUE_NONE) {
+                target.setVariable(slots[i], importValue(params[i]));
+            }
+        }
+    });
+}
+
+/**
+ * @brief Where the outcome of an execution goes: its error or the RETURNS read from its slots
+ */
+struct Outcome {
+    FlowGraphValue* returns;
+    std::string* strings;
+    size_t returnCount;
+    std::string* error;
+    bool* failed;
+
+    FlowGraphStatus finish(const Flow& flow, const ExecutionContext& context,
+                           const std::optional<ExecutionResult>& result) const {
+        if (!result) {
+            return FLOWGRAPH_STATUS_SUSPENDED;
+        }
+        if (!result->success) {
+            return fail(result->error);
+        }
+        *failed = false;
+        const auto& slots = flow.getProgram().returnSlots();
+        for (size_t i = 0; i < returnCount; ++i) {
+            exportValue(context.findVariable(slots[i]), returns[i], strings[i]);
+        }
+        return FLOWGRAPH_STATUS_SUCCESS;
+    }
+
+    FlowGraphStatus fail(const std::string& message) const {
+        error->assign(message);
+        *failed = true;
+        std::fill(returns, returns + returnCount, FlowGraphValue{});
+        return FLOWGRAPH_STATUS_ERROR;
+    }
+};
+
+std::unique_ptr<ExecutionContext> makeContext(const Flow& flow) {
+    auto context = std::make_unique<ExecutionContext>(flow.getProgram());
+    context->setKeepReturnValues(true);
+    context->setReleaseDeadValues(true);
+    return context;
+}
+
+FlowGraphFlow* loadWith(FlowGraphEngine* engine, const std::function<Flow()>& load) {
+    try {
+        auto* flow = new FlowGraphFlow{load()};
+        engine->failed = false;
+        return flow;
+    } catch (const std::exception& e) {
+        engine->error = e.what();
+        engine->failed = true;
+        return nullptr;
+    }
+}
+
+} // namespace
+
+struct FlowGraphContext {
+    Flow flow;
+    std::unique_ptr<ExecutionContext> context;
+    std::vector<FlowGraphValue> returns;
+    std::vector<std::string> strings;
+    std::string error;
+    bool failed = false;
+
+    explicit FlowGraphContext(const Flow& source)
+        : flow(source), context(makeContext(flow)), returns(flow.getReturnValues().size()),
+          strings(returns.size()) {}
+
+    ~FlowGraphContext() {
+        if (context->hasPendingProc()) {
+            flow.releaseContext(std::move(context));   // kept until the pending call completes
+        }
+    }
+
+    Outcome outcome() { return {returns.data(), strings.data(), returns.size(), &error, &failed}; }
+};
+
+struct FlowGraphBatch {
+    Flow flow;
+    std::vector<std::unique_ptr<ExecutionContext>> contexts;   // one per worker, kept between calls
+    std::vector<FlowGraphValue> returns;                       // count rows of RETURNS
+    std::vector<std::string> strings;
+    std::vector<std::string> errors;
+    std::unique_ptr<bool[]> failed;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    explicit FlowGraphBatch(const Flow& source) : flow(source) {}
+
+    size_t returnCount() const { return flow.getReturnValues().size(); }
+
+    void reserve(size_t executions) {
+        size_t width = returnCount();
+        if (returns.size() < executions * width) {
+            returns.resize(executions * width);
+            strings.resize(executions * width);
+        }
+        if (errors.size() < executions) {
+            errors.resize(executions);
+        }
+        if (capacity < executions) {
+            failed = std::make_unique<bool[]>(executions);
+            capacity = executions;
+        }
+        count = executions;
+    }
+};
+
+struct FlowGraphScheduler {
+    FlowGraph::FlowScheduler scheduler;
+    std::vector<FlowGraphValue> returns;   // handed to completion callbacks
+    std::vector<std::string> strings;
+};
+
+// Engine management
 
 FlowGraphEngine* flowgraph_engine_create(void) {
-    return nullptr; // Placeholder
+    return new FlowGraphEngine();
 }
 
 void flowgraph_engine_destroy(FlowGraphEngine* engine) {
-    // Placeholder
+    delete engine;
 }
 
+const char* flowgraph_engine_error(const FlowGraphEngine* engine) {
+    return engine->failed ? engine->error.c_str() : nullptr;
+}
+
+// External procedures
+
+bool flowgraph_register_procedure(FlowGraphEngine* engine, const char* name, FlowGraphProcedure procedure,
+                                  void* userData) {
+    if (!name || !procedure) {
+        engine->error = "Procedure name and implementation are required";
+        engine->failed = true;
+        return false;
+    }
+    engine->engine.registerProcedure(name, [procedure, userData](const ParameterMap& params,
+                                                                 FlowGraph::ProcCompletionCallback& callback) {
+        procedure(userData, new FlowGraphCall{params, callback, {}, {}});
+    });
+    engine->failed = false;
+    return true;
+}
+
+FlowGraphValue flowgraph_call_input(const FlowGraphCall* call, const char* name) {
+    FlowGraphValue value{};
+    auto it = call->inputs.find(name);
+    if (it == call->inputs.end()) {
+        return value;
+    }
+    auto storage = std::make_unique<std::string>();
+    exportValue(&it->second, value, *storage);
+    if (value.type == FLOWGRAPH_VALUE_STRING) {
+        call->strings.push_back(std::move(storage));
+    }
+    return value;
+}
+
+void flowgraph_call_set_output(FlowGraphCall* call, const char* name, FlowGraphValue value) {
+    call->outputs[name] = importValue(value);
+}
+
+void flowgraph_call_complete(FlowGraphCall* call) {
+    FlowGraph::ProcCompletionCallback& callback = call->callback;
+    ParameterMap outputs = std::move(call->outputs);
+    delete call;
+    callback(FlowGraph::ProcResult::completedSuccess(std::move(outputs)));
+}
+
+void flowgraph_call_fail(FlowGraphCall* call, const char* error) {
+    FlowGraph::ProcCompletionCallback& callback = call->callback;
+    delete call;
+    callback(FlowGraph::ProcResult::completedError(error ? error : ""));
+}
+
+// Flow loading and metadata
+
 FlowGraphFlow* flowgraph_load_flow(FlowGraphEngine* engine, const char* filepath) {
-    return nullptr; // Placeholder
+    return loadWith(engine, [&]() { return engine->engine.loadFlow(filepath); });
 }
 
 FlowGraphFlow* flowgraph_parse_flow(FlowGraphEngine* engine, const char* content, const char* name) {
-    return nullptr; // Placeholder
+    return loadWith(engine, [&]() { return engine->engine.parseFlow(content, name ? name : ""); });
 }
 
 void flowgraph_flow_destroy(FlowGraphFlow* flow) {
-    // Placeholder
+    delete flow;
+}
+
+const char* flowgraph_flow_title(const FlowGraphFlow* flow) {
+    return flow->flow.getTitle().c_str();
+}
+
+size_t flowgraph_flow_param_count(const FlowGraphFlow* flow) {
+    return flow->flow.getParameters().size();
 }
 
-FlowGraphResult flowgraph_execute_flow(FlowGraphFlow* flow) {
-    FlowGraphResult result = {false, "Not implemented yet"};
-    return result;
+FlowGraphParameterInfo flowgraph_flow_param(const FlowGraphFlow* flow, size_t index) {
+    return describe(flow->flow.getParameters()[index]);
 }
 
-void flowgraph_result_destroy(FlowGraphResult* result) {
-    // Placeholder
-}
\ No newline at end of file
+size_t flowgraph_flow_return_count(const FlowGraphFlow* flow) {
+    return flow->flow.getReturnValues().size();
+}
+
+FlowGraphParameterInfo flowgraph_flow_return(const FlowGraphFlow* flow, size_t index) {
+    return describe(flow->flow.getReturnValues()[index]);
+}
+
+// Reusable execution contexts
+
+FlowGraphContext* flowgraph_context_create(FlowGraphFlow* flow) {
+    return new FlowGraphContext(flow->flow);
+}
+
+void flowgraph_context_destroy(FlowGraphContext* context) {
+    delete context;
+}
+
+FlowGraphStatus flowgraph_execute(FlowGraphContext* context, const FlowGraphValue* params, size_t paramCount) {
+    FlowGraphStatus status = flowgraph_start(context, params, paramCount);
+    if (status == FLOWGRAPH_STATUS_SUSPENDED) {
+        return context->outcome().fail(AsyncNotSupported);
+    }
+    return status;
+}
+
+FlowGraphStatus flowgraph_start(FlowGraphContext* context, const FlowGraphValue* params, size_t paramCount) {
+    auto result = startPositional(context->flow, *context->context, params, paramCount);
+    return context->outcome().finish(context->flow, *context->context, result);
+}
+
+FlowGraphStatus flowgraph_resume(FlowGraphContext* context) {
+    auto result = context->flow.resume(*context->context);
+    return context->outcome().finish(context->flow, *context->context, result);
+}
+
+void flowgraph_context_set_resume_callback(FlowGraphContext* context, FlowGraphResumeCallback callback,
+                                           void* userData) {
+    if (!callback) {
+        context->context->setAsyncResumeHandler(nullptr);
+        return;
+    }
+    context->context->setAsyncResumeHandler([callback, userData]() { callback(userData); });
+}
+
+const char* flowgraph_context_error(const FlowGraphContext* context) {
+    return context->failed ? context->error.c_str() : nullptr;
+}
+
+const FlowGraphValue* flowgraph_context_returns(const FlowGraphContext* context) {
+    return context->returns.data();
+}
+
+// Batch execution
+
+FlowGraphBatch* flowgraph_batch_create(FlowGraphFlow* flow) {
+    return new FlowGraphBatch(flow->flow);
+}
+
+void flowgraph_batch_destroy(FlowGraphBatch* batch) {
+    delete batch;
+}
+
+FlowGraphStatus flowgraph_batch_execute(FlowGraphBatch* batch, const FlowGraphValue* params, size_t paramCount,
+                                        size_t count, size_t threadCount) {
+    batch->reserve(count);
+    if (threadCount == 0) {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    threadCount = std::max<size_t>(1, std::min(threadCount, count));
+    while (batch->contexts.size() < threadCount) {
+        batch->contexts.push_back(makeContext(batch->flow));
+    }
+
+    // Workers claim small chunks so uneven flow run times still balance out
+    constexpr size_t chunkSize = 16;
+    const size_t width = batch->returnCount();
+    std::atomic<size_t> nextIndex{0};
+    std::atomic<bool> allSucceeded{true};
+    auto worker = [&](std::unique_ptr<ExecutionContext>& context) {
+        for (;;) {
+            size_t begin = nextIndex.fetch_add(chunkSize, std::memory_order_relaxed);
+            if (begin >= count) {
+                break;
+            }
+            size_t end = std::min(begin + chunkSize, count);
+            for (size_t i = begin; i < end; ++i) {
+                Outcome outcome{batch->returns.data() + i * width, batch->strings.data() + i * width, width,
+                                &batch->errors[i], &batch->failed[i]};
+                auto result = startPositional(batch->flow, *context, params + i * paramCount, paramCount);
+                FlowGraphStatus status = outcome.finish(batch->flow, *context, result);
+                if (status == FLOWGRAPH_STATUS_SUSPENDED) {
+                    status = outcome.fail(AsyncNotSupported);
+                    // The pending call still completes into it; the pool keeps it until then
+                    batch->flow.releaseContext(std::move(context));
+                    context = makeContext(batch->flow);
+                }
+                if (status != FLOWGRAPH_STATUS_SUCCESS) {
+                    allSucceeded.store(false, std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker, std::ref(batch->contexts[i]));
+    }
+    worker(batch->contexts[0]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return allSucceeded.load() ? FLOWGRAPH_STATUS_SUCCESS : FLOWGRAPH_STATUS_ERROR;
+}
+
+const char* flowgraph_batch_error(const FlowGraphBatch* batch, size_t index) {
+    return batch->failed[index] ? batch->errors[index].c_str() : nullptr;
+}
+
+const FlowGraphValue* flowgraph_batch_returns(const FlowGraphBatch* batch, size_t index) {
+    return batch->returns.data() + index * batch->returnCount();
+}
+
+// Scheduler
+
+FlowGraphScheduler* flowgraph_scheduler_create(void) {
+    return new FlowGraphScheduler();
+}
+
+void flowgraph_scheduler_destroy(FlowGraphScheduler* scheduler) {
+    delete scheduler;
+}
+
+void flowgraph_scheduler_set_time_slice(FlowGraphScheduler* scheduler, size_t steps) {
+    scheduler->scheduler.setTimeSlice(steps);
+}
+
+uint64_t flowgraph_scheduler_submit(FlowGraphScheduler* scheduler, FlowGraphFlow* flow, const FlowGraphValue* params,
+                                    size_t paramCount, FlowGraphCompletion completion, void* userData) {
+    const auto& declared = flow->flow.getParameters();
+    ParameterMap bound;
+    for (size_t i = 0; i < std::min(paramCount, declared.size()); ++i) {
+        if (params[i].type != FLOWGRAPH_VALUE_NONE) {
+            bound[declared[i].name] = importValue(params[i]);
+        }
+    }
+    Flow target = flow->flow;
+    auto onComplete = [scheduler, target, completion, userData](FlowGraph::FlowScheduler::TaskId task,
+                                                                const ExecutionResult& result) {
+        if (!completion) {
+            return;
+        }
+        const auto& names = target.getReturnValues();
+        scheduler->returns.resize(names.size());
+        scheduler->strings.resize(names.size());
+        for (size_t i = 0; i < names.size(); ++i) {
+            auto it = result.returnValues.find(names[i].name);
+            exportValue(it != result.returnValues.end() ? &it->second : nullptr, scheduler->returns[i],
+                        scheduler->strings[i]);
+        }
+        completion(userData, task, result.success ? FLOWGRAPH_STATUS_SUCCESS : FLOWGRAPH_STATUS_ERROR,
+                   result.success ? nullptr : result.error.c_str(), scheduler->returns.data(), names.size());
+    };
+    return scheduler->scheduler.submit(target, bound, std::move(onComplete));
+}
+
+size_t flowgraph_scheduler_poll(FlowGraphScheduler* scheduler) {
+    return scheduler->scheduler.poll();
+}
+
+size_t flowgraph_scheduler_run_frame(FlowGraphScheduler* scheduler, uint64_t budgetMicroseconds) {
+    return scheduler->scheduler.runFrame(std::chrono::microseconds(budgetMicroseconds));
+}
+
+size_t flowgraph_scheduler_run(FlowGraphScheduler* scheduler) {
+    return scheduler->scheduler.run();
+}
+
+size_t flowgraph_scheduler_in_flight(const FlowGraphScheduler* scheduler) {
+    return scheduler->scheduler.inFlight();
+}
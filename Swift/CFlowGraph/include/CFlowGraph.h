@@ -5,34 +5,174 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // C API for FlowGraph to enable Swift interop
+//
+// Values cross the API as FlowGraphValue structs. Parameters are passed as
+// arrays in PARAMS order and return values are read in RETURNS order from
+// buffers owned by the context, batch or scheduler that produced them; they
+// stay valid until that object runs its next execution. Strings in those
+// buffers are copied into storage that keeps its capacity, so repeated
+// executions do not allocate for them. Destroy contexts, batches and flows
+// before the engine that loaded them.
 
 typedef struct FlowGraphEngine FlowGraphEngine;
 typedef struct FlowGraphFlow FlowGraphFlow;
+typedef struct FlowGraphContext FlowGraphContext;
+typedef struct FlowGraphBatch FlowGraphBatch;
+typedef struct FlowGraphScheduler FlowGraphScheduler;
+typedef struct FlowGraphCall FlowGraphCall;
+
+typedef enum {
+    FLOWGRAPH_VALUE_NONE = 0,   // unset parameter or return value
+    FLOWGRAPH_VALUE_NUMBER,
+    FLOWGRAPH_VALUE_BOOLEAN,
+    FLOWGRAPH_VALUE_STRING
+} FlowGraphValueType;
+
+typedef struct {
+    FlowGraphValueType type;
+    bool boolean;
+    double number;
+    const char* string;   // NUL-terminated when read from the engine
+    size_t length;        // bytes in string, without the terminator
+} FlowGraphValue;
+
+typedef enum {
+    FLOWGRAPH_STATUS_SUCCESS = 0,
+    FLOWGRAPH_STATUS_ERROR,
+    FLOWGRAPH_STATUS_SUSPENDED   // waiting for an async PROC, see flowgraph_resume()
+} FlowGraphStatus;
+
+static inline FlowGraphValue flowgraph_number(double number) {
+    FlowGraphValue value = {FLOWGRAPH_VALUE_NUMBER, false, number, NULL, 0};
+    return value;
+}
+
+static inline FlowGraphValue flowgraph_boolean(bool boolean) {
+    FlowGraphValue value = {FLOWGRAPH_VALUE_BOOLEAN, boolean, 0, NULL, 0};
+    return value;
+}
+
+static inline FlowGraphValue flowgraph_string(const char* string, size_t length) {
+    FlowGraphValue value = {FLOWGRAPH_VALUE_STRING, false, 0, string, length};
+    return value;
+}
 
 // Engine management
 FlowGraphEngine* flowgraph_engine_create(void);
 void flowgraph_engine_destroy(FlowGraphEngine* engine);
 
-// Flow loading and execution
+// Error of the last failed load, parse or registration on this engine, NULL if none
+const char* flowgraph_engine_error(const FlowGraphEngine* engine);
+
+// External procedures
+//
+// The procedure reads its inputs while it runs and completes the call with
+// flowgraph_call_complete() or flowgraph_call_fail(), either before it
+// returns or later from any thread; an execution suspends until then.
+typedef void (*FlowGraphProcedure)(void* userData, FlowGraphCall* call);
+
+bool flowgraph_register_procedure(FlowGraphEngine* engine, const char* name, FlowGraphProcedure procedure,
+                                  void* userData);
+
+// Input bound to the PROC parameter name (type NONE if not bound); valid while the procedure runs
+FlowGraphValue flowgraph_call_input(const FlowGraphCall* call, const char* name);
+void flowgraph_call_set_output(FlowGraphCall* call, const char* name, FlowGraphValue value);
+
+// Finish the call; the call object is released and must not be used afterwards
+void flowgraph_call_complete(FlowGraphCall* call);
+void flowgraph_call_fail(FlowGraphCall* call, const char* error);
+
+// Flow loading and metadata
+//
+// Loading fails if the flow calls a procedure that is not registered yet.
 FlowGraphFlow* flowgraph_load_flow(FlowGraphEngine* engine, const char* filepath);
 FlowGraphFlow* flowgraph_parse_flow(FlowGraphEngine* engine, const char* content, const char* name);
 void flowgraph_flow_destroy(FlowGraphFlow* flow);
 
-// Execution
 typedef struct {
-    bool success;
-    const char* error;
-    // TODO: Add parameter/return value handling
-} FlowGraphResult;
+    const char* name;
+    const char* comment;
+    FlowGraphValueType type;
+    bool optional;
+} FlowGraphParameterInfo;
 
-FlowGraphResult flowgraph_execute_flow(FlowGraphFlow* flow);
+const char* flowgraph_flow_title(const FlowGraphFlow* flow);
+size_t flowgraph_flow_param_count(const FlowGraphFlow* flow);
+FlowGraphParameterInfo flowgraph_flow_param(const FlowGraphFlow* flow, size_t index);
+size_t flowgraph_flow_return_count(const FlowGraphFlow* flow);
+FlowGraphParameterInfo flowgraph_flow_return(const FlowGraphFlow* flow, size_t index);
 
-// Cleanup
-void flowgraph_result_destroy(FlowGraphResult* result);
+// Reusable execution contexts
+//
+// params holds paramCount values in PARAMS order; missing trailing and NONE
+// values leave the parameter unset. A context runs one execution at a time:
+// while it waits for a pending call, starting it again fails. A context may
+// be destroyed with a call pending; the call can still be completed.
+FlowGraphContext* flowgraph_context_create(FlowGraphFlow* flow);
+void flowgraph_context_destroy(FlowGraphContext* context);
+
+// Run to the end; async PROCs that do not complete synchronously fail the execution
+FlowGraphStatus flowgraph_execute(FlowGraphContext* context, const FlowGraphValue* params, size_t paramCount);
+
+// Run until the end or the first async PROC that does not complete synchronously
+FlowGraphStatus flowgraph_start(FlowGraphContext* context, const FlowGraphValue* params, size_t paramCount);
+
+// Continue a suspended execution; SUSPENDED again while its PROC is pending
+FlowGraphStatus flowgraph_resume(FlowGraphContext* context);
+
+// Called once on the completing thread when a suspended execution's PROC completes;
+// it must hand the notification over to the thread that calls flowgraph_resume()
+typedef void (*FlowGraphResumeCallback)(void* userData);
+void flowgraph_context_set_resume_callback(FlowGraphContext* context, FlowGraphResumeCallback callback,
+                                           void* userData);
+
+// Error of the last execution, NULL if it succeeded
+const char* flowgraph_context_error(const FlowGraphContext* context);
+
+// flowgraph_flow_return_count() values of the last successful execution
+const FlowGraphValue* flowgraph_context_returns(const FlowGraphContext* context);
+
+// Batch execution
+//
+// params holds count * paramCount values, one row per execution.
+// threadCount 0 uses the hardware concurrency, 1 the calling thread. Rows
+// that suspend on an async PROC fail; their calls may still be completed.
+FlowGraphBatch* flowgraph_batch_create(FlowGraphFlow* flow);
+void flowgraph_batch_destroy(FlowGraphBatch* batch);
+
+// SUCCESS if every execution succeeded
+FlowGraphStatus flowgraph_batch_execute(FlowGraphBatch* batch, const FlowGraphValue* params, size_t paramCount,
+                                        size_t count, size_t threadCount);
+
+const char* flowgraph_batch_error(const FlowGraphBatch* batch, size_t index);
+const FlowGraphValue* flowgraph_batch_returns(const FlowGraphBatch* batch, size_t index);
+
+// Scheduler for executions waiting on async PROCs
+//
+// Completion callbacks run on the thread that polls; error and returns are
+// valid for the duration of the callback.
+typedef void (*FlowGraphCompletion)(void* userData, uint64_t task, FlowGraphStatus status, const char* error,
+                                    const FlowGraphValue* returns, size_t returnCount);
+
+FlowGraphScheduler* flowgraph_scheduler_create(void);
+void flowgraph_scheduler_destroy(FlowGraphScheduler* scheduler);
+
+// Steps an execution may run before others get a turn, 0 to run each one as far as it goes
+void flowgraph_scheduler_set_time_slice(FlowGraphScheduler* scheduler, size_t steps);
+
+uint64_t flowgraph_scheduler_submit(FlowGraphScheduler* scheduler, FlowGraphFlow* flow, const FlowGraphValue* params,
+                                    size_t paramCount, FlowGraphCompletion completion, void* userData);
+
+// Number of executions that finished
+size_t flowgraph_scheduler_poll(FlowGraphScheduler* scheduler);
+size_t flowgraph_scheduler_run_frame(FlowGraphScheduler* scheduler, uint64_t budgetMicroseconds);
+size_t flowgraph_scheduler_run(FlowGraphScheduler* scheduler);
+size_t flowgraph_scheduler_in_flight(const FlowGraphScheduler* scheduler);
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
@@ -1,10 +1,19 @@
 import Foundation
+import CFlowGraph
 
 /// Value types supported by FlowGraph (unified with C++ implementation)
 public enum FlowGraphValueType {
     case number   // Unified number type (replaces integer/float distinction)
     case boolean
     case string
+
+    init(_ type: CFlowGraph.FlowGraphValueType) {
+        switch type {
+        case FLOWGRAPH_VALUE_BOOLEAN: self = .boolean
+        case FLOWGRAPH_VALUE_STRING: self = .string
+        default: self = .number
+        }
+    }
 }
 
 /// Parameter or return value definition
@@ -13,13 +22,18 @@ public struct FlowGraphParameter {
     public let type: FlowGraphValueType
     public let comment: String
     public let optional: Bool
-    
+
     public init(name: String, type: FlowGraphValueType, comment: String = "", optional: Bool = false) {
         self.name = name
         self.type = type
         self.comment = comment
         self.optional = optional
     }
+
+    init(_ info: FlowGraphParameterInfo) {
+        self.init(name: String(cString: info.name), type: FlowGraphValueType(info.type),
+                  comment: String(cString: info.comment), optional: info.optional)
+    }
 }
 
 /// FlowGraph runtime value - can hold number, boolean, or string
@@ -27,7 +41,7 @@ public enum FlowGraphValue {
     case number(Double)
     case boolean(Bool)
     case string(String)
-    
+
     public var type: FlowGraphValueType {
         switch self {
         case .number: return .number
@@ -35,54 +49,405 @@ public enum FlowGraphValue {
         case .string: return .string
         }
     }
+
+    /// Copy of a value read from the engine, nil if it is unset
+    init?(_ value: CFlowGraph.FlowGraphValue) {
+        switch value.type {
+        case FLOWGRAPH_VALUE_NUMBER: self = .number(value.number)
+        case FLOWGRAPH_VALUE_BOOLEAN: self = .boolean(value.boolean)
+        case FLOWGRAPH_VALUE_STRING: self = .string(String(decoding: utf8Bytes(value), as: UTF8.self))
+        default: return nil
+        }
+    }
+}
+
+/// Bytes of a String value read from the engine, without copying
+func utf8Bytes(_ value: CFlowGraph.FlowGraphValue) -> UnsafeBufferPointer<UInt8> {
+    guard value.type == FLOWGRAPH_VALUE_STRING, let string = value.string else {
+        return UnsafeBufferPointer(start: nil, count: 0)
+    }
+    return UnsafeBufferPointer(start: UnsafeRawPointer(string).assumingMemoryBound(to: UInt8.self), count: value.length)
+}
+
+/// Pass values to the C API; strings point into one buffer that lives for the duration of body
+func withCValues<R>(_ values: [FlowGraphValue?],
+                    _ body: (UnsafeBufferPointer<CFlowGraph.FlowGraphValue>) throws -> R) rethrows -> R {
+    var bytes: [UInt8] = []
+    for case .string(let text)? in values {
+        bytes.append(contentsOf: text.utf8)
+    }
+    return try bytes.withUnsafeBufferPointer { storage in
+        let base = UnsafeRawPointer(storage.baseAddress)?.assumingMemoryBound(to: CChar.self)
+        var offset = 0
+        let converted = values.map { value -> CFlowGraph.FlowGraphValue in
+            switch value {
+            case .number(let number)?:
+                return flowgraph_number(number)
+            case .boolean(let boolean)?:
+                return flowgraph_boolean(boolean)
+            case .string(let text)?:
+                let length = text.utf8.count
+                defer { offset += length }
+                return flowgraph_string(base.map { $0 + offset }, length)
+            case nil:
+                return CFlowGraph.FlowGraphValue()
+            }
+        }
+        return try converted.withUnsafeBufferPointer(body)
+    }
+}
+
+/// Return values of an execution, read in place from engine-owned buffers
+///
+/// Valid until the context, batch or scheduler that produced them runs its
+/// next execution. Numbers and booleans are read without copying; string(at:)
+/// copies into a Swift String, utf8(at:) does not.
+public struct FlowGraphReturnValues: RandomAccessCollection {
+    let buffer: UnsafeBufferPointer<CFlowGraph.FlowGraphValue>
+    let names: [FlowGraphParameter]
+    let owner: AnyObject?
+
+    public var startIndex: Int { buffer.startIndex }
+    public var endIndex: Int { buffer.endIndex }
+
+    /// Value at a RETURNS position, nil if it is unset
+    public subscript(position: Int) -> FlowGraphValue? { FlowGraphValue(buffer[position]) }
+
+    /// Value of a named return value, nil if it is unset or not declared
+    public subscript(name: String) -> FlowGraphValue? {
+        guard let position = names.firstIndex(where: { $0.name == name }) else { return nil }
+        return self[position]
+    }
+
+    public func isSet(at position: Int) -> Bool { buffer[position].type != FLOWGRAPH_VALUE_NONE }
+    public func number(at position: Int) -> Double { buffer[position].number }
+    public func boolean(at position: Int) -> Bool { buffer[position].boolean }
+
+    /// UTF-8 bytes of a String return value, without copying
+    public func utf8(at position: Int) -> UnsafeBufferPointer<UInt8> { utf8Bytes(buffer[position]) }
+
+    public func string(at position: Int) -> String? {
+        let bytes = utf8(at: position)
+        return bytes.baseAddress == nil ? nil : String(decoding: bytes, as: UTF8.self)
+    }
+
+    /// Copy into a dictionary keyed by return value name
+    public func dictionary() -> [String: FlowGraphValue] {
+        var values: [String: FlowGraphValue] = [:]
+        for (position, parameter) in names.enumerated() {
+            values[parameter.name] = self[position]
+        }
+        return values
+    }
+}
+
+/// Outcome of starting or resuming an execution
+public enum FlowGraphExecutionStatus: Equatable {
+    case success
+    case failure(String)
+    case suspended   // waiting for an async procedure; resume() continues it
+}
+
+/// Call of an external procedure
+///
+/// Read inputs while the procedure runs; set outputs and complete or fail the
+/// call exactly once, right away or later from any thread.
+public struct FlowGraphCall {
+    let handle: OpaquePointer
+
+    public func input(_ name: String) -> FlowGraphValue? {
+        FlowGraphValue(flowgraph_call_input(handle, name))
+    }
+
+    public func setOutput(_ name: String, _ value: FlowGraphValue) {
+        withCValues([value]) { flowgraph_call_set_output(handle, name, $0[0]) }
+    }
+
+    public func complete() { flowgraph_call_complete(handle) }
+    public func fail(_ error: String) { flowgraph_call_fail(handle, error) }
+}
+
+final class Box<T> {
+    let value: T
+    init(_ value: T) { self.value = value }
 }
 
 /// Swift wrapper for FlowGraph engine
-public class FlowGraphEngine {
-    
+public final class FlowGraphEngine {
+    let handle: OpaquePointer
+    private var procedures: [Unmanaged<Box<(FlowGraphCall) -> Void>>] = []
+
     public init() {
-        // TODO: Initialize C++ engine when implementation is complete
+        handle = flowgraph_engine_create()
+    }
+
+    deinit {
+        flowgraph_engine_destroy(handle)
+        procedures.forEach { $0.release() }
+    }
+
+    private var lastError: String {
+        flowgraph_engine_error(handle).map { String(cString: $0) } ?? ""
     }
-    
+
     /// Load a flow from a file
     public func loadFlow(from filepath: String) throws -> FlowGraphFlow {
-        // TODO: Implement when C++ core is complete
-        throw FlowGraphError.loadFailed("C++ implementation not yet connected")
+        guard let flow = flowgraph_load_flow(handle, filepath) else {
+            throw FlowGraphError.loadFailed(lastError)
+        }
+        return FlowGraphFlow(handle: flow, engine: self)
     }
-    
+
     /// Parse a flow from string content
     public func parseFlow(content: String, name: String = "") throws -> FlowGraphFlow {
-        // TODO: Implement when C++ core is complete
-        throw FlowGraphError.parseFailed("C++ implementation not yet connected")
+        guard let flow = flowgraph_parse_flow(handle, content, name) else {
+            throw FlowGraphError.parseFailed(lastError)
+        }
+        return FlowGraphFlow(handle: flow, engine: self)
     }
-    
-    /// Register an external procedure (for future implementation)
-    public func registerProcedure(name: String, implementation: @escaping ([String: FlowGraphValue]) -> [String: FlowGraphValue]) {
-        // TODO: Implement when C++ core is complete
+
+    /// Register an external procedure that completes its calls itself, possibly asynchronously
+    public func registerProcedure(name: String, implementation: @escaping (FlowGraphCall) -> Void) {
+        let box = Unmanaged.passRetained(Box(implementation))
+        procedures.append(box)
+        flowgraph_register_procedure(handle, name, { userData, call in
+            let implementation = Unmanaged<Box<(FlowGraphCall) -> Void>>.fromOpaque(userData!).takeUnretainedValue()
+            implementation.value(FlowGraphCall(handle: call!))
+        }, box.toOpaque())
+    }
+
+    /// Register a synchronous external procedure
+    public func registerProcedure(name: String, inputs: [String],
+                                  implementation: @escaping ([String: FlowGraphValue]) -> [String: FlowGraphValue]) {
+        registerProcedure(name: name) { call in
+            var values: [String: FlowGraphValue] = [:]
+            for input in inputs {
+                values[input] = call.input(input)
+            }
+            for (output, value) in implementation(values) {
+                call.setOutput(output, value)
+            }
+            call.complete()
+        }
     }
 }
 
 /// Represents a loaded and ready-to-execute flow
-public class FlowGraphFlow {
-    
-    internal init() {
-        // TODO: Implement when C++ core is complete
+public final class FlowGraphFlow {
+    let handle: OpaquePointer
+    let engine: FlowGraphEngine   // flows must not outlive their engine
+    public let title: String
+    public let parameters: [FlowGraphParameter]
+    public let returnValues: [FlowGraphParameter]
+
+    init(handle: OpaquePointer, engine: FlowGraphEngine) {
+        self.handle = handle
+        self.engine = engine
+        title = String(cString: flowgraph_flow_title(handle))
+        parameters = (0..<flowgraph_flow_param_count(handle)).map {
+            FlowGraphParameter(flowgraph_flow_param(handle, $0))
+        }
+        returnValues = (0..<flowgraph_flow_return_count(handle)).map {
+            FlowGraphParameter(flowgraph_flow_return(handle, $0))
+        }
+    }
+
+    deinit {
+        flowgraph_flow_destroy(handle)
+    }
+
+    /// Reusable context for executions of this flow
+    public func makeContext() -> FlowGraphContext { FlowGraphContext(flow: self) }
+
+    /// Context for executing many parameter sets at once
+    public func makeBatch() -> FlowGraphBatch { FlowGraphBatch(flow: self) }
+
+    /// Parameters in PARAMS order, nil for the ones not in the dictionary
+    func positional(_ parameters: [String: FlowGraphValue]) -> [FlowGraphValue?] {
+        self.parameters.map { parameters[$0.name] }
     }
-    
-    /// Execute the flow with parameters
+
+    /// Execute the flow with parameters, copying the return values into the result
+    ///
+    /// Creates a context per call; reuse one from makeContext() to execute without copies.
     public func execute(parameters: [String: FlowGraphValue] = [:]) -> FlowGraphResult {
-        // TODO: Implement when C++ core is complete
-        return FlowGraphResult(
-            success: false,
-            error: "C++ implementation not yet connected",
-            returnValues: [:]
-        )
+        let context = makeContext()
+        if case .failure(let error) = context.execute(positional(parameters)) {
+            return FlowGraphResult(success: false, error: error)
+        }
+        return FlowGraphResult(success: true, error: nil, returnValues: context.returnValues.dictionary())
+    }
+}
+
+/// Reusable execution context: runs one execution at a time and owns its return values
+public final class FlowGraphContext {
+    let handle: OpaquePointer
+    public let flow: FlowGraphFlow
+    private var resumeHandler: Unmanaged<Box<() -> Void>>?
+
+    init(flow: FlowGraphFlow) {
+        self.flow = flow
+        handle = flowgraph_context_create(flow.handle)
+    }
+
+    deinit {
+        flowgraph_context_destroy(handle)
+        resumeHandler?.release()
+    }
+
+    private func status(_ status: FlowGraphStatus) -> FlowGraphExecutionStatus {
+        switch status {
+        case FLOWGRAPH_STATUS_SUCCESS: return .success
+        case FLOWGRAPH_STATUS_SUSPENDED: return .suspended
+        default: return .failure(error ?? "")
+        }
+    }
+
+    /// Run to the end with parameters in PARAMS order; async procedures fail the execution
+    @discardableResult
+    public func execute(_ parameters: [FlowGraphValue?]) -> FlowGraphExecutionStatus {
+        status(withCValues(parameters) { flowgraph_execute(handle, $0.baseAddress, $0.count) })
+    }
+
+    /// Run until the end or the first procedure that does not complete right away
+    @discardableResult
+    public func start(_ parameters: [FlowGraphValue?]) -> FlowGraphExecutionStatus {
+        status(withCValues(parameters) { flowgraph_start(handle, $0.baseAddress, $0.count) })
+    }
+
+    /// Continue a suspended execution once its procedure completed
+    @discardableResult
+    public func resume() -> FlowGraphExecutionStatus {
+        status(flowgraph_resume(handle))
+    }
+
+    /// Called on the completing thread when the procedure a suspended execution waits for completes
+    public func onResumable(_ handler: (() -> Void)?) {
+        resumeHandler?.release()
+        resumeHandler = nil
+        guard let handler = handler else {
+            flowgraph_context_set_resume_callback(handle, nil, nil)
+            return
+        }
+        let box = Unmanaged.passRetained(Box(handler))
+        resumeHandler = box
+        flowgraph_context_set_resume_callback(handle, { userData in
+            Unmanaged<Box<() -> Void>>.fromOpaque(userData!).takeUnretainedValue().value()
+        }, box.toOpaque())
+    }
+
+    /// Error of the last execution, nil if it succeeded
+    public var error: String? {
+        flowgraph_context_error(handle).map { String(cString: $0) }
+    }
+
+    /// Return values of the last successful execution, valid until the next one
+    public var returnValues: FlowGraphReturnValues {
+        FlowGraphReturnValues(buffer: UnsafeBufferPointer(start: flowgraph_context_returns(handle),
+                                                          count: flow.returnValues.count),
+                              names: flow.returnValues, owner: self)
+    }
+}
+
+/// Executes a flow for many parameter sets and owns all their return values
+public final class FlowGraphBatch {
+    let handle: OpaquePointer
+    public let flow: FlowGraphFlow
+    public private(set) var count = 0
+
+    init(flow: FlowGraphFlow) {
+        self.flow = flow
+        handle = flowgraph_batch_create(flow.handle)
+    }
+
+    deinit {
+        flowgraph_batch_destroy(handle)
+    }
+
+    /// Execute every row of parameters (PARAMS order); threadCount 0 uses the hardware concurrency
+    /// - Returns: true if every execution succeeded
+    @discardableResult
+    public func execute(_ rows: [[FlowGraphValue?]], threadCount: Int = 1) -> Bool {
+        let width = flow.parameters.count
+        var values: [FlowGraphValue?] = []
+        values.reserveCapacity(rows.count * width)
+        for row in rows {
+            values.append(contentsOf: row.prefix(width))
+            values.append(contentsOf: repeatElement(nil, count: max(0, width - row.count)))
+        }
+        count = rows.count
+        return withCValues(values) {
+            flowgraph_batch_execute(handle, $0.baseAddress, width, rows.count, threadCount)
+        } == FLOWGRAPH_STATUS_SUCCESS
+    }
+
+    public func error(at index: Int) -> String? {
+        flowgraph_batch_error(handle, index).map { String(cString: $0) }
+    }
+
+    public func returnValues(at index: Int) -> FlowGraphReturnValues {
+        FlowGraphReturnValues(buffer: UnsafeBufferPointer(start: flowgraph_batch_returns(handle, index),
+                                                          count: flow.returnValues.count),
+                              names: flow.returnValues, owner: self)
     }
-    
-    /// Get flow metadata (for future implementation)
-    public var title: String { "" }
-    public var parameters: [FlowGraphParameter] { [] }
-    public var returnValues: [FlowGraphParameter] { [] }
+}
+
+/// Runs executions that wait on async procedures, reporting each through its completion handler
+///
+/// Handlers run on the thread calling poll(), runFrame() or run(); the
+/// return values they get are only valid during the call.
+public final class FlowGraphScheduler {
+    public typealias Completion = (_ task: UInt64, _ error: String?, _ returnValues: FlowGraphReturnValues) -> Void
+
+    private struct Pending {
+        let completion: Completion
+        let flow: FlowGraphFlow   // kept alive while in flight
+    }
+
+    let handle: OpaquePointer
+
+    public init() {
+        handle = flowgraph_scheduler_create()
+    }
+
+    deinit {
+        flowgraph_scheduler_destroy(handle)
+    }
+
+    /// Nodes an execution runs before the next one's turn, 0 for no limit
+    public func setTimeSlice(_ steps: Int) {
+        flowgraph_scheduler_set_time_slice(handle, steps)
+    }
+
+    @discardableResult
+    public func submit(_ flow: FlowGraphFlow, parameters: [FlowGraphValue?],
+                       completion: @escaping Completion) -> UInt64 {
+        let box = Unmanaged.passRetained(Box(Pending(completion: completion, flow: flow)))
+        return withCValues(parameters) {
+            flowgraph_scheduler_submit(handle, flow.handle, $0.baseAddress, $0.count, { userData, task, _, error, returns, count in
+                let pending = Unmanaged<Box<Pending>>.fromOpaque(userData!).takeRetainedValue().value
+                let values = FlowGraphReturnValues(buffer: UnsafeBufferPointer(start: returns, count: count),
+                                                   names: pending.flow.returnValues, owner: nil)
+                pending.completion(task, error.map { String(cString: $0) }, values)
+            }, box.toOpaque())
+        }
+    }
+
+    /// Resume executions whose procedures completed; returns how many finished
+    @discardableResult
+    public func poll() -> Int { flowgraph_scheduler_poll(handle) }
+
+    /// Like poll(), but start no node once the budget has passed
+    @discardableResult
+    public func runFrame(budget: TimeInterval) -> Int {
+        flowgraph_scheduler_run_frame(handle, UInt64(max(0, budget) * 1_000_000))
+    }
+
+    /// Block until all executions have finished
+    @discardableResult
+    public func run() -> Int { flowgraph_scheduler_run(handle) }
+
+    public var inFlight: Int { flowgraph_scheduler_in_flight(handle) }
 }
 
 /// Result of flow execution
@@ -90,7 +455,7 @@ public struct FlowGraphResult {
     public let success: Bool
     public let error: String?
     public let returnValues: [String: FlowGraphValue]
-    
+
     internal init(success: Bool, error: String?, returnValues: [String: FlowGraphValue] = [:]) {
         self.success = success
         self.error = error
@@ -103,7 +468,7 @@ public enum FlowGraphError: Error, LocalizedError {
     case loadFailed(String)
     case parseFailed(String)
     case executionFailed(String)
-    
+
     public var errorDescription: String? {
         switch self {
         case .loadFailed(let message):
@@ -114,4 +479,4 @@ public enum FlowGraphError: Error, LocalizedError {
             return "Execution failed: \(message)"
         }
     }
-}
\ No newline at end of file
+}
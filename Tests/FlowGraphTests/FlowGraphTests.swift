@@ -35,43 +35,148 @@ final class FlowGraphTests: XCTestCase {
         XCTAssertFalse(param.optional)
     }
     
-    func testFlowExecutionStub() {
-        // Test that the stub implementation works correctly
+    static let greetFlow = """
+    TITLE: Greet
+    PARAMS:
+    S name
+    N count
+    RETURNS:
+    S message
+    N total
+    ERRORS:
+    EMPTY
+    NODES:
+    10 COND count > 0
+    20 ASSIGN S message "Hello " + name
+    30 ASSIGN N total count * 2
+    FLOW:
+    START -> 10
+    10.Y -> 20
+    10.N -> EMPTY
+    20 -> 30
+    30 -> END
+    """
+    
+    static let doubleFlow = """
+    TITLE: Double
+    PARAMS:
+    N value
+    RETURNS:
+    N result
+    NODES:
+    10 PROC double value>>in result<<out
+    FLOW:
+    START -> 10
+    10 -> END
+    """
+    
+    func testFlowExecution() throws {
         let engine = FlowGraphEngine()
+        let flow = try engine.parseFlow(content: Self.greetFlow, name: "greet.flow")
+        XCTAssertEqual(flow.title, "Greet")
+        XCTAssertEqual(flow.parameters.map { $0.name }, ["name", "count"])
+        XCTAssertEqual(flow.parameters[0].type, .string)
+        XCTAssertEqual(flow.returnValues.map { $0.name }, ["message", "total"])
         
-        do {
-            _ = try engine.loadFlow(from: "test.flow")
-            XCTFail("Should have thrown an error")
-        } catch FlowGraphError.loadFailed(let message) {
-            XCTAssertEqual(message, "C++ implementation not yet connected")
-        } catch {
-            XCTFail("Wrong error type")
+        let result = flow.execute(parameters: ["name": .string("Ada"), "count": .number(3)])
+        XCTAssertTrue(result.success)
+        XCTAssertNil(result.error)
+        guard case .string(let message)? = result.returnValues["message"] else {
+            return XCTFail("Missing message")
         }
+        XCTAssertEqual(message, "Hello Ada")
+        
+        let failed = flow.execute(parameters: ["name": .string("Ada"), "count": .number(0)])
+        XCTAssertFalse(failed.success)
+        XCTAssertEqual(failed.error, "EMPTY")
+        XCTAssertTrue(failed.returnValues.isEmpty)
+    }
+    
+    func testContextReadsReturnValuesInPlace() throws {
+        let engine = FlowGraphEngine()
+        let context = try engine.parseFlow(content: Self.greetFlow).makeContext()
+        
+        XCTAssertEqual(context.execute([.string("Ada"), .number(2)]), .success)
+        XCTAssertEqual(context.returnValues.string(at: 0), "Hello Ada")
+        XCTAssertEqual(context.returnValues.number(at: 1), 4)
         
-        do {
-            _ = try engine.parseFlow(content: "TITLE: Test", name: "test")
-            XCTFail("Should have thrown an error")
-        } catch FlowGraphError.parseFailed(let message) {
-            XCTAssertEqual(message, "C++ implementation not yet connected")
-        } catch {
-            XCTFail("Wrong error type")
+        let storage = context.returnValues.utf8(at: 0).baseAddress
+        XCTAssertEqual(context.execute([.string("Bob"), .number(1)]), .success)
+        XCTAssertEqual(context.returnValues.utf8(at: 0).baseAddress, storage)
+        XCTAssertEqual(context.returnValues.string(at: 0), "Hello Bob")
+        
+        XCTAssertEqual(context.execute([.string("Bob"), .number(0)]), .failure("EMPTY"))
+        XCTAssertFalse(context.returnValues.isSet(at: 0))
+    }
+    
+    func testProcedures() throws {
+        let engine = FlowGraphEngine()
+        engine.registerProcedure(name: "double", inputs: ["in"]) { inputs in
+            guard case .number(let value)? = inputs["in"] else { return [:] }
+            return ["out": .number(value * 2)]
+        }
+        let flow = try engine.parseFlow(content: Self.doubleFlow)
+        let result = flow.execute(parameters: ["value": .number(21)])
+        XCTAssertTrue(result.success)
+        guard case .number(let doubled)? = result.returnValues["result"] else {
+            return XCTFail("Missing result")
         }
+        XCTAssertEqual(doubled, 42)
     }
     
-    // Test flow execution with parameters
-    func testFlowExecutionWithParameters() {
-        // This will test the API design even though implementation is stubbed
-        let flow = FlowGraphFlow()
-        let parameters: [String: FlowGraphValue] = [
-            "input": .number(42.0),
-            "flag": .boolean(true),
-            "name": .string("test")
-        ]
+    func testAsyncProcedureResumes() throws {
+        let engine = FlowGraphEngine()
+        var pending: FlowGraphCall?
+        engine.registerProcedure(name: "double") { call in pending = call }
+        let context = try engine.parseFlow(content: Self.doubleFlow).makeContext()
+        var resumable = 0
+        context.onResumable { resumable += 1 }
+        
+        XCTAssertEqual(context.start([.number(5)]), .suspended)
+        XCTAssertEqual(context.resume(), .suspended)
+        pending?.setOutput("out", .number(10))
+        pending?.complete()
+        XCTAssertEqual(resumable, 1)
+        XCTAssertEqual(context.resume(), .success)
+        XCTAssertEqual(context.returnValues.number(at: 0), 10)
+    }
+    
+    func testBatchExecution() throws {
+        let engine = FlowGraphEngine()
+        let batch = try engine.parseFlow(content: Self.greetFlow).makeBatch()
+        let rows: [[FlowGraphValue?]] = (0..<50).map { [.string("x"), .number(Double($0 % 5))] }
+        
+        XCTAssertFalse(batch.execute(rows, threadCount: 4))
+        XCTAssertEqual(batch.count, 50)
+        for index in 0..<50 {
+            if index % 5 == 0 {
+                XCTAssertEqual(batch.error(at: index), "EMPTY")
+            } else {
+                XCTAssertNil(batch.error(at: index))
+                XCTAssertEqual(batch.returnValues(at: index).number(at: 1), Double(index % 5) * 2)
+            }
+        }
+    }
+    
+    func testSchedulerCompletion() throws {
+        let engine = FlowGraphEngine()
+        var pending: FlowGraphCall?
+        engine.registerProcedure(name: "double") { call in pending = call }
+        let flow = try engine.parseFlow(content: Self.doubleFlow)
+        let scheduler = FlowGraphScheduler()
+        
+        var results: [Double] = []
+        scheduler.submit(flow, parameters: [.number(4)]) { _, error, values in
+            XCTAssertNil(error)
+            results.append(values.number(at: 0))
+        }
+        XCTAssertEqual(scheduler.inFlight, 1)
+        XCTAssertEqual(scheduler.poll(), 0)
         
-        let result = flow.execute(parameters: parameters)
-        XCTAssertFalse(result.success)
-        XCTAssertEqual(result.error, "C++ implementation not yet connected")
-        XCTAssertTrue(result.returnValues.isEmpty)
+        pending?.setOutput("out", .number(8))
+        pending?.complete()
+        XCTAssertEqual(scheduler.poll(), 1)
+        XCTAssertEqual(results, [8])
     }
     
     func testValueTypeSystem() {
@@ -134,7 +239,7 @@ final class FlowGraphTests: XCTestCase {
                 _ = try engine.loadFlow(from: filename)
                 XCTFail("Should have thrown error for: \(description)")
             } catch FlowGraphError.loadFailed(let message) {
-                XCTAssertEqual(message, "C++ implementation not yet connected")
+                XCTAssertFalse(message.isEmpty)
             } catch {
                 XCTFail("Wrong error type for: \(description)")
             }
@@ -142,9 +247,8 @@ final class FlowGraphTests: XCTestCase {
         
         // Test parse flow error conditions
         let parseTestCases = [
-            ("", ""),
-            ("INVALID CONTENT", "invalid"),
-            ("TITLE: Test\nINVALID", "test_partial")
+            ("NODES:\n10 BOGUS", "invalid"),
+            ("INVALID CONTENT", "test_partial")
         ]
         
         for (content, name) in parseTestCases {
@@ -152,10 +256,10 @@ final class FlowGraphTests: XCTestCase {
                 _ = try engine.parseFlow(content: content, name: name)
                 XCTFail("Should have thrown error for content: \(content)")
             } catch FlowGraphError.parseFailed(let message) {
-                XCTAssertEqual(message, "C++ implementation not yet connected")
+                XCTAssertFalse(message.isEmpty)
             } catch {
                 XCTFail("Wrong error type for content: \(content)")
             }
         }
     }
-}
\ No newline at end of file
+}
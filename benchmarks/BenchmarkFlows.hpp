@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+
+namespace bench {
+
+/**
+ * @brief Straight-line flow of nodeCount arithmetic ASSIGN nodes on the parameter x
+ */
+inline std::string assignChainFlow(size_t nodeCount) {
+    std::string nodes;
+    std::string connections = "START -> 1\n";
+    for (size_t i = 1; i <= nodeCount; ++i) {
+        std::string id = std::to_string(i);
+        nodes += id + (i == 1 ? std::string(" ASSIGN N y x\n") : " ASSIGN N y y * 0.5 + x - " + id + "\n");
+        connections += id + " -> " + (i == nodeCount ? std::string("END") : std::to_string(i + 1)) + "\n";
+    }
+    return "TITLE: Assign chain\n\nPARAMS:\nN x\n\nRETURNS:\nN y\n\nNODES:\n" + nodes + "\nFLOW:\n" + connections;
+}
+
+/**
+ * @brief Counts from 0 to the parameter limit through a COND loop
+ */
+inline std::string countingLoopFlow() {
+    return R"(
+TITLE: Counting loop
+
+PARAMS:
+N limit
+
+RETURNS:
+N count
+
+NODES:
+10 ASSIGN N count 0
+20 COND count < limit
+30 ASSIGN N count count + 1
+
+FLOW:
+START -> 10
+10 -> 20
+20.Y -> 30
+20.N -> END
+30 -> 20
+)";
+}
+
+/**
+ * @brief COND loop calling the procedure "add" limit times
+ */
+inline std::string procLoopFlow() {
+    return R"(
+TITLE: Procedure loop
+
+PARAMS:
+N limit
+
+RETURNS:
+N count
+N total
+
+NODES:
+10 ASSIGN N count 0
+15 ASSIGN N total 0
+20 COND count < limit
+30 PROC add total>>a count>>b total<<sum
+40 ASSIGN N count count + 1
+
+FLOW:
+START -> 10
+10 -> 15
+15 -> 20
+20.Y -> 30
+20.N -> END
+30 -> 40
+40 -> 20
+)";
+}
+
+} // namespace bench
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief Shape of a synthetic flow made by generateFlow()
+ */
+struct FlowShape {
+    size_t nodes = 1000;            // exact number of nodes, at least variables + 1
+    size_t variables = 8;           // Number variables v0..v{n-1}, next to the parameter x
+    size_t branchFactor = 2;        // arms of a branch, chosen by a cascade of branchFactor - 1 CONDs
+    size_t loopDepth = 1;           // maximum nesting of COND loops
+    size_t loopTrips = 2;           // iterations of every loop
+    size_t expressionTerms = 3;     // operands of every ASSIGN expression and COND condition
+    double procDensity = 0.1;       // fraction of simple statements that are PROC calls of "work"
+    double branchDensity = 0.1;     // chance of a branch where one fits
+    double loopDensity = 0.05;      // chance of a loop where one fits
+    uint32_t seed = 1;
+};
+
+/**
+ * @brief Deterministic generator of large structured flows
+ *
+ * The flow is a sequence of statements: ASSIGNs of a number variable,
+ * PROC calls "work v>>a v>>b v<<result", branches whose arms join again and
+ * loops of loopTrips iterations, nested up to loopDepth. Every execution
+ * ends at END with RETURNS "N result". Expressions average their terms, so
+ * values stay bounded however long the flow is. The same shape always gives
+ * the same text, on every platform.
+ *
+ * "work" must be registered to execute the flow, e.g. as
+ * result = a * 0.5 + b * 0.25.
+ */
+class FlowGenerator {
+public:
+    explicit FlowGenerator(const FlowShape& shape)
+        : shape_(shape), random_(shape.seed) {
+        shape_.variables = std::max<size_t>(shape_.variables, 1);
+        shape_.branchFactor = std::max<size_t>(shape_.branchFactor, 2);
+        shape_.expressionTerms = std::max<size_t>(shape_.expressionTerms, 1);
+        shape_.nodes = std::max(shape_.nodes, shape_.variables + 1);
+    }
+
+    std::string generate() {
+        nodes_.clear();
+        connections_ = "START -> 1\n";
+        pending_.clear();
+        nextId_ = 1;
+        procNodes_ = 0;
+
+        // Variables start out defined, so every expression can read them
+        for (size_t i = 0; i < shape_.variables; ++i) {
+            emit("ASSIGN N v" + std::to_string(i) + " x + " + std::to_string(i));
+        }
+        block(shape_.nodes - shape_.variables - 1, 0);
+        emit("ASSIGN N result v0");
+        connections_ += std::to_string(nextId_ - 1) + " -> END\n";
+
+        std::string text = "TITLE: Synthetic flow (" + std::to_string(shape_.nodes) + " nodes)\n\n"
+                           "PARAMS:\nN x\n\nRETURNS:\nN result\n\nNODES:\n";
+        text += nodes_;
+        text += "\nFLOW:\n";
+        text += connections_;
+        return text;
+    }
+
+    /**
+     * @brief PROC nodes of the last generated flow
+     */
+    size_t procNodes() const { return procNodes_; }
+
+private:
+    struct Exit {
+        size_t node;
+        const char* port;   // "" for the default port, "Y" or "N"
+    };
+
+    FlowShape shape_;
+    std::mt19937 random_;
+    std::string nodes_;
+    std::string connections_;
+    std::vector<Exit> pending_;   // exits leading to the next node emitted
+    size_t nextId_ = 1;
+    size_t procNodes_ = 0;
+
+    // Only the raw engine output is specified by the standard; distributions are not portable
+    size_t below(size_t bound) { return bound == 0 ? 0 : static_cast<size_t>(random_() % bound); }
+    bool chance(double probability) { return static_cast<double>(random_()) < probability * 4294967296.0; }
+    std::string variable() { return "v" + std::to_string(below(shape_.variables)); }
+
+    /**
+     * @brief Add a node, connecting the pending exits to it
+     */
+    size_t emit(const std::string& body) {
+        size_t id = nextId_++;
+        std::string name = std::to_string(id);
+        nodes_ += name + " " + body + "\n";
+        for (const Exit& exit : pending_) {
+            connections_ += std::to_string(exit.node) + (*exit.port ? std::string(".") + exit.port : "") + " -> " +
+                            name + "\n";
+        }
+        pending_.assign(1, Exit{id, ""});
+        return id;
+    }
+
+    std::string expression() {
+        std::string text = "(";
+        for (size_t i = 0; i < shape_.expressionTerms; ++i) {
+            if (i > 0) {
+                text += below(2) ? " + " : " - ";
+            }
+            switch (below(3)) {
+                case 0: text += variable(); break;
+                case 1: text += variable() + " * 0.5"; break;
+                default: text += std::to_string(below(10) + 1); break;
+            }
+        }
+        return text + ") / " + std::to_string(shape_.expressionTerms);
+    }
+
+    void simple() {
+        if (chance(shape_.procDensity)) {
+            ++procNodes_;
+            emit("PROC work " + variable() + ">>a " + variable() + ">>b " + variable() + "<<result");
+        } else {
+            emit("ASSIGN N " + variable() + " " + expression());
+        }
+    }
+
+    /**
+     * @brief Emit exactly budget nodes
+     */
+    void block(size_t budget, size_t depth) {
+        const size_t branchMinimum = 2 * shape_.branchFactor - 1;   // CONDs and one node per arm
+        while (budget > 0) {
+            // Compound statements take a bounded share, so nesting stays shallow in large flows
+            size_t share = std::min<size_t>(budget, 4 + below(60));
+            if (depth < shape_.loopDepth && share >= 4 && chance(shape_.loopDensity)) {
+                loop(share, depth);
+            } else if (depth < shape_.loopDepth + 2 && share >= branchMinimum && chance(shape_.branchDensity)) {
+                branch(share, depth);
+            } else {
+                simple();
+                share = 1;
+            }
+            budget -= share;
+        }
+    }
+
+    void loop(size_t budget, size_t depth) {
+        std::string counter = "i" + std::to_string(depth);
+        emit("ASSIGN N " + counter + " 0");
+        size_t bodyEntry = nextId_;
+        block(budget - 3, depth + 1);
+        emit("ASSIGN N " + counter + " " + counter + " + 1");
+        size_t test = emit("COND " + counter + " < " + std::to_string(shape_.loopTrips));
+        connections_ += std::to_string(test) + ".Y -> " + std::to_string(bodyEntry) + "\n";
+        pending_.assign(1, Exit{test, "N"});
+    }
+
+    void branch(size_t budget, size_t depth) {
+        const size_t arms = shape_.branchFactor;
+        size_t armBudget = budget - (arms - 1);
+        std::vector<Exit> joined;
+        for (size_t arm = 0; arm < arms; ++arm) {
+            size_t test = 0;
+            if (arm + 1 < arms) {
+                test = emit("COND " + variable() + " < " + expression());
+                pending_.assign(1, Exit{test, "Y"});
+            }
+            // Every arm gets at least one node, the last one what is left
+            size_t size = arm + 1 < arms ? 1 + below(armBudget - (arms - arm - 1)) / 2 : armBudget;
+            armBudget -= size;
+            block(size, depth + 1);
+            joined.insert(joined.end(), pending_.begin(), pending_.end());
+            pending_.assign(1, Exit{test, "N"});
+        }
+        pending_ = std::move(joined);
+    }
+};
+
+/**
+ * @brief Generate a synthetic flow of the given shape, see FlowGenerator
+ */
+inline std::string generateFlow(const FlowShape& shape) {
+    return FlowGenerator(shape).generate();
+}
+
+} // namespace bench
@@ -0,0 +1,122 @@
+#include <benchmark/benchmark.h>
+#include "flowgraph/FlowGraph.hpp"
+#include "BenchmarkFlows.hpp"
+
+using namespace FlowGraph;
+
+namespace {
+
+Flow compile(Engine& engine, const std::string& source) {
+    Parser parser;
+    return engine.createFlow(parser.parse(source, "bench.flow"));
+}
+
+void registerAdd(Engine& engine) {
+    engine.registerProcedure("add", [](const ParameterMap& params, ProcCompletionCallback& callback) {
+        ParameterMap result;
+        result["sum"] = createValue(params.at("a").asNumber() + params.at("b").asNumber());
+        callback(ProcResult::completedSuccess(std::move(result)));
+    });
+}
+
+void run(benchmark::State& state, const Flow& flow, const ParameterMap& params) {
+    for (auto _ : state) {
+        ExecutionResult result = flow.execute(params);
+        if (!result.success) {
+            state.SkipWithError(result.error.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+void BM_ExecuteAssignChain(benchmark::State& state) {
+    Engine engine;
+    Flow flow = compile(engine, bench::assignChainFlow(static_cast<size_t>(state.range(0))));
+    ParameterMap params;
+    params["x"] = createValue(3.0);
+    run(state, flow, params);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ExecuteAssignChain)->Arg(10)->Arg(100)->Arg(1000);
+
+void BM_ExecuteCountingLoop(benchmark::State& state) {
+    Engine engine;
+    Flow flow = compile(engine, bench::countingLoopFlow());
+    ParameterMap params;
+    params["limit"] = createValue(static_cast<double>(state.range(0)));
+    run(state, flow, params);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ExecuteCountingLoop)->Arg(10)->Arg(1000)->Arg(100000);
+
+void BM_ExecuteProcLoop(benchmark::State& state) {
+    Engine engine;
+    registerAdd(engine);
+    Flow flow = compile(engine, bench::procLoopFlow());
+    ParameterMap params;
+    params["limit"] = createValue(static_cast<double>(state.range(0)));
+    run(state, flow, params);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ExecuteProcLoop)->Arg(10)->Arg(1000)->Arg(100000);
+
+// Executions per second of many small executions; the argument is the thread count
+void BM_ExecuteBatch(benchmark::State& state) {
+    constexpr size_t BatchSize = 4096;
+    Engine engine;
+    registerAdd(engine);
+    Flow flow = compile(engine, bench::procLoopFlow());
+    std::vector<ParameterMap> batch(BatchSize);
+    for (size_t i = 0; i < BatchSize; ++i) {
+        batch[i]["limit"] = createValue(static_cast<double>(i % 32));
+    }
+    for (auto _ : state) {
+        auto results = flow.executeBatch(batch, static_cast<size_t>(state.range(0)));
+        benchmark::DoNotOptimize(results);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BatchSize));
+}
+BENCHMARK(BM_ExecuteBatch)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// The same wide batch of counting loops, scalar per execution (0) or columnar (1)
+void BM_ExecuteColumns(benchmark::State& state) {
+    constexpr size_t BatchSize = 100000;
+    Engine engine;
+    Flow flow = compile(engine, bench::countingLoopFlow());
+    std::vector<double> limits(BatchSize);
+    std::vector<ParameterMap> batch(BatchSize);
+    for (size_t i = 0; i < BatchSize; ++i) {
+        limits[i] = static_cast<double>(i % 16);
+        batch[i]["limit"] = createValue(limits[i]);
+    }
+    ColumnBatch columns(BatchSize);
+    columns.setNumbers("limit", limits);
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            auto results = flow.executeBatch(batch);
+            benchmark::DoNotOptimize(results);
+        } else {
+            auto results = flow.executeColumns(columns);
+            benchmark::DoNotOptimize(results);
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BatchSize));
+}
+BENCHMARK(BM_ExecuteColumns)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// Independent executions on benchmark threads, each on the shared compiled flow
+void BM_ExecuteParallel(benchmark::State& state) {
+    static Engine engine;
+    static Flow flow = [] {
+        registerAdd(engine);
+        return compile(engine, bench::procLoopFlow());
+    }();
+    ParameterMap params;
+    params["limit"] = createValue(16.0);
+    run(state, flow, params);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ExecuteParallel)->ThreadRange(1, 8)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+#include "../include/flowgraph_layout/LayoutTypes.hpp"
+#include "../include/flowgraph_layout/Layout.hpp"
+#include "../include/flowgraph_layout/HierarchicalLayout.hpp"
+#include "../include/flowgraph_layout/ForceDirectedLayout.hpp"
+#include "../include/flowgraph_layout/GridLayout.hpp"
+#include <cstdlib>
+#include <map>
+
+using namespace flowgraph::layout;
+
+namespace {
+
+/**
+ * @brief Sparse random DAG with about two edges per node, the same for every run
+ */
+const GraphF& testGraph(size_t nodeCount) {
+    static std::map<size_t, GraphF> graphs;
+    auto it = graphs.find(nodeCount);
+    if (it == graphs.end()) {
+        std::srand(static_cast<unsigned>(nodeCount));
+        it = graphs.emplace(nodeCount, utils::createTestGraph(nodeCount, 4.0 / static_cast<double>(nodeCount))).first;
+    }
+    return it->second;
+}
+
+/// range(0) = node count, optional range(1) = LayoutConfig::threads
+template<typename Algorithm>
+void BM_Layout(benchmark::State& state) {
+    const GraphF& source = testGraph(static_cast<size_t>(state.range(0)));
+    LayoutConfig config;
+    if (state.range_size() > 1) {
+        config.threads = static_cast<size_t>(state.range(1));
+    }
+    Algorithm algorithm;
+    for (auto _ : state) {
+        state.PauseTiming();
+        GraphF graph = source;
+        state.ResumeTiming();
+        LayoutResult result = algorithm.apply(graph, config);
+        if (!result.success) {
+            state.SkipWithError(result.errorMessage.c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["nodes"] = static_cast<double>(source.nodeCount());
+    state.counters["edges"] = static_cast<double>(source.edgeCount());
+}
+
+BENCHMARK_TEMPLATE(BM_Layout, HierarchicalLayout<double>)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Layout, ForceDirectedLayout<double>)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Layout, ForceDirectedLayout<double>)
+    ->ArgNames({"nodes", "threads"})->ArgsProduct({{10000}, {2, 4, 8}})->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Layout, GridLayout<double>)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+#include "flowgraph/FlowGraph.hpp"
+#include "BenchmarkFlows.hpp"
+
+using namespace FlowGraph;
+
+namespace {
+
+void parseFlow(benchmark::State& state, const std::string& source) {
+    Parser parser;
+    for (auto _ : state) {
+        auto ast = parser.parse(source, "bench.flow");
+        benchmark::DoNotOptimize(ast);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * source.size()));
+}
+
+void BM_ParseSmallFlow(benchmark::State& state) {
+    parseFlow(state, bench::countingLoopFlow());
+}
+BENCHMARK(BM_ParseSmallFlow);
+
+void BM_ParseAssignChain(benchmark::State& state) {
+    std::string source = bench::assignChainFlow(static_cast<size_t>(state.range(0)));
+    parseFlow(state, source);
+    state.counters["nodes"] = static_cast<double>(state.range(0));
+}
+BENCHMARK(BM_ParseAssignChain)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+void BM_ParseAndCompile(benchmark::State& state) {
+    std::string source = bench::assignChainFlow(static_cast<size_t>(state.range(0)));
+    Engine engine;
+    Parser parser;
+    for (auto _ : state) {
+        Flow flow = engine.createFlow(parser.parse(source, "bench.flow"));
+        benchmark::DoNotOptimize(flow.getProgram());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * source.size()));
+}
+BENCHMARK(BM_ParseAndCompile)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+} // namespace
@@ -0,0 +1,344 @@
+/**
+ * @file flow_stress.cpp
+ * @brief Scaling run over synthetic flows of 10k to 1M nodes
+ *
+ * Usage:
+ *   flowgraph_stress [--nodes 10000,100000,1000000] [--branch 2] [--loop-depth 1]
+ *                    [--terms 3] [--proc-density 0.1] [--seed 1] [--executions N]
+ *                    [--layout-limit 100000] [--write <dir>] [--csv <file>]
+ *
+ * For every size a flow is generated (see FlowGenerator.hpp) and driven
+ * through the stages parse, compile, execute, scheduler and the hierarchical
+ * and grid layouts. Each stage reports its wall time, throughput and the
+ * peak resident memory while it ran (on Linux the peak is reset to the
+ * current resident size before every stage, so it includes what earlier
+ * stages still hold; elsewhere it is the process peak so far). --write
+ * keeps the generated corpus as .flow files, --csv appends the results to a
+ * file.
+ */
+
+#include "flowgraph/FlowGraph.hpp"
+#include "../include/flowgraph_layout/Layout.hpp"
+#include "../include/flowgraph_layout/GridLayout.hpp"
+#include "../include/flowgraph_layout/HierarchicalLayout.hpp"
+#include "FlowGenerator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace FlowGraph;
+
+namespace {
+
+struct Options {
+    std::vector<size_t> sizes{10000, 100000, 1000000};
+    bench::FlowShape shape;
+    size_t executions = 0;          // per size for the scheduler stage, 0 to scale with the size
+    size_t layoutLimit = 100000;    // larger flows skip the layouts
+    std::string writeDir;
+    std::string csvPath;
+};
+
+/**
+ * @brief Peak resident set size in bytes, 0 if unknown
+ */
+size_t peakMemory() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+#elif defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);   // bytes on macOS
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Start measuring a new peak; only Linux can reset it
+ */
+void resetPeakMemory() {
+#if defined(__linux__)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+#endif
+}
+
+struct Stage {
+    std::string name;
+    double seconds = 0;
+    double items = 0;
+    const char* unit = "";
+    size_t peakBytes = 0;
+};
+
+Stage measure(const std::string& name, const char* unit, const std::function<double()>& body) {
+    resetPeakMemory();
+    auto start = std::chrono::steady_clock::now();
+    double items = body();
+    Stage stage;
+    stage.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stage.name = name;
+    stage.items = items;
+    stage.unit = unit;
+    stage.peakBytes = peakMemory();
+    return stage;
+}
+
+void report(size_t nodes, const Stage& stage, std::ostream* csv) {
+    double rate = stage.seconds > 0 ? stage.items / stage.seconds : 0;
+    std::printf("%9zu  %-14s %10.2f ms %14.0f %-12s %9.1f MB\n", nodes, stage.name.c_str(), stage.seconds * 1e3, rate,
+                stage.unit, static_cast<double>(stage.peakBytes) / (1024.0 * 1024.0));
+    if (csv) {
+        *csv << nodes << ',' << stage.name << ',' << stage.seconds << ',' << rate << ',' << stage.unit << ','
+             << stage.peakBytes << '\n';
+    }
+}
+
+ParameterMap work(const ParameterMap& params) {
+    ParameterMap result;
+    result["result"] = createValue(params.at("a").asNumber() * 0.5 + params.at("b").asNumber() * 0.25);
+    return result;
+}
+
+/**
+ * @brief Layout graph of the compiled nodes, without the loops' back edges
+ *
+ * The hierarchical layout needs a DAG, so edges closing a cycle in a
+ * depth-first walk from the entry are left out, as the editor would draw
+ * them separately.
+ */
+flowgraph::layout::GraphF layoutGraph(const CompiledFlow& program) {
+    const size_t count = program.nodeCount();
+    std::vector<std::vector<NodeIndex>> successors(count);
+    for (NodeIndex i = 0; i < count; ++i) {
+        const CompiledNode& node = program.node(i);
+        for (const CompiledTarget* target : {&node.next, &node.yes, &node.no}) {
+            if (target->isNode()) {
+                successors[i].push_back(target->index);
+            }
+        }
+    }
+
+    flowgraph::layout::GraphF graph;
+    for (NodeIndex i = 0; i < count; ++i) {
+        graph.addNode(flowgraph::layout::NodeF(i));
+    }
+    enum : uint8_t { Unvisited, OnStack, Done };
+    std::vector<uint8_t> state(count, Unvisited);
+    std::vector<std::pair<NodeIndex, size_t>> stack;   // node, next successor to visit
+    for (NodeIndex root = 0; root < count; ++root) {
+        if (state[root] != Unvisited) {
+            continue;
+        }
+        state[root] = OnStack;
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+            auto& [node, next] = stack.back();
+            if (next == successors[node].size()) {
+                state[node] = Done;
+                stack.pop_back();
+                continue;
+            }
+            NodeIndex target = successors[node][next++];
+            if (state[target] == OnStack) {
+                continue;
+            }
+            graph.addEdge({node, target});
+            if (state[target] == Unvisited) {
+                state[target] = OnStack;
+                stack.emplace_back(target, 0);
+            }
+        }
+    }
+    return graph;
+}
+
+void runSize(const Options& options, size_t nodes, std::ostream* csv) {
+    bench::FlowShape shape = options.shape;
+    shape.nodes = nodes;
+    std::string source;
+    report(nodes, measure("generate", "nodes/s", [&]() {
+        source = bench::generateFlow(shape);
+        return static_cast<double>(nodes);
+    }), csv);
+    if (!options.writeDir.empty()) {
+        std::filesystem::create_directories(options.writeDir);
+        std::ofstream(options.writeDir + "/stress_" + std::to_string(nodes) + ".flow") << source;
+    }
+
+    std::unique_ptr<FlowAST> ast;
+    report(nodes, measure("parse", "nodes/s", [&]() {
+        ast = Parser().parse(source, "stress.flow");
+        return static_cast<double>(nodes);
+    }), csv);
+
+    Engine engine;
+    engine.registerProcedure<&work>("work");
+    std::optional<Flow> flow;
+    report(nodes, measure("compile", "nodes/s", [&]() {
+        flow.emplace(engine.createFlow(std::move(ast)));
+        return static_cast<double>(nodes);
+    }), csv);
+    if (!flow->getProgram().diagnostics().empty()) {
+        std::cerr << "compile: " << flow->getProgram().diagnostics().front() << std::endl;
+        std::exit(1);
+    }
+
+    // Nodes one execution visits, counted once with a profiler
+    auto profiler = std::make_shared<Profiler>();
+    flow->setProfiler(profiler);
+    ParameterMap params;
+    params["x"] = createValue(1.0);
+    ExecutionResult check = flow->execute(params);
+    flow->setProfiler(nullptr);
+    if (!check.success) {
+        std::cerr << "execute: " << check.error << std::endl;
+        std::exit(1);
+    }
+    double visits = 0;
+    for (const auto& node : profiler->snapshot().nodes) {
+        visits += static_cast<double>(node.visits);
+    }
+    profiler.reset();
+
+    report(nodes, measure("execute", "nodes/s", [&]() {
+        ExecutionResult result = flow->execute(params);
+        return result.success ? visits : 0;
+    }), csv);
+
+    // Many executions in flight on one scheduler, every PROC call completing later
+    size_t executions = options.executions ? options.executions : std::max<size_t>(1, 2000000 / nodes);
+    Engine asyncEngine;
+    std::vector<std::pair<ProcCompletionCallback*, ParameterMap>> pending;
+    asyncEngine.registerProcedure("work", [&pending](const ParameterMap& call, ProcCompletionCallback& callback) {
+        pending.emplace_back(&callback, work(call));
+    });
+    Flow asyncFlow = asyncEngine.createFlow(Parser().parse(source, "stress.flow"));
+    report(nodes, measure("scheduler", "nodes/s", [&]() {
+        FlowScheduler scheduler;
+        size_t failed = 0;
+        for (size_t i = 0; i < executions; ++i) {
+            ParameterMap input;
+            input["x"] = createValue(static_cast<double>(i));
+            scheduler.submit(asyncFlow, input, [&failed](FlowScheduler::TaskId, const ExecutionResult& result) {
+                failed += !result.success;
+            });
+        }
+        while (scheduler.inFlight() > 0) {
+            auto ready = std::move(pending);
+            pending.clear();
+            for (auto& [callback, values] : ready) {
+                (*callback)(ProcResult::completedSuccess(std::move(values)));
+            }
+            scheduler.poll();
+        }
+        return failed == 0 ? visits * static_cast<double>(executions) : 0;
+    }), csv);
+
+    if (nodes > options.layoutLimit) {
+        return;
+    }
+    flowgraph::layout::GraphF graph = layoutGraph(flow->getProgram());
+    flow.reset();
+    auto layout = [&](const char* name, flowgraph::layout::LayoutAlgorithm<double>& algorithm) {
+        report(nodes, measure(name, "nodes/s", [&]() {
+            flowgraph::layout::GraphF copy = graph;
+            auto result = algorithm.apply(copy, flowgraph::layout::LayoutConfig());
+            if (!result.success) {
+                std::cerr << name << ": " << result.errorMessage << std::endl;
+                return 0.0;
+            }
+            return static_cast<double>(nodes);
+        }), csv);
+    };
+    flowgraph::layout::HierarchicalLayout<double> hierarchical;
+    layout("hierarchical", hierarchical);
+    flowgraph::layout::GridLayout<double> grid;
+    layout("grid", grid);
+}
+
+std::vector<size_t> parseSizes(const std::string& list) {
+    std::vector<size_t> sizes;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        sizes.push_back(std::stoull(item));
+    }
+    return sizes;
+}
+
+int usage() {
+    std::cerr << "Usage: flowgraph_stress [--nodes 10000,100000,1000000] [--branch N] [--loop-depth N] [--terms N]\n"
+                 "                        [--proc-density F] [--seed N] [--executions N] [--layout-limit N]\n"
+                 "                        [--write <dir>] [--csv <file>]" << std::endl;
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return usage();
+        }
+        std::string value = argv[++i];
+        if (arg == "--nodes") {
+            options.sizes = parseSizes(value);
+        } else if (arg == "--branch") {
+            options.shape.branchFactor = std::stoull(value);
+        } else if (arg == "--loop-depth") {
+            options.shape.loopDepth = std::stoull(value);
+        } else if (arg == "--terms") {
+            options.shape.expressionTerms = std::stoull(value);
+        } else if (arg == "--proc-density") {
+            options.shape.procDensity = std::stod(value);
+        } else if (arg == "--seed") {
+            options.shape.seed = static_cast<uint32_t>(std::stoul(value));
+        } else if (arg == "--executions") {
+            options.executions = std::stoull(value);
+        } else if (arg == "--layout-limit") {
+            options.layoutLimit = std::stoull(value);
+        } else if (arg == "--write") {
+            options.writeDir = value;
+        } else if (arg == "--csv") {
+            options.csvPath = value;
+        } else {
+            return usage();
+        }
+    }
+
+    std::ofstream csvFile;
+    if (!options.csvPath.empty()) {
+        bool fresh = !std::filesystem::exists(options.csvPath);
+        csvFile.open(options.csvPath, std::ios::app);
+        if (fresh) {
+            csvFile << "nodes,stage,seconds,rate,unit,peak_bytes\n";
+        }
+    }
+    std::printf("%9s  %-14s %13s %14s %-12s %12s\n", "nodes", "stage", "time", "throughput", "", "peak RSS");
+    for (size_t nodes : options.sizes) {
+        runSize(options, nodes, csvFile.is_open() ? &csvFile : nullptr);
+    }
+    return 0;
+}
@@ -12,6 +12,7 @@
 #include "../../include/flowgraph_layout/HierarchicalLayout.hpp"
 #include "../../include/flowgraph_layout/ForceDirectedLayout.hpp"
 #include "../../include/flowgraph_layout/GridLayout.hpp"
+#include "../../include/flowgraph_layout/SpatialIndex.hpp"
 
 using namespace flowgraph::layout;
 
@@ -85,6 +86,134 @@ namespace {
             app->HandleContentScaleChange(xscale, yscale);
         }
     }
+    
+    // Layout algorithm for a name from the controls, hierarchical by default
+    std::unique_ptr<LayoutAlgorithm<double>> CreateLayoutAlgorithm(const std::string& name) {
+        if (name == "force_directed") {
+            return std::make_unique<ForceDirectedLayout<double>>();
+        } else if (name == "grid") {
+            return std::make_unique<GridLayout<double>>();
+        }
+        return std::make_unique<HierarchicalLayout<double>>();
+    }
+    
+    LayoutConfig EditorLayoutConfig() {
+        LayoutConfig config;
+        config.nodeSpacing = 60.0;
+        config.layerSpacing = 80.0;
+        config.iterations = 100;
+        return config;
+    }
+    
+    // Hand the worker's current positions to the UI thread
+    template<typename Job>
+    void PublishLayoutPositions(Job& job, const GraphF& graph) {
+        std::vector<std::pair<NodeId, PointF>> positions;
+        positions.reserve(graph.nodeCount());
+        for (const auto& pair : graph.getNodes()) {
+            positions.emplace_back(pair.first, pair.second.position);
+        }
+        std::lock_guard<std::mutex> lock(job.mutex);
+        job.positions.swap(positions);
+    }
+    
+    // Bounding box of the line drawn for an edge, between the node centres
+    bool EdgeBounds(const GraphF& graph, const Edge& edge, Box<double>& box) {
+        const NodeF* from = graph.getNode(edge.from);
+        const NodeF* to = graph.getNode(edge.to);
+        if (!from || !to) {
+            return false;
+        }
+        box = Box<double>::spanning(from->center(), to->center());
+        return true;
+    }
+}
+
+bool EditorApp::WaitForFrame() {
+    if (IsAnimating() || m_settleFrames > 0 || m_shouldRender) {
+        // A frame is due: sleep only until its slot, waking early for events
+        double wait = std::chrono::duration<double>(m_nextFrameTime - FrameClock::now()).count();
+        if (wait > 0.0) {
+            glfwWaitEventsTimeout(wait);
+        } else {
+            glfwPollEvents();
+        }
+    } else {
+        // Idle: block until the OS delivers an event
+        glfwWaitEvents();
+    }
+    
+    // Woken before the slot: wait out the rest on the next call
+    if (FrameClock::now() < m_nextFrameTime) {
+        return false;
+    }
+    
+    if (m_shouldRender.exchange(false)) {
+        m_settleFrames = SETTLE_FRAMES;
+    } else if (m_settleFrames > 0) {
+        m_settleFrames--;
+    } else if (!IsAnimating()) {
+        return false;
+    }
+    
+    m_nextFrameTime = FrameClock::now() + std::chrono::duration_cast<FrameClock::duration>(
+        std::chrono::duration<double>(1.0 / FRAME_RATE_CAP));
+    return true;
+}
+
+bool EditorApp::IsAnimating() const {
+    return m_isDraggingNode || m_isCreatingConnection || m_isPanning;
+}
+
+void EditorApp::HandleNodeDrag() {
+    if (!m_isDraggingNode || m_selectedNodeId == 0) return;
+    
+    if (ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+        // Update node position based on mouse movement
+        auto mouse_graph = ScreenToGraph(ImGui::GetMousePos());
+        auto graph_pos = flowgraph::layout::Point<double>(
+            mouse_graph.x - m_dragOffset.x,
+            mouse_graph.y - m_dragOffset.y
+        );
+        MoveNode(m_selectedNodeId, graph_pos);
+    } else if (ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
+        m_isDraggingNode = false;
+    }
+}
+
+void EditorApp::BeginFrameTiming() {
+    m_lastFrameStart = m_frameStart;
+    m_frameStart = FrameClock::now();
+    m_inputDone = m_frameStart;
+    m_frameLayoutSeconds = 0.0;
+}
+
+void EditorApp::MarkInputProcessed() {
+    m_inputDone = FrameClock::now();
+}
+
+void EditorApp::EndFrameTiming() {
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    const auto end = FrameClock::now();
+    
+    // Exponential moving average so the status bar stays readable
+    auto smooth = [](double& stat, double sample) { stat += (sample - stat) * 0.1; };
+    if (m_lastFrameStart != FrameClock::time_point()) {
+        smooth(m_frameStats.frameMs, Milliseconds(m_frameStart - m_lastFrameStart).count());
+    }
+    smooth(m_frameStats.inputMs, Milliseconds(m_inputDone - m_frameStart).count());
+    smooth(m_frameStats.layoutMs, m_frameLayoutSeconds * 1000.0);
+    smooth(m_frameStats.renderMs, std::max(0.0, Milliseconds(end - m_inputDone).count() - m_frameLayoutSeconds * 1000.0));
+    
+    const double elapsed = std::chrono::duration<double>(end - m_cpuSampleTime).count();
+    if (elapsed >= CPU_SAMPLE_SECONDS) {
+        const double cpu = GetProcessCpuTime();
+        if (m_cpuSampleTime != FrameClock::time_point()) {
+            m_frameStats.cpuPercent = 100.0 * (cpu - m_cpuSampleSeconds) / elapsed;
+        }
+        m_cpuSampleTime = end;
+        m_cpuSampleSeconds = cpu;
+    }
 }
 
 void EditorApp::InitializeDemoGraph() {
@@ -119,30 +248,114 @@ void EditorApp::InitializeDemoGraph() {
     ApplyLayout();
 }
 
+EditorApp::~EditorApp() {
+    StopLayoutJobs();
+}
+
 void EditorApp::ApplyLayout() {
     using namespace flowgraph::layout;
     
+    CancelLayout();
     if (!m_demoGraph || m_demoGraph->nodeCount() == 0) return;
     
-    std::unique_ptr<LayoutAlgorithm<double>> layout;
+    m_layoutJob = std::make_unique<LayoutJob>();
+    LayoutJob* job = m_layoutJob.get();
+    job->thread = std::thread([this, job, graph = *m_demoGraph, algorithm = m_currentLayoutAlgorithm]() mutable {
+        auto layout = CreateLayoutAlgorithm(algorithm);
+        LayoutConfig config = EditorLayoutConfig();
+        config.progressInterval = LAYOUT_PROGRESS_INTERVAL;
+        layout->setProgressCallback([&](const GraphF& current, size_t) {
+            if (job->cancelled) {
+                return false;
+            }
+            PublishLayoutPositions(*job, current);
+            RequestRender();
+            return true;
+        });
+        
+        auto result = layout->apply(graph, config);
+        if (result.success) {
+            PublishLayoutPositions(*job, graph);
+        } else if (!job->cancelled) {
+            std::cerr << "Layout failed: " << result.errorMessage << std::endl;
+        }
+        job->finished = true;
+        RequestRender();
+    });
+}
+
+void EditorApp::CancelLayout() {
+    if (m_layoutJob) {
+        // The worker stops at its next progress report; it is joined once it has
+        m_layoutJob->cancelled = true;
+        m_retiredLayoutJobs.push_back(std::move(m_layoutJob));
+    }
+}
+
+void EditorApp::UpdateLayoutJob() {
+    const auto start = FrameClock::now();
+    // Threads of cancelled jobs that have exited join immediately
+    m_retiredLayoutJobs.erase(
+        std::remove_if(m_retiredLayoutJobs.begin(), m_retiredLayoutJobs.end(), [](const auto& job) {
+            if (!job->finished) return false;
+            job->thread.join();
+            return true;
+        }),
+        m_retiredLayoutJobs.end());
+    
+    if (!m_layoutJob) return;
+    
+    // Once finished the worker no longer takes the lock; until then skip
+    // this frame rather than wait for it
+    const bool finished = m_layoutJob->finished;
+    std::vector<std::pair<NodeId, PointF>> positions;
+    std::unique_lock<std::mutex> lock(m_layoutJob->mutex, std::defer_lock);
+    if (finished) {
+        lock.lock();
+    } else if (!lock.try_lock()) {
+        return;
+    }
+    positions.swap(m_layoutJob->positions);
+    lock.unlock();
+    
+    for (const auto& [id, position] : positions) {
+        // Nodes deleted since the snapshot are skipped, a dragged node stays under the mouse
+        auto* node = m_demoGraph ? m_demoGraph->getNode(id) : nullptr;
+        if (node && !(m_isDraggingNode && id == m_selectedNodeId)) {
+            node->position = position;
+        }
+    }
+    if (!positions.empty()) {
+        m_spatialIndexDirty = true;
+    }
+    m_frameLayoutSeconds += std::chrono::duration<double>(FrameClock::now() - start).count();
     
-    if (m_currentLayoutAlgorithm == "hierarchical") {
-        layout = std::make_unique<HierarchicalLayout<double>>();
-    } else if (m_currentLayoutAlgorithm == "force_directed") {
-        layout = std::make_unique<ForceDirectedLayout<double>>();
-    } else if (m_currentLayoutAlgorithm == "grid") {
-        layout = std::make_unique<GridLayout<double>>();
-    } else {
-        // Default to hierarchical
-        layout = std::make_unique<HierarchicalLayout<double>>();
+    if (finished) {
+        m_layoutJob->thread.join();
+        m_layoutJob.reset();
     }
+}
+
+void EditorApp::StopLayoutJobs() {
+    CancelLayout();
+    for (auto& job : m_retiredLayoutJobs) {
+        job->thread.join();
+    }
+    m_retiredLayoutJobs.clear();
+}
+
+void EditorApp::ApplyIncrementalLayout(const std::vector<flowgraph::layout::NodeId>& changed) {
+    using namespace flowgraph::layout;
     
-    LayoutConfig config;
-    config.nodeSpacing = 60.0;
-    config.layerSpacing = 80.0;
-    config.iterations = 100;
+    // The edit makes a running full layout's snapshot stale
+    CancelLayout();
+    if (!m_autoLayout || !m_demoGraph || m_demoGraph->nodeCount() == 0) return;
     
-    auto result = layout->apply(*m_demoGraph, config);
+    const auto start = FrameClock::now();
+    auto layout = CreateLayoutAlgorithm(m_currentLayoutAlgorithm);
+    auto result = layout->applyIncremental(*m_demoGraph, changed, EditorLayoutConfig());
+    m_spatialIndexDirty = true;
+    m_frameLayoutSeconds += std::chrono::duration<double>(FrameClock::now() - start).count();
     
     if (!result.success) {
         std::cerr << "Layout failed: " << result.errorMessage << std::endl;
@@ -152,6 +365,8 @@ void EditorApp::ApplyLayout() {
 void EditorApp::RenderGraph() {
     using namespace flowgraph::layout;
     
+    UpdateLayoutJob();
+    
     ImGui::SetNextWindowPos(ImVec2(250, 50), ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowSize(ImVec2(800, 600), ImGuiCond_FirstUseEver);
     
@@ -193,13 +408,11 @@ void EditorApp::RenderGraph() {
         const ImVec2 mouse_pos = ImGui::GetMousePos();
         
         // Handle canvas panning
-        static bool is_panning = false;
-        
         if (is_hovered && ImGui::IsMouseClicked(ImGuiMouseButton_Middle)) {
-            is_panning = true;
+            m_isPanning = true;
             m_panStart = FromImVec2(mouse_pos);
         }
-        if (is_panning) {
+        if (m_isPanning) {
             if (ImGui::IsMouseDragging(ImGuiMouseButton_Middle)) {
                 ImVec2 delta = ImVec2(mouse_pos.x - m_panStart.x, mouse_pos.y - m_panStart.y);
                 m_canvasOffset.x += delta.x;
@@ -207,7 +420,7 @@ void EditorApp::RenderGraph() {
                 m_panStart = FromImVec2(mouse_pos);
                 RequestRender();
             } else if (ImGui::IsMouseReleased(ImGuiMouseButton_Middle)) {
-                is_panning = false;
+                m_isPanning = false;
             }
         }
         
@@ -250,79 +463,83 @@ void EditorApp::RenderGraph() {
         
         // Draw graph if we have nodes
         if (m_demoGraph && m_demoGraph->nodeCount() > 0) {
-            const auto& nodes = m_demoGraph->getNodes();
             const auto& edges = m_demoGraph->getEdges();
+            UpdateSpatialIndex();
+            
+            // Visible region in graph coordinates, padded by the port and arrow head size
+            auto view_min = ScreenToGraph(canvas_p0);
+            auto view_max = ScreenToGraph(canvas_p1);
+            const double view_margin = NODE_PORT_RADIUS + 8.0;
+            const Box<double> view{view_min.x - view_margin, view_min.y - view_margin,
+                                   view_max.x + view_margin, view_max.y + view_margin};
+            const bool low_detail = m_canvasZoom < LOD_ZOOM;
             
             // Draw edges first (behind nodes)
-            for (const auto& edge : edges) {
-                auto from_it = nodes.find(edge.from);
-                auto to_it = nodes.find(edge.to);
+            m_visibleItems.clear();
+            m_edgeIndex.query(view, [&](size_t index) { m_visibleItems.push_back(index); });
+            for (size_t index : m_visibleItems) {
+                const auto& from_node = *m_demoGraph->getNode(edges[index].from);
+                const auto& to_node = *m_demoGraph->getNode(edges[index].to);
                 
-                if (from_it != nodes.end() && to_it != nodes.end()) {
-                    const auto& from_node = from_it->second;
-                    const auto& to_node = to_it->second;
-                    
-                    ImVec2 from_screen = GraphToScreen(flowgraph::layout::Point<double>(
-                        from_node.position.x + from_node.size.x / 2,
-                        from_node.position.y + from_node.size.y / 2
-                    ));
-                    ImVec2 to_screen = GraphToScreen(flowgraph::layout::Point<double>(
-                        to_node.position.x + to_node.size.x / 2,
-                        to_node.position.y + to_node.size.y / 2
-                    ));
+                ImVec2 from_screen = GraphToScreen(from_node.center());
+                ImVec2 to_screen = GraphToScreen(to_node.center());
+                
+                if (low_detail) {
+                    draw_list->AddLine(from_screen, to_screen, IM_COL32(150, 150, 150, 255));
+                    continue;
+                }
+                
+                // Draw connection line
+                draw_list->AddLine(from_screen, to_screen, IM_COL32(150, 150, 150, 255), CONNECTION_THICKNESS);
+                
+                // Draw arrow head
+                ImVec2 direction = ImVec2(to_screen.x - from_screen.x, to_screen.y - from_screen.y);
+                float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+                if (length > 0) {
+                    direction.x /= length;
+                    direction.y /= length;
                     
-                    // Draw connection line
-                    draw_list->AddLine(from_screen, to_screen, IM_COL32(150, 150, 150, 255), CONNECTION_THICKNESS);
+                    float arrow_size = 8.0f * m_canvasZoom;
+                    ImVec2 arrow_tip = ImVec2(
+                        to_screen.x - direction.x * NODE_PORT_RADIUS * m_canvasZoom,
+                        to_screen.y - direction.y * NODE_PORT_RADIUS * m_canvasZoom
+                    );
+                    ImVec2 arrow_left = ImVec2(
+                        arrow_tip.x + direction.y * arrow_size - direction.x * arrow_size,
+                        arrow_tip.y - direction.x * arrow_size - direction.y * arrow_size
+                    );
+                    ImVec2 arrow_right = ImVec2(
+                        arrow_tip.x - direction.y * arrow_size - direction.x * arrow_size,
+                        arrow_tip.y + direction.x * arrow_size - direction.y * arrow_size
+                    );
                     
-                    // Draw arrow head
-                    ImVec2 direction = ImVec2(to_screen.x - from_screen.x, to_screen.y - from_screen.y);
-                    float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-                    if (length > 0) {
-                        direction.x /= length;
-                        direction.y /= length;
-                        
-                        float arrow_size = 8.0f * m_canvasZoom;
-                        ImVec2 arrow_tip = ImVec2(
-                            to_screen.x - direction.x * NODE_PORT_RADIUS * m_canvasZoom,
-                            to_screen.y - direction.y * NODE_PORT_RADIUS * m_canvasZoom
-                        );
-                        ImVec2 arrow_left = ImVec2(
-                            arrow_tip.x + direction.y * arrow_size - direction.x * arrow_size,
-                            arrow_tip.y - direction.x * arrow_size - direction.y * arrow_size
-                        );
-                        ImVec2 arrow_right = ImVec2(
-                            arrow_tip.x - direction.y * arrow_size - direction.x * arrow_size,
-                            arrow_tip.y + direction.x * arrow_size - direction.y * arrow_size
-                        );
-                        
-                        draw_list->AddTriangleFilled(arrow_tip, arrow_left, arrow_right, IM_COL32(150, 150, 150, 255));
-                    }
+                    draw_list->AddTriangleFilled(arrow_tip, arrow_left, arrow_right, IM_COL32(150, 150, 150, 255));
                 }
             }
             
             // Draw connection being created
             if (m_isCreatingConnection && m_connectionSourceId != 0) {
-                auto source_it = nodes.find(m_connectionSourceId);
-                if (source_it != nodes.end()) {
-                    const auto& source_node = source_it->second;
-                    ImVec2 source_screen = GraphToScreen(flowgraph::layout::Point<double>(
-                        source_node.position.x + source_node.size.x / 2,
-                        source_node.position.y + source_node.size.y / 2
-                    ));
-                    
+                const auto* source_node = m_demoGraph->getNode(m_connectionSourceId);
+                if (source_node) {
+                    ImVec2 source_screen = GraphToScreen(source_node->center());
                     draw_list->AddLine(source_screen, ToImVec2(m_connectionEndPos), IM_COL32(255, 255, 0, 255), CONNECTION_THICKNESS);
                 }
             }
             
             // Draw nodes on top
-            for (const auto& pair : nodes) {
-                const auto& node = pair.second;
+            m_visibleItems.clear();
+            m_nodeIndex.query(view, [&](size_t id) { m_visibleItems.push_back(id); });
+            
+            if (low_detail) {
+                // Plain boxes written straight into one reserved vertex block
+                draw_list->PrimReserve(static_cast<int>(m_visibleItems.size()) * 6, static_cast<int>(m_visibleItems.size()) * 4);
+            }
+            
+            for (size_t id : m_visibleItems) {
+                const auto& node = *m_demoGraph->getNode(id);
                 
                 ImVec2 node_min = GraphToScreen(node.position);
-                ImVec2 node_max = GraphToScreen(flowgraph::layout::Point<double>(
-                    node.position.x + node.size.x,
-                    node.position.y + node.size.y
-                ));
+                ImVec2 node_max = GraphToScreen(node.position + node.size);
                 
                 // Check if node is currently being dragged
                 bool is_selected = (m_selectedNodeId == node.id);
@@ -336,6 +553,11 @@ void EditorApp::RenderGraph() {
                 ImU32 node_color = is_selected ? IM_COL32(120, 180, 220, 255) : IM_COL32(100, 150, 200, 255);
                 ImU32 border_color = is_selected ? IM_COL32(90, 150, 190, 255) : IM_COL32(70, 120, 170, 255);
                 
+                if (low_detail) {
+                    draw_list->PrimRect(node_min, node_max, node_color);
+                    continue;
+                }
+                
                 draw_list->AddRectFilled(node_min, node_max, node_color, 4.0f * m_canvasZoom);
                 draw_list->AddRect(node_min, node_max, border_color, 4.0f * m_canvasZoom, 0, 2.0f * m_canvasZoom);
                 
@@ -367,6 +589,20 @@ void EditorApp::RenderGraph() {
                     draw_list->AddText(font, font->FontSize * font_scale, text_pos, IM_COL32(255, 255, 255, 255), node_text);
                 }
             }
+            
+            // One context menu for whichever node was right-clicked, submitted
+            // after the node loop so deleting does not disturb the iteration
+            if (ImGui::BeginPopup("node_context")) {
+                if (ImGui::MenuItem("Delete Node")) {
+                    if (m_selectedNodeId == m_contextMenuNodeId) {
+                        m_selectedNodeId = 0;
+                    }
+                    DeleteNode(m_contextMenuNodeId);
+                    ImGui::CloseCurrentPopup();
+                    RequestRender();
+                }
+                ImGui::EndPopup();
+            }
         }
     }
     ImGui::End();
@@ -402,6 +638,19 @@ void EditorApp::RenderGraphControls() {
             RequestRender();
         }
         
+        if (m_layoutJob) {
+            if (ImGui::Button("Cancel Layout", ImVec2(-1, 0))) {
+                CancelLayout();
+                RequestRender();
+            }
+            ImGui::TextDisabled("Computing layout...");
+        }
+        
+        if (ImGui::Checkbox("Relayout on edit", &m_autoLayout) && m_autoLayout) {
+            ApplyLayout();
+            RequestRender();
+        }
+        
         if (ImGui::Button("Regenerate Graph", ImVec2(-1, 0))) {
             InitializeDemoGraph();
             RequestRender();
@@ -451,8 +700,10 @@ void EditorApp::RenderStatusBar() {
                             ImGuiWindowFlags_NoSavedSettings;
     
     if (ImGui::Begin("##StatusBar", nullptr, flags)) {
-        // FPS display
-        ImGui::Text("FPS: %.1f (%.3f ms)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
+        // Frame timings; the frame interval grows while idle because frames are only drawn on demand
+        ImGui::Text("Frame: %.1f ms (input %.2f, layout %.2f, render %.2f) | CPU: %.0f%%",
+                    m_frameStats.frameMs, m_frameStats.inputMs, m_frameStats.layoutMs,
+                    m_frameStats.renderMs, m_frameStats.cpuPercent);
         
         ImGui::SameLine();
         ImGui::Text(" | ");
@@ -535,24 +786,12 @@ bool EditorApp::HandleNodeInteraction(size_t node_id, ImVec2 node_min, ImVec2 no
             return true;
         }
         
-        // Handle node deletion with right-click
+        // Handle node deletion with right-click; the menu itself is drawn by RenderGraph
         if (ImGui::IsMouseClicked(ImGuiMouseButton_Right)) {
-            ImGui::OpenPopup(("node_context_" + std::to_string(node_id)).c_str());
-            return true;
-        }
-    }
-    
-    // Handle node context menu
-    if (ImGui::BeginPopup(("node_context_" + std::to_string(node_id)).c_str())) {
-        if (ImGui::MenuItem("Delete Node")) {
-            DeleteNode(node_id);
-            if (m_selectedNodeId == node_id) {
-                m_selectedNodeId = 0;
-            }
-            ImGui::CloseCurrentPopup();
+            m_contextMenuNodeId = node_id;
+            ImGui::OpenPopup("node_context");
             return true;
         }
-        ImGui::EndPopup();
     }
     
     return false;
@@ -561,41 +800,22 @@ bool EditorApp::HandleNodeInteraction(size_t node_id, ImVec2 node_min, ImVec2 no
 void EditorApp::CreateConnection(size_t from_node_id, size_t to_node_id) {
     if (m_demoGraph && from_node_id != to_node_id) {
         // Check if connection already exists
-        const auto& edges = m_demoGraph->getEdges();
-        for (const auto& edge : edges) {
-            if (edge.from == from_node_id && edge.to == to_node_id) {
-                return; // Connection already exists
-            }
+        const auto& successors = m_demoGraph->getNeighbors(from_node_id);
+        if (std::find(successors.begin(), successors.end(), to_node_id) != successors.end()) {
+            return; // Connection already exists
         }
         
         // Add the new edge
         m_demoGraph->addEdge({from_node_id, to_node_id});
+        m_spatialIndexDirty = true;
+        ApplyIncrementalLayout({from_node_id, to_node_id});
     }
 }
 
 void EditorApp::DeleteConnection(size_t from_node_id, size_t to_node_id) {
-    if (m_demoGraph) {
-        // TODO: Implement edge removal - the layout library doesn't have removeEdge
-        // For now, we'll rebuild the graph without the edge
-        auto& edges = m_demoGraph->getEdges();
-        std::vector<flowgraph::layout::Edge> remaining_edges;
-        
-        for (const auto& edge : edges) {
-            if (!(edge.from == from_node_id && edge.to == to_node_id)) {
-                remaining_edges.push_back(edge);
-            }
-        }
-        
-        // Create new graph with remaining edges
-        auto new_graph = std::make_unique<flowgraph::layout::GraphF>();
-        const auto& nodes = m_demoGraph->getNodes();
-        for (const auto& pair : nodes) {
-            new_graph->addNode(pair.second);
-        }
-        for (const auto& edge : remaining_edges) {
-            new_graph->addEdge(edge);
-        }
-        m_demoGraph = std::move(new_graph);
+    if (m_demoGraph && m_demoGraph->removeEdge(from_node_id, to_node_id) > 0) {
+        m_spatialIndexDirty = true;
+        ApplyIncrementalLayout({from_node_id, to_node_id});
     }
 }
 
@@ -604,6 +824,8 @@ size_t EditorApp::CreateNode(const flowgraph::layout::Point<double>& position) {
         size_t new_id = m_nextNodeId++;
         flowgraph::layout::NodeF new_node(new_id, position, {NODE_WIDTH, NODE_HEIGHT});
         m_demoGraph->addNode(new_node);
+        m_spatialIndexDirty = true;
+        ApplyIncrementalLayout({new_id});
         return new_id;
     }
     return 0;
@@ -611,30 +833,53 @@ size_t EditorApp::CreateNode(const flowgraph::layout::Point<double>& position) {
 
 void EditorApp::DeleteNode(size_t node_id) {
     if (m_demoGraph) {
-        // TODO: Implement node removal - the layout library doesn't have removeNode
-        // For now, we'll rebuild the graph without the node and its edges
-        const auto& nodes = m_demoGraph->getNodes();
-        const auto& edges = m_demoGraph->getEdges();
-        
-        // Create new graph without the deleted node
-        auto new_graph = std::make_unique<flowgraph::layout::GraphF>();
-        
-        // Add all nodes except the one being deleted
-        for (const auto& pair : nodes) {
-            if (pair.first != node_id) {
-                new_graph->addNode(pair.second);
-            }
+        // Former neighbours are the nodes whose surroundings changed
+        auto neighbours = m_demoGraph->getAdjacentNodes(node_id);
+        if (m_demoGraph->removeNode(node_id)) {
+            m_spatialIndexDirty = true;
+            ApplyIncrementalLayout(neighbours);
         }
-        
-        // Add all edges that don't involve the deleted node
-        for (const auto& edge : edges) {
-            if (edge.from != node_id && edge.to != node_id) {
-                new_graph->addEdge(edge);
+    }
+}
+
+void EditorApp::UpdateSpatialIndex() {
+    if (!m_spatialIndexDirty || !m_demoGraph) return;
+    
+    m_nodeIndex.clear();
+    for (const auto& pair : m_demoGraph->getNodes()) {
+        m_nodeIndex.insert(pair.first, Box<double>::of(pair.second));
+    }
+    
+    // Edge indices shift when edges are removed, so the whole edge index is rebuilt
+    m_edgeIndex.clear();
+    const auto& edges = m_demoGraph->getEdges();
+    Box<double> box;
+    for (size_t index = 0; index < edges.size(); ++index) {
+        if (EdgeBounds(*m_demoGraph, edges[index], box)) {
+            m_edgeIndex.insert(index, box);
+        }
+    }
+    
+    m_spatialIndexDirty = false;
+}
+
+bool EditorApp::MoveNode(size_t node_id, const flowgraph::layout::Point<double>& position) {
+    auto* node = m_demoGraph ? m_demoGraph->getNode(node_id) : nullptr;
+    if (!node) return false;
+    
+    node->position = position;
+    if (!m_spatialIndexDirty) {
+        // Only this node and its edges moved
+        m_nodeIndex.insert(node_id, Box<double>::of(*node));
+        const auto& edges = m_demoGraph->getEdges();
+        Box<double> box;
+        for (size_t index : m_demoGraph->getIncidentEdges(node_id)) {
+            if (EdgeBounds(*m_demoGraph, edges[index], box)) {
+                m_edgeIndex.insert(index, box);
             }
         }
-        
-        m_demoGraph = std::move(new_graph);
     }
+    return true;
 }
 
 flowgraph::layout::Point<double> EditorApp::ScreenToGraph(ImVec2 screen_pos) {
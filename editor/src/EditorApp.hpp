@@ -1,10 +1,16 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 #include <imgui.h>
 #include "../../include/flowgraph_layout/LayoutTypes.hpp"
+#include "../../include/flowgraph_layout/SpatialIndex.hpp"
 
 struct GLFWwindow;
 
@@ -20,7 +26,7 @@ namespace Editor {
  */
 class EditorApp {
 public:
-    virtual ~EditorApp() = default;
+    virtual ~EditorApp();
 
     /**
      * @brief Create platform-specific EditorApp instance
@@ -47,6 +53,8 @@ public:
 
     /**
      * @brief Request a render on next frame (for on-demand rendering)
+     *
+     * Safe to call from the layout worker thread.
      */
     virtual void RequestRender() = 0;
 
@@ -97,6 +105,12 @@ protected:
      */
     virtual bool ShouldContinue() = 0;
 
+    /**
+     * @brief CPU time used by the whole process so far, all threads
+     * @return CPU time in seconds
+     */
+    virtual double GetProcessCpuTime() const = 0;
+
     /**
      * @brief Cleanup ImGui resources
      */
@@ -119,21 +133,98 @@ protected:
      */
     virtual std::string GetPlatformText() const = 0;
 
+    /**
+     * @brief Block until the next frame should be drawn
+     *
+     * While nothing is animating this sleeps in glfwWaitEvents, so an idle
+     * editor uses no CPU. Requested and animated frames are paced to
+     * FRAME_RATE_CAP, and a few settle frames follow each request so ImGui
+     * widgets can finish reacting to input.
+     * @return true if a frame should be rendered now
+     */
+    bool WaitForFrame();
+    
+    /**
+     * @brief Check whether an interaction needs frames without further events
+     * @return true while dragging a node, creating a connection or panning
+     */
+    bool IsAnimating() const;
+    
+    /**
+     * @brief Move the dragged node to follow the mouse
+     */
+    void HandleNodeDrag();
+    
+    /**
+     * @brief Start timing a frame; call before HandleNodeDrag and RenderFrame
+     */
+    void BeginFrameTiming();
+    
+    /**
+     * @brief Mark the end of input processing; call after ImGui::NewFrame
+     */
+    void MarkInputProcessed();
+    
+    /**
+     * @brief Finish timing a frame and update the status bar statistics
+     */
+    void EndFrameTiming();
+
     /**
      * @brief Initialize demo graph data
      */
     void InitializeDemoGraph();
     
     /**
-     * @brief Apply selected layout algorithm to the graph
+     * @brief Start the selected layout algorithm on a worker thread
+     *
+     * The worker lays out a snapshot of the graph and publishes positions
+     * every LAYOUT_PROGRESS_INTERVAL iterations; UpdateLayoutJob() applies
+     * them. A layout that is already running is cancelled.
      */
     void ApplyLayout();
     
+    /**
+     * @brief Cancel the running background layout without waiting for it
+     */
+    void CancelLayout();
+    
+    /**
+     * @brief Apply positions published by the layout worker, never blocking
+     */
+    void UpdateLayoutJob();
+    
+    /**
+     * @brief Cancel all layout workers and wait for them to exit
+     */
+    void StopLayoutJobs();
+    
+    /**
+     * @brief Update the layout after an edit, moving only what the edit affects
+     * @param changed Nodes that were added or whose connections changed
+     */
+    void ApplyIncrementalLayout(const std::vector<flowgraph::layout::NodeId>& changed);
+    
     /**
      * @brief Render the graph visualization
+     *
+     * Only nodes and edges inside the visible canvas region are drawn.
      */
     void RenderGraph();
     
+    /**
+     * @brief Rebuild the node and edge spatial indices if the graph changed
+     */
+    void UpdateSpatialIndex();
+    
+    /**
+     * @brief Move a node and update its entries in the spatial indices
+     * @param node_id ID of the node to move
+     * @param position New top-left position in graph coordinates
+     * @return true if the node exists
+     */
+    bool MoveNode(size_t node_id, const flowgraph::layout::Point<double>& position);
+    
     /**
      * @brief Render the graph controls UI
      */
@@ -204,9 +295,44 @@ protected:
     bool IsMouseOverPort(ImVec2 mouse_pos, ImVec2 port_pos, float radius);
 
 protected:
+    /**
+     * @brief Layout running on a worker thread against a snapshot of the graph
+     */
+    struct LayoutJob {
+        std::thread thread;
+        std::atomic<bool> cancelled{false};
+        std::atomic<bool> finished{false};  // Set after the last positions were published
+        std::mutex mutex;                   // Guards positions
+        std::vector<std::pair<flowgraph::layout::NodeId, flowgraph::layout::PointF>> positions;  // Not yet applied
+    };
+    
+    /**
+     * @brief Smoothed frame timings shown in the status bar
+     */
+    struct FrameStats {
+        double frameMs = 0.0;       // Interval between rendered frames
+        double inputMs = 0.0;       // Event polling, drag handling and ImGui input processing
+        double layoutMs = 0.0;      // Layout work on the UI thread
+        double renderMs = 0.0;      // Building the UI and submitting draw data
+        double cpuPercent = 0.0;    // Process CPU time over wall time, all threads
+    };
+    
+    using FrameClock = std::chrono::steady_clock;
+    
     GLFWwindow* m_window = nullptr;
     bool m_initialized = false;
-    bool m_shouldRender = true;
+    std::atomic<bool> m_shouldRender{true};
+    
+    // Frame scheduling and statistics
+    FrameClock::time_point m_nextFrameTime;
+    int m_settleFrames = 0;                 // Frames still to draw after the last request
+    FrameStats m_frameStats;
+    FrameClock::time_point m_frameStart;
+    FrameClock::time_point m_inputDone;
+    FrameClock::time_point m_lastFrameStart;
+    double m_frameLayoutSeconds = 0.0;      // Layout time accumulated during the current frame
+    FrameClock::time_point m_cpuSampleTime;
+    double m_cpuSampleSeconds = 0.0;
     
     // Content scale for high-DPI support
     float m_contentScaleX = 1.0f;
@@ -217,13 +343,18 @@ protected:
     std::string m_currentLayoutAlgorithm = "hierarchical";
     std::vector<std::string> m_availableLayouts = {"hierarchical", "force_directed", "grid"};
     bool m_showGraphControls = true;
+    bool m_autoLayout = true;             // Relayout incrementally after each edit
+    std::unique_ptr<LayoutJob> m_layoutJob;                        // Running background layout, if any
+    std::vector<std::unique_ptr<LayoutJob>> m_retiredLayoutJobs;   // Cancelled jobs whose threads have not exited yet
     
     // Node editor state
     size_t m_selectedNodeId = 0;          // 0 means no selection
+    size_t m_contextMenuNodeId = 0;       // Node the context menu was opened for
     bool m_isDraggingNode = false;
     flowgraph::layout::PointF m_dragOffset;                    // Offset from node center to mouse during drag
     size_t m_connectionSourceId = 0;      // 0 means no connection in progress
     bool m_isCreatingConnection = false;
+    bool m_isPanning = false;
     flowgraph::layout::PointF m_connectionEndPos;              // Current mouse position during connection creation
 
     // Canvas state for zoom and pan
@@ -232,6 +363,12 @@ protected:
     ImVec2 m_canvasSize;                    // Size of the canvas area
     ImVec2 m_canvasPos;                     // Top-left position of canvas
 
+    // Spatial indices for viewport culling, keyed by node ID and edge index
+    flowgraph::layout::SpatialGrid<double> m_nodeIndex{SPATIAL_CELL_SIZE};
+    flowgraph::layout::SpatialGrid<double> m_edgeIndex{SPATIAL_CELL_SIZE};
+    bool m_spatialIndexDirty = true;        // Set whenever nodes or edges are added, removed or laid out
+    std::vector<size_t> m_visibleItems;     // Scratch buffer for viewport queries
+
     // Node editor settings
     static constexpr float NODE_WIDTH = 80.0f;
     static constexpr float NODE_HEIGHT = 40.0f;
@@ -239,6 +376,12 @@ protected:
     static constexpr float CONNECTION_THICKNESS = 2.0f;
     static constexpr float MIN_ZOOM = 0.1f;
     static constexpr float MAX_ZOOM = 5.0f;
+    static constexpr size_t LAYOUT_PROGRESS_INTERVAL = 5;  // Iterations between animated layout updates
+    static constexpr double FRAME_RATE_CAP = 60.0;         // Upper bound on frames per second
+    static constexpr int SETTLE_FRAMES = 2;                // Extra frames after each render request
+    static constexpr double CPU_SAMPLE_SECONDS = 1.0;      // Window for the CPU usage figure
+    static constexpr float LOD_ZOOM = 0.35f;            // Below this zoom nodes are drawn as plain boxes
+    static constexpr double SPATIAL_CELL_SIZE = 256.0;  // Graph units per spatial index cell
     
     // Next node ID for creating new nodes
     size_t m_nextNodeId = 10;
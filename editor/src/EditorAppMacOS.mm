@@ -15,6 +15,7 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_metal.h>
 
+#include <ctime>
 #include <iostream>
 #include <memory>
 
@@ -82,43 +83,15 @@ public:
 
         // Main application loop with on-demand rendering
         while (ShouldContinue()) {
-            // Handle node dragging if active
-            if (m_isDraggingNode && m_selectedNodeId != 0) {
-                if (ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
-                    // Update node position based on mouse movement
-                    ImVec2 mouse_pos = ImGui::GetMousePos();
-                    auto mouse_graph = ScreenToGraph(mouse_pos);
-                    auto graph_pos = flowgraph::layout::Point<double>(
-                        mouse_graph.x - m_dragOffset.x, 
-                        mouse_graph.y - m_dragOffset.y
-                    );
-                    
-                    if (m_demoGraph) {
-                        auto* node = m_demoGraph->getNode(m_selectedNodeId);
-                        if (node) {
-                            node->position = graph_pos;
-                            RequestRender();
-                        }
-                    }
-                } else if (ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
-                    m_isDraggingNode = false;
-                }
+            // Sleeps on OS events while idle, paces frames while animating
+            if (!WaitForFrame()) {
+                continue;
             }
             
-            // Wait for events instead of polling continuously
-            // This ensures 0% CPU usage when idle
-            glfwWaitEvents();
-            
-            if (m_shouldRender) {
-                RenderFrame();
-                m_shouldRender = false;
-                
-                // Check if ImGui wants to continue rendering (animations, etc.)
-                ImGuiIO& io = ImGui::GetIO();
-                if (io.WantCaptureMouse || io.WantCaptureKeyboard || m_isDraggingNode || m_isCreatingConnection) {
-                    m_shouldRender = true;
-                }
-            }
+            BeginFrameTiming();
+            HandleNodeDrag();
+            RenderFrame();
+            EndFrameTiming();
         }
 
         return 0;
@@ -129,6 +102,8 @@ public:
             return;
         }
 
+        // Workers wake the event loop, so they must exit before GLFW goes away
+        StopLayoutJobs();
         CleanupImGui();
         CleanupWindow();
         
@@ -361,6 +336,7 @@ protected:
             ImGui_ImplMetal_NewFrame(renderPassDescriptor);
             ImGui_ImplGlfw_NewFrame();
             ImGui::NewFrame();
+            MarkInputProcessed();
 
             // Menu bar
             if (ImGui::BeginMainMenuBar()) {
@@ -463,6 +439,12 @@ protected:
         glfwTerminate();
     }
 
+    double GetProcessCpuTime() const override {
+        timespec cpu_time{};
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_time);
+        return cpu_time.tv_sec + cpu_time.tv_nsec * 1e-9;
+    }
+
     float GetStatusBarHeight() const override {
         return 12.0f * std::max(m_contentScaleX, m_contentScaleY);
     }
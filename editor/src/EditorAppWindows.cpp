@@ -95,43 +95,15 @@ public:
 
         // Main application loop with on-demand rendering
         while (ShouldContinue()) {
-            // Handle node dragging if active
-            if (m_isDraggingNode && m_selectedNodeId != 0) {
-                if (ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
-                    // Update node position based on mouse movement
-                    ImVec2 mouse_pos = ImGui::GetMousePos();
-                    auto mouse_graph = ScreenToGraph(mouse_pos);
-                    auto graph_pos = flowgraph::layout::Point<double>(
-                        mouse_graph.x - m_dragOffset.x, 
-                        mouse_graph.y - m_dragOffset.y
-                    );
-                    
-                    if (m_demoGraph) {
-                        auto* node = m_demoGraph->getNode(m_selectedNodeId);
-                        if (node) {
-                            node->position = graph_pos;
-                            RequestRender();
-                        }
-                    }
-                } else if (ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
-                    m_isDraggingNode = false;
-                }
+            // Sleeps on OS events while idle, paces frames while animating
+            if (!WaitForFrame()) {
+                continue;
             }
             
-            // Wait for events instead of polling continuously
-            // This ensures 0% CPU usage when idle
-            glfwWaitEvents();
-            
-            if (m_shouldRender) {
-                RenderFrame();
-                m_shouldRender = false;
-                
-                // Check if ImGui wants to continue rendering (animations, etc.)
-                ImGuiIO& io = ImGui::GetIO();
-                if (io.WantCaptureMouse || io.WantCaptureKeyboard || m_isDraggingNode || m_isCreatingConnection) {
-                    m_shouldRender = true;
-                }
-            }
+            BeginFrameTiming();
+            HandleNodeDrag();
+            RenderFrame();
+            EndFrameTiming();
         }
 
         return 0;
@@ -142,6 +114,8 @@ public:
             return;
         }
 
+        // Workers wake the event loop, so they must exit before GLFW goes away
+        StopLayoutJobs();
         CleanupImGui();
         CleanupWindow();
         
@@ -323,6 +297,7 @@ protected:
         ImGui_ImplDX11_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
+        MarkInputProcessed();
 
         // Menu bar
         if (ImGui::BeginMainMenuBar()) {
@@ -396,6 +371,20 @@ protected:
         glfwTerminate();
     }
 
+    double GetProcessCpuTime() const override {
+        FILETIME creation, exit, kernel, user;
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+            return 0.0;
+        }
+        auto seconds = [](const FILETIME& time) {
+            ULARGE_INTEGER ticks;
+            ticks.LowPart = time.dwLowDateTime;
+            ticks.HighPart = time.dwHighDateTime;
+            return ticks.QuadPart * 1e-7; // 100 ns units
+        };
+        return seconds(kernel) + seconds(user);
+    }
+
     float GetStatusBarHeight() const override {
         // Windows status bar uses system DPI scaling
         float scale = CalculateMaxScale(m_contentScaleX, m_contentScaleY);
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "LayoutTypes.hpp"
+#include <cstdint>
+#include <utility>
+
+namespace flowgraph::layout {
+
+/// Structure-of-arrays copy of a Graph that layout algorithms run on
+///
+/// Nodes get dense indices [0, size()) in the iteration order of the source
+/// graph; positions and sizes live in contiguous arrays and the adjacency is
+/// stored in CSR form, so inner loops touch memory sequentially instead of
+/// hashing node IDs. Edges whose endpoints are not in the graph are dropped.
+template<typename T = double>
+struct DenseGraph {
+    using Index = uint32_t;
+
+    /// Contiguous run of node indices (CSR row)
+    struct IndexRange {
+        const Index* first = nullptr;
+        const Index* last = nullptr;
+
+        const Index* begin() const { return first; }
+        const Index* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    std::vector<NodeId> ids;              ///< Dense index -> node ID
+    std::vector<T> x, y;                  ///< Top-left positions
+    std::vector<T> w, h;                  ///< Sizes
+    std::vector<std::pair<Index, Index>> edges;   ///< (from, to) in source edge order
+
+    std::vector<Index> outOffsets, outTargets;    ///< Successors of i: outTargets[outOffsets[i], outOffsets[i + 1])
+    std::vector<Index> inOffsets, inSources;      ///< Predecessors of i: inSources[inOffsets[i], inOffsets[i + 1])
+
+    size_t size() const { return ids.size(); }
+    size_t edgeCount() const { return edges.size(); }
+
+    IndexRange successors(Index node) const {
+        return {outTargets.data() + outOffsets[node], outTargets.data() + outOffsets[node + 1]};
+    }
+
+    IndexRange predecessors(Index node) const {
+        return {inSources.data() + inOffsets[node], inSources.data() + inOffsets[node + 1]};
+    }
+
+    /// Build the dense form of a graph
+    static DenseGraph fromGraph(const Graph<T>& graph) {
+        DenseGraph dense;
+        const size_t count = graph.nodeCount();
+        dense.ids.reserve(count);
+        dense.x.reserve(count);
+        dense.y.reserve(count);
+        dense.w.reserve(count);
+        dense.h.reserve(count);
+
+        std::unordered_map<NodeId, Index> index;
+        index.reserve(count);
+        for (const auto& pair : graph.getNodes()) {
+            index.emplace(pair.first, static_cast<Index>(dense.ids.size()));
+            dense.ids.push_back(pair.first);
+            dense.x.push_back(pair.second.position.x);
+            dense.y.push_back(pair.second.position.y);
+            dense.w.push_back(pair.second.size.x);
+            dense.h.push_back(pair.second.size.y);
+        }
+
+        dense.edges.reserve(graph.edgeCount());
+        for (const auto& edge : graph.getEdges()) {
+            auto from = index.find(edge.from);
+            auto to = index.find(edge.to);
+            if (from != index.end() && to != index.end()) {
+                dense.edges.emplace_back(from->second, to->second);
+            }
+        }
+        dense.buildAdjacency();
+        return dense;
+    }
+
+    /// Write the positions back to the nodes they were taken from
+    void applyPositions(Graph<T>& graph) const {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            graph.updateNodePosition(ids[i], {x[i], y[i]});
+        }
+    }
+
+    /// Build a Graph with the same nodes, positions and edges
+    Graph<T> toGraph() const {
+        Graph<T> graph;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            graph.addNode(Node<T>(ids[i], {x[i], y[i]}, {w[i], h[i]}));
+        }
+        for (const auto& [from, to] : edges) {
+            graph.addEdge({ids[from], ids[to]});
+        }
+        return graph;
+    }
+
+private:
+    void buildAdjacency() {
+        const size_t count = ids.size();
+        outOffsets.assign(count + 1, 0);
+        inOffsets.assign(count + 1, 0);
+        for (const auto& [from, to] : edges) {
+            ++outOffsets[from + 1];
+            ++inOffsets[to + 1];
+        }
+        for (size_t i = 0; i < count; ++i) {
+            outOffsets[i + 1] += outOffsets[i];
+            inOffsets[i + 1] += inOffsets[i];
+        }
+
+        // Fill in edge order so rows keep the order of the source graph
+        outTargets.resize(edges.size());
+        inSources.resize(edges.size());
+        std::vector<Index> outNext(outOffsets.begin(), outOffsets.end() - 1);
+        std::vector<Index> inNext(inOffsets.begin(), inOffsets.end() - 1);
+        for (const auto& [from, to] : edges) {
+            outTargets[outNext[from]++] = to;
+            inSources[inNext[to]++] = from;
+        }
+    }
+};
+
+using DenseGraphF = DenseGraph<double>;
+
+} // namespace flowgraph::layout
@@ -1,40 +1,24 @@
 #pragma once
 
 #include "LayoutTypes.hpp"
+#include "DenseGraph.hpp"
+#include "LayoutKernels.hpp"
+#include "Parallel.hpp"
 #include <random>
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <unordered_set>
 
 namespace flowgraph::layout {
 
 /// Force-directed layout algorithm using Fruchterman-Reingold algorithm
-/// Suitable for general graphs and provides natural-looking layouts
+/// Suitable for general graphs and provides natural-looking layouts.
+/// Repulsion is approximated with a Barnes-Hut quadtree (LayoutConfig::barnesHutTheta)
 template<typename T = double>
 class ForceDirectedLayout : public LayoutAlgorithm<T> {
 private:
-    struct ForceVector {
-        T x, y;
-        ForceVector(T x_ = 0, T y_ = 0) : x(x_), y(y_) {}
-        
-        ForceVector operator+(const ForceVector& other) const {
-            return {x + other.x, y + other.y};
-        }
-        
-        ForceVector operator*(T scalar) const {
-            return {x * scalar, y * scalar};
-        }
-        
-        T magnitude() const {
-            return std::sqrt(x * x + y * y);
-        }
-        
-        ForceVector normalized() const {
-            T mag = magnitude();
-            if (mag == 0) return {0, 0};
-            return {x / mag, y / mag};
-        }
-    };
-    
     std::mt19937 rng_;
     
 public:
@@ -49,7 +33,7 @@ public:
     }
     
     bool isOptimizedForLargeGraphs() const override {
-        return false; // O(n²) complexity, not ideal for very large graphs
+        return true; // O(n log n) per iteration with Barnes-Hut repulsion
     }
     
     LayoutResult apply(Graph<T>& graph, const LayoutConfig& config = {}) override {
@@ -68,10 +52,55 @@ public:
             T optimal_edge_length = calculateOptimalEdgeLength(graph, config);
             
             // Run force-directed simulation
-            size_t iterations = simulateForces(graph, config, optimal_edge_length);
+            DenseGraph<T> dense = DenseGraph<T>::fromGraph(graph);
+            std::vector<size_t> active(dense.size());
+            std::iota(active.begin(), active.end(), size_t(0));
+            size_t iterations = simulateForces(dense, config, optimal_edge_length, active, optimal_edge_length, graph);
             
             // Apply final adjustments
-            removeOverlaps(graph, config);
+            removeOverlaps(dense, config, active);
+            dense.applyPositions(graph);
+            
+            result.success = true;
+            result.iterations = iterations;
+            result.boundingBox = calculateBoundingBox(graph);
+            
+        } catch (const std::exception& e) {
+            result.success = false;
+            result.errorMessage = e.what();
+        }
+        
+        return result;
+    }
+    
+    /// Relax only the neighbourhood of the changed nodes
+    ///
+    /// Nodes within IncrementalRadius edges of a changed node move, starting
+    /// from their current positions at a low temperature; all other nodes stay
+    /// where they are but still repel. New nodes left at the origin are placed
+    /// next to their positioned neighbours.
+    LayoutResult applyIncremental(Graph<T>& graph, const std::vector<NodeId>& changed,
+                                  const LayoutConfig& config = {}) override {
+        LayoutResult result;
+        
+        if (graph.nodeCount() == 0) {
+            result.success = true;
+            return result;
+        }
+        
+        try {
+            DenseGraph<T> dense = DenseGraph<T>::fromGraph(graph);
+            std::vector<size_t> active = collectNeighbourhood(dense, changed);
+            placeNewNodes(dense, active, config);
+            
+            T optimal_edge_length = calculateOptimalEdgeLength(graph, config);
+            size_t iterations = 0;
+            if (!active.empty()) {
+                iterations = simulateForces(dense, config, optimal_edge_length, active,
+                                            optimal_edge_length * IncrementalTemperature, graph);
+                removeOverlaps(dense, config, active);
+                dense.applyPositions(graph);
+            }
             
             result.success = true;
             result.iterations = iterations;
@@ -116,33 +145,223 @@ private:
         return std::max(config.nodeSpacing, side_length / std::sqrt(static_cast<T>(node_count)));
     }
     
-    /// Main force simulation loop
-    size_t simulateForces(Graph<T>& graph, const LayoutConfig& config, T optimal_edge_length) {
+    /// Barnes-Hut quadtree over the node centers, rebuilt every iteration
+    struct QuadTree {
+        static constexpr size_t LeafSize = 8;    // one or two vector loads per coordinate
+        static constexpr size_t MaxDepth = 24;   // bounds depth with coincident centers
+        
+        struct Cell {
+            T minX = 0, minY = 0, size = 0;
+            T massX = 0, massY = 0; // center of mass
+            size_t mass = 0;        // number of bodies in the cell
+            size_t first = 0;       // leaves: bodies order[first, first + mass), also sortedX/Y
+            int64_t child = -1;     // first of four children, -1 for leaves
+        };
+        
+        std::vector<Cell> cells;
+        std::vector<size_t> order;
+        std::vector<T> sortedX, sortedY; // positions in tree order, contiguous per leaf
+        
+        void build(const std::vector<T>& xs, const std::vector<T>& ys) {
+            cells.clear();
+            order.resize(xs.size());
+            std::iota(order.begin(), order.end(), size_t(0));
+            
+            auto [minX, maxX] = std::minmax_element(xs.begin(), xs.end());
+            auto [minY, maxY] = std::minmax_element(ys.begin(), ys.end());
+            Cell root;
+            root.minX = *minX;
+            root.minY = *minY;
+            root.size = std::max(*maxX - *minX, *maxY - *minY) + 1;
+            cells.push_back(root);
+            split(0, xs, ys, 0, xs.size(), 0);
+            
+            sortedX.resize(order.size());
+            sortedY.resize(order.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                sortedX[i] = xs[order[i]];
+                sortedY[i] = ys[order[i]];
+            }
+        }
+        
+    private:
+        void split(size_t index, const std::vector<T>& xs, const std::vector<T>& ys,
+                   size_t begin, size_t end, size_t depth) {
+            T sumX = 0, sumY = 0;
+            for (size_t i = begin; i < end; ++i) {
+                sumX += xs[order[i]];
+                sumY += ys[order[i]];
+            }
+            size_t count = end - begin;
+            cells[index].mass = count;
+            cells[index].first = begin;
+            if (count > 0) {
+                cells[index].massX = sumX / static_cast<T>(count);
+                cells[index].massY = sumY / static_cast<T>(count);
+            }
+            if (count <= LeafSize || depth == MaxDepth) {
+                return;
+            }
+            
+            const Cell cell = cells[index];
+            T half = cell.size / 2;
+            T midX = cell.minX + half, midY = cell.minY + half;
+            auto first = order.begin() + static_cast<std::ptrdiff_t>(begin);
+            auto last = order.begin() + static_cast<std::ptrdiff_t>(end);
+            auto bottom = std::partition(first, last, [&](size_t i) { return ys[i] < midY; });
+            auto topRight = std::partition(first, bottom, [&](size_t i) { return xs[i] < midX; });
+            auto bottomRight = std::partition(bottom, last, [&](size_t i) { return xs[i] < midX; });
+            size_t bounds[5] = {begin, static_cast<size_t>(topRight - order.begin()),
+                                static_cast<size_t>(bottom - order.begin()),
+                                static_cast<size_t>(bottomRight - order.begin()), end};
+            
+            size_t child = cells.size();
+            cells[index].child = static_cast<int64_t>(child);
+            for (size_t quadrant = 0; quadrant < 4; ++quadrant) {
+                Cell quad;
+                quad.minX = quadrant % 2 ? midX : cell.minX;
+                quad.minY = quadrant < 2 ? cell.minY : midY;
+                quad.size = half;
+                cells.push_back(quad);
+            }
+            for (size_t quadrant = 0; quadrant < 4; ++quadrant) {
+                split(child + quadrant, xs, ys, bounds[quadrant], bounds[quadrant + 1], depth + 1);
+            }
+        }
+    };
+    
+    /// Node centers and the forces acting on them, by dense index
+    struct Bodies {
+        std::vector<T> x, y;
+        std::vector<T> fx, fy;
+        std::vector<T> edgeX, edgeY; // per-edge deltas, then spring forces
+    };
+    
+    static constexpr size_t ParallelChunk = 256; // fewer nodes per worker run inline
+    static constexpr size_t IncrementalRadius = 2; // hops around a changed node that may move
+    static constexpr T IncrementalTemperature = static_cast<T>(0.2); // of the optimal edge length
+    
+    QuadTree tree_;
+    std::vector<std::vector<int64_t>> stacks_; // traversal stack per worker
+    
+    /// Dense indices of the existing changed nodes and everything within IncrementalRadius edges
+    std::vector<size_t> collectNeighbourhood(const DenseGraph<T>& dense, const std::vector<NodeId>& changed) {
+        std::unordered_set<NodeId> seeds(changed.begin(), changed.end());
+        std::vector<size_t> distance(dense.size(), std::numeric_limits<size_t>::max());
+        std::vector<size_t> active;
+        for (size_t i = 0; i < dense.size(); ++i) {
+            if (seeds.count(dense.ids[i])) {
+                distance[i] = 0;
+                active.push_back(i);
+            }
+        }
+        
+        // Breadth-first over edges in both directions; active doubles as the queue
+        for (size_t head = 0; head < active.size(); ++head) {
+            auto node = static_cast<typename DenseGraph<T>::Index>(active[head]);
+            if (distance[node] == IncrementalRadius) {
+                continue;
+            }
+            for (auto range : {dense.successors(node), dense.predecessors(node)}) {
+                for (auto other : range) {
+                    if (distance[other] == std::numeric_limits<size_t>::max()) {
+                        distance[other] = distance[node] + 1;
+                        active.push_back(other);
+                    }
+                }
+            }
+        }
+        std::sort(active.begin(), active.end());
+        return active;
+    }
+    
+    /// Put moving nodes that are still at the origin next to their positioned neighbours
+    void placeNewNodes(DenseGraph<T>& dense, const std::vector<size_t>& active, const LayoutConfig& config) {
+        std::uniform_real_distribution<T> jitter(-config.nodeSpacing / 2, config.nodeSpacing / 2);
+        std::uniform_real_distribution<T> dist_x(config.marginX, config.marginX + 400);
+        std::uniform_real_distribution<T> dist_y(config.marginY, config.marginY + 400);
+        auto unplaced = [&](size_t i) { return dense.x[i] == 0 && dense.y[i] == 0; };
+        
+        for (size_t i : active) {
+            if (!unplaced(i)) {
+                continue;
+            }
+            T sum_x = 0, sum_y = 0;
+            size_t placed = 0;
+            auto node = static_cast<typename DenseGraph<T>::Index>(i);
+            for (auto range : {dense.successors(node), dense.predecessors(node)}) {
+                for (auto other : range) {
+                    if (!unplaced(other)) {
+                        sum_x += dense.x[other];
+                        sum_y += dense.y[other];
+                        placed++;
+                    }
+                }
+            }
+            if (placed > 0) {
+                dense.x[i] = sum_x / static_cast<T>(placed) + jitter(rng_);
+                dense.y[i] = sum_y / static_cast<T>(placed) + jitter(rng_);
+            } else {
+                dense.x[i] = dist_x(rng_);
+                dense.y[i] = dist_y(rng_);
+            }
+        }
+    }
+    
+    /// Main force simulation loop; only the nodes listed in active move
+    ///
+    /// Intermediate positions are written to graph when progress is reported.
+    size_t simulateForces(DenseGraph<T>& dense, const LayoutConfig& config, T optimal_edge_length,
+                          const std::vector<size_t>& active, T initial_temperature, Graph<T>& graph) {
         const size_t max_iterations = static_cast<size_t>(config.iterations);
         const T convergence_threshold = config.convergenceThreshold;
         
         // Temperature for simulated annealing
-        T temperature = optimal_edge_length;
+        T temperature = initial_temperature;
         const T cooling_factor = 0.95;
         const T min_temperature = 1.0;
         
+        const size_t count = dense.size();
+        Bodies bodies;
+        bodies.x.resize(count);
+        bodies.y.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            bodies.x[i] = dense.x[i] + dense.w[i] / 2;
+            bodies.y[i] = dense.y[i] + dense.h[i] / 2;
+        }
+        
+        // Fixed nodes get their forces cleared before each step
+        std::vector<size_t> fixed;
+        if (active.size() < count) {
+            std::vector<bool> moving(count, false);
+            for (size_t i : active) {
+                moving[i] = true;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (!moving[i]) {
+                    fixed.push_back(i);
+                }
+            }
+        }
+        
         size_t iteration = 0;
         for (; iteration < max_iterations; ++iteration) {
-            std::unordered_map<NodeId, ForceVector> forces;
-            
-            // Initialize forces
-            for (const auto& pair : graph.getNodes()) {
-                forces[pair.first] = ForceVector();
-            }
+            bodies.fx.assign(count, 0);
+            bodies.fy.assign(count, 0);
             
-            // Calculate repulsive forces between all pairs of nodes
-            calculateRepulsiveForces(graph, forces, optimal_edge_length);
+            // Calculate repulsive forces, approximating distant groups of nodes
+            calculateRepulsiveForces(bodies, active, optimal_edge_length, static_cast<T>(config.barnesHutTheta),
+                                     config.threads);
             
             // Calculate attractive forces for connected nodes
-            calculateAttractiveForces(graph, forces, optimal_edge_length);
+            calculateAttractiveForces(dense, bodies, optimal_edge_length);
+            for (size_t i : fixed) {
+                bodies.fx[i] = 0;
+                bodies.fy[i] = 0;
+            }
             
             // Apply forces and update positions
-            T max_displacement = applyForces(graph, forces, temperature);
+            T max_displacement = applyForces(bodies, temperature);
             
             // Cool down
             temperature = std::max(min_temperature, temperature * cooling_factor);
@@ -151,121 +370,185 @@ private:
             if (max_displacement < convergence_threshold) {
                 break;
             }
+            
+            if (this->progressDue(config, iteration + 1)) {
+                copyPositions(bodies, dense);
+                dense.applyPositions(graph);
+                this->reportProgress(graph, iteration + 1);
+            }
         }
         
+        copyPositions(bodies, dense);
         return iteration;
     }
     
-    /// Calculate repulsive forces between all pairs of nodes
-    void calculateRepulsiveForces(Graph<T>& graph, 
-                                 std::unordered_map<NodeId, ForceVector>& forces,
-                                 T optimal_edge_length) {
-        const auto& nodes = graph.getNodes();
+    /// Write body centers back as top-left node positions
+    static void copyPositions(const Bodies& bodies, DenseGraph<T>& dense) {
+        for (size_t i = 0; i < dense.size(); ++i) {
+            dense.x[i] = bodies.x[i] - dense.w[i] / 2;
+            dense.y[i] = bodies.y[i] - dense.h[i] / 2;
+        }
+    }
+    
+    /// Calculate repulsive forces between nodes closer than three edge lengths
+    ///
+    /// Each node walks a Barnes-Hut quadtree: a cell seen under an angle below
+    /// theta acts as one body at its center of mass, cells entirely out of range
+    /// are skipped. theta = 0 visits every pair in range, like the exact method.
+    void calculateRepulsiveForces(Bodies& bodies, const std::vector<size_t>& active,
+                                  T optimal_edge_length, T theta, size_t threads) {
+        const std::vector<T>& xs = bodies.x;
+        const std::vector<T>& ys = bodies.y;
         const T k_repulsive = optimal_edge_length * optimal_edge_length;
+        const T range = optimal_edge_length * 3; // Limit range
+        const T range_squared = range * range;
+        const T theta_squared = theta * theta;
         
-        for (auto it1 = nodes.begin(); it1 != nodes.end(); ++it1) {
-            for (auto it2 = std::next(it1); it2 != nodes.end(); ++it2) {
-                const auto& node1 = it1->second;
-                const auto& node2 = it2->second;
-                
-                Point<T> center1 = node1.center();
-                Point<T> center2 = node2.center();
-                
-                Point<T> delta = center1 - center2;
-                T distance = delta.magnitude();
+        tree_.build(xs, ys);
+        stacks_.resize(detail::resolveThreadCount(threads));
+        
+        // Nodes only read the tree and write their own force, so chunks of
+        // nodes run on separate threads without synchronization
+        detail::parallelFor(active.size(), threads, ParallelChunk, [&](size_t begin, size_t end, size_t worker) {
+            std::vector<int64_t>& stack = stacks_[worker];
+            for (size_t a = begin; a < end; ++a) {
+                const size_t i = active[a];
+                const T px = xs[i], py = ys[i];
+                T fx = 0, fy = 0;
                 
-                if (distance > 0 && distance < optimal_edge_length * 3) { // Limit range
-                    T force_magnitude = k_repulsive / (distance * distance);
-                    Point<T> force_direction = delta.normalized();
+                stack.assign(1, 0);
+                while (!stack.empty()) {
+                    const auto& cell = tree_.cells[static_cast<size_t>(stack.back())];
+                    stack.pop_back();
+                    if (cell.mass == 0) {
+                        continue;
+                    }
+                    
+                    // Distance from the point to the nearest point of the cell
+                    T gapX = std::max({cell.minX - px, static_cast<T>(0), px - (cell.minX + cell.size)});
+                    T gapY = std::max({cell.minY - py, static_cast<T>(0), py - (cell.minY + cell.size)});
+                    if (gapX * gapX + gapY * gapY >= range_squared) {
+                        continue;
+                    }
                     
-                    ForceVector force(force_direction.x * force_magnitude, 
-                                    force_direction.y * force_magnitude);
+                    if (cell.child < 0) {
+                        // The node itself sits at distance 0 and is skipped by the kernel
+                        kernels::accumulateRepulsion(px, py, tree_.sortedX.data() + cell.first,
+                                                     tree_.sortedY.data() + cell.first, cell.mass,
+                                                     k_repulsive, range_squared, fx, fy);
+                        continue;
+                    }
                     
-                    forces[it1->first] = forces[it1->first] + force;
-                    forces[it2->first] = forces[it2->first] + (force * -1);
+                    T dx = px - cell.massX, dy = py - cell.massY;
+                    bool outside = gapX > 0 || gapY > 0;
+                    if (outside && cell.size * cell.size < theta_squared * (dx * dx + dy * dy)) {
+                        // One body at the center of mass, scaled by the number of bodies
+                        kernels::scalar::accumulateRepulsion(px, py, &cell.massX, &cell.massY, 1,
+                                                             k_repulsive * static_cast<T>(cell.mass),
+                                                             range_squared, fx, fy);
+                        continue;
+                    }
+                    for (int64_t child = cell.child; child < cell.child + 4; ++child) {
+                        stack.push_back(child);
+                    }
                 }
+                
+                bodies.fx[i] += fx;
+                bodies.fy[i] += fy;
             }
-        }
+        });
     }
     
     /// Calculate attractive forces for connected nodes
-    void calculateAttractiveForces(Graph<T>& graph,
-                                  std::unordered_map<NodeId, ForceVector>& forces,
-                                  T optimal_edge_length) {
-        for (const auto& edge : graph.getEdges()) {
-            auto node1 = graph.getNode(edge.from);
-            auto node2 = graph.getNode(edge.to);
-            
-            if (!node1 || !node2) continue;
-            
-            Point<T> center1 = node1->center();
-            Point<T> center2 = node2->center();
-            
-            Point<T> delta = center2 - center1;
-            T distance = delta.magnitude();
-            
-            if (distance > 0) {
-                T force_magnitude = (distance * distance) / optimal_edge_length;
-                Point<T> force_direction = delta.normalized();
-                
-                ForceVector force(force_direction.x * force_magnitude,
-                                force_direction.y * force_magnitude);
-                
-                forces[edge.from] = forces[edge.from] + force;
-                forces[edge.to] = forces[edge.to] + (force * -1);
-            }
+    ///
+    /// Edge deltas are gathered into contiguous arrays, turned into d^2 / k
+    /// springs by a vector kernel and scattered back onto both endpoints.
+    void calculateAttractiveForces(const DenseGraph<T>& dense, Bodies& bodies, T optimal_edge_length) {
+        const size_t edge_count = dense.edgeCount();
+        bodies.edgeX.resize(edge_count);
+        bodies.edgeY.resize(edge_count);
+        for (size_t e = 0; e < edge_count; ++e) {
+            const auto [from, to] = dense.edges[e];
+            bodies.edgeX[e] = bodies.x[to] - bodies.x[from];
+            bodies.edgeY[e] = bodies.y[to] - bodies.y[from];
+        }
+        
+        kernels::springForces(bodies.edgeX.data(), bodies.edgeY.data(), edge_count,
+                              static_cast<T>(1) / optimal_edge_length);
+        
+        for (size_t e = 0; e < edge_count; ++e) {
+            const auto [from, to] = dense.edges[e];
+            bodies.fx[from] += bodies.edgeX[e];
+            bodies.fy[from] += bodies.edgeY[e];
+            bodies.fx[to] -= bodies.edgeX[e];
+            bodies.fy[to] -= bodies.edgeY[e];
         }
     }
     
-    /// Apply forces to nodes and update positions
-    T applyForces(Graph<T>& graph,
-                  const std::unordered_map<NodeId, ForceVector>& forces,
-                  T temperature) {
-        T max_displacement = 0;
-        
-        for (const auto& pair : forces) {
-            NodeId node_id = pair.first;
-            const ForceVector& force = pair.second;
-            
-            auto node = graph.getNode(node_id);
-            if (!node) continue;
-            
-            // Limit displacement by temperature
-            T displacement_magnitude = std::min(force.magnitude(), temperature);
-            
-            if (displacement_magnitude > 0) {
-                ForceVector displacement = force.normalized() * displacement_magnitude;
-                
-                Point<T> new_position = {
-                    node->position.x + displacement.x,
-                    node->position.y + displacement.y
-                };
-                
-                graph.updateNodePosition(node_id, new_position);
-                max_displacement = std::max(max_displacement, displacement_magnitude);
-            }
-        }
-        
-        return max_displacement;
+    /// Apply forces to nodes and update positions, limiting each step by temperature
+    T applyForces(Bodies& bodies, T temperature) {
+        return kernels::displace(bodies.x.data(), bodies.y.data(), bodies.fx.data(), bodies.fy.data(),
+                                 bodies.x.size(), temperature);
     }
     
     /// Remove overlaps between nodes using simple separation
-    void removeOverlaps(Graph<T>& graph, const LayoutConfig& config) {
+    ///
+    /// Candidates come from a spatial hash with cells as large as the largest
+    /// node plus the separation, so only nodes in neighboring cells can overlap.
+    /// Only nodes listed in active move; a fixed node pushes the other one the
+    /// whole way.
+    void removeOverlaps(DenseGraph<T>& dense, const LayoutConfig& config, const std::vector<size_t>& active) {
         const size_t max_overlap_iterations = 10;
         const T min_separation = config.nodeSpacing * 0.5;
+        const size_t count = dense.size();
+        if (count == 0) {
+            return;
+        }
+        
+        T cell_width = *std::max_element(dense.w.begin(), dense.w.end()) + min_separation;
+        T cell_height = *std::max_element(dense.h.begin(), dense.h.end()) + min_separation;
+        if (cell_width <= 0 || cell_height <= 0) {
+            return;
+        }
+        
+        auto cellOf = [&](size_t i) {
+            return std::make_pair(static_cast<int64_t>(std::floor(dense.x[i] / cell_width)),
+                                  static_cast<int64_t>(std::floor(dense.y[i] / cell_height)));
+        };
+        auto key = [](int64_t x, int64_t y) {
+            return (static_cast<uint64_t>(x) << 32) ^ static_cast<uint32_t>(y);
+        };
+        
+        std::vector<bool> moving(count, false);
+        for (size_t i : active) {
+            moving[i] = true;
+        }
         
+        std::unordered_map<uint64_t, std::vector<size_t>> buckets;
         for (size_t iter = 0; iter < max_overlap_iterations; ++iter) {
             bool had_overlaps = false;
-            const auto& nodes = graph.getNodes();
             
-            for (auto it1 = nodes.begin(); it1 != nodes.end(); ++it1) {
-                for (auto it2 = std::next(it1); it2 != nodes.end(); ++it2) {
-                    const auto& node1 = it1->second;
-                    const auto& node2 = it2->second;
-                    
-                    if (nodesOverlap(node1, node2, min_separation)) {
-                        separateNodes(graph, it1->first, it2->first, min_separation);
-                        had_overlaps = true;
+            buckets.clear();
+            for (size_t i = 0; i < count; ++i) {
+                auto [x, y] = cellOf(i);
+                buckets[key(x, y)].push_back(i);
+            }
+            
+            for (size_t i : active) {
+                auto [x, y] = cellOf(i);
+                for (int64_t nx = x - 1; nx <= x + 1; ++nx) {
+                    for (int64_t ny = y - 1; ny <= y + 1; ++ny) {
+                        auto bucket = buckets.find(key(nx, ny));
+                        if (bucket == buckets.end()) {
+                            continue;
+                        }
+                        for (size_t j : bucket->second) {
+                            // Pairs of moving nodes are visited once, from the lower index
+                            if ((!moving[j] || j > i) && nodesOverlap(dense, i, j, min_separation)) {
+                                separateNodes(dense, i, j, min_separation, moving[j]);
+                                had_overlaps = true;
+                            }
+                        }
                     }
                 }
             }
@@ -275,24 +558,17 @@ private:
     }
     
     /// Check if two nodes overlap
-    bool nodesOverlap(const Node<T>& a, const Node<T>& b, T padding) {
-        return !(a.position.x + a.size.x + padding <= b.position.x ||
-                 b.position.x + b.size.x + padding <= a.position.x ||
-                 a.position.y + a.size.y + padding <= b.position.y ||
-                 b.position.y + b.size.y + padding <= a.position.y);
+    static bool nodesOverlap(const DenseGraph<T>& dense, size_t a, size_t b, T padding) {
+        return !(dense.x[a] + dense.w[a] + padding <= dense.x[b] ||
+                 dense.x[b] + dense.w[b] + padding <= dense.x[a] ||
+                 dense.y[a] + dense.h[a] + padding <= dense.y[b] ||
+                 dense.y[b] + dense.h[b] + padding <= dense.y[a]);
     }
     
-    /// Separate two overlapping nodes
-    void separateNodes(Graph<T>& graph, NodeId id1, NodeId id2, T min_separation) {
-        auto node1 = graph.getNode(id1);
-        auto node2 = graph.getNode(id2);
-        
-        if (!node1 || !node2) return;
-        
-        Point<T> center1 = node1->center();
-        Point<T> center2 = node2->center();
-        
-        Point<T> delta = center1 - center2;
+    /// Separate two overlapping nodes; b only moves if b_moves is set
+    void separateNodes(DenseGraph<T>& dense, size_t a, size_t b, T min_separation, bool b_moves) {
+        Point<T> delta = {(dense.x[a] + dense.w[a] / 2) - (dense.x[b] + dense.w[b] / 2),
+                          (dense.y[a] + dense.h[a] / 2) - (dense.y[b] + dense.h[b] / 2)};
         T distance = delta.magnitude();
         
         if (distance == 0) {
@@ -303,20 +579,19 @@ private:
         }
         
         if (distance > 0) {
-            T required_distance = (node1->size.x + node2->size.x) / 2 + min_separation;
+            T required_distance = (dense.w[a] + dense.w[b]) / 2 + min_separation;
             T separation_distance = (required_distance - distance) / 2;
             
             Point<T> separation_vector = delta.normalized() * separation_distance;
             
-            graph.updateNodePosition(id1, {
-                node1->position.x + separation_vector.x,
-                node1->position.y + separation_vector.y
-            });
-            
-            graph.updateNodePosition(id2, {
-                node2->position.x - separation_vector.x,
-                node2->position.y - separation_vector.y
-            });
+            if (b_moves) {
+                dense.x[b] -= separation_vector.x;
+                dense.y[b] -= separation_vector.y;
+            } else {
+                separation_vector = separation_vector * 2;
+            }
+            dense.x[a] += separation_vector.x;
+            dense.y[a] += separation_vector.y;
         }
     }
     
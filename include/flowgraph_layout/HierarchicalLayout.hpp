@@ -1,10 +1,12 @@
 #pragma once
 
 #include "LayoutTypes.hpp"
+#include "DenseGraph.hpp"
+#include "Parallel.hpp"
 #include <queue>
-#include <set>
 #include <algorithm>
 #include <numeric>
+#include <unordered_set>
 
 namespace flowgraph::layout {
 
@@ -13,13 +15,19 @@ namespace flowgraph::layout {
 template<typename T = double>
 class HierarchicalLayout : public LayoutAlgorithm<T> {
 private:
+    using Index = typename DenseGraph<T>::Index;
+    
     struct LayerInfo {
-        std::vector<NodeId> nodes;
+        std::vector<Index> nodes;
         T y_position = 0;
     };
     
     std::vector<LayerInfo> layers_;
-    std::unordered_map<NodeId, size_t> node_to_layer_;
+    std::vector<size_t> node_to_layer_;     // by dense index
+    std::vector<size_t> position_in_layer_; // by dense index, kept in sync with layers_
+    std::vector<std::pair<T, NodeId>> barycenters_;
+    
+    static constexpr size_t ParallelChunk = 1024; // fewer nodes per worker run inline
     
 public:
     std::string getName() const override {
@@ -31,6 +39,19 @@ public:
     }
     
     LayoutResult apply(Graph<T>& graph, const LayoutConfig& config = {}) override {
+        return run(graph, config, nullptr);
+    }
+    
+    /// Re-layer the graph, keeping the current left-to-right order of nodes
+    /// and reducing crossings only in the layers of changed nodes and their
+    /// neighbours
+    LayoutResult applyIncremental(Graph<T>& graph, const std::vector<NodeId>& changed,
+                                  const LayoutConfig& config = {}) override {
+        return run(graph, config, &changed);
+    }
+    
+private:
+    LayoutResult run(Graph<T>& graph, const LayoutConfig& config, const std::vector<NodeId>* changed) {
         LayoutResult result;
         
         if (graph.nodeCount() == 0) {
@@ -39,18 +60,27 @@ public:
         }
         
         try {
+            DenseGraph<T> dense = DenseGraph<T>::fromGraph(graph);
+            
             // Phase 1: Assign nodes to layers
-            if (!assignLayers(graph)) {
+            if (!assignLayers(dense)) {
                 result.success = false;
                 result.errorMessage = "Graph contains cycles - not suitable for hierarchical layout";
                 return result;
             }
             
             // Phase 2: Reduce edge crossings
-            reduceCrossings(graph, config);
+            if (changed) {
+                orderLayersByPosition(dense);
+                std::vector<bool> affected = affectedLayers(dense, *changed);
+                reduceCrossings(dense, config, &affected);
+            } else {
+                reduceCrossings(dense, config, nullptr);
+            }
             
             // Phase 3: Assign coordinates
-            assignCoordinates(graph, config);
+            assignCoordinates(dense, config);
+            dense.applyPositions(graph);
             
             result.success = true;
             result.boundingBox = calculateBoundingBox(graph);
@@ -63,31 +93,23 @@ public:
         return result;
     }
     
-private:
     /// Phase 1: Assign nodes to layers using longest path algorithm
-    bool assignLayers(Graph<T>& graph) {
+    bool assignLayers(const DenseGraph<T>& dense) {
+        const size_t count = dense.size();
         layers_.clear();
-        node_to_layer_.clear();
+        node_to_layer_.assign(count, 0);
         
         // Calculate in-degree for each node
-        std::unordered_map<NodeId, size_t> in_degree;
-        for (const auto& pair : graph.getNodes()) {
-            in_degree[pair.first] = 0;
-        }
-        
-        for (const auto& edge : graph.getEdges()) {
-            in_degree[edge.to]++;
+        std::vector<size_t> in_degree(count);
+        for (size_t i = 0; i < count; ++i) {
+            in_degree[i] = dense.predecessors(static_cast<Index>(i)).size();
         }
         
-        // Topological sort with layer assignment
-        std::queue<NodeId> ready_nodes;
-        std::unordered_map<NodeId, size_t> node_layers;
-        
-        // Start with nodes having no incoming edges
-        for (const auto& pair : in_degree) {
-            if (pair.second == 0) {
-                ready_nodes.push(pair.first);
-                node_layers[pair.first] = 0;
+        // Topological sort with layer assignment, starting with nodes having no incoming edges
+        std::queue<Index> ready_nodes;
+        for (size_t i = 0; i < count; ++i) {
+            if (in_degree[i] == 0) {
+                ready_nodes.push(static_cast<Index>(i));
             }
         }
         
@@ -95,61 +117,88 @@ private:
         size_t max_layer = 0;
         
         while (!ready_nodes.empty()) {
-            NodeId current = ready_nodes.front();
+            Index current = ready_nodes.front();
             ready_nodes.pop();
             processed_nodes++;
             
-            size_t current_layer = node_layers[current];
+            size_t current_layer = node_to_layer_[current];
             max_layer = std::max(max_layer, current_layer);
             
             // Process all outgoing edges
-            for (const auto& edge : graph.getEdges()) {
-                if (edge.from == current) {
-                    in_degree[edge.to]--;
-                    
-                    // Update layer assignment
-                    node_layers[edge.to] = std::max(node_layers[edge.to], current_layer + 1);
-                    
-                    if (in_degree[edge.to] == 0) {
-                        ready_nodes.push(edge.to);
-                    }
+            for (Index next : dense.successors(current)) {
+                node_to_layer_[next] = std::max(node_to_layer_[next], current_layer + 1);
+                if (--in_degree[next] == 0) {
+                    ready_nodes.push(next);
                 }
             }
         }
         
         // Check for cycles
-        if (processed_nodes != graph.nodeCount()) {
+        if (processed_nodes != count) {
             return false; // Graph contains cycles
         }
         
         // Organize nodes into layers
         layers_.resize(max_layer + 1);
-        for (const auto& pair : node_layers) {
-            size_t layer = pair.second;
-            layers_[layer].nodes.push_back(pair.first);
-            node_to_layer_[pair.first] = layer;
+        position_in_layer_.assign(count, 0);
+        for (size_t i = 0; i < count; ++i) {
+            auto& nodes = layers_[node_to_layer_[i]].nodes;
+            position_in_layer_[i] = nodes.size();
+            nodes.push_back(static_cast<Index>(i));
         }
         
         return true;
     }
     
-    /// Phase 2: Reduce edge crossings using barycenter heuristic
-    void reduceCrossings(Graph<T>& graph, const LayoutConfig& config) {
+    /// Warm start: order every layer by the current x positions of its nodes
+    void orderLayersByPosition(const DenseGraph<T>& dense) {
+        for (auto& layer : layers_) {
+            std::stable_sort(layer.nodes.begin(), layer.nodes.end(),
+                             [&](Index a, Index b) { return dense.x[a] < dense.x[b]; });
+            for (size_t i = 0; i < layer.nodes.size(); ++i) {
+                position_in_layer_[layer.nodes[i]] = i;
+            }
+        }
+    }
+    
+    /// Layers holding a changed node or one of its neighbours
+    std::vector<bool> affectedLayers(const DenseGraph<T>& dense, const std::vector<NodeId>& changed) const {
+        std::unordered_set<NodeId> seeds(changed.begin(), changed.end());
+        std::vector<bool> affected(layers_.size(), false);
+        for (size_t i = 0; i < dense.size(); ++i) {
+            if (!seeds.count(dense.ids[i])) {
+                continue;
+            }
+            auto node = static_cast<Index>(i);
+            affected[node_to_layer_[node]] = true;
+            for (auto range : {dense.successors(node), dense.predecessors(node)}) {
+                for (Index other : range) {
+                    affected[node_to_layer_[other]] = true;
+                }
+            }
+        }
+        return affected;
+    }
+    
+    /// Phase 2: Reduce edge crossings using barycenter heuristic, optionally
+    /// only reordering the affected layers
+    void reduceCrossings(const DenseGraph<T>& dense, const LayoutConfig& config, const std::vector<bool>* affected) {
         const size_t max_iterations = static_cast<size_t>(config.iterations / 4); // Use 1/4 of total iterations
+        auto reorders = [&](size_t layer) { return !affected || (*affected)[layer]; };
         
         for (size_t iter = 0; iter < max_iterations; ++iter) {
             bool changed = false;
             
             // Forward pass: fix upper layers, optimize lower layers
             for (size_t layer = 1; layer < layers_.size(); ++layer) {
-                if (reorderLayer(graph, layer, true)) {
+                if (reorders(layer) && reorderLayer(dense, layer, true, config.threads)) {
                     changed = true;
                 }
             }
             
             // Backward pass: fix lower layers, optimize upper layers
             for (size_t layer = layers_.size() - 2; layer != SIZE_MAX; --layer) {
-                if (reorderLayer(graph, layer, false)) {
+                if (reorders(layer) && reorderLayer(dense, layer, false, config.threads)) {
                     changed = true;
                 }
             }
@@ -159,64 +208,64 @@ private:
     }
     
     /// Reorder nodes in a layer to reduce crossings
-    bool reorderLayer(Graph<T>& graph, size_t layer_idx, bool forward) {
+    ///
+    /// Barycenters only read the positions of the neighboring layer, so wide
+    /// layers compute them in parallel; the sort that follows is sequential.
+    bool reorderLayer(const DenseGraph<T>& dense, size_t layer_idx, bool forward, size_t threads) {
         if (layer_idx >= layers_.size()) return false;
         
         auto& layer = layers_[layer_idx];
         if (layer.nodes.size() <= 1) return false;
         
         // Calculate barycenter for each node
-        std::vector<std::pair<T, NodeId>> barycenters;
-        
-        for (NodeId node_id : layer.nodes) {
-            T barycenter = calculateBarycenter(graph, node_id, forward);
-            barycenters.emplace_back(barycenter, node_id);
-        }
+        auto& barycenters = barycenters_;
+        barycenters.resize(layer.nodes.size());
+        detail::parallelFor(layer.nodes.size(), threads, ParallelChunk, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                Index node = layer.nodes[i];
+                barycenters[i] = {calculateBarycenter(dense, node, forward), dense.ids[node]};
+            }
+        });
         
-        // Sort by barycenter
-        auto original_order = layer.nodes;
-        std::sort(barycenters.begin(), barycenters.end());
+        // Sort by barycenter, ties by node ID
+        std::vector<Index> order(layer.nodes.size());
+        std::iota(order.begin(), order.end(), Index(0));
+        std::sort(order.begin(), order.end(), [&](Index a, Index b) {
+            return barycenters[a] < barycenters[b];
+        });
         
-        layer.nodes.clear();
-        for (const auto& pair : barycenters) {
-            layer.nodes.push_back(pair.second);
+        bool changed = false;
+        std::vector<Index> reordered(layer.nodes.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            reordered[i] = layer.nodes[order[i]];
+            changed = changed || order[i] != i;
+            position_in_layer_[reordered[i]] = i;
         }
+        layer.nodes = std::move(reordered);
         
-        return original_order != layer.nodes;
+        return changed;
     }
     
     /// Calculate barycenter position for a node
-    T calculateBarycenter(Graph<T>& graph, NodeId node_id, bool forward) {
-        size_t current_layer = node_to_layer_[node_id];
+    T calculateBarycenter(const DenseGraph<T>& dense, Index node, bool forward) const {
+        size_t current_layer = node_to_layer_[node];
         T sum_positions = 0;
         size_t count = 0;
         
         if (forward && current_layer > 0) {
             // Look at predecessors in previous layer
-            size_t prev_layer = current_layer - 1;
-            for (const auto& edge : graph.getEdges()) {
-                if (edge.to == node_id && node_to_layer_[edge.from] == prev_layer) {
-                    // Find position of predecessor in its layer
-                    const auto& prev_nodes = layers_[prev_layer].nodes;
-                    auto it = std::find(prev_nodes.begin(), prev_nodes.end(), edge.from);
-                    if (it != prev_nodes.end()) {
-                        sum_positions += static_cast<T>(std::distance(prev_nodes.begin(), it));
-                        count++;
-                    }
+            for (Index other : dense.predecessors(node)) {
+                if (node_to_layer_[other] == current_layer - 1) {
+                    sum_positions += static_cast<T>(position_in_layer_[other]);
+                    count++;
                 }
             }
         } else if (!forward && current_layer + 1 < layers_.size()) {
             // Look at successors in next layer
-            size_t next_layer = current_layer + 1;
-            for (const auto& edge : graph.getEdges()) {
-                if (edge.from == node_id && node_to_layer_[edge.to] == next_layer) {
-                    // Find position of successor in its layer
-                    const auto& next_nodes = layers_[next_layer].nodes;
-                    auto it = std::find(next_nodes.begin(), next_nodes.end(), edge.to);
-                    if (it != next_nodes.end()) {
-                        sum_positions += static_cast<T>(std::distance(next_nodes.begin(), it));
-                        count++;
-                    }
+            for (Index other : dense.successors(node)) {
+                if (node_to_layer_[other] == current_layer + 1) {
+                    sum_positions += static_cast<T>(position_in_layer_[other]);
+                    count++;
                 }
             }
         }
@@ -225,7 +274,7 @@ private:
     }
     
     /// Phase 3: Assign final coordinates
-    void assignCoordinates(Graph<T>& graph, const LayoutConfig& config) {
+    void assignCoordinates(DenseGraph<T>& dense, const LayoutConfig& config) {
         if (layers_.empty()) return;
         
         T current_y = config.marginY;
@@ -234,49 +283,26 @@ private:
             auto& layer = layers_[layer_idx];
             layer.y_position = current_y;
             
-            // Calculate total width needed for this layer
-            T total_node_width = 0;
-            for (NodeId node_id : layer.nodes) {
-                auto node = graph.getNode(node_id);
-                if (node) {
-                    total_node_width += node->size.x;
-                }
-            }
-            
-            T total_spacing = (layer.nodes.size() - 1) * config.nodeSpacing;
-            T total_width = total_node_width + total_spacing;
-            
             // Position nodes horizontally
             T current_x = config.marginX;
-            if (total_width > 0) {
-                // Center the layer if we have space
-                current_x = config.marginX;
-            }
-            
-            for (size_t i = 0; i < layer.nodes.size(); ++i) {
-                NodeId node_id = layer.nodes[i];
-                auto node = graph.getNode(node_id);
-                if (node) {
-                    graph.updateNodePosition(node_id, {current_x, current_y});
-                    current_x += node->size.x + config.nodeSpacing;
-                }
+            for (Index node : layer.nodes) {
+                dense.x[node] = current_x;
+                dense.y[node] = current_y;
+                current_x += dense.w[node] + config.nodeSpacing;
             }
             
             // Move to next layer
-            current_y += findMaxNodeHeightInLayer(graph, layer_idx) + config.layerSpacing;
+            current_y += findMaxNodeHeightInLayer(dense, layer_idx) + config.layerSpacing;
         }
     }
     
     /// Find maximum node height in a layer
-    T findMaxNodeHeightInLayer(Graph<T>& graph, size_t layer_idx) {
+    T findMaxNodeHeightInLayer(const DenseGraph<T>& dense, size_t layer_idx) {
         if (layer_idx >= layers_.size()) return 0;
         
         T max_height = 0;
-        for (NodeId node_id : layers_[layer_idx].nodes) {
-            auto node = graph.getNode(node_id);
-            if (node) {
-                max_height = std::max(max_height, node->size.y);
-            }
+        for (Index node : layers_[layer_idx].nodes) {
+            max_height = std::max(max_height, dense.h[node]);
         }
         return max_height > 0 ? max_height : 30; // Default height
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "LayoutTypes.hpp"
+#include "LayoutKernels.hpp"
 #include <memory>
 #include <string>
 #include <functional>
@@ -208,19 +209,31 @@ bool nodesOverlap(const Node<T>& a, const Node<T>& b, T padding = 0) {
 }
 
 /// Count overlapping nodes in the graph
+///
+/// Boxes are copied into contiguous arrays once, then each node is tested
+/// against all later ones by the vectorized AABB kernel.
 template<typename T>
 size_t countOverlaps(const Graph<T>& graph, T padding = 0) {
-    size_t overlaps = 0;
-    const auto& nodes = graph.getNodes();
-    
-    for (auto it1 = nodes.begin(); it1 != nodes.end(); ++it1) {
-        for (auto it2 = std::next(it1); it2 != nodes.end(); ++it2) {
-            if (nodesOverlap(it1->second, it2->second, padding)) {
-                overlaps++;
-            }
-        }
+    const size_t count = graph.nodeCount();
+    std::vector<T> xs, ys, ws, hs;
+    xs.reserve(count);
+    ys.reserve(count);
+    ws.reserve(count);
+    hs.reserve(count);
+    for (const auto& pair : graph.getNodes()) {
+        xs.push_back(pair.second.position.x);
+        ys.push_back(pair.second.position.y);
+        ws.push_back(pair.second.size.x);
+        hs.push_back(pair.second.size.y);
     }
     
+    size_t overlaps = 0;
+    for (size_t i = 0; i + 1 < count; ++i) {
+        overlaps += kernels::countOverlaps(xs[i], ys[i], ws[i], hs[i],
+                                           xs.data() + i + 1, ys.data() + i + 1,
+                                           ws.data() + i + 1, hs.data() + i + 1,
+                                           count - i - 1, padding);
+    }
     return overlaps;
 }
 
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+// The vector backend is chosen at compile time: AVX2 when the compiler targets
+// it (-mavx2, -march=native or /arch:AVX2), NEON on AArch64, scalar otherwise.
+// Define FLOWGRAPH_NO_SIMD to force the scalar kernels.
+#if !defined(FLOWGRAPH_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define FLOWGRAPH_LAYOUT_AVX2 1
+#elif !defined(FLOWGRAPH_NO_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FLOWGRAPH_LAYOUT_NEON 1
+#endif
+
+namespace flowgraph::layout::kernels {
+
+/// Name of the vector backend the kernels were compiled for
+constexpr const char* backend() {
+#if defined(FLOWGRAPH_LAYOUT_AVX2)
+    return "avx2";
+#elif defined(FLOWGRAPH_LAYOUT_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+/// Reference implementations, used for any T and for the tail of vector loops
+namespace scalar {
+
+template<typename T>
+void accumulateRepulsion(T px, T py, const T* xs, const T* ys, size_t count,
+                         T k, T range_squared, T& fx, T& fy) {
+    for (size_t i = 0; i < count; ++i) {
+        T dx = px - xs[i], dy = py - ys[i];
+        T distance_squared = dx * dx + dy * dy;
+        if (distance_squared > 0 && distance_squared < range_squared) {
+            T scale = k / (distance_squared * std::sqrt(distance_squared));
+            fx += dx * scale;
+            fy += dy * scale;
+        }
+    }
+}
+
+template<typename T>
+void springForces(T* dx, T* dy, size_t count, T inverse_length) {
+    for (size_t i = 0; i < count; ++i) {
+        T scale = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]) * inverse_length;
+        dx[i] *= scale;
+        dy[i] *= scale;
+    }
+}
+
+template<typename T>
+T displace(T* xs, T* ys, const T* fx, const T* fy, size_t count, T limit) {
+    T max_displacement = 0;
+    for (size_t i = 0; i < count; ++i) {
+        T magnitude = std::sqrt(fx[i] * fx[i] + fy[i] * fy[i]);
+        T displacement = std::min(magnitude, limit);
+        if (displacement > 0) {
+            T scale = displacement / magnitude;
+            xs[i] += fx[i] * scale;
+            ys[i] += fy[i] * scale;
+            max_displacement = std::max(max_displacement, displacement);
+        }
+    }
+    return max_displacement;
+}
+
+template<typename T>
+size_t countOverlaps(T x, T y, T w, T h, const T* xs, const T* ys, const T* ws, const T* hs,
+                     size_t count, T padding) {
+    size_t overlaps = 0;
+    for (size_t i = 0; i < count; ++i) {
+        overlaps += (x + w + padding > xs[i]) & (xs[i] + ws[i] + padding > x) &
+                    (y + h + padding > ys[i]) & (ys[i] + hs[i] + padding > y);
+    }
+    return overlaps;
+}
+
+} // namespace scalar
+
+#if defined(FLOWGRAPH_LAYOUT_AVX2)
+namespace detail {
+
+inline double horizontalSum(__m256d v) {
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+inline double horizontalMax(__m256d v) {
+    __m128d max = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(max, _mm_unpackhi_pd(max, max)));
+}
+
+} // namespace detail
+#endif
+
+/// Add the repulsion of unit bodies at (xs[i], ys[i]) on the point (px, py)
+///
+/// Each body within range pushes with k / d^2 along the direction away from
+/// it; bodies at distance 0 (including the point itself) are skipped.
+template<typename T>
+void accumulateRepulsion(T px, T py, const T* xs, const T* ys, size_t count,
+                         T k, T range_squared, T& fx, T& fy) {
+    size_t i = 0;
+    if constexpr (std::is_same_v<T, double>) {
+#if defined(FLOWGRAPH_LAYOUT_AVX2)
+        const __m256d vpx = _mm256_set1_pd(px), vpy = _mm256_set1_pd(py);
+        const __m256d vk = _mm256_set1_pd(k), vrange = _mm256_set1_pd(range_squared);
+        const __m256d zero = _mm256_setzero_pd();
+        __m256d accx = zero, accy = zero;
+        for (; i + 4 <= count; i += 4) {
+            __m256d dx = _mm256_sub_pd(vpx, _mm256_loadu_pd(xs + i));
+            __m256d dy = _mm256_sub_pd(vpy, _mm256_loadu_pd(ys + i));
+            __m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+            __m256d mask = _mm256_and_pd(_mm256_cmp_pd(d2, zero, _CMP_GT_OQ),
+                                         _mm256_cmp_pd(d2, vrange, _CMP_LT_OQ));
+            __m256d scale = _mm256_div_pd(vk, _mm256_mul_pd(d2, _mm256_sqrt_pd(d2)));
+            scale = _mm256_and_pd(scale, mask);
+            accx = _mm256_add_pd(accx, _mm256_mul_pd(dx, scale));
+            accy = _mm256_add_pd(accy, _mm256_mul_pd(dy, scale));
+        }
+        fx += detail::horizontalSum(accx);
+        fy += detail::horizontalSum(accy);
+#elif defined(FLOWGRAPH_LAYOUT_NEON)
+        const float64x2_t vpx = vdupq_n_f64(px), vpy = vdupq_n_f64(py);
+        const float64x2_t vk = vdupq_n_f64(k), vrange = vdupq_n_f64(range_squared);
+        const float64x2_t zero = vdupq_n_f64(0);
+        float64x2_t accx = zero, accy = zero;
+        for (; i + 2 <= count; i += 2) {
+            float64x2_t dx = vsubq_f64(vpx, vld1q_f64(xs + i));
+            float64x2_t dy = vsubq_f64(vpy, vld1q_f64(ys + i));
+            float64x2_t d2 = vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy));
+            uint64x2_t mask = vandq_u64(vcgtq_f64(d2, zero), vcltq_f64(d2, vrange));
+            float64x2_t scale = vdivq_f64(vk, vmulq_f64(d2, vsqrtq_f64(d2)));
+            scale = vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(scale), mask));
+            accx = vaddq_f64(accx, vmulq_f64(dx, scale));
+            accy = vaddq_f64(accy, vmulq_f64(dy, scale));
+        }
+        fx += vaddvq_f64(accx);
+        fy += vaddvq_f64(accy);
+#endif
+    }
+    scalar::accumulateRepulsion(px, py, xs + i, ys + i, count - i, k, range_squared, fx, fy);
+}
+
+/// Turn edge deltas into spring forces of magnitude d^2 * inverse_length, in place
+template<typename T>
+void springForces(T* dx, T* dy, size_t count, T inverse_length) {
+    size_t i = 0;
+    if constexpr (std::is_same_v<T, double>) {
+#if defined(FLOWGRAPH_LAYOUT_AVX2)
+        const __m256d vinv = _mm256_set1_pd(inverse_length);
+        for (; i + 4 <= count; i += 4) {
+            __m256d x = _mm256_loadu_pd(dx + i), y = _mm256_loadu_pd(dy + i);
+            __m256d d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y)));
+            __m256d scale = _mm256_mul_pd(d, vinv);
+            _mm256_storeu_pd(dx + i, _mm256_mul_pd(x, scale));
+            _mm256_storeu_pd(dy + i, _mm256_mul_pd(y, scale));
+        }
+#elif defined(FLOWGRAPH_LAYOUT_NEON)
+        const float64x2_t vinv = vdupq_n_f64(inverse_length);
+        for (; i + 2 <= count; i += 2) {
+            float64x2_t x = vld1q_f64(dx + i), y = vld1q_f64(dy + i);
+            float64x2_t d = vsqrtq_f64(vaddq_f64(vmulq_f64(x, x), vmulq_f64(y, y)));
+            float64x2_t scale = vmulq_f64(d, vinv);
+            vst1q_f64(dx + i, vmulq_f64(x, scale));
+            vst1q_f64(dy + i, vmulq_f64(y, scale));
+        }
+#endif
+    }
+    scalar::springForces(dx + i, dy + i, count - i, inverse_length);
+}
+
+/// Move each point along its force by at most limit; returns the largest step
+template<typename T>
+T displace(T* xs, T* ys, const T* fx, const T* fy, size_t count, T limit) {
+    size_t i = 0;
+    T max_displacement = 0;
+    if constexpr (std::is_same_v<T, double>) {
+#if defined(FLOWGRAPH_LAYOUT_AVX2)
+        const __m256d vlimit = _mm256_set1_pd(limit), zero = _mm256_setzero_pd();
+        __m256d vmax = zero;
+        for (; i + 4 <= count; i += 4) {
+            __m256d x = _mm256_loadu_pd(fx + i), y = _mm256_loadu_pd(fy + i);
+            __m256d magnitude = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y)));
+            __m256d displacement = _mm256_min_pd(magnitude, vlimit);
+            __m256d moving = _mm256_cmp_pd(displacement, zero, _CMP_GT_OQ);
+            __m256d scale = _mm256_and_pd(_mm256_div_pd(displacement, magnitude), moving);
+            _mm256_storeu_pd(xs + i, _mm256_add_pd(_mm256_loadu_pd(xs + i), _mm256_mul_pd(x, scale)));
+            _mm256_storeu_pd(ys + i, _mm256_add_pd(_mm256_loadu_pd(ys + i), _mm256_mul_pd(y, scale)));
+            vmax = _mm256_max_pd(vmax, _mm256_and_pd(displacement, moving));
+        }
+        max_displacement = detail::horizontalMax(vmax);
+#elif defined(FLOWGRAPH_LAYOUT_NEON)
+        const float64x2_t vlimit = vdupq_n_f64(limit), zero = vdupq_n_f64(0);
+        float64x2_t vmax = zero;
+        for (; i + 2 <= count; i += 2) {
+            float64x2_t x = vld1q_f64(fx + i), y = vld1q_f64(fy + i);
+            float64x2_t magnitude = vsqrtq_f64(vaddq_f64(vmulq_f64(x, x), vmulq_f64(y, y)));
+            float64x2_t displacement = vminq_f64(magnitude, vlimit);
+            uint64x2_t moving = vcgtq_f64(displacement, zero);
+            float64x2_t scale = vreinterpretq_f64_u64(
+                vandq_u64(vreinterpretq_u64_f64(vdivq_f64(displacement, magnitude)), moving));
+            vst1q_f64(xs + i, vaddq_f64(vld1q_f64(xs + i), vmulq_f64(x, scale)));
+            vst1q_f64(ys + i, vaddq_f64(vld1q_f64(ys + i), vmulq_f64(y, scale)));
+            vmax = vmaxq_f64(vmax, vreinterpretq_f64_u64(
+                vandq_u64(vreinterpretq_u64_f64(displacement), moving)));
+        }
+        max_displacement = vmaxvq_f64(vmax);
+#endif
+    }
+    return std::max(max_displacement,
+                    scalar::displace(xs + i, ys + i, fx + i, fy + i, count - i, limit));
+}
+
+/// Count the boxes (xs[i], ys[i], ws[i], hs[i]) that overlap the box (x, y, w, h)
+///
+/// Boxes that only touch, or are closer than padding, count as overlapping
+/// exactly like utils::nodesOverlap.
+template<typename T>
+size_t countOverlaps(T x, T y, T w, T h, const T* xs, const T* ys, const T* ws, const T* hs,
+                     size_t count, T padding) {
+    size_t i = 0;
+    size_t overlaps = 0;
+    if constexpr (std::is_same_v<T, double>) {
+#if defined(FLOWGRAPH_LAYOUT_AVX2)
+        const __m256d vx = _mm256_set1_pd(x), vy = _mm256_set1_pd(y);
+        const __m256d vright = _mm256_set1_pd(x + w + padding), vbottom = _mm256_set1_pd(y + h + padding);
+        const __m256d vpadding = _mm256_set1_pd(padding);
+        for (; i + 4 <= count; i += 4) {
+            __m256d bx = _mm256_loadu_pd(xs + i), by = _mm256_loadu_pd(ys + i);
+            __m256d bright = _mm256_add_pd(_mm256_add_pd(bx, _mm256_loadu_pd(ws + i)), vpadding);
+            __m256d bbottom = _mm256_add_pd(_mm256_add_pd(by, _mm256_loadu_pd(hs + i)), vpadding);
+            __m256d hit = _mm256_and_pd(
+                _mm256_and_pd(_mm256_cmp_pd(vright, bx, _CMP_GT_OQ), _mm256_cmp_pd(bright, vx, _CMP_GT_OQ)),
+                _mm256_and_pd(_mm256_cmp_pd(vbottom, by, _CMP_GT_OQ), _mm256_cmp_pd(bbottom, vy, _CMP_GT_OQ)));
+            unsigned lanes = static_cast<unsigned>(_mm256_movemask_pd(hit));
+            overlaps += (lanes & 1) + ((lanes >> 1) & 1) + ((lanes >> 2) & 1) + (lanes >> 3);
+        }
+#elif defined(FLOWGRAPH_LAYOUT_NEON)
+        const float64x2_t vx = vdupq_n_f64(x), vy = vdupq_n_f64(y);
+        const float64x2_t vright = vdupq_n_f64(x + w + padding), vbottom = vdupq_n_f64(y + h + padding);
+        const float64x2_t vpadding = vdupq_n_f64(padding);
+        for (; i + 2 <= count; i += 2) {
+            float64x2_t bx = vld1q_f64(xs + i), by = vld1q_f64(ys + i);
+            float64x2_t bright = vaddq_f64(vaddq_f64(bx, vld1q_f64(ws + i)), vpadding);
+            float64x2_t bbottom = vaddq_f64(vaddq_f64(by, vld1q_f64(hs + i)), vpadding);
+            uint64x2_t hit = vandq_u64(vandq_u64(vcgtq_f64(vright, bx), vcgtq_f64(bright, vx)),
+                                       vandq_u64(vcgtq_f64(vbottom, by), vcgtq_f64(bbottom, vy)));
+            overlaps += static_cast<size_t>(vaddvq_u64(vshrq_n_u64(hit, 63)));
+        }
+#endif
+    }
+    return overlaps + scalar::countOverlaps(x, y, w, h, xs + i, ys + i, ws + i, hs + i, count - i, padding);
+}
+
+} // namespace flowgraph::layout::kernels
@@ -7,6 +7,8 @@
 #include <memory>
 #include <string>
 #include <limits>
+#include <functional>
+#include <stdexcept>
 
 namespace flowgraph::layout {
 
@@ -101,6 +103,37 @@ private:
     std::unordered_map<NodeId, NodeType> nodes_;
     std::vector<Edge> edges_;
     std::unordered_map<NodeId, std::vector<NodeId>> adjacency_list_;
+    std::unordered_map<NodeId, std::vector<size_t>> incident_edges_; // indices into edges_, both directions
+    
+    static void eraseOne(std::vector<size_t>& values, size_t value) {
+        auto it = std::find(values.begin(), values.end(), value);
+        if (it != values.end()) {
+            *it = values.back();
+            values.pop_back();
+        }
+    }
+    
+    /// Remove edges_[index] by moving the last edge into its slot
+    void removeEdgeAt(size_t index) {
+        Edge edge = edges_[index];
+        auto& successors = adjacency_list_[edge.from];
+        successors.erase(std::find(successors.begin(), successors.end(), edge.to));
+        eraseOne(incident_edges_[edge.from], index);
+        if (edge.to != edge.from) {
+            eraseOne(incident_edges_[edge.to], index);
+        }
+        
+        size_t last = edges_.size() - 1;
+        if (index != last) {
+            const Edge& moved = edges_[last];
+            for (NodeId endpoint : {moved.from, moved.to}) {
+                auto& indices = incident_edges_[endpoint];
+                std::replace(indices.begin(), indices.end(), last, index);
+            }
+            edges_[index] = moved;
+        }
+        edges_.pop_back();
+    }
     
 public:
     /// Add a node to the graph
@@ -113,6 +146,10 @@ public:
     
     /// Add an edge to the graph
     void addEdge(const Edge& edge) {
+        incident_edges_[edge.from].push_back(edges_.size());
+        if (edge.to != edge.from) {
+            incident_edges_[edge.to].push_back(edges_.size());
+        }
         edges_.push_back(edge);
         adjacency_list_[edge.from].push_back(edge.to);
         
@@ -122,6 +159,61 @@ public:
         }
     }
     
+    /// Remove every edge from -> to in O(degree); returns the number removed
+    ///
+    /// The last edge takes the slot of a removed one, so getEdges() order is
+    /// not preserved.
+    size_t removeEdge(NodeId from, NodeId to) {
+        auto it = incident_edges_.find(from);
+        if (it == incident_edges_.end()) {
+            return 0;
+        }
+        size_t removed = 0;
+        for (size_t i = 0; i < it->second.size();) {
+            size_t index = it->second[i];
+            if (edges_[index].from == from && edges_[index].to == to) {
+                removeEdgeAt(index);
+                removed++;
+            } else {
+                ++i;
+            }
+        }
+        return removed;
+    }
+    
+    /// Remove a node and all edges touching it in O(degree)
+    bool removeNode(NodeId id) {
+        auto it = incident_edges_.find(id);
+        if (it != incident_edges_.end()) {
+            while (!it->second.empty()) {
+                removeEdgeAt(it->second.back());
+            }
+            incident_edges_.erase(it);
+        }
+        adjacency_list_.erase(id);
+        return nodes_.erase(id) > 0;
+    }
+    
+    /// Get the nodes connected to a node by an edge in either direction
+    std::vector<NodeId> getAdjacentNodes(NodeId id) const {
+        std::vector<NodeId> adjacent;
+        auto it = incident_edges_.find(id);
+        if (it != incident_edges_.end()) {
+            for (size_t index : it->second) {
+                const Edge& edge = edges_[index];
+                adjacent.push_back(edge.from == id ? edge.to : edge.from);
+            }
+        }
+        return adjacent;
+    }
+
+    /// Get indices into getEdges() of the edges touching a node
+    const std::vector<size_t>& getIncidentEdges(NodeId id) const {
+        static const std::vector<size_t> empty;
+        auto it = incident_edges_.find(id);
+        return it != incident_edges_.end() ? it->second : empty;
+    }
+
     /// Get node by ID
     NodeType* getNode(NodeId id) {
         auto it = nodes_.find(id);
@@ -157,6 +249,7 @@ public:
         nodes_.clear();
         edges_.clear();
         adjacency_list_.clear();
+        incident_edges_.clear();
     }
     
     /// Update node position
@@ -180,6 +273,9 @@ struct LayoutConfig {
     bool preserveAspectRatio = true;     ///< Preserve aspect ratio during layout
     double marginX = 50.0;          ///< Horizontal margin
     double marginY = 50.0;          ///< Vertical margin
+    double barnesHutTheta = 0.8;    ///< Barnes-Hut opening angle for repulsion (force-directed), 0 = exact
+    size_t threads = 1;             ///< Worker threads for parallel phases, 0 = hardware concurrency; output does not depend on it
+    size_t progressInterval = 0;    ///< Iterations between progress callbacks (iterative algorithms), 0 = none
 };
 
 /// Layout result information
@@ -191,15 +287,34 @@ struct LayoutResult {
     PointF boundingBox;  ///< Total size of the layout
 };
 
+/// Thrown out of a running layout when its progress callback asks to stop
+struct LayoutCancelled : std::runtime_error {
+    LayoutCancelled() : std::runtime_error("Layout cancelled") {}
+};
+
 /// Base class for all layout algorithms
 template<typename T = double>
 class LayoutAlgorithm {
 public:
+    /// Receives the graph with intermediate positions; return false to cancel
+    using ProgressCallback = std::function<bool(const Graph<T>& graph, size_t iteration)>;
+    
     virtual ~LayoutAlgorithm() = default;
     
     /// Apply layout to the graph
     virtual LayoutResult apply(Graph<T>& graph, const LayoutConfig& config = {}) = 0;
     
+    /// Update the layout after an edit, starting from the current positions
+    ///
+    /// changed lists the nodes that were added or whose edges changed; IDs no
+    /// longer in the graph are ignored. Algorithms without an incremental mode
+    /// run a full apply().
+    virtual LayoutResult applyIncremental(Graph<T>& graph, const std::vector<NodeId>& changed,
+                                          const LayoutConfig& config = {}) {
+        (void)changed;
+        return apply(graph, config);
+    }
+    
     /// Get algorithm name
     virtual std::string getName() const = 0;
     
@@ -208,6 +323,28 @@ public:
     
     /// Check if algorithm is suitable for large graphs
     virtual bool isOptimizedForLargeGraphs() const { return false; }
+    
+    /// Report progress every LayoutConfig::progressInterval iterations
+    ///
+    /// Only iterative algorithms report. The callback runs on the thread that
+    /// called apply(); if it returns false, apply() fails with "Layout
+    /// cancelled" and leaves the last reported positions in the graph.
+    void setProgressCallback(ProgressCallback callback) { progress_ = std::move(callback); }
+    
+protected:
+    ProgressCallback progress_;
+    
+    /// Whether iteration (1-based) should be reported
+    bool progressDue(const LayoutConfig& config, size_t iteration) const {
+        return progress_ && config.progressInterval > 0 && iteration % config.progressInterval == 0;
+    }
+    
+    /// Call the progress callback, throwing LayoutCancelled if it asks to stop
+    void reportProgress(const Graph<T>& graph, size_t iteration) {
+        if (!progress_(graph, iteration)) {
+            throw LayoutCancelled();
+        }
+    }
 };
 
 } // namespace flowgraph::layout
\ No newline at end of file
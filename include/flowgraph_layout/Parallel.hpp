@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace flowgraph::layout::detail {
+
+/// Number of workers for LayoutConfig::threads (0 = hardware concurrency)
+inline size_t resolveThreadCount(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    return threads;
+}
+
+/// Run body(begin, end, worker) over [0, count) split into one contiguous
+/// chunk per worker
+///
+/// Chunks depend only on count and the worker count, so a body that writes
+/// disjoint per-index results gives the same output for any number of
+/// threads. Runs inline when there is less than minChunk work per worker.
+/// The first exception thrown by a worker is rethrown after all have joined.
+template<typename Body>
+void parallelFor(size_t count, size_t threads, size_t minChunk, Body&& body) {
+    size_t workers = std::min(resolveThreadCount(threads), std::max<size_t>(1, count / std::max<size_t>(1, minChunk)));
+    if (workers <= 1) {
+        body(size_t(0), count, size_t(0));
+        return;
+    }
+
+    const size_t chunk = (count + workers - 1) / workers;
+    std::vector<std::exception_ptr> errors(workers);
+    auto run = [&](size_t worker) {
+        size_t begin = std::min(count, worker * chunk);
+        size_t end = std::min(count, begin + chunk);
+        try {
+            body(begin, end, worker);
+        } catch (...) {
+            errors[worker] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t worker = 1; worker < workers; ++worker) {
+        pool.emplace_back(run, worker);
+    }
+    run(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+} // namespace flowgraph::layout::detail
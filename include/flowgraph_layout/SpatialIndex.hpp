@@ -0,0 +1,148 @@
+#pragma once
+
+#include "LayoutTypes.hpp"
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+
+namespace flowgraph::layout {
+
+/// Axis-aligned box for spatial queries
+template<typename T = double>
+struct Box {
+    T minX = 0, minY = 0, maxX = 0, maxY = 0;
+
+    static Box of(const Node<T>& node) {
+        return {node.position.x, node.position.y, node.position.x + node.size.x, node.position.y + node.size.y};
+    }
+
+    static Box spanning(const Point<T>& a, const Point<T>& b) {
+        return {std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y)};
+    }
+
+    bool intersects(const Box& other) const {
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+};
+
+/// Uniform grid over item bounding boxes for viewport and hit queries
+///
+/// Items are keyed by a caller-chosen size_t (a node ID, an edge index) and
+/// registered in every cell their box touches, so a query only looks at the
+/// cells it covers. Items can be moved or removed one at a time, which keeps
+/// dragging a node O(cells it spans).
+template<typename T = double>
+class SpatialGrid {
+public:
+    using Key = size_t;
+
+    explicit SpatialGrid(T cellSize = 256) : cell_size_(cellSize) {}
+
+    /// Add an item, or move it if the key is already present
+    void insert(Key key, const Box<T>& box) {
+        remove(key);
+        items_.emplace(key, box);
+        forEachCell(box, [&](uint64_t cell) { cells_[cell].push_back({key, box}); });
+    }
+
+    /// Remove an item; returns false if it was not present
+    bool remove(Key key) {
+        auto it = items_.find(key);
+        if (it == items_.end()) {
+            return false;
+        }
+        forEachCell(it->second, [&](uint64_t cell) {
+            auto bucket = cells_.find(cell);
+            auto& entries = bucket->second;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (entries[i].key == key) {
+                    entries[i] = entries.back();
+                    entries.pop_back();
+                    break;
+                }
+            }
+            if (entries.empty()) {
+                cells_.erase(bucket);
+            }
+        });
+        items_.erase(it);
+        return true;
+    }
+
+    void clear() {
+        items_.clear();
+        cells_.clear();
+    }
+
+    size_t size() const { return items_.size(); }
+
+    /// Call visit(key) once for every item whose box intersects the query box
+    template<typename Visitor>
+    void query(const Box<T>& box, Visitor&& visit) const {
+        const int64_t firstX = cellCoordinate(box.minX), lastX = cellCoordinate(box.maxX);
+        const int64_t firstY = cellCoordinate(box.minY), lastY = cellCoordinate(box.maxY);
+        if ((lastX - firstX + 1) * (lastY - firstY + 1) > static_cast<int64_t>(cells_.size())) {
+            // Query covers more cells than are occupied: walk the occupied ones
+            for (const auto& [cell, entries] : cells_) {
+                int64_t x = static_cast<int32_t>(cell >> 32), y = static_cast<int32_t>(cell & 0xffffffffu);
+                if (x >= firstX && x <= lastX && y >= firstY && y <= lastY) {
+                    visitCell(entries, x, y, firstX, firstY, box, visit);
+                }
+            }
+            return;
+        }
+        for (int64_t x = firstX; x <= lastX; ++x) {
+            for (int64_t y = firstY; y <= lastY; ++y) {
+                auto bucket = cells_.find(cellKey(x, y));
+                if (bucket != cells_.end()) {
+                    visitCell(bucket->second, x, y, firstX, firstY, box, visit);
+                }
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        Key key;
+        Box<T> box;
+    };
+
+    T cell_size_;
+    std::unordered_map<Key, Box<T>> items_;
+    std::unordered_map<uint64_t, std::vector<Entry>> cells_;
+
+    int64_t cellCoordinate(T value) const {
+        return static_cast<int64_t>(std::floor(value / cell_size_));
+    }
+
+    static uint64_t cellKey(int64_t x, int64_t y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+
+    template<typename Function>
+    void forEachCell(const Box<T>& box, Function&& function) const {
+        for (int64_t x = cellCoordinate(box.minX); x <= cellCoordinate(box.maxX); ++x) {
+            for (int64_t y = cellCoordinate(box.minY); y <= cellCoordinate(box.maxY); ++y) {
+                function(cellKey(x, y));
+            }
+        }
+    }
+
+    /// An item spanning several cells is reported only from the first cell
+    /// that both it and the query cover
+    template<typename Visitor>
+    void visitCell(const std::vector<Entry>& entries, int64_t x, int64_t y, int64_t firstX, int64_t firstY,
+                   const Box<T>& box, Visitor& visit) const {
+        for (const auto& entry : entries) {
+            if (!entry.box.intersects(box)) {
+                continue;
+            }
+            if (std::max(cellCoordinate(entry.box.minX), firstX) == x &&
+                std::max(cellCoordinate(entry.box.minY), firstY) == y) {
+                visit(entry.key);
+            }
+        }
+    }
+};
+
+} // namespace flowgraph::layout
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "flowgraph/FlowGraph.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+/**
+ * @brief Fixtures shared by the unit tests
+ */
+namespace FlowGraph::test {
+
+/**
+ * @brief Parse flow source and create the flow on the given engine
+ */
+inline Flow parse(Engine& engine, const std::string& source, const std::string& name = "test.flow") {
+    Parser parser;
+    return engine.createFlow(parser.parse(source, name));
+}
+
+/**
+ * @brief Replace a file's content, creating its directory if needed
+ */
+inline void writeFile(const std::filesystem::path& path, const std::string& content) {
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+} // namespace FlowGraph::test
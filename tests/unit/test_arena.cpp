@@ -0,0 +1,94 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace FlowGraph;
+
+TEST_CASE("Arena allocation", "[arena]") {
+    SECTION("Allocations are aligned and packed into few blocks") {
+        Arena arena(1024);
+        std::vector<void*> pointers;
+        for (int i = 0; i < 100; ++i) {
+            pointers.push_back(arena.allocate(1 + i % 7, 8));
+            REQUIRE(reinterpret_cast<uintptr_t>(pointers.back()) % 8 == 0);
+        }
+        REQUIRE(arena.blockCount() == 1);
+
+        auto* wide = arena.allocate(16, 64);
+        REQUIRE(reinterpret_cast<uintptr_t>(wide) % 64 == 0);
+    }
+
+    SECTION("Blocks grow and oversized requests fit") {
+        Arena arena(256);
+        for (int i = 0; i < 64; ++i) {
+            arena.allocate(100);
+        }
+        REQUIRE(arena.bytesUsed() == 6400);
+        REQUIRE(arena.blockCount() < 8);
+
+        char* large = static_cast<char*>(arena.allocate(3 * Arena::MaxBlockSize));
+        large[3 * Arena::MaxBlockSize - 1] = 'x';
+        REQUIRE(arena.allocate(8) != nullptr);
+    }
+
+    SECTION("Objects are constructed in place") {
+        Arena arena;
+        auto* text = arena.create<std::string>(40, 'a');
+        REQUIRE(text->size() == 40);
+        text->~basic_string();
+    }
+
+#ifdef FLOWGRAPH_HAS_PMR
+    SECTION("The memory resource backs pmr containers") {
+        Arena arena;
+        {
+            std::pmr::vector<int> values(arena.resource());
+            for (int i = 0; i < 1000; ++i) {
+                values.push_back(i);
+            }
+            REQUIRE(values[999] == 999);
+        }
+        REQUIRE(arena.bytesUsed() >= 1000 * sizeof(int));
+    }
+#endif
+}
+
+TEST_CASE("Flow ASTs allocate their nodes in an arena", "[arena][ast]") {
+    std::string source = "TITLE: Arena\n\nNODES:\n";
+    for (int i = 1; i <= 200; ++i) {
+        source += std::to_string(i * 10) + " ASSIGN I value_with_a_long_name_" + std::to_string(i) + " " +
+                  std::to_string(i) + "\n";
+    }
+    source += "\nFLOW:\nSTART -> 10\n2000 -> END\n";
+
+    SECTION("Parsed nodes share a few arena blocks") {
+        Parser parser;
+        auto ast = parser.parse(source, "arena.flow");
+        REQUIRE(ast->nodes.size() == 200);
+        REQUIRE(ast->arena);
+        REQUIRE(ast->arena->blockCount() <= 3);
+        REQUIRE(ast->nodes.front().get_deleter().inArena);
+        REQUIRE(static_cast<const AssignNode&>(*ast->nodes[199]).variableName == "value_with_a_long_name_200");
+    }
+
+    SECTION("Loaded .flowc images use an arena as well") {
+        Parser parser;
+        auto image = FlowArchive::serialize(*parser.parse(source, "arena.flow"));
+        auto ast = FlowArchive::deserialize(image);
+        REQUIRE(ast->arena);
+        REQUIRE(ast->nodes.back().get_deleter().inArena);
+    }
+
+    SECTION("Heap and arena nodes can be mixed") {
+        auto ast = FlowAST::withArena();
+        ast->nodes.push_back(ast->makeNode<CondNode>("10", "true"));
+        ast->nodes.push_back(std::make_unique<AssignNode>("20", TypeInfo(ValueType::Number), "x", "1"));
+        REQUIRE(ast->nodes[0].get_deleter().inArena);
+        REQUIRE_FALSE(ast->nodes[1].get_deleter().inArena);
+
+        FlowAST heap;
+        REQUIRE_FALSE(heap.makeNode<CondNode>("10", "true").get_deleter().inArena);
+    }
+}
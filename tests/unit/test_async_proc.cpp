@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include "flowgraph/FlowGraph.hpp"
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <thread>
 
 using namespace FlowGraph;
@@ -364,4 +366,91 @@ TEST_CASE("ProcResult factory methods", "[proc][result]") {
         REQUIRE(result.error.empty());
         REQUIRE(result.returnValues.empty());
     }
-}
\ No newline at end of file
+}
+TEST_CASE("ProcCompletionCallback suspension handshake", "[async][proc]") {
+    SECTION("Completion before Suspend is taken synchronously") {
+        ProcCompletionCallback callback;
+        int resumed = 0;
+        callback.SetResumeHandler([&resumed] { ++resumed; });
+        
+        callback(ProcResult::completedSuccess({}));
+        REQUIRE(callback.IsResolved());
+        REQUIRE_FALSE(callback.Suspend());
+        REQUIRE(resumed == 0);
+    }
+    
+    SECTION("Completion after Suspend invokes the resume handler once") {
+        ProcCompletionCallback callback;
+        int resumed = 0;
+        callback.SetResumeHandler([&resumed] { ++resumed; });
+        
+        REQUIRE(callback.Suspend());
+        REQUIRE_FALSE(callback.IsResolved());
+        callback(ProcResult::completedError("late"));
+        REQUIRE(callback.IsResolved());
+        REQUIRE(callback.GetResult().error == "late");
+        REQUIRE(resumed == 1);
+        
+        // Reset for the next call keeps the handler installed
+        callback.Reset();
+        REQUIRE_FALSE(callback.IsResolved());
+        REQUIRE(callback.Suspend());
+        callback(ProcResult::completedSuccess({}));
+        REQUIRE(resumed == 2);
+    }
+    
+    SECTION("Racing completion from another thread is handled exactly once") {
+        for (int i = 0; i < 1000; ++i) {
+            ProcCompletionCallback callback;
+            std::atomic<int> resumed{0};
+            callback.SetResumeHandler([&resumed] { ++resumed; });
+            
+            std::thread completer([&callback] { callback(ProcResult::completedSuccess({})); });
+            bool suspended = callback.Suspend();
+            completer.join();
+            
+            REQUIRE(callback.IsResolved());
+            REQUIRE(resumed.load() == (suspended ? 1 : 0));
+        }
+    }
+
+    SECTION("Async callback has returned once the callback is resolved") {
+        ProcCompletionCallback callback;
+        std::atomic<bool> callbackDone{false};
+        callback.SetAsyncCallback([&callbackDone](const ProcResult&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            callbackDone = true;
+        });
+
+        std::thread completer([&callback] { callback(ProcResult::completedSuccess({})); });
+        while (!callback.IsResolved()) {
+            std::this_thread::yield();
+        }
+        REQUIRE(callbackDone.load());
+        completer.join();
+    }
+
+    SECTION("Reset and destruction wait for a resume handler still running") {
+        for (int i = 0; i < 2; ++i) {
+            auto callback = std::make_unique<ProcCompletionCallback>();
+            std::atomic<bool> handlerDone{false};
+            callback->SetResumeHandler([&handlerDone] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                handlerDone = true;
+            });
+            REQUIRE(callback->Suspend());
+
+            std::thread completer([&callback] { (*callback)(ProcResult::completedSuccess({})); });
+            while (!callback->IsResolved()) {
+                std::this_thread::yield();
+            }
+            if (i == 0) {
+                callback->Reset();
+            } else {
+                callback.reset();
+            }
+            REQUIRE(handlerDone.load());
+            completer.join();
+        }
+    }
+}
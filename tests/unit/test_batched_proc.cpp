@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+const char* const CheckFlow = R"(
+TITLE: Check
+
+PARAMS:
+N user
+
+RETURNS:
+N score
+
+NODES:
+10 PROC check_user user>>id score<<score
+
+FLOW:
+START -> 10
+10 -> END
+)";
+
+// score = 2 * id for every call of the batch
+std::vector<ProcResult> scoreUsers(const std::vector<ParameterMap>& batch) {
+    std::vector<ProcResult> results;
+    for (const auto& params : batch) {
+        ParameterMap values;
+        values["score"] = createValue(params.at("id").asNumber() * 2);
+        results.push_back(ProcResult::completedSuccess(std::move(values)));
+    }
+    return results;
+}
+
+ParameterMap userParams(int user) {
+    ParameterMap params;
+    params["user"] = createValue(static_cast<double>(user));
+    return params;
+}
+
+} // namespace
+
+TEST_CASE("Batched PROCs coalesce concurrent calls", "[proc][batch][async]") {
+    Engine engine;
+    std::mutex mutex;
+    std::vector<size_t> batchSizes;
+    BatchedProcDefinition definition;
+    definition.title = "check_user";
+    definition.maxBatchSize = 32;
+    definition.window = std::chrono::milliseconds(50);
+    definition.implementation = [&](const std::vector<ParameterMap>& batch) {
+        std::lock_guard<std::mutex> lock(mutex);
+        batchSizes.push_back(batch.size());
+        return scoreUsers(batch);
+    };
+
+    SECTION("Suspended executions share round-trips and get their own results") {
+        engine.registerBatchedProcedure("check_user", definition);
+        auto flow = parse(engine, CheckFlow);
+        FlowScheduler scheduler;
+        std::vector<double> scores(100, -1);
+        for (int i = 0; i < 100; ++i) {
+            scheduler.submit(flow, userParams(i), [&scores, i](FlowScheduler::TaskId, const ExecutionResult& result) {
+                REQUIRE(result.success);
+                scores[i] = result.returnValues.at("score").asNumber();
+            });
+        }
+        REQUIRE(scheduler.run() == 100);
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(scores[i] == 2 * i);
+        }
+        REQUIRE(std::accumulate(batchSizes.begin(), batchSizes.end(), size_t(0)) == 100);
+        REQUIRE(batchSizes.size() <= 10);
+        REQUIRE(*std::max_element(batchSizes.begin(), batchSizes.end()) <= 32);
+    }
+
+    SECTION("A zero window runs each call synchronously") {
+        definition.window = std::chrono::microseconds(0);
+        engine.registerBatchedProcedure("check_user", definition);
+        auto result = parse(engine, CheckFlow).execute(userParams(21));
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("score").asNumber() == 42);
+        REQUIRE(batchSizes == std::vector<size_t>{1});
+    }
+
+    SECTION("A failing batch fails every call in it") {
+        definition.maxBatchSize = 4;
+        definition.implementation = [](const std::vector<ParameterMap>& batch) -> std::vector<ProcResult> {
+            if (batch.size() > 1) {
+                return {ProcResult::completedSuccess()}; // too few results
+            }
+            throw std::runtime_error("backend unavailable");
+        };
+        engine.registerBatchedProcedure("check_user", definition);
+        auto flow = parse(engine, CheckFlow);
+        FlowScheduler scheduler;
+        std::vector<std::string> errors;
+        for (int i = 0; i < 5; ++i) {
+            scheduler.submit(flow, userParams(i), [&errors](FlowScheduler::TaskId, const ExecutionResult& result) {
+                errors.push_back(result.error);
+            });
+        }
+        REQUIRE(scheduler.run() == 5);
+        const std::string prefix = "Execution error: PROC execution failed: ";
+        REQUIRE(std::count(errors.begin(), errors.end(), prefix + "Batched procedure returned 1 results for 4 calls") == 4);
+        REQUIRE(std::count(errors.begin(), errors.end(), prefix + "backend unavailable") == 1);
+    }
+
+    SECTION("Replacing the procedure runs the calls queued with the old one") {
+        definition.window = std::chrono::seconds(60);
+        engine.registerBatchedProcedure("check_user", definition);
+        auto flow = parse(engine, CheckFlow);
+        auto context = flow.acquireContext();
+        REQUIRE_FALSE(flow.start(*context, userParams(4)));
+        REQUIRE_FALSE(context->getProcCallback().IsResolved());
+
+        // The old batcher flushes and joins its thread instead of waiting out the window
+        definition.window = std::chrono::microseconds(0);
+        engine.registerBatchedProcedure("check_user", definition);
+        REQUIRE(context->getProcCallback().IsResolved());
+        auto result = flow.resume(*context);
+        REQUIRE(result);
+        REQUIRE(result->returnValues.at("score").asNumber() == 8);
+        flow.releaseContext(std::move(context));
+
+        REQUIRE(flow.execute(userParams(5)).returnValues.at("score").asNumber() == 10);
+        REQUIRE(batchSizes == std::vector<size_t>{1, 1});
+    }
+
+    SECTION("The definition is reported like any procedure") {
+        engine.registerBatchedProcedure("check_user", definition);
+        REQUIRE(engine.hasProcedure("check_user"));
+        REQUIRE(engine.getProcedureDefinition("check_user").title == "check_user");
+    }
+}
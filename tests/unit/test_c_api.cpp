@@ -0,0 +1,346 @@
+#include <catch2/catch_test_macros.hpp>
+#include "CFlowGraph.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const GreetFlow = R"(
+TITLE: Greet
+
+PARAMS:
+S name
+N count
+B loud
+
+RETURNS:
+S message
+N total
+B shouted
+
+ERRORS:
+EMPTY
+
+NODES:
+10 COND count > 0
+20 ASSIGN S message "Hello " + name
+30 ASSIGN N total count * 2
+40 ASSIGN B shouted loud
+
+FLOW:
+START -> 10
+10.Y -> 20
+10.N -> EMPTY
+20 -> 30
+30 -> 40
+40 -> END
+)";
+
+const char* const DoubleFlow = R"(
+TITLE: Double
+PARAMS:
+N value
+RETURNS:
+N result
+NODES:
+10 PROC double value>>in result<<out
+FLOW:
+START -> 10
+10 -> END
+)";
+
+FlowGraphValue text(const char* value) {
+    return flowgraph_string(value, std::strlen(value));
+}
+
+std::string str(const FlowGraphValue& value) {
+    return std::string(value.string, value.length);
+}
+
+// Doubles its input synchronously
+void doubleNow(void*, FlowGraphCall* call) {
+    FlowGraphValue in = flowgraph_call_input(call, "in");
+    flowgraph_call_set_output(call, "out", flowgraph_number(in.number * 2));
+    flowgraph_call_complete(call);
+}
+
+// Keeps the call pending for the test to complete
+void keepPending(void* userData, FlowGraphCall* call) {
+    *static_cast<FlowGraphCall**>(userData) = call;
+}
+
+// Collects every call for the test to complete later
+void collectPending(void* userData, FlowGraphCall* call) {
+    static_cast<std::vector<FlowGraphCall*>*>(userData)->push_back(call);
+}
+
+void completeWith(FlowGraphCall* call, double value) {
+    flowgraph_call_set_output(call, "out", flowgraph_number(value));
+    flowgraph_call_complete(call);
+}
+
+void countResume(void* userData) {
+    ++*static_cast<int*>(userData);
+}
+
+struct Completed {
+    uint64_t task = 0;
+    FlowGraphStatus status = FLOWGRAPH_STATUS_SUSPENDED;
+    std::string error;
+    std::vector<double> numbers;
+};
+
+void recordCompletion(void* userData, uint64_t task, FlowGraphStatus status, const char* error,
+                      const FlowGraphValue* returns, size_t returnCount) {
+    auto& completed = *static_cast<std::vector<Completed>*>(userData);
+    Completed entry{task, status, error ? error : "", {}};
+    for (size_t i = 0; i < returnCount; ++i) {
+        entry.numbers.push_back(returns[i].number);
+    }
+    completed.push_back(entry);
+}
+
+} // namespace
+
+TEST_CASE("C API loads flows and reports errors", "[c_api]") {
+    FlowGraphEngine* engine = flowgraph_engine_create();
+
+    FlowGraphFlow* flow = flowgraph_parse_flow(engine, GreetFlow, "greet.flow");
+    REQUIRE(flow);
+    REQUIRE(flowgraph_engine_error(engine) == nullptr);
+    REQUIRE(std::string(flowgraph_flow_title(flow)) == "Greet");
+    REQUIRE(flowgraph_flow_param_count(flow) == 3);
+    REQUIRE(std::string(flowgraph_flow_param(flow, 1).name) == "count");
+    REQUIRE(flowgraph_flow_param(flow, 0).type == FLOWGRAPH_VALUE_STRING);
+    REQUIRE(flowgraph_flow_return_count(flow) == 3);
+    REQUIRE(std::string(flowgraph_flow_return(flow, 2).name) == "shouted");
+    REQUIRE(flowgraph_flow_return(flow, 2).type == FLOWGRAPH_VALUE_BOOLEAN);
+    REQUIRE_FALSE(flowgraph_flow_return(flow, 2).optional);
+    flowgraph_flow_destroy(flow);
+
+    REQUIRE(flowgraph_parse_flow(engine, "NODES:\n10 BOGUS\n", "bad.flow") == nullptr);
+    REQUIRE(flowgraph_engine_error(engine) != nullptr);
+    REQUIRE(flowgraph_load_flow(engine, "does/not/exist.flow") == nullptr);
+    REQUIRE(flowgraph_engine_error(engine) != nullptr);
+
+    flowgraph_engine_destroy(engine);
+}
+
+TEST_CASE("C API executes in reusable contexts", "[c_api]") {
+    FlowGraphEngine* engine = flowgraph_engine_create();
+    FlowGraphFlow* flow = flowgraph_parse_flow(engine, GreetFlow, "greet.flow");
+    FlowGraphContext* context = flowgraph_context_create(flow);
+
+    FlowGraphValue params[] = {text("Ada"), flowgraph_number(3), flowgraph_boolean(true)};
+    REQUIRE(flowgraph_execute(context, params, 3) == FLOWGRAPH_STATUS_SUCCESS);
+    REQUIRE(flowgraph_context_error(context) == nullptr);
+    const FlowGraphValue* returns = flowgraph_context_returns(context);
+    REQUIRE(returns[0].type == FLOWGRAPH_VALUE_STRING);
+    REQUIRE(str(returns[0]) == "Hello Ada");
+    REQUIRE(returns[1].type == FLOWGRAPH_VALUE_NUMBER);
+    REQUIRE(returns[1].number == 6);
+    REQUIRE(returns[2].type == FLOWGRAPH_VALUE_BOOLEAN);
+    REQUIRE(returns[2].boolean);
+
+    SECTION("Return buffers are reused by the next execution") {
+        const char* storage = returns[0].string;
+        FlowGraphValue next[] = {text("Bob"), flowgraph_number(1), flowgraph_boolean(false)};
+        REQUIRE(flowgraph_execute(context, next, 3) == FLOWGRAPH_STATUS_SUCCESS);
+        REQUIRE(flowgraph_context_returns(context) == returns);
+        REQUIRE(returns[0].string == storage);
+        REQUIRE(str(returns[0]) == "Hello Bob");
+        REQUIRE(returns[1].number == 2);
+        REQUIRE_FALSE(returns[2].boolean);
+    }
+
+    SECTION("Errors clear the return values") {
+        params[1] = flowgraph_number(0);
+        REQUIRE(flowgraph_execute(context, params, 3) == FLOWGRAPH_STATUS_ERROR);
+        REQUIRE(std::string(flowgraph_context_error(context)) == "EMPTY");
+        REQUIRE(returns[0].type == FLOWGRAPH_VALUE_NONE);
+    }
+
+    SECTION("Missing parameters stay unset") {
+        REQUIRE(flowgraph_execute(context, params, 1) == FLOWGRAPH_STATUS_ERROR);
+        REQUIRE(flowgraph_context_error(context) != nullptr);
+    }
+
+    flowgraph_context_destroy(context);
+    flowgraph_flow_destroy(flow);
+    flowgraph_engine_destroy(engine);
+}
+
+TEST_CASE("C API procedures complete synchronously or later", "[c_api][async]") {
+    FlowGraphEngine* engine = flowgraph_engine_create();
+
+    SECTION("Synchronous completion") {
+        REQUIRE(flowgraph_register_procedure(engine, "double", doubleNow, nullptr));
+        FlowGraphFlow* flow = flowgraph_parse_flow(engine, DoubleFlow, "double.flow");
+        FlowGraphContext* context = flowgraph_context_create(flow);
+        FlowGraphValue value = flowgraph_number(21);
+        REQUIRE(flowgraph_execute(context, &value, 1) == FLOWGRAPH_STATUS_SUCCESS);
+        REQUIRE(flowgraph_context_returns(context)[0].number == 42);
+        flowgraph_context_destroy(context);
+        flowgraph_flow_destroy(flow);
+    }
+
+    SECTION("Suspended executions resume after the completion callback") {
+        FlowGraphCall* pending = nullptr;
+        REQUIRE(flowgraph_register_procedure(engine, "double", keepPending, &pending));
+        FlowGraphFlow* flow = flowgraph_parse_flow(engine, DoubleFlow, "double.flow");
+        FlowGraphContext* context = flowgraph_context_create(flow);
+        int resumes = 0;
+        flowgraph_context_set_resume_callback(context, countResume, &resumes);
+
+        FlowGraphValue value = flowgraph_number(5);
+        REQUIRE(flowgraph_start(context, &value, 1) == FLOWGRAPH_STATUS_SUSPENDED);
+        REQUIRE(pending);
+        REQUIRE(flowgraph_call_input(pending, "in").number == 5);
+        REQUIRE(flowgraph_call_input(pending, "missing").type == FLOWGRAPH_VALUE_NONE);
+        REQUIRE(flowgraph_resume(context) == FLOWGRAPH_STATUS_SUSPENDED);
+
+        flowgraph_call_set_output(pending, "out", flowgraph_number(50));
+        flowgraph_call_complete(pending);
+        REQUIRE(resumes == 1);
+        REQUIRE(flowgraph_resume(context) == FLOWGRAPH_STATUS_SUCCESS);
+        REQUIRE(flowgraph_context_returns(context)[0].number == 50);
+
+        pending = nullptr;
+        REQUIRE(flowgraph_start(context, &value, 1) == FLOWGRAPH_STATUS_SUSPENDED);
+        flowgraph_call_fail(pending, "unavailable");
+        REQUIRE(flowgraph_resume(context) == FLOWGRAPH_STATUS_ERROR);
+        REQUIRE(std::string(flowgraph_context_error(context)) == "Execution error: PROC execution failed: unavailable");
+
+        REQUIRE(flowgraph_execute(context, &value, 1) == FLOWGRAPH_STATUS_ERROR);
+        REQUIRE(std::string(flowgraph_context_error(context)) ==
+                "Async PROC execution not supported in synchronous mode");
+        flowgraph_call_complete(pending);
+
+        flowgraph_context_destroy(context);
+        flowgraph_flow_destroy(flow);
+    }
+
+    flowgraph_engine_destroy(engine);
+}
+
+TEST_CASE("C API keeps contexts alive while a call is pending", "[c_api][async]") {
+    FlowGraphEngine* engine = flowgraph_engine_create();
+    std::vector<FlowGraphCall*> pending;
+    REQUIRE(flowgraph_register_procedure(engine, "double", collectPending, &pending));
+    FlowGraphFlow* flow = flowgraph_parse_flow(engine, DoubleFlow, "double.flow");
+    FlowGraphValue value = flowgraph_number(3);
+
+    SECTION("A waiting context rejects new executions") {
+        FlowGraphContext* context = flowgraph_context_create(flow);
+        REQUIRE(flowgraph_start(context, &value, 1) == FLOWGRAPH_STATUS_SUSPENDED);
+        REQUIRE(flowgraph_start(context, &value, 1) == FLOWGRAPH_STATUS_ERROR);
+        REQUIRE(std::string(flowgraph_context_error(context)) ==
+                "Execution context is still waiting for an async PROC");
+        REQUIRE(flowgraph_execute(context, &value, 1) == FLOWGRAPH_STATUS_ERROR);
+        REQUIRE(pending.size() == 1);
+
+        completeWith(pending[0], 6);
+        REQUIRE(flowgraph_resume(context) == FLOWGRAPH_STATUS_SUCCESS);
+        REQUIRE(flowgraph_context_returns(context)[0].number == 6);
+        flowgraph_context_destroy(context);
+    }
+
+    SECTION("Calls complete after their context was destroyed") {
+        FlowGraphContext* context = flowgraph_context_create(flow);
+        REQUIRE(flowgraph_execute(context, &value, 1) == FLOWGRAPH_STATUS_ERROR);
+        flowgraph_context_destroy(context);
+        REQUIRE(pending.size() == 1);
+        completeWith(pending[0], 6);
+    }
+
+    SECTION("Suspended batch rows do not share a context") {
+        FlowGraphBatch* batch = flowgraph_batch_create(flow);
+        FlowGraphValue rows[] = {flowgraph_number(1), flowgraph_number(2)};
+        REQUIRE(flowgraph_batch_execute(batch, rows, 1, 2, 1) == FLOWGRAPH_STATUS_ERROR);
+        REQUIRE(std::string(flowgraph_batch_error(batch, 1)) == "Async PROC execution not supported in synchronous mode");
+        REQUIRE(pending.size() == 2);
+        REQUIRE(flowgraph_call_input(pending[0], "in").number == 1);
+        REQUIRE(flowgraph_call_input(pending[1], "in").number == 2);
+
+        // The batch is reusable at once, and the calls complete after it is gone
+        REQUIRE(flowgraph_batch_execute(batch, rows, 1, 1, 1) == FLOWGRAPH_STATUS_ERROR);
+        flowgraph_batch_destroy(batch);
+        for (size_t i = 0; i < pending.size(); ++i) {
+            completeWith(pending[i], static_cast<double>(i));
+        }
+    }
+
+    flowgraph_flow_destroy(flow);
+    flowgraph_engine_destroy(engine);
+}
+
+TEST_CASE("C API executes batches into engine-owned buffers", "[c_api][batch]") {
+    FlowGraphEngine* engine = flowgraph_engine_create();
+    FlowGraphFlow* flow = flowgraph_parse_flow(engine, GreetFlow, "greet.flow");
+    FlowGraphBatch* batch = flowgraph_batch_create(flow);
+
+    const size_t count = 100;
+    std::vector<FlowGraphValue> params;
+    for (size_t i = 0; i < count; ++i) {
+        params.push_back(text("x"));
+        params.push_back(flowgraph_number(static_cast<double>(i % 10)));
+        params.push_back(flowgraph_boolean(i % 2 == 0));
+    }
+
+    for (size_t threads : {1, 4}) {
+        REQUIRE(flowgraph_batch_execute(batch, params.data(), 3, count, threads) == FLOWGRAPH_STATUS_ERROR);
+        for (size_t i = 0; i < count; ++i) {
+            const FlowGraphValue* returns = flowgraph_batch_returns(batch, i);
+            if (i % 10 == 0) {
+                REQUIRE(std::string(flowgraph_batch_error(batch, i)) == "EMPTY");
+                REQUIRE(returns[1].type == FLOWGRAPH_VALUE_NONE);
+                continue;
+            }
+            REQUIRE(flowgraph_batch_error(batch, i) == nullptr);
+            REQUIRE(str(returns[0]) == "Hello x");
+            REQUIRE(returns[1].number == static_cast<double>(i % 10) * 2);
+            REQUIRE(returns[2].boolean == (i % 2 == 0));
+        }
+    }
+
+    REQUIRE(flowgraph_batch_execute(batch, params.data() + 3, 3, 9, 0) == FLOWGRAPH_STATUS_SUCCESS);
+    REQUIRE(flowgraph_batch_execute(batch, nullptr, 0, 0, 0) == FLOWGRAPH_STATUS_SUCCESS);
+
+    flowgraph_batch_destroy(batch);
+    flowgraph_flow_destroy(flow);
+    flowgraph_engine_destroy(engine);
+}
+
+TEST_CASE("C API scheduler reports completions through callbacks", "[c_api][scheduler]") {
+    FlowGraphEngine* engine = flowgraph_engine_create();
+    FlowGraphCall* pending = nullptr;
+    flowgraph_register_procedure(engine, "double", keepPending, &pending);
+    FlowGraphFlow* flow = flowgraph_parse_flow(engine, DoubleFlow, "double.flow");
+    FlowGraphScheduler* scheduler = flowgraph_scheduler_create();
+
+    std::vector<Completed> completed;
+    FlowGraphValue value = flowgraph_number(4);
+    uint64_t task = flowgraph_scheduler_submit(scheduler, flow, &value, 1, recordCompletion, &completed);
+    REQUIRE(flowgraph_scheduler_in_flight(scheduler) == 1);
+    REQUIRE(flowgraph_call_input(pending, "in").number == 4);
+    REQUIRE(flowgraph_scheduler_poll(scheduler) == 0);
+
+    flowgraph_call_set_output(pending, "out", flowgraph_number(8));
+    flowgraph_call_complete(pending);
+    REQUIRE(flowgraph_scheduler_run_frame(scheduler, 10000) == 1);
+    REQUIRE(completed.size() == 1);
+    REQUIRE(completed[0].task == task);
+    REQUIRE(completed[0].status == FLOWGRAPH_STATUS_SUCCESS);
+    REQUIRE(completed[0].numbers == std::vector<double>{8});
+
+    flowgraph_scheduler_submit(scheduler, flow, &value, 1, recordCompletion, &completed);
+    flowgraph_call_fail(pending, "offline");
+    REQUIRE(flowgraph_scheduler_poll(scheduler) == 1);
+    REQUIRE(completed[1].status == FLOWGRAPH_STATUS_ERROR);
+    REQUIRE(completed[1].error == "Execution error: PROC execution failed: offline");
+
+    flowgraph_scheduler_destroy(scheduler);
+    flowgraph_flow_destroy(flow);
+    flowgraph_engine_destroy(engine);
+}
@@ -0,0 +1,203 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <string>
+#include <vector>
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+// Damage with armor and a critical multiplier, repeated hits until the target is down
+const char* const DamageFlow = R"(
+TITLE: Damage
+
+PARAMS:
+N health
+N attack
+N armor
+B critical
+
+RETURNS:
+N hits
+N remaining
+B killed
+
+ERRORS:
+IMMUNE
+
+NODES:
+10 ASSIGN N hits 0
+15 ASSIGN N damage attack - armor
+20 COND damage > 0
+25 ASSIGN N damage critical ? damage * 2 : damage
+30 ASSIGN N health health - damage
+40 ASSIGN N hits hits + 1
+50 COND health > 0 && hits < 100
+60 ASSIGN N remaining health
+70 ASSIGN B killed health <= 0
+
+FLOW:
+START -> 10
+10 -> 15
+15 -> 20
+20.Y -> 25
+20.N -> IMMUNE
+25 -> 30
+30 -> 40
+40 -> 50
+50.Y -> 30
+50.N -> 60
+60 -> 70
+70 -> END
+)";
+
+ColumnBatch damageBatch(size_t lanes) {
+    ColumnBatch batch(lanes);
+    std::vector<double> health(lanes), attack(lanes), armor(lanes);
+    std::vector<bool> critical(lanes);
+    for (size_t i = 0; i < lanes; ++i) {
+        health[i] = 50 + static_cast<double>(i % 97);
+        attack[i] = static_cast<double>(i % 13);
+        armor[i] = static_cast<double>(i % 5);
+        critical[i] = i % 3 == 0;
+    }
+    batch.setNumbers("health", health);
+    batch.setNumbers("attack", attack);
+    batch.setNumbers("armor", armor);
+    batch.setBooleans("critical", critical);
+    return batch;
+}
+
+ParameterMap laneParams(const ColumnBatch& batch, size_t lane) {
+    ParameterMap params;
+    for (const auto& [name, column] : batch.columns()) {
+        if (column.isSet(lane)) {
+            params[name] = column.value(lane);
+        }
+    }
+    return params;
+}
+
+// Every lane must end as the scalar executor ends it
+void requireSameAsScalar(const Flow& flow, const ColumnBatch& batch, const ColumnBatchResult& result) {
+    for (size_t lane = 0; lane < batch.lanes(); ++lane) {
+        ExecutionResult expected = flow.execute(laneParams(batch, lane));
+        REQUIRE(result.success(lane) == expected.success);
+        if (!expected.success) {
+            REQUIRE(*result.error(lane) == expected.error);
+            continue;
+        }
+        for (const auto& returnValue : flow.getReturnValues()) {
+            const Column* column = result.returns.find(returnValue.name);
+            REQUIRE(column);
+            auto it = expected.returnValues.find(returnValue.name);
+            REQUIRE(column->isSet(lane) == (it != expected.returnValues.end()));
+            if (it != expected.returnValues.end()) {
+                REQUIRE(sameValue(column->value(lane), it->second));
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("ColumnBatch", "[columnar]") {
+    ColumnBatch batch(3);
+    batch.setNumbers("x", {1, 2, 3});
+    batch.setBooleans("flag", {true, false, true});
+    REQUIRE(batch.find("x")->number(2) == 3);
+    REQUIRE(batch.find("flag")->value(1).isBoolean());
+    REQUIRE_FALSE(batch.find("flag")->boolean(1));
+    REQUIRE(batch.find("y") == nullptr);
+    REQUIRE_FALSE(batch.column("y").isSet(0));
+    REQUIRE_THROWS_AS(batch.setNumbers("z", {1, 2}), FlowGraphError);
+}
+
+TEST_CASE("Columnar execution matches scalar execution", "[columnar]") {
+    Engine engine;
+
+    SECTION("Branches and loops stay on the columnar path") {
+        auto flow = parse(engine, DamageFlow);
+        ColumnBatch batch = damageBatch(1000); // several chunks, the last one partial
+        ColumnBatchResult result = flow.executeColumns(batch);
+        REQUIRE(result.scalarLanes == 0);
+        REQUIRE_FALSE(result.errors.empty()); // attack <= armor: IMMUNE
+        REQUIRE(*result.error(0) == "IMMUNE");
+        requireSameAsScalar(flow, batch, result);
+
+        ColumnBatchResult threaded = flow.executeColumns(batch, 4);
+        REQUIRE(threaded.errors == result.errors);
+        REQUIRE(threaded.returns.find("hits")->values == result.returns.find("hits")->values);
+    }
+
+    SECTION("Lanes the typed code cannot decide run on the scalar path") {
+        int calls = 0;
+        engine.registerProcedure("scale", [&calls](const ParameterMap& params, ProcCompletionCallback& callback) {
+            ++calls;
+            ParameterMap values;
+            values["out"] = createValue(params.at("in").asNumber() * 10);
+            callback(ProcResult::completedSuccess(std::move(values)));
+        });
+        auto flow = parse(engine, R"(
+TITLE: Mixed
+PARAMS:
+N a
+N b
+RETURNS:
+N ratio
+N scaled
+NODES:
+10 ASSIGN N ratio a / b
+20 COND ratio > 1
+30 PROC scale ratio>>in scaled<<out
+40 ASSIGN N scaled 0
+FLOW:
+START -> 10
+10 -> 20
+20.Y -> 30
+20.N -> 40
+30 -> END
+40 -> END
+)");
+        ColumnBatch batch(300);
+        std::vector<double> a(300), b(300);
+        for (size_t i = 0; i < 300; ++i) {
+            a[i] = static_cast<double>(i);
+            b[i] = static_cast<double>(i % 7);   // division by zero in every 7th lane
+        }
+        batch.setNumbers("a", a);
+        batch.setNumbers("b", b);
+        batch.column("b").types[5] = StaticType::Unknown;   // unset in one lane
+        ColumnBatchResult result = flow.executeColumns(batch);
+        REQUIRE(result.scalarLanes > 0);
+        REQUIRE(calls > 0);
+        REQUIRE(result.returns.find("scaled")->number(300 - 1) == 10 * (299.0 / 5));
+        requireSameAsScalar(flow, batch, result);
+    }
+
+    SECTION("Variables without a compiled slot are bound on the scalar path") {
+        auto flow = parse(engine, R"(
+TITLE: Extra
+RETURNS:
+N total
+NODES:
+10 ASSIGN N total bonus + 1
+FLOW:
+START -> 10
+10 -> END
+)");
+        ColumnBatch batch(2);
+        batch.setNumbers("bonus", {1, 2});
+        ColumnBatchResult result = flow.executeColumns(batch);
+        requireSameAsScalar(flow, batch, result);
+    }
+
+    SECTION("An empty batch has no lanes") {
+        auto flow = parse(engine, DamageFlow);
+        ColumnBatchResult result = flow.executeColumns(ColumnBatch(0), 4);
+        REQUIRE(result.errors.empty());
+        REQUIRE(result.returns.lanes() == 0);
+    }
+}
@@ -0,0 +1,286 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/detail/CompiledFlow.hpp"
+
+using namespace FlowGraph;
+
+namespace {
+
+std::unique_ptr<FlowAST> makeBranchingAST() {
+    auto ast = std::make_unique<FlowAST>();
+    ast->errors.emplace_back("NOT_FOUND");
+    ast->nodes.push_back(std::make_unique<AssignNode>("10", TypeInfo(ValueType::Number), "x", "1"));
+    ast->nodes.push_back(std::make_unique<CondNode>("20", "x > 0"));
+    auto proc = std::make_unique<ProcNode>("30", "lookup");
+    proc->addBinding("x", "key", false);
+    ast->nodes.push_back(std::move(proc));
+    
+    ast->connections.emplace_back("START", "10");
+    ast->connections.emplace_back("10", "20");
+    ast->connections.emplace_back("20", "30", "Y");
+    ast->connections.emplace_back("20", "NOT_FOUND", "N");
+    ast->connections.emplace_back("30", "END");
+    ast->connections.emplace_back("30", "10", "NOT_FOUND");
+    return ast;
+}
+
+} // namespace
+
+TEST_CASE("CompiledFlow node indexing", "[compiled][nodes]") {
+    CompiledFlow program(makeBranchingAST());
+    
+    SECTION("Node IDs resolve to dense indices in declaration order") {
+        REQUIRE(program.nodeCount() == 3);
+        REQUIRE(program.findNodeIndex("10") == NodeIndex(0));
+        REQUIRE(program.findNodeIndex("20") == NodeIndex(1));
+        REQUIRE(program.findNodeIndex("30") == NodeIndex(2));
+        REQUIRE_FALSE(program.findNodeIndex("99").has_value());
+    }
+    
+    SECTION("Nodes carry their kind tag") {
+        REQUIRE(program.node(0).kind == NodeKind::Assign);
+        REQUIRE(program.node(1).kind == NodeKind::Cond);
+        REQUIRE(program.node(2).kind == NodeKind::Proc);
+        REQUIRE(program.node(2).asProc().procedureName == "lookup");
+    }
+}
+
+TEST_CASE("CompiledFlow edge table", "[compiled][edges]") {
+    CompiledFlow program(makeBranchingAST());
+    
+    SECTION("START and default ports") {
+        REQUIRE(program.entry().kind == TargetKind::Node);
+        REQUIRE(program.entry().index == 0);
+        REQUIRE(program.node(0).next.kind == TargetKind::Node);
+        REQUIRE(program.node(0).next.index == 1);
+        REQUIRE(program.node(2).next.kind == TargetKind::End);
+    }
+    
+    SECTION("COND Y/N ports and error emission") {
+        const auto& cond = program.node(1);
+        REQUIRE(cond.yes.kind == TargetKind::Node);
+        REQUIRE(cond.yes.index == 2);
+        REQUIRE(cond.no.kind == TargetKind::Error);
+        REQUIRE(program.errorName(cond.no.index) == "NOT_FOUND");
+    }
+    
+    SECTION("Error capture ports") {
+        const auto& proc = program.node(2);
+        REQUIRE(proc.errorEdgeCount == 1);
+        
+        const CompiledTarget* capture = program.findErrorTarget(proc, "NOT_FOUND");
+        REQUIRE(capture != nullptr);
+        REQUIRE(capture->kind == TargetKind::Node);
+        REQUIRE(capture->index == 0);
+        REQUIRE(program.findErrorTarget(proc, "OTHER") == nullptr);
+    }
+    
+    SECTION("COND without Y/N ports falls back to the default port") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->nodes.push_back(std::make_unique<CondNode>("10", "true"));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "END");
+        
+        CompiledFlow fallback(std::move(ast));
+        REQUIRE(fallback.node(0).yes.kind == TargetKind::End);
+        REQUIRE(fallback.node(0).no.kind == TargetKind::End);
+    }
+}
+
+TEST_CASE("CompiledFlow dead nodes and blocks", "[compiled][layout]") {
+    auto assign = [](const std::string& id, const std::string& expression) {
+        return std::make_unique<AssignNode>(id, TypeInfo(ValueType::Number), "x", expression);
+    };
+
+    SECTION("Nodes unreachable from START are dropped") {
+        auto ast = makeBranchingAST();
+        ast->nodes.push_back(assign("40", "2"));
+        ast->nodes.push_back(std::make_unique<CondNode>("50", "false"));
+        ast->nodes.push_back(assign("60", "3"));
+        ast->nodes.push_back(assign("70", "4"));
+        ast->connections.emplace_back("40", "10");
+        ast->connections.emplace_back("50", "60", "Y");
+        ast->connections.emplace_back("50", "70", "N");
+        ast->connections.emplace_back("70", "END");
+
+        // 50 is only reachable from 20 through its constant-false port
+        ast->connections.erase(ast->connections.begin() + 3);
+        ast->connections.emplace_back("20", "50", "N");
+
+        CompiledFlow program(std::move(ast));
+        REQUIRE(program.stats().sourceNodes == 7);
+        REQUIRE(program.stats().deadNodes == 2);
+        REQUIRE(program.stats().deadNodeIds == std::vector<std::string>{"40", "60"});
+        REQUIRE(program.nodeCount() == 5);
+        REQUIRE_FALSE(program.findNodeIndex("40").has_value());
+        REQUIRE(program.stats().constantExpressions == 3);
+
+        NodeIndex cond = *program.findNodeIndex("50");
+        REQUIRE(program.node(cond).no.index == *program.findNodeIndex("70"));
+        REQUIRE(program.findErrorTarget(program.node(*program.findNodeIndex("30")), "NOT_FOUND")->index ==
+                *program.findNodeIndex("10"));
+    }
+
+    SECTION("Single-entry ASSIGN chains are laid out as blocks") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->nodes.push_back(assign("30", "x + 3"));
+        ast->nodes.push_back(assign("10", "1"));
+        ast->nodes.push_back(std::make_unique<CondNode>("40", "x < 10"));
+        ast->nodes.push_back(assign("20", "x * 2"));
+        ast->nodes.push_back(assign("50", "x - 1"));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "20");
+        ast->connections.emplace_back("20", "30");
+        ast->connections.emplace_back("30", "40");
+        ast->connections.emplace_back("40", "20", "Y"); // 20 has two predecessors
+        ast->connections.emplace_back("40", "50", "N");
+        ast->connections.emplace_back("50", "END");
+
+        CompiledFlow program(std::move(ast));
+        NodeIndex first = *program.findNodeIndex("20");
+        REQUIRE(program.findNodeIndex("30") == first + 1);
+        REQUIRE(program.node(first).blockLength == 2);
+        REQUIRE(program.node(first + 1).blockLength == 1);
+        REQUIRE(program.node(*program.findNodeIndex("10")).blockLength == 1);
+        REQUIRE(program.stats().blocks == 1);
+        REQUIRE(program.stats().fusedNodes == 1);
+        REQUIRE(program.stats().deadNodes == 0);
+    }
+
+    SECTION("Flows without START keep all nodes") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->nodes.push_back(assign("10", "1"));
+        ast->nodes.push_back(assign("20", "2"));
+        ast->connections.emplace_back("10", "20");
+        CompiledFlow program(std::move(ast));
+        REQUIRE(program.nodeCount() == 2);
+        REQUIRE(program.stats().deadNodes == 0);
+    }
+}
+
+TEST_CASE("CompiledFlow interned names", "[compiled][symbols]") {
+    auto symbols = std::make_shared<SymbolTable>();
+    CompiledFlow first(makeBranchingAST(), symbols);
+    CompiledFlow second(makeBranchingAST(), symbols);
+    
+    SECTION("Node IDs and error names are interned once per table") {
+        REQUIRE(&first.symbols() == symbols.get());
+        REQUIRE(symbols->name(first.node(1).id) == "20");
+        REQUIRE(first.node(1).id == second.node(1).id);
+        REQUIRE(first.errorSymbol(first.node(1).no.index) == *symbols->find("NOT_FOUND"));
+        
+        size_t size = symbols->size();
+        CompiledFlow third(makeBranchingAST(), symbols);
+        REQUIRE(symbols->size() == size);
+    }
+    
+    SECTION("Error capture by symbol") {
+        Symbol notFound = second.errorSymbol(second.node(1).no.index);
+        const CompiledTarget* capture = first.findErrorTarget(first.node(2), notFound);
+        REQUIRE(capture != nullptr);
+        REQUIRE(capture->index == 0);
+        REQUIRE(first.findErrorTarget(first.node(2), symbols->intern("OTHER")) == nullptr);
+    }
+    
+    SECTION("Lookups do not intern unknown names") {
+        size_t size = symbols->size();
+        REQUIRE_FALSE(first.findNodeIndex("unknown").has_value());
+        REQUIRE(first.findErrorTarget(first.node(2), "UNKNOWN_ERROR") == nullptr);
+        REQUIRE(symbols->size() == size);
+        REQUIRE(symbols->intern("") == NoSymbol);
+    }
+}
+
+TEST_CASE("CompiledFlow diagnostics", "[compiled][validation]") {
+    SECTION("Well-formed flow has no diagnostics") {
+        CompiledFlow program(makeBranchingAST());
+        REQUIRE(program.diagnostics().empty());
+    }
+    
+    SECTION("Duplicate IDs and ambiguous ports are reported") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->nodes.push_back(std::make_unique<AssignNode>("10", TypeInfo(ValueType::Number), "x", "1"));
+        ast->nodes.push_back(std::make_unique<AssignNode>("10", TypeInfo(ValueType::Number), "y", "2"));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "END");
+        ast->connections.emplace_back("10", "10");
+        
+        CompiledFlow program(std::move(ast));
+        REQUIRE(program.nodeCount() == 1);
+        REQUIRE(program.diagnostics().size() == 2);
+        REQUIRE(program.diagnostics()[0] == "Duplicate node ID: 10");
+        REQUIRE(program.diagnostics()[1] == "Multiple connections from 10");
+    }
+    
+    SECTION("Missing START leaves the entry unresolved") {
+        auto ast = std::make_unique<FlowAST>();
+        CompiledFlow program(std::move(ast));
+        REQUIRE(program.entry().kind == TargetKind::None);
+    }
+}
+
+TEST_CASE("CompiledFlow expression cache", "[compiled][expression]") {
+    SECTION("ASSIGN and COND expressions are parsed once at compile time") {
+        CompiledFlow program(makeBranchingAST());
+        REQUIRE(program.node(0).expression != nullptr);
+        REQUIRE(program.node(1).expression != nullptr);
+        REQUIRE(program.node(2).expression == nullptr); // PROC has no expression
+    }
+    
+    SECTION("Invalid expressions are reported as diagnostics") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->nodes.push_back(std::make_unique<AssignNode>("10", TypeInfo(ValueType::Number), "x", "2 + + 3"));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "END");
+        
+        CompiledFlow program(std::move(ast));
+        REQUIRE(program.node(0).expression == nullptr);
+        REQUIRE(program.diagnostics().size() == 1);
+        REQUIRE(program.diagnostics()[0].rfind("Invalid expression in node 10: ", 0) == 0);
+    }
+}
+
+TEST_CASE("CompiledFlow variable slots", "[compiled][slots]") {
+    SECTION("Parameters, returns, ASSIGN targets and PROC bindings get slots") {
+        auto ast = makeBranchingAST();
+        ast->parameters.emplace_back("limit", TypeInfo(ValueType::Number));
+        ast->returnValues.emplace_back("x", TypeInfo(ValueType::Number));
+        CompiledFlow program(std::move(ast));
+        
+        REQUIRE(program.slots().size() == 2);
+        REQUIRE(program.slots().find("limit") == SlotIndex(0));
+        REQUIRE(program.slots().find("x") == SlotIndex(1));
+        REQUIRE_FALSE(program.slots().find("key").has_value()); // PROC side of a binding
+        REQUIRE(program.returnSlots() == std::vector<SlotIndex>{1});
+        REQUIRE(program.node(0).slot == 1);
+    }
+}
+
+TEST_CASE("CompiledFlow PROC bindings", "[compiled][proc]") {
+    SECTION("Bindings are split into input and output slot pairs") {
+        auto ast = std::make_unique<FlowAST>();
+        auto proc = std::make_unique<ProcNode>("10", "calc");
+        proc->addBinding("result", "out", true);
+        proc->addBinding("a", "left", false);
+        proc->addBinding("b", "right", false);
+        ast->nodes.push_back(std::move(proc));
+        ast->nodes.push_back(std::make_unique<ProcNode>("20", "noop"));
+        CompiledFlow program(std::move(ast));
+        
+        REQUIRE(program.procNodeCount() == 2);
+        REQUIRE(program.node(0).procIndex == 0);
+        REQUIRE(program.node(1).procIndex == 1);
+        
+        auto inputs = program.inputBindings(program.node(0));
+        REQUIRE(inputs.size() == 2);
+        REQUIRE(*inputs.begin()[0].procParam == "left");
+        REQUIRE(inputs.begin()[0].slot == program.slots().find("a"));
+        REQUIRE(*inputs.begin()[1].procParam == "right");
+        
+        auto outputs = program.outputBindings(program.node(0));
+        REQUIRE(outputs.size() == 1);
+        REQUIRE(*outputs.begin()->procParam == "out");
+        REQUIRE(outputs.begin()->slot == program.slots().find("result"));
+        
+        REQUIRE(program.inputBindings(program.node(1)).size() == 0);
+    }
+}
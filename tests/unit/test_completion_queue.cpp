@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/detail/CompletionQueue.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace FlowGraph;
+
+namespace {
+
+struct TestNode {
+    TestNode* next = nullptr;
+    int producer = 0;
+    int sequence = 0;
+};
+
+} // namespace
+
+TEST_CASE("CompletionQueue", "[async][queue]") {
+    SECTION("Drains in push order") {
+        CompletionQueue<TestNode> queue;
+        REQUIRE(queue.empty());
+        REQUIRE(queue.popAll() == nullptr);
+        
+        TestNode nodes[3];
+        for (int i = 0; i < 3; ++i) {
+            nodes[i].sequence = i;
+            queue.push(&nodes[i]);
+        }
+        REQUIRE_FALSE(queue.empty());
+        
+        TestNode* list = queue.popAll();
+        REQUIRE(queue.empty());
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(list == &nodes[i]);
+            list = list->next;
+        }
+        REQUIRE(list == nullptr);
+        
+        // Drained nodes can be pushed again
+        queue.push(&nodes[1]);
+        REQUIRE(queue.popAll() == &nodes[1]);
+    }
+    
+    SECTION("Concurrent producers with a draining consumer") {
+        constexpr int producers = 4;
+        constexpr int perProducer = 10000;
+        std::vector<TestNode> nodes(producers * perProducer);
+        CompletionQueue<TestNode> queue;
+        
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                for (int i = 0; i < perProducer; ++i) {
+                    TestNode& node = nodes[p * perProducer + i];
+                    node.producer = p;
+                    node.sequence = i;
+                    queue.push(&node);
+                }
+            });
+        }
+        
+        int received = 0;
+        std::vector<int> lastSequence(producers, -1);
+        bool ordered = true;
+        while (received < producers * perProducer) {
+            for (TestNode* node = queue.popAll(); node; node = node->next) {
+                // Each producer's nodes arrive in the order it pushed them
+                ordered = ordered && node->sequence == lastSequence[node->producer] + 1;
+                lastSequence[node->producer] = node->sequence;
+                ++received;
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        REQUIRE(ordered);
+        REQUIRE(received == producers * perProducer);
+        REQUIRE(queue.empty());
+    }
+}
@@ -0,0 +1,133 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include <array>
+
+using namespace FlowGraph;
+
+#ifdef FLOWGRAPH_HAS_COROUTINES
+
+namespace {
+
+// Event whose wait() suspends the awaiting coroutine until fire() is called
+struct ManualEvent {
+    std::coroutine_handle<> waiter;
+    
+    struct Awaiter {
+        ManualEvent* event;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) noexcept { event->waiter = handle; }
+        void await_resume() const noexcept {}
+    };
+    
+    Awaiter wait() { return {this}; }
+    
+    void fire() {
+        auto handle = std::exchange(waiter, nullptr);
+        handle.resume();
+    }
+};
+
+std::unique_ptr<FlowAST> makeDoubleAST() {
+    // 10 PROC double(x>>value, y<<result) -> END
+    auto ast = std::make_unique<FlowAST>();
+    ast->parameters.emplace_back("x", TypeInfo(ValueType::Number));
+    ast->returnValues.emplace_back("y", TypeInfo(ValueType::Number));
+    auto proc = std::make_unique<ProcNode>("10", "double");
+    proc->addBinding("x", "value", false);
+    proc->addBinding("y", "result", true);
+    ast->nodes.push_back(std::move(proc));
+    ast->connections.emplace_back("START", "10");
+    ast->connections.emplace_back("10", "END");
+    return ast;
+}
+
+ParameterMap doubled(const ParameterMap& params) {
+    ParameterMap out;
+    out["result"] = createValue(params.at("value").asNumber() * 2);
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("Coroutine PROCs", "[coroutine][async]") {
+    Engine engine;
+    
+    SECTION("A coroutine that does not suspend completes synchronously") {
+        registerCoroutineProcedure(engine, "double", [](const ParameterMap& params) -> FlowTask<ParameterMap> {
+            co_return doubled(params);
+        });
+        ParameterMap params;
+        params["x"] = createValue(21.0);
+        auto result = engine.createFlow(makeDoubleAST()).execute(params);
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("y").asNumber() == 42.0);
+    }
+    
+    SECTION("Suspended coroutine PROCs resume the flow through the scheduler") {
+        ManualEvent event;
+        registerCoroutineProcedure(engine, "double", [&event](const ParameterMap& params) -> FlowTask<ParameterMap> {
+            co_await event.wait();
+            co_return doubled(params);
+        });
+        auto flow = engine.createFlow(makeDoubleAST());
+        
+        FlowScheduler scheduler;
+        // The lambda must outlive its coroutine, so it is not invoked as a temporary
+        auto body = [&]() -> FlowTask<double> {
+            ParameterMap params;
+            params["x"] = createValue(5.0);
+            ExecutionResult result = co_await executeAsync(scheduler, flow, params);
+            co_return result.returnValues.at("y").asNumber();
+        };
+        auto run = body();
+        
+        run.start();
+        REQUIRE_FALSE(run.done());
+        REQUIRE(scheduler.inFlight() == 1);
+        
+        event.fire();
+        REQUIRE(scheduler.poll() == 1);
+        REQUIRE(run.done());
+        REQUIRE(run.result() == 10.0);
+    }
+    
+    SECTION("Callables larger than the invoker's buffer are registered too") {
+        std::array<double, 16> factors{};
+        factors.fill(2.0);
+        registerCoroutineProcedure(engine, "double", [factors](const ParameterMap& params) -> FlowTask<ParameterMap> {
+            ParameterMap out;
+            out["result"] = createValue(params.at("value").asNumber() * factors.back());
+            co_return out;
+        });
+        ParameterMap params;
+        params["x"] = createValue(4.0);
+        REQUIRE(engine.createFlow(makeDoubleAST()).execute(params).returnValues.at("y").asNumber() == 8.0);
+    }
+    
+    SECTION("Exceptions become PROC errors") {
+        registerCoroutineProcedure(engine, "double", [](const ParameterMap&) -> FlowTask<ParameterMap> {
+            throw std::runtime_error("no value");
+            co_return ParameterMap{};
+        });
+        auto result = engine.createFlow(makeDoubleAST()).execute();
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "Execution error: PROC execution failed: no value");
+    }
+}
+
+TEST_CASE("FlowTask composition", "[coroutine]") {
+    SECTION("Awaiting nested tasks") {
+        auto inner = []() -> FlowTask<int> { co_return 20; };
+        auto body = [&]() -> FlowTask<int> {
+            int a = co_await inner();
+            int b = co_await inner();
+            co_return a + b + 2;
+        };
+        auto outer = body();
+        outer.start();
+        REQUIRE(outer.done());
+        REQUIRE(outer.result() == 42);
+    }
+}
+
+#endif // FLOWGRAPH_HAS_COROUTINES
@@ -0,0 +1,192 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+// 10-30 form a fused ASSIGN block, 40 loops back to 20
+const char* counterSource = R"(
+TITLE: Counter
+
+PARAMS:
+N limit
+
+RETURNS:
+N count
+
+NODES:
+10 ASSIGN N count 0
+20 ASSIGN N count count + 1
+30 ASSIGN N doubled count * 2
+40 COND count < limit
+
+FLOW:
+START -> 10
+10 -> 20
+20 -> 30
+30 -> 40
+40.Y -> 20
+40.N -> END
+)";
+
+ParameterMap limit(double value) {
+    ParameterMap params;
+    params["limit"] = createValue(value);
+    return params;
+}
+
+} // namespace
+
+TEST_CASE("Debug execution steps node by node", "[debug]") {
+    Engine engine;
+    auto flow = parse(engine, counterSource);
+    REQUIRE(flow.getProgram().stats().fusedNodes == 1); // 10 -> 20 share a block in release runs
+    auto debug = flow.createDebugContext(limit(2));
+
+    SECTION("Each step runs one node, also inside fused blocks") {
+        std::vector<std::string> visited;
+        while (!debug->isFinished()) {
+            auto result = debug->step();
+            if (!debug->isFinished()) {
+                REQUIRE(result.state == ExecutionState::Paused);
+                visited.push_back(result.currentNodeId);
+            }
+        }
+        REQUIRE(visited == std::vector<std::string>{"20", "30", "40", "20", "30", "40"});
+        REQUIRE(debug->isCompleted());
+        REQUIRE(debug->getResult()->returnValues.at("count").asNumber() == 2);
+    }
+
+    SECTION("Variable views are lazy and current") {
+        debug->step();
+        auto paused = debug->step(); // before 30
+        REQUIRE(paused.currentNodeId == "30");
+        REQUIRE(paused.localVariables.empty());
+        REQUIRE(paused.variables.find("count")->asNumber() == 1);
+        REQUIRE(paused.variables.find("doubled") == nullptr);
+
+        debug->step();
+        REQUIRE(paused.variables.find("doubled")->asNumber() == 2);
+        REQUIRE(debug->getCurrentState().localVariables.at("doubled").asNumber() == 2);
+    }
+
+    SECTION("Variables can be changed while paused") {
+        debug->step();
+        debug->setVariable("count", createValue(10.0));
+        auto result = debug->run();
+        REQUIRE(result.flowCompleted);
+        REQUIRE(debug->getResult()->returnValues.at("count").asNumber() == 11);
+    }
+}
+
+TEST_CASE("Debug breakpoints and callbacks", "[debug]") {
+    Engine engine;
+    auto flow = parse(engine, counterSource);
+    auto debug = flow.createDebugContext(limit(3));
+
+    SECTION("run() stops at every hit of a breakpoint") {
+        debug->addBreakpoint("30");
+        REQUIRE(debug->hasBreakpoint("30"));
+        for (double expected = 1; expected <= 3; ++expected) {
+            auto result = debug->run();
+            REQUIRE(result.atBreakpoint);
+            REQUIRE(result.currentNodeId == "30");
+            REQUIRE(result.variables.find("count")->asNumber() == expected);
+        }
+        debug->removeBreakpoint("30");
+        REQUIRE(debug->run().flowCompleted);
+    }
+
+    SECTION("A breakpoint on the first node stops before it runs") {
+        debug->addBreakpoint("10");
+        auto result = debug->run();
+        REQUIRE(result.atBreakpoint);
+        REQUIRE(result.variables.find("count") == nullptr);
+        REQUIRE(debug->run().flowCompleted);
+    }
+
+    SECTION("pause() stops before the next node") {
+        debug->pause();
+        auto result = debug->run();
+        REQUIRE(result.state == ExecutionState::Paused);
+        REQUIRE_FALSE(result.atBreakpoint);
+        REQUIRE(result.currentNodeId == "10");
+    }
+
+    SECTION("The callback sees every node") {
+        std::vector<std::string> nodes;
+        debug->setDebugCallback([&nodes](const DebugStepResult& step) { nodes.push_back(step.currentNodeId); });
+        REQUIRE(debug->run().flowCompleted);
+        REQUIRE(nodes.size() == 10);
+        REQUIRE(nodes.front() == "10");
+        REQUIRE(nodes.back() == "40");
+    }
+
+    SECTION("Errors finish the debug execution") {
+        auto failing = parse(engine, "TITLE: Fail\n\nNODES:\n10 ASSIGN N x missing + 1\n\nFLOW:\nSTART -> 10\n10 -> END\n");
+        auto context = failing.createDebugContext();
+        auto result = context->run();
+        REQUIRE(context->isFinished());
+        REQUIRE(result.state == ExecutionState::Error);
+        REQUIRE(result.currentNodeId == "10");
+        REQUIRE(result.error.find("Variable not found") != std::string::npos);
+    }
+}
+
+TEST_CASE("Debug execution steps into sub-flows and async PROCs", "[debug][subflow][async]") {
+    Engine engine;
+    ProcCompletionCallback* pending = nullptr;
+    engine.registerProcedure("fetch", [&pending](const ParameterMap&, ProcCompletionCallback& callback) {
+        pending = &callback;
+    });
+    engine.registerModule("fetch.flow", parse(engine, R"(
+TITLE: Fetch
+
+RETURNS:
+N data
+
+NODES:
+10 PROC fetch data<<value
+20 ASSIGN N data data * 2
+
+FLOW:
+START -> 10
+10 -> 20
+20 -> END
+)", "fetch.flow"));
+    auto caller = parse(engine, R"(
+TITLE: Caller
+
+RETURNS:
+N result
+
+NODES:
+10 PROC fetch.flow result<<data
+20 ASSIGN N result result + 1
+
+FLOW:
+START -> 10
+10 -> 20
+20 -> END
+)", "caller.flow");
+
+    auto debug = caller.createDebugContext();
+    REQUIRE(debug->step().currentNodeId == "10");  // inside fetch.flow, before the async PROC
+    auto waiting = debug->step();
+    REQUIRE(waiting.waitingForAsync);
+    REQUIRE(waiting.asyncProcName == "fetch");
+    REQUIRE(debug->step().waitingForAsync); // not completed yet
+
+    ParameterMap values;
+    values["value"] = createValue(20.0);
+    (*pending)(ProcResult::completedSuccess(values));
+    auto inCallee = debug->step();
+    REQUIRE(inCallee.currentNodeId == "20");
+    REQUIRE(inCallee.variables.find("data")->asNumber() == 20);
+    REQUIRE(debug->step().currentNodeId == "20"); // back in the caller
+    REQUIRE(debug->step().flowCompleted);
+    REQUIRE(debug->getResult()->returnValues.at("result").asNumber() == 41);
+}
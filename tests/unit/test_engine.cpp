@@ -10,4 +10,463 @@ TEST_CASE("Basic engine functionality", "[engine]") {
     }
 }
 
-// More comprehensive engine tests will be added in next iteration
\ No newline at end of file
+namespace {
+
+std::unique_ptr<FlowAST> makeCounterAST() {
+    // Counts from 0 to limit through a COND loop
+    auto ast = std::make_unique<FlowAST>();
+    ast->parameters.emplace_back("limit", TypeInfo(ValueType::Number));
+    ast->returnValues.emplace_back("count", TypeInfo(ValueType::Number));
+    ast->nodes.push_back(std::make_unique<AssignNode>("10", TypeInfo(ValueType::Number), "count", "0"));
+    ast->nodes.push_back(std::make_unique<CondNode>("20", "count < limit"));
+    ast->nodes.push_back(std::make_unique<AssignNode>("30", TypeInfo(ValueType::Number), "count", "count + 1"));
+    ast->connections.emplace_back("START", "10");
+    ast->connections.emplace_back("10", "20");
+    ast->connections.emplace_back("20", "30", "Y");
+    ast->connections.emplace_back("20", "END", "N");
+    ast->connections.emplace_back("30", "20");
+    return ast;
+}
+
+std::unique_ptr<FlowAST> makeSquareAST() {
+    // Counter followed by PROC square count>>x squared<<y
+    auto ast = makeCounterAST();
+    ast->returnValues.emplace_back("squared", TypeInfo(ValueType::Number));
+    auto proc = std::make_unique<ProcNode>("40", "square");
+    proc->addBinding("count", "x", false);
+    proc->addBinding("squared", "y", true);
+    ast->nodes.push_back(std::move(proc));
+    ast->connections[3] = FlowConnection("20", "40", "N"); // 20.N -> 40 instead of END
+    ast->connections.emplace_back("40", "END");
+    return ast;
+}
+
+/**
+ * @brief Register "square" as an async PROC that completes only when the test says so
+ */
+void registerDeferredSquare(Engine& engine, std::vector<ProcCompletionCallback*>& pending) {
+    engine.registerProcedure("square", [&pending](const ParameterMap&, ProcCompletionCallback& callback) {
+        pending.push_back(&callback);
+    });
+}
+
+ProcResult squared(double value) {
+    ParameterMap out;
+    out["y"] = createValue(value);
+    return ProcResult::completedSuccess(std::move(out));
+}
+
+} // namespace
+
+TEST_CASE("Flow execution follows connections", "[engine][execution]") {
+    SECTION("Nodes run in FLOW order, not declaration order") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->returnValues.emplace_back("value", TypeInfo(ValueType::Number));
+        ast->nodes.push_back(std::make_unique<AssignNode>("10", TypeInfo(ValueType::Number), "value", "value * 10"));
+        ast->nodes.push_back(std::make_unique<AssignNode>("20", TypeInfo(ValueType::Number), "value", "2"));
+        ast->connections.emplace_back("START", "20");
+        ast->connections.emplace_back("20", "10");
+        ast->connections.emplace_back("10", "END");
+        
+        Flow flow(std::move(ast));
+        auto result = flow.execute();
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("value").asNumber() == 20.0);
+    }
+    
+    SECTION("Fused ASSIGN blocks run every node, also in loops") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->returnValues.emplace_back("value", TypeInfo(ValueType::Number));
+        ast->nodes.push_back(std::make_unique<AssignNode>("10", TypeInfo(ValueType::Number), "value", "0"));
+        ast->nodes.push_back(std::make_unique<AssignNode>("20", TypeInfo(ValueType::Number), "value", "value + 1"));
+        ast->nodes.push_back(std::make_unique<AssignNode>("30", TypeInfo(ValueType::Number), "value", "value * 3"));
+        ast->nodes.push_back(std::make_unique<CondNode>("40", "value < 100"));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "20");
+        ast->connections.emplace_back("20", "30");
+        ast->connections.emplace_back("30", "40");
+        ast->connections.emplace_back("40", "20", "Y");
+        ast->connections.emplace_back("40", "END", "N");
+
+        Flow flow(std::move(ast));
+        REQUIRE(flow.getProgram().stats().fusedNodes == 1);
+        auto result = flow.execute();
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("value").asNumber() == 120.0); // 3, 12, 39, 120
+    }
+    
+    SECTION("COND loop") {
+        Flow flow(makeCounterAST());
+        
+        ParameterMap params;
+        params["limit"] = createValue(5.0);
+        auto result = flow.execute(params);
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("count").asNumber() == 5.0);
+    }
+    
+    SECTION("The same flow can be executed repeatedly") {
+        Flow flow(makeCounterAST());
+        for (double limit = 0; limit < 4; ++limit) {
+            ParameterMap params;
+            params["limit"] = createValue(limit);
+            auto result = flow.execute(params);
+            REQUIRE(result.success);
+            REQUIRE(result.returnValues.at("count").asNumber() == limit);
+        }
+    }
+    
+    SECTION("Missing START connection is an execution error") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->nodes.push_back(std::make_unique<AssignNode>("10", TypeInfo(ValueType::Number), "x", "1"));
+        ast->connections.emplace_back("10", "END");
+        
+        Flow flow(std::move(ast));
+        auto result = flow.execute();
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "Flow must have a START connection");
+    }
+}
+
+TEST_CASE("Flow execution with cached expressions", "[engine][expression]") {
+    SECTION("Cached expression tree reads current variable values") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->returnValues.emplace_back("total", TypeInfo(ValueType::Number));
+        ast->nodes.push_back(std::make_unique<AssignNode>("10", TypeInfo(ValueType::Number), "total", "a + b"));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "END");
+        Flow flow(std::move(ast));
+        
+        for (double a = 1; a <= 3; ++a) {
+            ParameterMap params;
+            params["a"] = createValue(a);
+            params["b"] = createValue(10.0);
+            auto result = flow.execute(params);
+            REQUIRE(result.success);
+            REQUIRE(result.returnValues.at("total").asNumber() == a + 10.0);
+        }
+    }
+    
+    SECTION("Invalid expression fails when the node runs") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->nodes.push_back(std::make_unique<AssignNode>("10", TypeInfo(ValueType::Number), "x", "2 + + 3"));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "END");
+        Flow flow(std::move(ast));
+        
+        REQUIRE(flow.validate().size() == 1);
+        auto result = flow.execute();
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error.find("Expression evaluation error") != std::string::npos);
+    }
+}
+
+TEST_CASE("Flow error emission and capture", "[engine][errors]") {
+    SECTION("Error emission terminates the flow with the error name") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->errors.emplace_back("NEGATIVE");
+        ast->nodes.push_back(std::make_unique<CondNode>("10", "x >= 0"));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "END", "Y");
+        ast->connections.emplace_back("10", "NEGATIVE", "N");
+        
+        Flow flow(std::move(ast));
+        REQUIRE(flow.validate().empty());
+        
+        ParameterMap params;
+        params["x"] = createValue(-1.0);
+        auto result = flow.execute(params);
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "NEGATIVE");
+        
+        params["x"] = createValue(1.0);
+        REQUIRE(flow.execute(params).success);
+    }
+    
+    SECTION("PROC error is routed through the capture port") {
+        Engine engine;
+        engine.registerProcedure("lookup", [](const ParameterMap& /*params*/, ProcCompletionCallback& callback) {
+            callback(ProcResult::completedError("NOT_FOUND"));
+        });
+        
+        auto ast = std::make_unique<FlowAST>();
+        ast->errors.emplace_back("NOT_FOUND");
+        ast->returnValues.emplace_back("found", TypeInfo(ValueType::Boolean));
+        ast->nodes.push_back(std::make_unique<ProcNode>("10", "lookup"));
+        ast->nodes.push_back(std::make_unique<AssignNode>("20", TypeInfo(ValueType::Boolean), "found", "true"));
+        ast->nodes.push_back(std::make_unique<AssignNode>("30", TypeInfo(ValueType::Boolean), "found", "false"));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "20");
+        ast->connections.emplace_back("10", "30", "NOT_FOUND");
+        ast->connections.emplace_back("20", "END");
+        ast->connections.emplace_back("30", "END");
+        
+        auto flow = engine.createFlow(std::move(ast));
+        auto result = flow.execute();
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("found").asBoolean() == false);
+    }
+    
+    SECTION("Uncaptured PROC error fails the execution") {
+        Engine engine;
+        engine.registerProcedure("fail", [](const ParameterMap& /*params*/, ProcCompletionCallback& callback) {
+            callback(ProcResult::completedError("boom"));
+        });
+        
+        auto ast = std::make_unique<FlowAST>();
+        ast->nodes.push_back(std::make_unique<ProcNode>("10", "fail"));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "END");
+        
+        auto result = engine.createFlow(std::move(ast)).execute();
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "Execution error: PROC execution failed: boom");
+    }
+}
+
+TEST_CASE("Reusable execution contexts", "[engine][context]") {
+    SECTION("A caller-owned context is reset between executions") {
+        Flow flow(makeCounterAST());
+        auto context = flow.acquireContext();
+        
+        ParameterMap params;
+        params["limit"] = createValue(3.0);
+        params["extra"] = createValue(1.0);
+        REQUIRE(flow.execute(*context, params).returnValues.at("count").asNumber() == 3.0);
+        REQUIRE(context->hasVariable("extra"));
+        
+        ParameterMap next;
+        next["limit"] = createValue(1.0);
+        REQUIRE(flow.execute(*context, next).returnValues.at("count").asNumber() == 1.0);
+        REQUIRE_FALSE(context->hasVariable("extra"));
+        REQUIRE(context->getState() == ExecutionState::Completed);
+    }
+    
+    SECTION("Released contexts are handed out again") {
+        Flow flow(makeCounterAST());
+        auto context = flow.acquireContext();
+        ExecutionContext* raw = context.get();
+        flow.releaseContext(std::move(context));
+        
+        auto reused = flow.acquireContext();
+        REQUIRE(reused.get() == raw);
+        REQUIRE(reused->getState() == ExecutionState::NotStarted);
+        
+        // Copies of a Flow share the pool
+        Flow copy = flow;
+        copy.releaseContext(std::move(reused));
+        REQUIRE(flow.acquireContext().get() == raw);
+    }
+    
+    SECTION("Contexts of another flow are rejected") {
+        Flow flow(makeCounterAST());
+        Flow other(makeCounterAST());
+        auto context = other.acquireContext();
+        
+        auto result = flow.execute(*context);
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "Execution context belongs to a different flow");
+        REQUIRE_THROWS_AS(flow.releaseContext(std::move(context)), FlowGraphError);
+    }
+    
+    SECTION("Contexts left waiting for an async PROC are parked until it completes") {
+        Engine engine;
+        std::vector<ProcCompletionCallback*> pending;
+        registerDeferredSquare(engine, pending);
+        auto flow = engine.createFlow(makeSquareAST());
+        
+        ParameterMap params;
+        params["limit"] = createValue(2.0);
+        REQUIRE_FALSE(flow.execute(params).success);
+        REQUIRE_FALSE(flow.execute(params).success);
+        REQUIRE(pending.size() == 2);
+        REQUIRE(pending[0] != pending[1]);
+        
+        // Completing after execute() returned lands in a context the pool still owns
+        (*pending[0])(squared(4.0));
+        auto context = flow.acquireContext();
+        REQUIRE(&context->getProcCallback() == pending[0]);
+        REQUIRE(context->getState() == ExecutionState::NotStarted);
+        (*pending[1])(squared(4.0));
+    }
+
+    SECTION("Only parked contexts whose PROC completed are handed out again") {
+        Engine engine;
+        std::vector<ProcCompletionCallback*> pending;
+        registerDeferredSquare(engine, pending);
+        auto flow = engine.createFlow(makeSquareAST());
+
+        ParameterMap params;
+        params["limit"] = createValue(2.0);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE_FALSE(flow.execute(params).success);
+        }
+        REQUIRE(pending.size() == 3);
+
+        (*pending[2])(squared(4.0));
+        auto reclaimed = flow.acquireContext();
+        REQUIRE(&reclaimed->getProcCallback() == pending[2]);
+        auto fresh = flow.acquireContext();
+        REQUIRE(&fresh->getProcCallback() != pending[0]);
+        REQUIRE(&fresh->getProcCallback() != pending[1]);
+
+        (*pending[0])(squared(4.0));
+        (*pending[1])(squared(4.0));
+    }
+    
+    SECTION("A context still waiting for an async PROC cannot be started again") {
+        Engine engine;
+        std::vector<ProcCompletionCallback*> pending;
+        registerDeferredSquare(engine, pending);
+        auto flow = engine.createFlow(makeSquareAST());
+        auto context = flow.acquireContext();
+        
+        ParameterMap params;
+        params["limit"] = createValue(3.0);
+        REQUIRE_FALSE(flow.start(*context, params));
+        auto rejected = flow.execute(*context, params);
+        REQUIRE_FALSE(rejected.success);
+        REQUIRE(rejected.error == "Execution context is still waiting for an async PROC");
+        REQUIRE(pending.size() == 1);
+        
+        (*pending[0])(squared(9.0));
+        auto resumed = flow.resume(*context);
+        REQUIRE(resumed);
+        REQUIRE(resumed->returnValues.at("squared").asNumber() == 9.0);
+        REQUIRE_FALSE(flow.execute(*context, params).success);   // suspends again, now allowed
+        (*pending[1])(squared(9.0));
+        flow.releaseContext(std::move(context));
+    }
+}
+
+TEST_CASE("Batch execution", "[engine][batch]") {
+    std::vector<ParameterMap> batch;
+    for (int i = 0; i < 100; ++i) {
+        ParameterMap params;
+        params["limit"] = createValue(static_cast<double>(i % 7));
+        batch.push_back(std::move(params));
+    }
+    
+    SECTION("Results are returned in input order") {
+        Flow flow(makeCounterAST());
+        auto results = flow.executeBatch(batch);
+        REQUIRE(results.size() == batch.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            REQUIRE(results[i].success);
+            REQUIRE(results[i].returnValues.at("count").asNumber() == static_cast<double>(i % 7));
+        }
+    }
+    
+    SECTION("Parallel execution matches sequential execution") {
+        Engine engine;
+        engine.registerLegacyProcedure("square", [](const ParameterMap& params) {
+            ParameterMap out;
+            double x = params.at("x").asNumber();
+            out["y"] = createValue(x * x);
+            return out;
+        });
+        
+        auto ast = makeCounterAST();
+        ast->returnValues.emplace_back("squared", TypeInfo(ValueType::Number));
+        auto proc = std::make_unique<ProcNode>("40", "square");
+        proc->addBinding("count", "x", false);
+        proc->addBinding("squared", "y", true);
+        ast->nodes.push_back(std::move(proc));
+        ast->connections[3] = FlowConnection("20", "40", "N"); // 20.N -> 40 instead of END
+        ast->connections.emplace_back("40", "END");
+        
+        auto flow = engine.createFlow(std::move(ast));
+        auto sequential = flow.executeBatch(batch, 1);
+        auto parallel = flow.executeBatch(batch, 4);
+        REQUIRE(parallel.size() == sequential.size());
+        for (size_t i = 0; i < parallel.size(); ++i) {
+            REQUIRE(parallel[i].success);
+            double count = static_cast<double>(i % 7);
+            REQUIRE(parallel[i].returnValues.at("squared").asNumber() == count * count);
+            REQUIRE(parallel[i].returnValues.at("squared").asNumber() == sequential[i].returnValues.at("squared").asNumber());
+        }
+    }
+    
+    SECTION("Empty batch") {
+        Flow flow(makeCounterAST());
+        REQUIRE(flow.executeBatch({}, 0).empty());
+    }
+    
+    SECTION("Rows left waiting for an async PROC get contexts of their own") {
+        Engine engine;
+        std::vector<ProcCompletionCallback*> pending;
+        registerDeferredSquare(engine, pending);
+        auto flow = engine.createFlow(makeSquareAST());
+        
+        auto results = flow.executeBatch({batch[1], batch[2]}, 1);
+        REQUIRE(results.size() == 2);
+        REQUIRE_FALSE(results[0].success);
+        REQUIRE_FALSE(results[1].success);
+        REQUIRE(pending.size() == 2);
+        REQUIRE(pending[0] != pending[1]);
+        
+        // Late completions land in contexts the pool still owns
+        (*pending[0])(squared(1.0));
+        (*pending[1])(squared(4.0));
+        REQUIRE_FALSE(flow.execute(batch[3]).success);
+        REQUIRE(pending.size() == 3);
+        (*pending[2])(squared(9.0));
+    }
+}
+
+TEST_CASE("PROC resolution at load", "[engine][proc]") {
+    auto makeAST = [] {
+        auto ast = std::make_unique<FlowAST>();
+        ast->returnValues.emplace_back("seen", TypeInfo(ValueType::Number));
+        auto proc = std::make_unique<ProcNode>("10", "count_params");
+        proc->addBinding("a", "a", false);
+        proc->addBinding("b", "b", false);
+        proc->addBinding("seen", "count", true);
+        ast->nodes.push_back(std::move(proc));
+        ast->connections.emplace_back("START", "10");
+        ast->connections.emplace_back("10", "END");
+        return ast;
+    };
+    auto countParams = [](const ParameterMap& params) {
+        ParameterMap out;
+        out["count"] = createValue(static_cast<double>(params.size()));
+        return out;
+    };
+    
+    SECTION("Missing procedures are reported at load") {
+        Engine engine;
+        REQUIRE_THROWS_AS(engine.createFlow(makeAST()), FlowGraphError);
+        
+        // Without strict loading the flow is created, and validate() lists what is missing
+        engine.setStrictProcedures(false);
+        auto flow = engine.createFlow(makeAST());
+        auto errors = flow.validate();
+        REQUIRE(errors.size() == 1);
+        REQUIRE(errors[0] == "Procedure not found: count_params (node 10)");
+        
+        // Registering afterwards is still picked up by name
+        engine.registerLegacyProcedure("count_params", countParams);
+        REQUIRE(flow.validate().empty());
+        ParameterMap params;
+        params["a"] = createValue(1.0);
+        params["b"] = createValue(2.0);
+        REQUIRE(flow.execute(params).returnValues.at("seen").asNumber() == 2.0);
+    }
+    
+    SECTION("Unassigned input variables are left out of the parameters") {
+        Engine engine;
+        engine.registerLegacyProcedure("count_params", countParams);
+        auto flow = engine.createFlow(makeAST());
+        auto context = flow.acquireContext();
+        
+        ParameterMap both;
+        both["a"] = createValue(1.0);
+        both["b"] = createValue(2.0);
+        ParameterMap onlyA;
+        onlyA["a"] = createValue(1.0);
+        
+        REQUIRE(flow.execute(*context, both).returnValues.at("seen").asNumber() == 2.0);
+        REQUIRE(flow.execute(*context, onlyA).returnValues.at("seen").asNumber() == 1.0);
+        REQUIRE(flow.execute(*context, both).returnValues.at("seen").asNumber() == 2.0);
+    }
+}
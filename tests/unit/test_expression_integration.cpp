@@ -274,4 +274,37 @@ TEST_CASE("ExpressionKit integration - Direct Value usage", "[expression][integr
         REQUIRE(getValueType(boolVal) == ValueType::Boolean);
         REQUIRE(getValueType(stringVal) == ValueType::String);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("ExpressionKit integration - Slot storage", "[expression][integration][slots]") {
+    SECTION("Compiled slots and run-time variables are both visible to expressions") {
+        auto ast = std::make_unique<FlowAST>();
+        ast->parameters.emplace_back("x", TypeInfo(ValueType::Number));
+        CompiledFlow program(std::move(ast));
+        ExecutionContext context(program);
+        
+        REQUIRE_FALSE(context.hasVariable("x")); // slot exists but is unassigned
+        context.setVariable("x", createValue(2.0));
+        context.setVariable("y", createValue(3.0)); // not known at compile time
+        
+        REQUIRE(context.evaluateExpression("x * y").asNumber() == 6.0);
+        REQUIRE(context.getLocalVariables().size() == 2);
+    }
+    
+    SECTION("Expressions see updates without re-synchronisation") {
+        FlowAST ast;
+        ExecutionContext context(ast);
+        auto expression = ExpressionKit::Expression::Parse("n + 1");
+        
+        context.setVariable("n", createValue(1.0));
+        REQUIRE(context.evaluateExpression(*expression).asNumber() == 2.0);
+        context.setVariable("n", createValue(41.0));
+        REQUIRE(context.evaluateExpression(*expression).asNumber() == 42.0);
+    }
+    
+    SECTION("Unassigned variables are reported") {
+        FlowAST ast;
+        ExecutionContext context(ast);
+        REQUIRE_THROWS_AS(context.getVariable("missing"), FlowGraphError);
+        REQUIRE_THROWS_AS(context.evaluateExpression("missing + 1"), FlowGraphError);
+    }
+}
@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include <filesystem>
+#include <fstream>
+
+using namespace FlowGraph;
+
+namespace {
+
+const char* kScoreFlow = R"(// Score a submission
+TITLE: Score
+
+PARAMS:
+N points
+S name ?
+
+RETURNS:
+N score
+S grade
+
+ERRORS:
+// points out of range
+BAD_POINTS
+
+NODES:
+10 COND points >= 0
+20 ASSIGN N score points * 10
+30 PROC label score>>value grade<<text
+40 ASSIGN S grade "n/a"
+
+FLOW:
+START -> 10
+10.Y -> 20
+10.N -> BAD_POINTS
+20 -> 30
+30.BAD_POINTS -> 40
+30 -> END
+40 -> END
+)";
+
+ParameterMap labelProc(const ParameterMap& params) {
+    ParameterMap result;
+    result["text"] = createValue(params.at("value").asNumber() >= 50 ? std::string("pass") : std::string("fail"));
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("Binary flow format round-trips the AST", "[archive]") {
+    Parser parser;
+    auto original = parser.parse(kScoreFlow, "score.flow");
+    std::string image = FlowArchive::serialize(*original);
+    REQUIRE(FlowArchive::isArchive(image));
+
+    SECTION("All sections are preserved") {
+        auto ast = FlowArchive::deserialize(image);
+        REQUIRE(ast->title == "Score");
+        REQUIRE(ast->comment == "Score a submission");
+        REQUIRE(ast->location.filename == "score.flow");
+        REQUIRE(ast->parameters.size() == 2);
+        REQUIRE(ast->parameters[1].type.type == ValueType::String);
+        REQUIRE(ast->parameters[1].type.optional);
+        REQUIRE(ast->returnValues.size() == 2);
+        REQUIRE(ast->errors.size() == 1);
+        REQUIRE(ast->errors[0].comment == "points out of range");
+        REQUIRE(ast->nodes.size() == 4);
+        REQUIRE(ast->connections.size() == 7);
+
+        auto* assign = static_cast<AssignNode*>(ast->findNode("20"));
+        REQUIRE(assign->kind == NodeKind::Assign);
+        REQUIRE(assign->expression == "points * 10");
+        REQUIRE(assign->location.line == original->findNode("20")->location.line);
+
+        auto* proc = static_cast<ProcNode*>(ast->findNode("30"));
+        REQUIRE(proc->procedureName == "label");
+        REQUIRE(proc->bindings.size() == 2);
+        REQUIRE(proc->bindings[1].isOutput);
+        REQUIRE(proc->bindings[1].procParam == "text");
+
+        REQUIRE(ast->connections[2].fromPort == "N");
+        REQUIRE(ast->connections[2].toNode == "BAD_POINTS");
+        REQUIRE(FlowArchive::serialize(*ast) == image);
+    }
+
+    SECTION("Strings are stored once") {
+        // "score" appears as a return value, an ASSIGN target and a binding
+        size_t occurrences = 0;
+        for (size_t pos = image.find("score"); pos != std::string::npos; pos = image.find("score", pos + 1)) {
+            ++occurrences;
+        }
+        REQUIRE(occurrences == 2); // "score" and "score.flow"
+    }
+
+    SECTION("Corrupt images are rejected") {
+        REQUIRE_THROWS_AS(FlowArchive::deserialize(image.substr(0, image.size() - 1)), FlowGraphError);
+        REQUIRE_THROWS_AS(FlowArchive::deserialize(image.substr(0, 10)), FlowGraphError);
+        REQUIRE_THROWS_AS(FlowArchive::deserialize(kScoreFlow), FlowGraphError);
+
+        std::string otherVersion = image;
+        otherVersion[4] = static_cast<char>(FlowArchive::Version + 1);
+        REQUIRE_THROWS_AS(FlowArchive::deserialize(otherVersion), FlowGraphError);
+    }
+}
+
+TEST_CASE("FlowGraphEngine saves and loads compiled flows", "[archive][file]") {
+    auto dir = std::filesystem::temp_directory_path() / "flowgraph_archive_test";
+    std::filesystem::create_directories(dir);
+    auto source = dir / "score.flow";
+    auto compiled = dir / "score.flowc";
+    {
+        std::ofstream out(source);
+        out << kScoreFlow;
+    }
+
+    FlowGraphEngine engine;
+    engine.registerLegacyProcedure("label", labelProc);
+    engine.saveCompiled(engine.loadFlow(source.string()), compiled.string());
+
+    ParameterMap params;
+    params["points"] = createValue(7.0);
+
+    SECTION("Compiled flows execute like their source") {
+        FlowGraphEngine runtime;
+        runtime.registerLegacyProcedure("label", labelProc);
+        Flow flow = runtime.loadCompiled(compiled.string());
+        auto result = flow.execute(params);
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues["score"].asNumber() == 70.0);
+        REQUIRE(result.returnValues["grade"].asString() == "pass");
+        REQUIRE(flow.validate().empty());
+
+        // loadFlow accepts .flowc files and caches them like sources
+        Flow again = runtime.loadFlow(compiled.string());
+        REQUIRE(&again.getProgram() == &flow.getProgram());
+    }
+
+    SECTION("loadCompiled rejects text sources") {
+        REQUIRE_THROWS_AS(engine.loadCompiled(source.string()), FlowGraphError);
+    }
+
+    std::filesystem::remove_all(dir);
+}
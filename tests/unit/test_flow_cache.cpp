@@ -0,0 +1,138 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <filesystem>
+#include <thread>
+
+using namespace FlowGraph;
+using FlowGraph::test::writeFile;
+
+namespace {
+
+const char* kDoubleFlow = R"(TITLE: Double
+
+PARAMS:
+N x
+
+RETURNS:
+N y
+
+NODES:
+10 ASSIGN N y x * 2
+
+FLOW:
+START -> 10
+10 -> END
+)";
+
+ParameterMap xParam(double x) {
+    ParameterMap params;
+    params["x"] = createValue(x);
+    return params;
+}
+
+} // namespace
+
+TEST_CASE("FlowGraphEngine loads flow files", "[cache][file]") {
+    auto dir = std::filesystem::temp_directory_path() / "flowgraph_cache_test";
+    std::filesystem::create_directories(dir);
+    auto path = dir / "double.flow";
+    writeFile(path, kDoubleFlow);
+
+    FlowGraphEngine engine;
+
+    SECTION("Loaded flows execute") {
+        Flow flow = engine.loadFlow(path.string());
+        REQUIRE(flow.getTitle() == "Double");
+        auto result = flow.execute(xParam(21));
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues["y"].asNumber() == 42.0);
+
+        auto direct = executeFlow(path.string(), xParam(2));
+        REQUIRE(direct.returnValues["y"].asNumber() == 4.0);
+    }
+
+    SECTION("Unchanged files share the compiled flow") {
+        Flow first = engine.loadFlow(path.string());
+        Flow second = engine.loadFlow((dir / "." / "double.flow").string());
+        REQUIRE(&first.getProgram() == &second.getProgram());
+        REQUIRE(engine.getFlowCache().misses() == 1);
+        REQUIRE(engine.getFlowCache().hits() == 1);
+        REQUIRE(engine.getFlowCache().size() == 1);
+    }
+
+    SECTION("Changed files are parsed again") {
+        Flow first = engine.loadFlow(path.string());
+        std::string changed = kDoubleFlow;
+        changed.replace(changed.find("x * 2"), 5, "x * 3");
+        writeFile(path, changed);
+
+        Flow second = engine.loadFlow(path.string());
+        REQUIRE(&first.getProgram() != &second.getProgram());
+        REQUIRE(second.execute(xParam(2)).returnValues["y"].asNumber() == 6.0);
+        REQUIRE(first.execute(xParam(2)).returnValues["y"].asNumber() == 4.0);
+        REQUIRE(engine.getFlowCache().size() == 1);
+    }
+
+    SECTION("Invalidation forces a reload") {
+        Flow first = engine.loadFlow(path.string());
+        REQUIRE(engine.getFlowCache().invalidate(path.string()));
+        Flow second = engine.loadFlow(path.string());
+        REQUIRE(&first.getProgram() != &second.getProgram());
+        REQUIRE(engine.getFlowCache().misses() == 2);
+    }
+
+    SECTION("Concurrent loads return equivalent flows") {
+        std::vector<std::thread> threads;
+        std::vector<std::optional<Flow>> flows(8);
+        for (size_t i = 0; i < flows.size(); ++i) {
+            threads.emplace_back([&, i] { flows[i] = engine.loadFlow(path.string()); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(engine.getFlowCache().size() == 1);
+        for (const auto& flow : flows) {
+            REQUIRE(flow->execute(xParam(1)).returnValues["y"].asNumber() == 2.0);
+        }
+        Flow cached = engine.loadFlow(path.string());
+        REQUIRE(&cached.getProgram() == &engine.loadFlow(path.string()).getProgram());
+    }
+
+    SECTION("Missing files throw IO errors") {
+        try {
+            engine.loadFlow((dir / "missing.flow").string());
+            FAIL("Expected an IO error");
+        } catch (const FlowGraphError& e) {
+            REQUIRE(e.type() == FlowGraphError::Type::IO);
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("FlowGraphEngine caches parsed sources", "[cache]") {
+    FlowGraphEngine engine;
+
+    Flow first = engine.parseFlow(kDoubleFlow, "double");
+    Flow second = engine.parseFlow(kDoubleFlow, "double");
+    REQUIRE(&first.getProgram() == &second.getProgram());
+
+    Flow renamed = engine.parseFlow(kDoubleFlow, "other");
+    REQUIRE(&first.getProgram() != &renamed.getProgram());
+
+    REQUIRE(second.execute(xParam(5)).returnValues["y"].asNumber() == 10.0);
+    REQUIRE(FlowCache::contentHash("abc") != FlowCache::contentHash("abd"));
+
+    engine.getFlowCache().clear();
+    REQUIRE(engine.getFlowCache().size() == 0);
+}
+
+TEST_CASE("FlowGraphEngine rejects flows calling unknown procedures", "[cache]") {
+    FlowGraphEngine engine;
+    const std::string source = "NODES:\n10 PROC count_params\n\nFLOW:\nSTART -> 10\n10 -> END\n";
+    REQUIRE_THROWS_AS(engine.parseFlow(source, "missing"), FlowGraphError);
+
+    engine.setStrictProcedures(false);
+    REQUIRE(engine.parseFlow(source, "missing").validate().size() == 1);
+}
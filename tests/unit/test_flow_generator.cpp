@@ -0,0 +1,75 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include "../../benchmarks/FlowGenerator.hpp"
+#include <string>
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+ParameterMap work(const ParameterMap& params) {
+    ParameterMap result;
+    result["result"] = createValue(params.at("a").asNumber() * 0.5 + params.at("b").asNumber() * 0.25);
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("Generated flows have the requested shape", "[generator]") {
+    bench::FlowShape shape;
+    shape.nodes = 2000;
+    shape.branchFactor = 3;
+    shape.loopDepth = 2;
+
+    SECTION("Exact node count and no diagnostics") {
+        Engine engine;
+        engine.registerProcedure<&work>("work");
+        Flow flow = parse(engine, bench::generateFlow(shape));
+        REQUIRE(flow.getProgram().nodeCount() == 2000);
+        REQUIRE(flow.getProgram().diagnostics().empty());
+        REQUIRE(flow.validate().empty());
+    }
+
+    SECTION("Same seed, same text; another seed, another flow") {
+        REQUIRE(bench::generateFlow(shape) == bench::generateFlow(shape));
+        bench::FlowShape other = shape;
+        other.seed = 2;
+        REQUIRE(bench::generateFlow(shape) != bench::generateFlow(other));
+    }
+
+    SECTION("PROC density is roughly honoured") {
+        shape.procDensity = 0.3;
+        bench::FlowGenerator generator(shape);
+        generator.generate();
+        REQUIRE(generator.procNodes() > 300);
+        REQUIRE(generator.procNodes() < 900);
+
+        shape.procDensity = 0;
+        bench::FlowGenerator none(shape);
+        REQUIRE(none.generate().find("PROC") == std::string::npos);
+        REQUIRE(none.procNodes() == 0);
+    }
+}
+
+TEST_CASE("Generated flows execute to the end", "[generator]") {
+    bench::FlowShape shape;
+    shape.nodes = 10000;
+    shape.loopTrips = 3;
+
+    Engine engine;
+    engine.registerProcedure<&work>("work");
+    Flow flow = parse(engine, bench::generateFlow(shape));
+
+    ParameterMap params;
+    params["x"] = createValue(2.0);
+    ExecutionResult result = flow.execute(params);
+    REQUIRE(result.success);
+    REQUIRE(result.returnValues.count("result") == 1);
+
+    // Repeated executions agree
+    ExecutionResult again = flow.execute(params);
+    REQUIRE(again.success);
+    REQUIRE(again.returnValues.at("result").asNumber() == result.returnValues.at("result").asNumber());
+}
@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+using namespace FlowGraph;
+using FlowGraph::test::writeFile;
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// n = x + step; the step's digit count changes the file size, so a rewrite
+// is noticed even where modification times are coarse
+std::string addSource(const std::string& step) {
+    return "TITLE: Add\n\nPARAMS:\nI x\n\nRETURNS:\nI n\n\nNODES:\n10 ASSIGN I n x + " + step +
+           "\n\nFLOW:\nSTART -> 10\n10 -> END\n";
+}
+
+// Calls add.flow, optionally waiting on an async PROC first
+std::string callerSource(bool wait) {
+    std::string nodes = wait ? "10 PROC wait\n20 PROC add.flow x>>x n<<n\n" : "20 PROC add.flow x>>x n<<n\n";
+    std::string flow = wait ? "START -> 10\n10 -> 20\n20 -> END\n" : "START -> 20\n20 -> END\n";
+    return "TITLE: Caller\n\nPARAMS:\nI x\n\nRETURNS:\nI n\n\nNODES:\n" + nodes + "\nFLOW:\n" + flow;
+}
+
+double run(const Flow& flow, double x) {
+    ParameterMap params;
+    params["x"] = createValue(x);
+    auto result = flow.execute(params);
+    REQUIRE(result.success);
+    return result.returnValues.at("n").asNumber();
+}
+
+} // namespace
+
+TEST_CASE("FlowReloader publishes changed flows", "[reload][file]") {
+    fs::path dir = fs::temp_directory_path() / "flowgraph_reload_test";
+    fs::remove_all(dir);
+    writeFile(dir / "add.flow", addSource("1"));
+    FlowGraphEngine engine;
+    std::vector<std::string> errors;
+    engine.getReloader().setErrorHandler([&errors](const std::string&, const std::string& message) {
+        errors.push_back(message);
+    });
+
+    SECTION("New calls get the new version, pinned ones keep the old") {
+        FlowHandle handle = engine.watchFlow((dir / "add.flow").string());
+        REQUIRE(handle.version() == 1);
+        REQUIRE(run(*handle.get(), 1) == 2);
+        auto pinned = handle.get();
+
+        writeFile(dir / "add.flow", addSource("10"));
+        REQUIRE(engine.getReloader().poll() == 1);
+        REQUIRE(handle.version() == 2);
+        REQUIRE(run(*handle.get(), 1) == 11);
+        REQUIRE(run(*pinned, 1) == 2);
+
+        // Watching again shares the handle; an unchanged file is not reloaded
+        REQUIRE(engine.watchFlow((dir / "add.flow").string()).version() == 2);
+        REQUIRE(engine.getReloader().poll() == 0);
+        REQUIRE(errors.empty());
+    }
+
+    SECTION("Broken edits keep the loaded version") {
+        FlowHandle handle = engine.watchFlow((dir / "add.flow").string());
+        writeFile(dir / "add.flow", "TITLE: Add\nNODES:\n10 LOOP\n");
+        REQUIRE(engine.getReloader().poll() == 0);
+        REQUIRE(errors.size() == 1);
+        REQUIRE(errors[0].find("3:4: Expected node type") != std::string::npos);
+
+        writeFile(dir / "add.flow", "TITLE: Add\n\nNODES:\n10 ASSIGN I n 1\n");
+        REQUIRE(engine.getReloader().poll() == 0);
+        REQUIRE(errors.size() == 3); // neither START nor END
+        REQUIRE(handle.version() == 1);
+        REQUIRE(run(*handle.get(), 1) == 2);
+
+        fs::remove(dir / "add.flow");
+        REQUIRE(engine.getReloader().poll() == 0);
+        REQUIRE(errors.size() == 4);
+    }
+
+    SECTION("Reloaded modules are relinked into their callers") {
+        writeFile(dir / "main.flow", callerSource(false));
+        REQUIRE(engine.loadDirectory(dir.string()).success());
+        auto main = engine.getModuleHandle("main.flow");
+        REQUIRE(main);
+        REQUIRE(run(*main->get(), 1) == 2);
+
+        writeFile(dir / "add.flow", addSource("100"));
+        REQUIRE(engine.getReloader().poll() == 1);
+        REQUIRE(engine.getModuleHandle("add.flow")->version() == 2);
+        REQUIRE(run(*engine.getModule("add.flow"), 1) == 101);
+        REQUIRE(run(*main->get(), 1) == 101);
+        REQUIRE(main->version() == 1);
+    }
+
+    SECTION("Suspended executions finish on the version they started with") {
+        ProcCompletionCallback* pending = nullptr;
+        engine.registerProcedure("wait", [&pending](const ParameterMap&, ProcCompletionCallback& callback) {
+            pending = &callback;
+        });
+        writeFile(dir / "main.flow", callerSource(true));
+        REQUIRE(engine.loadDirectory(dir.string()).success());
+        auto main = engine.getModuleHandle("main.flow");
+
+        FlowScheduler scheduler;
+        double before = -1;
+        ParameterMap params;
+        params["x"] = createValue(1.0);
+        scheduler.submit(*main->get(), params, [&before](FlowScheduler::TaskId, const ExecutionResult& result) {
+            before = result.returnValues.at("n").asNumber();
+        });
+        REQUIRE(pending);
+
+        writeFile(dir / "main.flow", callerSource(true) + "\n");
+        writeFile(dir / "add.flow", addSource("100"));
+        REQUIRE(engine.getReloader().poll() == 2);
+        REQUIRE(main->version() == 2);
+
+        // The replaced caller is no longer relinked, so it still calls the old add.flow
+        (*pending)(ProcResult::completedSuccess({}));
+        REQUIRE(scheduler.poll() == 1);
+        REQUIRE(before == 2);
+
+        double after = -1;
+        scheduler.submit(*main->get(), params, [&after](FlowScheduler::TaskId, const ExecutionResult& result) {
+            after = result.returnValues.at("n").asNumber();
+        });
+        (*pending)(ProcResult::completedSuccess({}));
+        REQUIRE(scheduler.poll() == 1);
+        REQUIRE(after == 101);
+    }
+
+    SECTION("Background polling") {
+        FlowHandle handle = engine.watchFlow((dir / "add.flow").string());
+        engine.enableHotReload(std::chrono::milliseconds(5));
+        REQUIRE(engine.getReloader().isRunning());
+        writeFile(dir / "add.flow", addSource("1000"));
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (handle.version() == 1 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        engine.disableHotReload();
+        REQUIRE_FALSE(engine.getReloader().isRunning());
+        REQUIRE(run(*handle.get(), 1) == 1001);
+    }
+
+    fs::remove_all(dir);
+}
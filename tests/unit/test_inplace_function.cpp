@@ -0,0 +1,137 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/detail/Engine.hpp"
+#include <memory>
+
+using namespace FlowGraph;
+
+namespace {
+
+int twice(int x) { return x * 2; }
+
+void asyncIncrement(const ParameterMap& params, ProcCompletionCallback& callback) {
+    ParameterMap out;
+    out["y"] = createValue(params.at("x").asNumber() + 1);
+    callback(ProcResult::completedSuccess(std::move(out)));
+}
+
+ParameterMap legacySquare(const ParameterMap& params) {
+    ParameterMap out;
+    double x = params.at("x").asNumber();
+    out["y"] = createValue(x * x);
+    return out;
+}
+
+ParameterMap legacyThrows(const ParameterMap&) {
+    throw std::runtime_error("bad input");
+}
+
+std::unique_ptr<FlowAST> makeCallAST(const std::string& procName) {
+    auto ast = std::make_unique<FlowAST>();
+    ast->parameters.emplace_back("x", TypeInfo(ValueType::Number));
+    ast->returnValues.emplace_back("y", TypeInfo(ValueType::Number));
+    auto proc = std::make_unique<ProcNode>("10", procName);
+    proc->addBinding("x", "x", false);
+    proc->addBinding("y", "y", true);
+    ast->nodes.push_back(std::move(proc));
+    ast->connections.emplace_back("START", "10");
+    ast->connections.emplace_back("10", "END");
+    return ast;
+}
+
+} // namespace
+
+TEST_CASE("InplaceFunction", "[types][function]") {
+    SECTION("Empty and null states") {
+        InplaceFunction<int(int)> empty;
+        REQUIRE_FALSE(empty);
+        InplaceFunction<int(int)> null = static_cast<int (*)(int)>(nullptr);
+        REQUIRE_FALSE(null);
+        InplaceFunction<int(int)> emptyStd = std::function<int(int)>();
+        REQUIRE_FALSE(emptyStd);
+        REQUIRE_THROWS_AS(empty(1), std::bad_function_call);
+    }
+    
+    SECTION("Function pointers, lambdas and std::function") {
+        InplaceFunction<int(int)> pointer = &twice;
+        REQUIRE(pointer(21) == 42);
+        
+        int offset = 10;
+        InplaceFunction<int(int)> lambda = [offset](int x) { return x + offset; };
+        REQUIRE(lambda(5) == 15);
+        
+        std::function<int(int)> stdFunction = [](int x) { return x - 1; };
+        InplaceFunction<int(int)> wrapped = stdFunction;
+        REQUIRE(wrapped(1) == 0);
+    }
+    
+    SECTION("Move-only callables and ownership transfer") {
+        auto counter = std::make_shared<int>(0);
+        {
+            InplaceFunction<void()> a = [owned = std::make_unique<int>(7), counter]() { *counter += *owned; };
+            InplaceFunction<void()> b = std::move(a);
+            REQUIRE_FALSE(a);
+            b();
+            REQUIRE(*counter == 7);
+            REQUIRE(counter.use_count() == 2);
+            b = nullptr;
+            REQUIRE(counter.use_count() == 1);
+        }
+        REQUIRE(counter.use_count() == 1);
+    }
+}
+
+TEST_CASE("Compile-time procedure registration", "[engine][proc]") {
+    Engine engine;
+    ParameterMap params;
+    params["x"] = createValue(4.0);
+    
+    SECTION("Async signature") {
+        engine.registerProcedure<&asyncIncrement>("increment");
+        REQUIRE(engine.hasProcedure("increment"));
+        auto result = engine.createFlow(makeCallAST("increment")).execute(params);
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("y").asNumber() == 5.0);
+    }
+    
+    SECTION("Legacy signature") {
+        engine.registerProcedure<&legacySquare>("square");
+        auto result = engine.createFlow(makeCallAST("square")).execute(params);
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("y").asNumber() == 16.0);
+        
+        // getProcedure still hands out a working std::function
+        ProcCompletionCallback callback;
+        engine.getProcedure("square")(params, callback);
+        REQUIRE(callback.IsResolved());
+        REQUIRE(callback.GetResult().returnValues.at("y").asNumber() == 16.0);
+    }
+    
+    SECTION("Legacy exceptions become PROC errors") {
+        engine.registerProcedure<&legacyThrows>("throws");
+        auto result = engine.createFlow(makeCallAST("throws")).execute(params);
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "Execution error: PROC execution failed: bad input");
+    }
+    
+    SECTION("Plain functions are called without a wrapper") {
+        engine.registerProcedure<&asyncIncrement>("increment");
+        engine.registerProcedure<&legacySquare>("square");
+        engine.registerProcedure("plain", &asyncIncrement);
+        engine.registerProcedure("lambda", [](const ParameterMap& in, ProcCompletionCallback& callback) {
+            asyncIncrement(in, callback);
+        });
+        REQUIRE(engine.findProcedureHandle("increment").function);
+        REQUIRE(engine.findProcedureHandle("square").function);
+        REQUIRE(engine.findProcedureHandle("plain").function == &asyncIncrement);
+        REQUIRE_FALSE(engine.findProcedureHandle("lambda").function);
+        REQUIRE(engine.createFlow(makeCallAST("plain")).execute(params).returnValues.at("y").asNumber() == 5.0);
+    }
+    
+    SECTION("Re-registration replaces the dispatched procedure") {
+        engine.registerLegacyProcedure("calc", legacySquare);
+        auto flow = engine.createFlow(makeCallAST("calc"));
+        REQUIRE(flow.execute(params).returnValues.at("y").asNumber() == 16.0);
+        engine.registerProcedure<&asyncIncrement>("calc");
+        REQUIRE(flow.execute(params).returnValues.at("y").asNumber() == 5.0);
+    }
+}
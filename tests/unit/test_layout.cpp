@@ -5,9 +5,12 @@
 // Include all layout headers
 #include "../../include/flowgraph_layout/LayoutTypes.hpp"
 #include "../../include/flowgraph_layout/Layout.hpp"
+#include "../../include/flowgraph_layout/DenseGraph.hpp"
+#include "../../include/flowgraph_layout/LayoutKernels.hpp"
 #include "../../include/flowgraph_layout/HierarchicalLayout.hpp"
 #include "../../include/flowgraph_layout/ForceDirectedLayout.hpp"
 #include "../../include/flowgraph_layout/GridLayout.hpp"
+#include "../../include/flowgraph_layout/SpatialIndex.hpp"
 
 using namespace flowgraph::layout;
 using namespace Catch::literals;
@@ -112,6 +115,167 @@ TEST_CASE("LayoutTypes - Graph operations", "[layout][types]") {
         REQUIRE(graph.getNeighbors(2).size() == 0);
         REQUIRE(graph.getNeighbors(4).size() == 0); // Non-existent node
     }
+    
+    SECTION("Edge and node removal") {
+        GraphF graph;
+        for (size_t i = 1; i <= 4; ++i) {
+            graph.addNode(NodeF(i));
+        }
+        graph.addEdge({1, 2});
+        graph.addEdge({2, 3});
+        graph.addEdge({1, 2}); // Parallel edge
+        graph.addEdge({3, 4});
+        graph.addEdge({4, 1});
+        graph.addEdge({3, 3}); // Self loop
+        
+        auto adjacent = graph.getAdjacentNodes(1);
+        std::sort(adjacent.begin(), adjacent.end());
+        REQUIRE(adjacent == std::vector<NodeId>{2, 2, 4});
+        
+        REQUIRE(graph.removeEdge(1, 2) == 2);
+        REQUIRE(graph.removeEdge(1, 2) == 0);
+        REQUIRE(graph.edgeCount() == 4);
+        REQUIRE(graph.getNeighbors(1).empty());
+        REQUIRE(graph.getAdjacentNodes(2) == std::vector<NodeId>{3});
+        
+        REQUIRE(graph.removeNode(3));
+        REQUIRE_FALSE(graph.removeNode(3));
+        REQUIRE(graph.nodeCount() == 3);
+        REQUIRE(graph.edgeCount() == 1);
+        REQUIRE(graph.getEdges()[0] == Edge(4, 1));
+        REQUIRE(graph.getNeighbors(2).empty());
+        REQUIRE(graph.getAdjacentNodes(4) == std::vector<NodeId>{1});
+        REQUIRE(graph.getIncidentEdges(4) == std::vector<size_t>{0});
+        REQUIRE(graph.getIncidentEdges(3).empty());
+        
+        graph.addEdge({2, 4});
+        REQUIRE(graph.getAdjacentNodes(4).size() == 2);
+        REQUIRE(graph.removeEdge(4, 1) == 1);
+        REQUIRE(graph.getEdges()[0] == Edge(2, 4));
+        REQUIRE(graph.getAdjacentNodes(1).empty());
+    }
+}
+
+TEST_CASE("DenseGraph - Conversion and adjacency", "[layout][types]") {
+    GraphF graph;
+    graph.addNode(NodeF(1, {10.0, 20.0}, {50.0, 30.0}));
+    graph.addNode(NodeF(2, {60.0, 70.0}, {40.0, 20.0}));
+    graph.addNode(NodeF(3));
+    graph.addEdge({1, 2});
+    graph.addEdge({1, 3});
+    graph.addEdge({3, 2});
+    graph.addEdge({1, 99}); // Unknown endpoint, dropped
+    
+    auto dense = DenseGraphF::fromGraph(graph);
+    REQUIRE(dense.size() == 3);
+    REQUIRE(dense.edgeCount() == 3);
+    
+    auto indexOf = [&](NodeId id) {
+        auto it = std::find(dense.ids.begin(), dense.ids.end(), id);
+        REQUIRE(it != dense.ids.end());
+        return static_cast<DenseGraphF::Index>(it - dense.ids.begin());
+    };
+    auto a = indexOf(1), b = indexOf(2), c = indexOf(3);
+    
+    SECTION("Positions and sizes") {
+        REQUIRE(dense.x[a] == 10.0);
+        REQUIRE(dense.y[a] == 20.0);
+        REQUIRE(dense.w[b] == 40.0);
+        REQUIRE(dense.h[b] == 20.0);
+    }
+    
+    SECTION("CSR rows keep edge order") {
+        std::vector<DenseGraphF::Index> out(dense.successors(a).begin(), dense.successors(a).end());
+        REQUIRE(out == std::vector<DenseGraphF::Index>{b, c});
+        REQUIRE(dense.successors(b).empty());
+        
+        std::vector<DenseGraphF::Index> in(dense.predecessors(b).begin(), dense.predecessors(b).end());
+        REQUIRE(in == std::vector<DenseGraphF::Index>{a, c});
+        REQUIRE(dense.predecessors(a).empty());
+    }
+    
+    SECTION("Positions are written back") {
+        dense.x[c] = 5.0;
+        dense.y[c] = 7.0;
+        dense.applyPositions(graph);
+        REQUIRE(graph.getNode(3)->position.x == 5.0);
+        REQUIRE(graph.getNode(3)->position.y == 7.0);
+        REQUIRE(graph.getNode(1)->position.x == 10.0);
+    }
+    
+    SECTION("Round trip through toGraph") {
+        GraphF copy = dense.toGraph();
+        REQUIRE(copy.nodeCount() == 3);
+        REQUIRE(copy.edgeCount() == 3);
+        REQUIRE(copy.getNode(2)->size.x == 40.0);
+        REQUIRE(copy.getNeighbors(1).size() == 2);
+    }
+}
+
+TEST_CASE("Layout kernels match the scalar reference", "[layout][kernels]") {
+    INFO("backend: " << kernels::backend());
+    
+    // Odd count so vector loops also run their scalar tail
+    const size_t count = 37;
+    std::vector<double> xs(count), ys(count), ws(count), hs(count);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = static_cast<double>((i * 37) % 200);
+        ys[i] = static_cast<double>((i * 53) % 200);
+        ws[i] = static_cast<double>(10 + (i * 7) % 30);
+        hs[i] = static_cast<double>(10 + (i * 11) % 30);
+    }
+    
+    SECTION("Repulsion") {
+        double fx = 0, fy = 0, expectedX = 0, expectedY = 0;
+        kernels::accumulateRepulsion(xs[5], ys[5], xs.data(), ys.data(), count, 50.0, 10000.0, fx, fy);
+        kernels::scalar::accumulateRepulsion(xs[5], ys[5], xs.data(), ys.data(), count, 50.0, 10000.0,
+                                             expectedX, expectedY);
+        REQUIRE(fx == Catch::Approx(expectedX).epsilon(1e-12));
+        REQUIRE(fy == Catch::Approx(expectedY).epsilon(1e-12));
+    }
+    
+    SECTION("Springs and displacement") {
+        std::vector<double> dx(count), dy(count);
+        for (size_t i = 0; i < count; ++i) {
+            dx[i] = xs[i] - 100.0;
+            dy[i] = ys[i] - 100.0;
+        }
+        dx[3] = dy[3] = 0.0; // No force, no movement
+        auto expectedDx = dx, expectedDy = dy;
+        kernels::springForces(dx.data(), dy.data(), count, 0.01);
+        kernels::scalar::springForces(expectedDx.data(), expectedDy.data(), count, 0.01);
+        for (size_t i = 0; i < count; ++i) {
+            REQUIRE(dx[i] == Catch::Approx(expectedDx[i]));
+            REQUIRE(dy[i] == Catch::Approx(expectedDy[i]));
+        }
+        
+        auto expectedX = xs, expectedY = ys;
+        double step = kernels::displace(xs.data(), ys.data(), dx.data(), dy.data(), count, 10.0);
+        double expectedStep = kernels::scalar::displace(expectedX.data(), expectedY.data(),
+                                                        dx.data(), dy.data(), count, 10.0);
+        REQUIRE(step == Catch::Approx(expectedStep));
+        for (size_t i = 0; i < count; ++i) {
+            REQUIRE(xs[i] == Catch::Approx(expectedX[i]));
+            REQUIRE(ys[i] == Catch::Approx(expectedY[i]));
+        }
+    }
+    
+    SECTION("Overlap count agrees with nodesOverlap") {
+        GraphF graph;
+        for (size_t i = 0; i < count; ++i) {
+            graph.addNode(NodeF(i, {xs[i], ys[i]}, {ws[i], hs[i]}));
+        }
+        size_t expected = 0;
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = i + 1; j < count; ++j) {
+                if (utils::nodesOverlap(*graph.getNode(i), *graph.getNode(j), 2.0)) {
+                    expected++;
+                }
+            }
+        }
+        REQUIRE(expected > 0);
+        REQUIRE(utils::countOverlaps(graph, 2.0) == expected);
+    }
 }
 
 TEST_CASE("GridLayout - Basic functionality", "[layout][grid]") {
@@ -287,6 +451,227 @@ TEST_CASE("ForceDirectedLayout - Basic functionality", "[layout][force]") {
         // Nodes should not overlap
         REQUIRE(utils::countOverlaps(graph) == 0);
     }
+    
+    SECTION("Overlapping nodes are separated") {
+        GraphF graph;
+        for (size_t i = 0; i < 6; ++i) {
+            graph.addNode(NodeF(i, {100.0 + 10.0 * i, 100.0}));
+        }
+        graph.addNode(NodeF(6, {900.0, 900.0}));
+        
+        ForceDirectedLayout<double> layout;
+        LayoutConfig config;
+        config.iterations = 0; // overlap removal only
+        
+        REQUIRE(layout.apply(graph, config).success);
+        REQUIRE(utils::countOverlaps(graph) == 0);
+        REQUIRE(graph.getNode(6)->position.x == 900.0);
+    }
+
+    SECTION("Progress callback and cancellation") {
+        auto graph = utils::createTestGraph(40, 0.1);
+        ForceDirectedLayout<double> layout;
+        LayoutConfig config;
+        config.iterations = 20;
+        config.convergenceThreshold = 0; // run every iteration
+        config.progressInterval = 5;
+
+        std::vector<size_t> reported;
+        PointF first_position;
+        layout.setProgressCallback([&](const GraphF& current, size_t iteration) {
+            if (reported.empty()) {
+                first_position = current.getNode(1)->position;
+            }
+            reported.push_back(iteration);
+            return true;
+        });
+        REQUIRE(layout.apply(graph, config).success);
+        REQUIRE(reported == std::vector<size_t>{5, 10, 15, 20});
+        REQUIRE(first_position.distanceTo(graph.getNode(1)->position) > 0.0);
+
+        layout.setProgressCallback([&](const GraphF&, size_t iteration) { return iteration < 10; });
+        auto result = layout.apply(graph, config);
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.errorMessage == "Layout cancelled");
+    }
+}
+
+TEST_CASE("ForceDirectedLayout - Barnes-Hut repulsion", "[layout][force]") {
+    std::srand(7);
+    const auto source = utils::createTestGraph(300, 0.01);
+    
+    SECTION("Approximation stays close to the exact forces") {
+        auto exact = source;
+        auto approximate = source;
+        LayoutConfig config;
+        config.barnesHutTheta = 0;
+        REQUIRE(ForceDirectedLayout<double>().apply(exact, config).success);
+        config.barnesHutTheta = 0.8;
+        auto result = ForceDirectedLayout<double>().apply(approximate, config);
+        REQUIRE(result.success);
+        
+        auto exactBounds = utils::calculateBoundingBox(exact);
+        auto approximateBounds = utils::calculateBoundingBox(approximate);
+        REQUIRE(approximateBounds.x == Catch::Approx(exactBounds.x).epsilon(0.15));
+        REQUIRE(approximateBounds.y == Catch::Approx(exactBounds.y).epsilon(0.15));
+    }
+    
+    SECTION("Large graphs") {
+        std::srand(11);
+        auto graph = utils::createTestGraph(3000, 4.0 / 3000);
+        ForceDirectedLayout<double> layout;
+        REQUIRE(layout.isOptimizedForLargeGraphs());
+        LayoutConfig config;
+        config.iterations = 20;
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        auto result = layout.apply(graph, config);
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - start);
+        REQUIRE(result.success);
+        REQUIRE(duration.count() < 5000);
+        for (const auto& pair : graph.getNodes()) {
+            REQUIRE(std::isfinite(pair.second.position.x));
+            REQUIRE(std::isfinite(pair.second.position.y));
+        }
+    }
+}
+
+TEST_CASE("Parallel layout matches single-threaded output", "[layout][parallel]") {
+    auto samePositions = [](const GraphF& a, const GraphF& b) {
+        for (const auto& pair : a.getNodes()) {
+            const auto* other = b.getNode(pair.first);
+            if (!other || other->position.x != pair.second.position.x ||
+                other->position.y != pair.second.position.y) {
+                return false;
+            }
+        }
+        return true;
+    };
+    
+    SECTION("Force-directed") {
+        std::srand(5);
+        const auto source = utils::createTestGraph(2000, 2.0 / 2000);
+        auto single = source;
+        auto parallel = source;
+        LayoutConfig config;
+        config.iterations = 10;
+        REQUIRE(ForceDirectedLayout<double>().apply(single, config).success);
+        config.threads = 4;
+        REQUIRE(ForceDirectedLayout<double>().apply(parallel, config).success);
+        REQUIRE(samePositions(single, parallel));
+    }
+    
+    SECTION("Hierarchical with wide layers") {
+        GraphF source;
+        const size_t width = 3000;
+        for (size_t i = 0; i < 3 * width; ++i) {
+            source.addNode(NodeF(i));
+        }
+        for (size_t i = 0; i < width; ++i) {
+            source.addEdge({i, width + (i * 7) % width});
+            source.addEdge({width + i, 2 * width + (i * 13) % width});
+        }
+        auto single = source;
+        auto parallel = source;
+        LayoutConfig config;
+        REQUIRE(HierarchicalLayout<double>().apply(single, config).success);
+        config.threads = 4;
+        REQUIRE(HierarchicalLayout<double>().apply(parallel, config).success);
+        REQUIRE(samePositions(single, parallel));
+    }
+}
+
+TEST_CASE("Incremental layout after edits", "[layout][incremental]") {
+    SECTION("Force-directed only moves the neighbourhood of the edit") {
+        // Two chains far apart; the edit touches the first one
+        GraphF graph;
+        for (size_t i = 0; i < 20; ++i) {
+            graph.addNode(NodeF(i, {100.0 * static_cast<double>(i % 10) + 10.0,
+                                    i < 10 ? 10.0 : 5000.0}));
+            if (i % 10 != 0) {
+                graph.addEdge({i - 1, i});
+            }
+        }
+        const GraphF before = graph;
+        
+        graph.addNode(NodeF(100)); // At the origin: placed next to its neighbour
+        graph.addEdge({0, 100});
+        
+        ForceDirectedLayout<double> layout;
+        auto result = layout.applyIncremental(graph, {100}, LayoutConfig{});
+        REQUIRE(result.success);
+        
+        auto added = graph.getNode(100);
+        REQUIRE(added->center().distanceTo(graph.getNode(0)->center()) < 500.0);
+        for (size_t i = 3; i < 20; ++i) {
+            REQUIRE(graph.getNode(i)->position.x == before.getNode(i)->position.x);
+            REQUIRE(graph.getNode(i)->position.y == before.getNode(i)->position.y);
+        }
+        
+        // Removing the node again relaxes its former neighbour only
+        auto neighbours = graph.getAdjacentNodes(100);
+        REQUIRE(graph.removeNode(100));
+        REQUIRE(layout.applyIncremental(graph, neighbours, LayoutConfig{}).success);
+        REQUIRE(graph.getNode(5)->position.x == before.getNode(5)->position.x);
+    }
+    
+    SECTION("Hierarchical keeps the order of untouched layers") {
+        GraphF graph;
+        graph.addNode(NodeF(1));
+        for (size_t i = 2; i <= 6; ++i) {
+            graph.addNode(NodeF(i));
+            graph.addEdge({1, i});
+        }
+        for (size_t i = 7; i <= 11; ++i) {
+            graph.addNode(NodeF(i));
+            graph.addEdge({i - 5, i});
+        }
+        HierarchicalLayout<double> layout;
+        REQUIRE(layout.apply(graph).success);
+        const GraphF before = graph;
+        
+        graph.addNode(NodeF(12));
+        graph.addEdge({11, 12});
+        REQUIRE(layout.applyIncremental(graph, {12}).success);
+        
+        REQUIRE(graph.getNode(12)->position.y > graph.getNode(11)->position.y);
+        for (size_t i = 1; i <= 6; ++i) {
+            REQUIRE(graph.getNode(i)->position.x == before.getNode(i)->position.x);
+            REQUIRE(graph.getNode(i)->position.y == before.getNode(i)->position.y);
+        }
+    }
+    
+    SECTION("Algorithms without an incremental mode fall back to a full layout") {
+        GraphF graph;
+        for (size_t i = 1; i <= 4; ++i) {
+            graph.addNode(NodeF(i));
+        }
+        GridLayout<double> layout;
+        REQUIRE(layout.applyIncremental(graph, {1}).success);
+        REQUIRE(utils::countOverlaps(graph) == 0);
+    }
+    
+    SECTION("Large graph edits stay interactive") {
+        std::srand(13);
+        auto graph = utils::createTestGraph(5000, 2.0 / 5000);
+        ForceDirectedLayout<double> layout;
+        LayoutConfig config;
+        config.iterations = 10;
+        REQUIRE(layout.apply(graph, config).success);
+        
+        config.iterations = 100;
+        auto start = std::chrono::high_resolution_clock::now();
+        graph.addNode(NodeF(5000));
+        graph.addEdge({17, 5000});
+        REQUIRE(layout.applyIncremental(graph, {5000}, config).success);
+        auto neighbours = graph.getAdjacentNodes(42);
+        graph.removeNode(42);
+        REQUIRE(layout.applyIncremental(graph, neighbours, config).success);
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - start);
+        REQUIRE(duration.count() < 1000);
+    }
 }
 
 TEST_CASE("HierarchicalLayout - Basic functionality", "[layout][hierarchical]") {
@@ -387,6 +772,61 @@ TEST_CASE("HierarchicalLayout - Basic functionality", "[layout][hierarchical]")
     }
 }
 
+TEST_CASE("SpatialGrid - Viewport queries", "[layout][spatial]") {
+    auto collect = [](const SpatialGrid<double>& grid, const Box<double>& view) {
+        std::vector<size_t> keys;
+        grid.query(view, [&](size_t key) { keys.push_back(key); });
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    };
+
+    SECTION("Matches a brute-force scan") {
+        auto graph = utils::createTestGraph(500, 0.0);
+        SpatialGrid<double> grid(64.0);
+        for (const auto& [id, node] : graph.getNodes()) {
+            grid.insert(id, Box<double>::of(node));
+        }
+        REQUIRE(grid.size() == 500);
+
+        // Small views, views straddling cell borders and one larger than the graph
+        std::vector<Box<double>> views = {
+            {0, 0, 50, 50}, {63, 63, 65, 65}, {100, 40, 260, 300}, {-1000, -1000, 5000, 5000}};
+        for (const auto& view : views) {
+            std::vector<size_t> expected;
+            for (const auto& [id, node] : graph.getNodes()) {
+                if (Box<double>::of(node).intersects(view)) {
+                    expected.push_back(id);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+            REQUIRE(collect(grid, view) == expected);
+        }
+    }
+
+    SECTION("Items spanning several cells are reported once") {
+        SpatialGrid<double> grid(10.0);
+        grid.insert(1, {-25, -25, 95, 5});
+        REQUIRE(collect(grid, {-100, -100, 100, 100}) == std::vector<size_t>{1});
+        REQUIRE(collect(grid, {40, 0, 41, 1}) == std::vector<size_t>{1});
+        REQUIRE(collect(grid, {40, 10, 41, 11}).empty());
+    }
+
+    SECTION("Moving and removing items") {
+        SpatialGrid<double> grid(32.0);
+        grid.insert(1, {0, 0, 10, 10});
+        grid.insert(2, {100, 100, 110, 110});
+
+        grid.insert(1, {200, 200, 210, 210});
+        REQUIRE(grid.size() == 2);
+        REQUIRE(collect(grid, {0, 0, 20, 20}).empty());
+        REQUIRE(collect(grid, {195, 195, 205, 205}) == std::vector<size_t>{1});
+
+        REQUIRE(grid.remove(2));
+        REQUIRE_FALSE(grid.remove(2));
+        REQUIRE(collect(grid, {0, 0, 500, 500}) == std::vector<size_t>{1});
+    }
+}
+
 TEST_CASE("Layout utility functions", "[layout][utils]") {
     SECTION("Bounding box calculation") {
         GraphF graph;
@@ -0,0 +1,110 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+using namespace FlowGraph;
+using FlowGraph::test::writeFile;
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::string moduleSource(const std::string& title, const std::string& nodes) {
+    return "TITLE: " + title + "\n\nNODES:\n" + nodes + "\n\nFLOW:\nSTART -> 10\n10 -> END\n";
+}
+
+bool contains(const std::vector<std::string>& list, const std::string& text) {
+    return std::any_of(list.begin(), list.end(), [&](const std::string& entry) {
+        return entry.find(text) != std::string::npos;
+    });
+}
+
+} // namespace
+
+TEST_CASE("FlowGraphEngine loads flow libraries", "[library][file]") {
+    fs::path dir = fs::temp_directory_path() / "flowgraph_library_test";
+    fs::remove_all(dir);
+    writeFile(dir / "main.flow", moduleSource("Main", "10 PROC auth/login.flow user>>name"));
+    writeFile(dir / "auth" / "login.flow", moduleSource("Login", "10 PROC ../utils/log.flow"));
+    writeFile(dir / "utils" / "log.flow", moduleSource("Log", "10 PROC print"));
+    writeFile(dir / "notes.txt", "not a flow");
+
+    FlowGraphEngine engine;
+
+    SECTION("Modules load in parallel and link") {
+        for (size_t threads : {size_t(1), size_t(4), size_t(0)}) {
+            FlowGraphEngine library;
+            auto result = library.loadDirectory(dir.string(), threads);
+            INFO(result.errors.size());
+            REQUIRE(result.success());
+            REQUIRE(result.modules == std::vector<std::string>{"auth/login.flow", "main.flow", "utils/log.flow"});
+            REQUIRE(library.getModule("auth/login.flow")->getTitle() == "Login");
+            REQUIRE_FALSE(library.getModule("notes.txt"));
+        }
+    }
+
+    SECTION("Precompiled modules provide the same module") {
+        FlowGraphEngine compiler;
+        compiler.saveCompiled(compiler.loadFlow((dir / "utils" / "log.flow").string()),
+                              (dir / "utils" / "log.flowc").string());
+        fs::remove(dir / "utils" / "log.flow");
+
+        auto result = engine.loadDirectory(dir.string());
+        REQUIRE(result.success());
+        REQUIRE(engine.getModule("utils/log.flow")->getTitle() == "Log");
+    }
+
+    SECTION("A precompiled module next to its source is used unless it is stale") {
+        fs::path source = dir / "utils" / "log.flow";
+        fs::path archive = dir / "utils" / "log.flowc";
+        FlowGraphEngine compiler;
+        compiler.saveCompiled(compiler.parseFlow(moduleSource("Compiled log", "10 PROC print"), "log.flow"),
+                              archive.string());
+        auto now = fs::file_time_type::clock::now();
+
+        fs::last_write_time(source, now - std::chrono::hours(1));
+        fs::last_write_time(archive, now);
+        FlowGraphEngine fresh;
+        auto result = fresh.loadDirectory(dir.string());
+        REQUIRE(result.success());
+        REQUIRE(fresh.getModule("utils/log.flow")->getTitle() == "Compiled log");
+
+        fs::last_write_time(source, now);
+        fs::last_write_time(archive, now - std::chrono::hours(1));
+        FlowGraphEngine stale;
+        result = stale.loadDirectory(dir.string());
+        REQUIRE(result.success());
+        REQUIRE(stale.getModule("utils/log.flow")->getTitle() == "Log");
+    }
+
+    SECTION("All errors are reported together") {
+        writeFile(dir / "broken.flow", "TITLE: Broken\nNODES:\n10 LOOP\n");
+        writeFile(dir / "dangling.flow", moduleSource("Dangling", "10 PROC missing.flow"));
+        writeFile(dir / "unknown.flow", moduleSource("Unknown", "10 PROC no_such_proc"));
+        writeFile(dir / "open.flow", "TITLE: Open\nNODES:\n10 ASSIGN N x 1\n");
+
+        auto result = engine.loadDirectory(dir.string(), 2);
+        REQUIRE_FALSE(result.success());
+        REQUIRE(result.errors.size() == 5); // open.flow lacks both START and END
+        REQUIRE(contains(result.errors, "broken.flow:3:4: Expected node type"));
+        REQUIRE(contains(result.errors, "dangling.flow: Module not found: missing.flow (node 10)"));
+        REQUIRE(contains(result.errors, "unknown.flow: Procedure not found: no_such_proc (node 10)"));
+        REQUIRE(contains(result.errors, "open.flow: Flow must have a START connection"));
+
+        // Modules that parsed are still registered
+        REQUIRE(result.modules.size() == 6);
+        REQUIRE_FALSE(engine.getModule("broken.flow"));
+        REQUIRE(engine.getModule("dangling.flow"));
+    }
+
+    SECTION("Missing directories are reported") {
+        auto result = engine.loadDirectory((dir / "missing").string());
+        REQUIRE(result.errors.size() == 1);
+        REQUIRE(result.modules.empty());
+    }
+
+    fs::remove_all(dir);
+}
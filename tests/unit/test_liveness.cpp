@@ -0,0 +1,229 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace FlowGraph;
+
+namespace {
+
+std::unique_ptr<FlowAST> parseAST(const std::string& source) {
+    Parser parser;
+    return parser.parse(source, "liveness.flow");
+}
+
+std::vector<std::string> liveAfter(const CompiledFlow& program, const std::string& nodeId) {
+    std::vector<std::string> names;
+    for (SlotIndex slot : program.liveAfter(program.node(*program.findNodeIndex(nodeId)))) {
+        names.push_back(program.slots().name(slot));
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+BindingRange inputsOf(const CompiledFlow& program, const std::string& nodeId) {
+    return program.inputBindings(program.node(*program.findNodeIndex(nodeId)));
+}
+
+// 10 reads report only; 20 reads name; 30 writes greeting, which is returned
+const char* const GreetFlow = R"(
+TITLE: Greet
+
+PARAMS:
+S name
+S report
+
+RETURNS:
+S greeting
+
+NODES:
+10 PROC upload report>>body
+20 PROC lookup name>>user title<<title
+30 ASSIGN S greeting title + " " + name
+
+FLOW:
+START -> 10
+10 -> 20
+20 -> 30
+30 -> END
+)";
+
+} // namespace
+
+TEST_CASE("Liveness analysis finds the variables live after PROC nodes", "[compiled][liveness]") {
+    SECTION("Straight line") {
+        CompiledFlow program(parseAST(GreetFlow));
+        // 20 might not return title, so an earlier value could still be read at 30
+        REQUIRE(liveAfter(program, "10") == std::vector<std::string>{"name", "title"});
+        REQUIRE(liveAfter(program, "20") == std::vector<std::string>{"name", "title"});
+        REQUIRE(inputsOf(program, "10").begin()->lastUse);
+        REQUIRE_FALSE(inputsOf(program, "20").begin()->lastUse);
+        REQUIRE(program.stats().lastUseInputs == 1);
+    }
+    
+    SECTION("Loops keep what the next iteration reads") {
+        CompiledFlow program(parseAST(R"(
+TITLE: Loop
+
+PARAMS:
+N count
+S label
+
+RETURNS:
+N total
+
+NODES:
+10 ASSIGN N total 0
+20 PROC work label>>text count>>n
+30 ASSIGN N count count - 1
+40 COND count > 0
+
+FLOW:
+START -> 10
+10 -> 20
+20 -> 30
+30 -> 40
+40.Y -> 20
+40.N -> END
+)"));
+        REQUIRE(liveAfter(program, "20") == std::vector<std::string>{"count", "label", "total"});
+        for (const auto& binding : inputsOf(program, "20")) {
+            REQUIRE_FALSE(binding.lastUse);
+        }
+    }
+    
+    SECTION("Error captures and dotted names keep their variables") {
+        CompiledFlow program(parseAST(R"(
+TITLE: Capture
+
+PARAMS:
+S key
+S fallback
+N player
+
+RETURNS:
+S value
+
+NODES:
+10 PROC fetch key>>key value<<value
+20 ASSIGN S value fallback
+30 COND player.health > 0
+
+FLOW:
+START -> 10
+10 -> 30
+10.MISSING -> 20
+20 -> END
+30.Y -> END
+30.N -> END
+)"));
+        REQUIRE(liveAfter(program, "10") == std::vector<std::string>{"fallback", "player", "value"});
+        REQUIRE(inputsOf(program, "10").begin()->lastUse);
+    }
+    
+    SECTION("A variable bound to two inputs is only moved into the last") {
+        CompiledFlow program(parseAST(R"(
+TITLE: Twice
+
+PARAMS:
+S text
+
+NODES:
+10 PROC compare text>>left text>>right
+
+FLOW:
+START -> 10
+10 -> END
+)"));
+        auto inputs = inputsOf(program, "10");
+        REQUIRE_FALSE(inputs.begin()[0].lastUse);
+        REQUIRE(inputs.begin()[1].lastUse);
+    }
+}
+
+TEST_CASE("Executions release variables that are no longer live", "[engine][liveness]") {
+    Engine engine;
+    ProcCompletionCallback* pending = nullptr;
+    std::string uploaded;
+    engine.registerProcedure("upload", [&](const ParameterMap& params, ProcCompletionCallback& callback) {
+        uploaded = params.at("body").asString();
+        callback(ProcResult::completedSuccess());
+    });
+    engine.registerProcedure("lookup", [&](const ParameterMap&, ProcCompletionCallback& callback) {
+        pending = &callback;
+    });
+    Parser parser;
+    Flow flow = engine.createFlow(parser.parse(GreetFlow, "greet.flow"));
+    
+    ParameterMap params;
+    params["name"] = createValue("Ada");
+    params["report"] = createValue(std::string(4096, 'x'));
+    auto completeLookup = [&]() {
+        ParameterMap values;
+        values["title"] = createValue("Dr.");
+        (*pending)(ProcResult::completedSuccess(values));
+    };
+    
+    SECTION("Suspended executions keep only their live variables") {
+        auto context = flow.acquireContext();
+        context->setReleaseDeadValues(true);
+        REQUIRE_FALSE(flow.start(*context, params));
+        REQUIRE(context->isWaitingForAsync());
+        REQUIRE(uploaded.size() == 4096);
+        REQUIRE_FALSE(context->hasVariable("report"));
+        REQUIRE(context->getVariable("name").asString() == "Ada");
+        
+        completeLookup();
+        auto result = flow.resume(*context);
+        REQUIRE(result);
+        REQUIRE(result->success);
+        REQUIRE(result->returnValues.at("greeting").asString() == "Dr. Ada");
+        flow.releaseContext(std::move(context));
+    }
+    
+    SECTION("Parked contexts do not hold values moved into PROC inputs") {
+        auto context = flow.acquireContext();
+        context->setReleaseDeadValues(true);
+        REQUIRE_FALSE(flow.start(*context, params));
+        const CompiledFlow& program = flow.getProgram();
+        auto procInputs = [&](const std::string& nodeId) -> const ParameterMap& {
+            return context->getProcInputs(program.node(*program.findNodeIndex(nodeId)).procIndex).params;
+        };
+        REQUIRE(uploaded.size() == 4096);
+        REQUIRE_FALSE(procInputs("10").at("body").isString());
+        // The suspended PROC keeps its parameters until it completes
+        REQUIRE(procInputs("20").at("user").asString() == "Ada");
+        
+        completeLookup();
+        REQUIRE(flow.resume(*context)->returnValues.at("greeting").asString() == "Dr. Ada");
+        flow.releaseContext(std::move(context));
+    }
+    
+    SECTION("Contexts that do not release dead values keep every variable") {
+        auto context = flow.acquireContext();
+        REQUIRE_FALSE(flow.start(*context, params));
+        REQUIRE(context->getVariable("report").asString().size() == 4096);
+        completeLookup();
+        REQUIRE(flow.resume(*context)->returnValues.at("greeting").asString() == "Dr. Ada");
+        REQUIRE(context->hasVariable("greeting"));
+        flow.releaseContext(std::move(context));
+    }
+    
+    SECTION("Scheduled executions give the same results") {
+        FlowScheduler scheduler;
+        std::string greeting;
+        scheduler.submit(flow, params, [&](FlowScheduler::TaskId, const ExecutionResult& result) {
+            greeting = result.returnValues.at("greeting").asString();
+        });
+        REQUIRE(uploaded.size() == 4096);
+        completeLookup();
+        REQUIRE(scheduler.poll() == 1);
+        REQUIRE(greeting == "Dr. Ada");
+        
+        // Pooled contexts come back with every variable kept
+        auto context = flow.acquireContext();
+        REQUIRE_FALSE(context->releasesDeadValues());
+        flow.releaseContext(std::move(context));
+    }
+}
@@ -0,0 +1,310 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <stdexcept>
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+// The monitoring example of FileFormat.md with both stats fetched in parallel
+const char* const StatsFlow = R"(
+TITLE: Stats
+
+RETURNS:
+N cpu_usage
+N mem_usage
+B is_healthy
+
+ERRORS:
+TIMEOUT
+DEGRADED
+
+NODES:
+5 PAR
+10 PROC get_cpu_stats cpu_usage<<usage
+20 PROC get_memory_stats mem_usage<<usage
+25 JOIN
+30 ASSIGN B is_healthy cpu_usage < 80 && mem_usage < 90
+40 ASSIGN B is_healthy false
+
+FLOW:
+START -> 5
+5 -> 10
+5 -> 20
+5.TIMEOUT -> 40
+10 -> 25
+20 -> 25
+25 -> 30
+30 -> END
+40 -> END
+)";
+
+ProcDefinition stat(double usage) {
+    ProcDefinition definition;
+    definition.implementation = [usage](const ParameterMap&, ProcCompletionCallback& callback) {
+        ParameterMap values;
+        values["usage"] = createValue(usage);
+        callback(ProcResult::completedSuccess(std::move(values)));
+    };
+    return definition;
+}
+
+// Keeps the callback of its last call pending
+ProcDefinition pending(ProcCompletionCallback*& slot) {
+    ProcDefinition definition;
+    definition.implementation = [&slot](const ParameterMap&, ProcCompletionCallback& callback) {
+        slot = &callback;
+    };
+    return definition;
+}
+
+ProcResult usage(double value) {
+    ParameterMap values;
+    values["usage"] = createValue(value);
+    return ProcResult::completedSuccess(std::move(values));
+}
+
+} // namespace
+
+TEST_CASE("PAR and JOIN nodes are parsed and compiled", "[parallel][parser]") {
+    Parser parser;
+    auto ast = parser.parse(StatsFlow, "stats.flow");
+    REQUIRE(ast->findNode("5")->kind == NodeKind::Par);
+    REQUIRE(ast->findNode("25")->kind == NodeKind::Join);
+
+    SECTION("Default connections of a PAR are its branches") {
+        CompiledFlow program(std::move(ast));
+        REQUIRE(program.diagnostics().empty());
+        const CompiledNode& par = program.node(*program.findNodeIndex("5"));
+        REQUIRE(program.branches(par).size() == 2);
+        REQUIRE(program.branches(par).begin()[0].index == *program.findNodeIndex("10"));
+        REQUIRE(program.branches(par).begin()[1].index == *program.findNodeIndex("20"));
+        REQUIRE(program.stats().deadNodes == 0);
+    }
+
+    SECTION("The node kinds survive a .flowc round trip") {
+        auto loaded = FlowArchive::deserialize(FlowArchive::serialize(*ast));
+        REQUIRE(loaded->findNode("5")->kind == NodeKind::Par);
+        REQUIRE(loaded->findNode("25")->kind == NodeKind::Join);
+    }
+
+    SECTION("A PAR without branches is reported") {
+        auto empty = parser.parse("TITLE: T\nNODES:\n5 PAR\nFLOW:\nSTART -> 5\n5.TIMEOUT -> END\n", "empty.flow");
+        CompiledFlow program(std::move(empty));
+        REQUIRE(program.diagnostics() == std::vector<std::string>{"PAR node 5 has no branches"});
+    }
+}
+
+TEST_CASE("Branches of a PAR run concurrently and join", "[parallel][async]") {
+    Engine engine;
+
+    SECTION("Synchronous branches merge their writes") {
+        engine.registerProcedure("get_cpu_stats", stat(40));
+        engine.registerProcedure("get_memory_stats", stat(95));
+        auto result = parse(engine, StatsFlow).execute();
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("cpu_usage").asNumber() == 40);
+        REQUIRE(result.returnValues.at("mem_usage").asNumber() == 95);
+        REQUIRE(result.returnValues.at("is_healthy").asBoolean() == false);
+    }
+
+    SECTION("Async PROCs of all branches are in flight together") {
+        ProcCompletionCallback* cpu = nullptr;
+        ProcCompletionCallback* memory = nullptr;
+        engine.registerProcedure("get_cpu_stats", pending(cpu));
+        engine.registerProcedure("get_memory_stats", pending(memory));
+        auto flow = parse(engine, StatsFlow);
+
+        FlowScheduler scheduler;
+        std::optional<ExecutionResult> result;
+        scheduler.submit(flow, {}, [&result](FlowScheduler::TaskId, const ExecutionResult& finished) {
+            result = finished;
+        });
+        REQUIRE(cpu);
+        REQUIRE(memory);
+
+        (*memory)(usage(30));
+        REQUIRE(scheduler.poll() == 0);
+        REQUIRE(scheduler.inFlight() == 1);
+        (*cpu)(usage(20));
+        REQUIRE(scheduler.poll() == 1);
+        REQUIRE(result->success);
+        REQUIRE(result->returnValues.at("cpu_usage").asNumber() == 20);
+        REQUIRE(result->returnValues.at("mem_usage").asNumber() == 30);
+        REQUIRE(result->returnValues.at("is_healthy").asBoolean());
+    }
+
+    SECTION("A branch suspends again after its first PROC completed") {
+        ProcCompletionCallback* cpu = nullptr;
+        ProcCompletionCallback* memory = nullptr;
+        engine.registerProcedure("get_cpu_stats", pending(cpu));
+        engine.registerProcedure("get_memory_stats", pending(memory));
+        ProcCompletionCallback* load = nullptr;
+        engine.registerProcedure("get_load", pending(load));
+        auto flow = parse(engine, R"(
+TITLE: Load
+RETURNS:
+N cpu_usage
+N load
+NODES:
+5 PAR
+10 PROC get_cpu_stats cpu_usage<<usage
+15 PROC get_load load<<usage
+20 PROC get_memory_stats mem_usage<<usage
+25 JOIN
+FLOW:
+START -> 5
+5 -> 10
+5 -> 20
+10 -> 15
+15 -> 25
+20 -> 25
+25 -> END
+)");
+        FlowScheduler scheduler;
+        std::optional<ExecutionResult> result;
+        scheduler.submit(flow, {}, [&result](FlowScheduler::TaskId, const ExecutionResult& finished) {
+            result = finished;
+        });
+        (*cpu)(usage(1));
+        REQUIRE(scheduler.poll() == 0);
+        REQUIRE(load);
+        (*memory)(usage(2));
+        REQUIRE(scheduler.poll() == 0);
+        (*load)(usage(3));
+        REQUIRE(scheduler.poll() == 1);
+        REQUIRE(result->success);
+        REQUIRE(result->returnValues.at("cpu_usage").asNumber() == 1);
+        REQUIRE(result->returnValues.at("load").asNumber() == 3);
+    }
+
+    SECTION("Branches writing different values to a variable fail the flow") {
+        engine.registerProcedure("get_cpu_stats", stat(40));
+        engine.registerProcedure("get_memory_stats", stat(95));
+        auto flow = parse(engine, R"(
+TITLE: Conflict
+RETURNS:
+N usage
+NODES:
+5 PAR
+10 PROC get_cpu_stats usage<<usage
+20 PROC get_memory_stats usage<<usage
+25 JOIN
+FLOW:
+START -> 5
+5 -> 10
+5 -> 20
+10 -> 25
+20 -> 25
+25 -> END
+)");
+        auto result = flow.execute();
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "Execution error: Branches of PAR 5 write different values to usage");
+
+        engine.registerProcedure("get_memory_stats", stat(40));
+        result = parse(engine, R"(
+TITLE: Same
+RETURNS:
+N usage
+NODES:
+5 PAR
+10 PROC get_cpu_stats usage<<usage
+20 PROC get_memory_stats usage<<usage
+25 JOIN
+FLOW:
+START -> 5
+5 -> 10
+5 -> 20
+10 -> 25
+20 -> 25
+25 -> END
+)").execute();
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("usage").asNumber() == 40);
+    }
+
+    SECTION("Errors emitted by a branch are caught on the PAR node") {
+        engine.registerProcedure("get_cpu_stats", stat(40));
+        engine.registerProcedure("get_memory_stats", [](const ParameterMap&, ProcCompletionCallback& callback) {
+            callback(ProcResult::completedError("TIMEOUT"));
+        });
+        const std::string source = StatsFlow;
+        std::string caught = source;
+        caught.replace(caught.find("20 -> 25"), 8, "20 -> 25\n20.TIMEOUT -> TIMEOUT");
+        auto result = parse(engine, caught).execute();
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("is_healthy").asBoolean() == false);
+        REQUIRE(result.returnValues.count("cpu_usage") == 0); // writes of failed PARs are dropped
+
+        std::string uncaught = source;
+        uncaught.replace(uncaught.find("20 -> 25"), 8, "20 -> 25\n20.TIMEOUT -> DEGRADED");
+        result = parse(engine, uncaught).execute();
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "DEGRADED");
+    }
+
+    SECTION("A failing branch fails the PAR once the others have settled") {
+        ProcCompletionCallback* cpu = nullptr;
+        engine.registerProcedure("get_cpu_stats", pending(cpu));
+        engine.registerProcedure("get_memory_stats", [](const ParameterMap&, ProcCompletionCallback&) {
+            throw std::runtime_error("no memory stats");
+        });
+        FlowScheduler scheduler;
+        std::optional<ExecutionResult> result;
+        scheduler.submit(parse(engine, StatsFlow), {}, [&result](FlowScheduler::TaskId, const ExecutionResult& finished) {
+            result = finished;
+        });
+        REQUIRE_FALSE(result);
+        (*cpu)(usage(20));
+        REQUIRE(scheduler.poll() == 1);
+        REQUIRE(result->error == "Execution error: PROC execution failed: no memory stats");
+    }
+
+    SECTION("Branches that end without a JOIN fail the PAR") {
+        engine.registerProcedure("get_cpu_stats", stat(40));
+        engine.registerProcedure("get_memory_stats", stat(95));
+        std::string source = StatsFlow;
+        source.replace(source.find("20 -> 25"), 8, "20 -> END");
+        auto result = parse(engine, source).execute();
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "Execution error: Branch of PAR 5 ended before reaching a JOIN");
+    }
+
+    SECTION("PARs nest inside branches") {
+        engine.registerProcedure("get_cpu_stats", stat(10));
+        engine.registerProcedure("get_memory_stats", stat(20));
+        auto result = parse(engine, R"(
+TITLE: Nested
+RETURNS:
+N total
+NODES:
+5 PAR
+6 PAR
+10 PROC get_cpu_stats a<<usage
+11 PROC get_memory_stats b<<usage
+15 JOIN
+16 ASSIGN N c a + b
+20 ASSIGN N d 1
+25 JOIN
+30 ASSIGN N total c + d
+FLOW:
+START -> 5
+5 -> 6
+5 -> 20
+6 -> 10
+6 -> 11
+10 -> 15
+11 -> 15
+15 -> 16
+16 -> 25
+20 -> 25
+25 -> 30
+30 -> END
+)").execute();
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("total").asNumber() == 31);
+    }
+}
@@ -1,5 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include "flowgraph/detail/Parser.hpp"
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 
 using namespace FlowGraph;
@@ -199,4 +201,236 @@ START -> 10
         std::cout << "  - All error checks passed" << std::endl;
         std::cout << "  - Ready for error flow execution (when engine is implemented)" << std::endl;
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Lexer produces views with single-token lookahead", "[parser][lexer]") {
+    const std::string source = "10.Y -> 20 // done\nname>>\"quoted text\" 3.5";
+    Lexer lexer(source, "lexer.flow");
+
+    auto inSource = [&](const Token& token) {
+        return token.text.data() >= source.data() && token.text.data() + token.text.size() <= source.data() + source.size();
+    };
+
+    SECTION("Tokens point into the source buffer") {
+        std::vector<Token> tokens;
+        do {
+            tokens.push_back(lexer.nextToken());
+        } while (tokens.back().type != TokenType::EOF_Token);
+        REQUIRE(tokens.size() == 12);
+        REQUIRE(tokens[0].type == TokenType::Number);
+        REQUIRE(tokens[0].text == "10");
+        REQUIRE(tokens[1].type == TokenType::Dot);
+        REQUIRE(tokens[2].text == "Y");
+        REQUIRE(tokens[3].type == TokenType::Arrow);
+        REQUIRE(tokens[5].type == TokenType::LineComment);
+        REQUIRE(tokens[6].type == TokenType::Newline);
+        REQUIRE(tokens[8].type == TokenType::InputBinding);
+        REQUIRE(tokens[9].type == TokenType::String);
+        REQUIRE(tokens[9].text == "quoted text");
+        REQUIRE(tokens[10].text == "3.5");
+        REQUIRE(tokens[11].type == TokenType::EOF_Token);
+        for (const auto& token : tokens) {
+            REQUIRE(inSource(token));
+        }
+        REQUIRE(tokens[7].line == 2);
+        REQUIRE(tokens[7].column == 1);
+        REQUIRE(tokens[9].column == 7);
+    }
+
+    SECTION("peekToken does not consume") {
+        const Token& peeked = lexer.peekToken();
+        REQUIRE(peeked.text == "10");
+        REQUIRE(lexer.peekToken().text.data() == peeked.text.data());
+        REQUIRE(lexer.nextToken().text == "10");
+        REQUIRE(lexer.peekToken().type == TokenType::Dot);
+    }
+
+    SECTION("Raw line slices stop at trailing comments") {
+        Token first = lexer.nextToken();
+        REQUIRE(lexer.readRestOfLine(first) == "10.Y -> 20");
+        REQUIRE(lexer.nextToken().type == TokenType::LineComment);
+        REQUIRE(lexer.nextToken().type == TokenType::Newline);
+    }
+
+    SECTION("Long runs of unknown characters do not recurse") {
+        std::string noise(200000, '$');
+        Lexer noisy(noise);
+        size_t invalid = 0;
+        while (noisy.hasMoreTokens()) {
+            invalid += noisy.nextToken().type == TokenType::Invalid;
+        }
+        REQUIRE(invalid == noise.size());
+    }
+}
+
+TEST_CASE("Parser builds the full AST", "[parser]") {
+    std::string content = R"(
+/*
+ * Login flow
+ */
+TITLE: User Login (v2)
+
+PARAMS:    // trailing comments are not attached
+// account name
+S username
+S password
+N attempts ?
+
+RETURNS:
+B success
+S token
+
+ERRORS:
+// no such account
+USER_NOT_FOUND
+
+NODES:
+// look the user up
+10 PROC auth/check_user.flow username>>login exists<<found
+20 COND found && attempts < 3 // inline comment
+30 ASSIGN S token "tok-" + username
+40 PROC log msg>>"Login // ok"
+50 ASSIGN B success true
+
+FLOW:
+START -> 10
+10 -> 20
+10.USER_NOT_FOUND -> END
+20.Y -> 30
+20.N -> USER_NOT_FOUND
+30 -> 40
+40 -> 50
+50 -> END
+)";
+
+    Parser parser;
+    auto ast = parser.parse(content, "login.flow");
+
+    SECTION("Header sections") {
+        REQUIRE(ast->title == "User Login (v2)");
+        REQUIRE(ast->comment == "Login flow");
+
+        REQUIRE(ast->parameters.size() == 3);
+        REQUIRE(ast->parameters[0].name == "username");
+        REQUIRE(ast->parameters[0].type.type == ValueType::String);
+        REQUIRE(ast->parameters[0].comment == "account name");
+        REQUIRE(ast->parameters[1].comment.empty());
+        REQUIRE(ast->parameters[2].type.type == ValueType::Number);
+        REQUIRE(ast->parameters[2].type.optional);
+
+        REQUIRE(ast->returnValues.size() == 2);
+        REQUIRE(ast->returnValues[0].type.type == ValueType::Boolean);
+        REQUIRE(ast->returnValues[1].name == "token");
+
+        REQUIRE(ast->errors.size() == 1);
+        REQUIRE(ast->errors[0].comment == "no such account");
+    }
+
+    SECTION("Nodes") {
+        REQUIRE(ast->nodes.size() == 5);
+
+        auto* check = static_cast<ProcNode*>(ast->findNode("10"));
+        REQUIRE(check->kind == NodeKind::Proc);
+        REQUIRE(check->procedureName == "auth/check_user.flow");
+        REQUIRE(check->comment == "look the user up");
+        REQUIRE(check->location.line == 23);
+        REQUIRE(check->location.filename == "login.flow");
+        REQUIRE(check->bindings.size() == 2);
+        REQUIRE(check->bindings[0].localVar == "username");
+        REQUIRE(check->bindings[0].procParam == "login");
+        REQUIRE_FALSE(check->bindings[0].isOutput);
+        REQUIRE(check->bindings[1].localVar == "exists");
+        REQUIRE(check->bindings[1].procParam == "found");
+        REQUIRE(check->bindings[1].isOutput);
+
+        auto* cond = static_cast<CondNode*>(ast->findNode("20"));
+        REQUIRE(cond->condition == "found && attempts < 3");
+
+        auto* assign = static_cast<AssignNode*>(ast->findNode("30"));
+        REQUIRE(assign->targetType.type == ValueType::String);
+        REQUIRE(assign->variableName == "token");
+        REQUIRE(assign->expression == "\"tok-\" + username");
+
+        auto* log = static_cast<ProcNode*>(ast->findNode("40"));
+        REQUIRE(log->bindings[0].procParam == "Login // ok");
+    }
+
+    SECTION("Connections") {
+        REQUIRE(ast->connections.size() == 8);
+        REQUIRE(ast->connections[0].fromNode == "START");
+        REQUIRE(ast->connections[0].toNode == "10");
+        REQUIRE(ast->connections[2].fromNode == "10");
+        REQUIRE(ast->connections[2].fromPort == "USER_NOT_FOUND");
+        REQUIRE(ast->connections[2].toNode == "END");
+        REQUIRE(ast->connections[3].fromPort == "Y");
+        REQUIRE(ast->connections[4].toNode == "USER_NOT_FOUND");
+        REQUIRE(ast->validate().empty());
+    }
+}
+
+TEST_CASE("Parser reports syntax errors with locations", "[parser][errors]") {
+    Parser parser;
+
+    auto parseError = [&](const std::string& content) -> FlowGraphError {
+        try {
+            parser.parse(content, "bad.flow");
+        } catch (const FlowGraphError& e) {
+            return e;
+        }
+        FAIL("Expected a parse error");
+        return FlowGraphError(FlowGraphError::Type::Runtime, "");
+    };
+
+    SECTION("Unknown node type") {
+        auto e = parseError("TITLE: x\nNODES:\n10 LOOP forever\n");
+        REQUIRE(e.type() == FlowGraphError::Type::Parse);
+        REQUIRE(e.location()->filename == "bad.flow");
+        REQUIRE(e.location()->line == 3);
+        REQUIRE(e.location()->column == 4);
+    }
+
+    SECTION("Invalid type") {
+        auto e = parseError("PARAMS:\nX value\n");
+        REQUIRE(e.message() == "Invalid type: X");
+    }
+
+    SECTION("Missing arrow") {
+        auto e = parseError("FLOW:\nSTART 10\n");
+        REQUIRE(e.location()->line == 2);
+    }
+
+    SECTION("Unterminated string") {
+        auto e = parseError("NODES:\n10 PROC log msg>>\"open\n");
+        REQUIRE(e.message() == "Unterminated string literal");
+    }
+}
+
+TEST_CASE("Parser reads files", "[parser][file]") {
+    auto path = std::filesystem::temp_directory_path() / "flowgraph_parser_test.flow";
+    {
+        std::ofstream out(path);
+        out << "TITLE: From Disk\n\nNODES:\n10 ASSIGN N x 1\n\nFLOW:\nSTART -> 10\n10 -> END\n";
+    }
+
+    SECTION("Mapped source") {
+        SourceFile file = SourceFile::open(path.string());
+        REQUIRE(file.size() > 0);
+        SourceFile moved = std::move(file);
+        REQUIRE(moved.view().substr(0, 5) == "TITLE");
+    }
+
+    SECTION("parseFile") {
+        Parser parser;
+        auto ast = parser.parseFile(path.string());
+        REQUIRE(ast->title == "From Disk");
+        REQUIRE(ast->nodes.size() == 1);
+        REQUIRE(ast->connections.size() == 2);
+        REQUIRE(ast->location.filename == path.string());
+    }
+
+    SECTION("Missing file") {
+        Parser parser;
+        REQUIRE_THROWS_AS(parser.parseFile(path.string() + ".missing"), FlowGraphError);
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,182 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <chrono>
+#include <thread>
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+// Looks up key, then fails with MISSING if the PROC reports it
+const char* const LookupFlow = R"(
+TITLE: Lookup
+
+PARAMS:
+S key
+
+RETURNS:
+N value
+
+ERRORS:
+MISSING
+
+NODES:
+10 PROC config key>>name value<<value
+
+FLOW:
+START -> 10
+10 -> END
+10.MISSING -> MISSING
+)";
+
+ProcDefinition configProc(int& calls) {
+    ProcDefinition definition;
+    definition.title = "config";
+    definition.pure = true;
+    definition.implementation = [&calls](const ParameterMap& params, ProcCompletionCallback& callback) {
+        ++calls;
+        const std::string& name = params.at("name").asString();
+        if (name == "missing") {
+            callback(ProcResult::completedError("MISSING"));
+            return;
+        }
+        ParameterMap values;
+        values["value"] = createValue(static_cast<double>(name.size()));
+        callback(ProcResult::completedSuccess(std::move(values)));
+    };
+    return definition;
+}
+
+ExecutionResult lookup(const Flow& flow, const std::string& key) {
+    ParameterMap params;
+    params["key"] = createValue(key);
+    return flow.execute(params);
+}
+
+} // namespace
+
+TEST_CASE("ProcResultCache", "[proc][cache]") {
+    Value one = createValue(1.0), two = createValue(2.0), text = createValue("1"), yes = createValue(true);
+    std::vector<Value*> a{&one}, b{&two}, c{&text}, d{&yes};
+    ParameterMap values;
+    values["r"] = createValue(10.0);
+
+    SECTION("Keys depend on type and value") {
+        REQUIRE(ProcResultCache::hash(a) != ProcResultCache::hash(b));
+        REQUIRE(ProcResultCache::hash(a) != ProcResultCache::hash(c));
+        REQUIRE(ProcResultCache::hash(a) != ProcResultCache::hash(d));
+        Value zero = createValue(0.0), negativeZero = createValue(-0.0);
+        REQUIRE(ProcResultCache::hash({&zero}) == ProcResultCache::hash({&negativeZero}));
+    }
+
+    SECTION("Entries are found by key and checked against the inputs") {
+        ProcResultCache cache(8);
+        cache.insert(ProcResultCache::hash(a), a, values);
+        auto hit = cache.find(ProcResultCache::hash(a), a);
+        REQUIRE(hit);
+        REQUIRE(hit->at("r").asNumber() == 10);
+        REQUIRE_FALSE(cache.find(ProcResultCache::hash(a), b)); // colliding key, other inputs
+        REQUIRE_FALSE(cache.find(ProcResultCache::hash(b), b));
+        REQUIRE(cache.hits() == 1);
+        REQUIRE(cache.misses() == 2);
+    }
+
+    SECTION("The least recently used entry is evicted") {
+        ProcResultCache cache(2, std::chrono::milliseconds(0), 1);
+        cache.insert(1, a, values);
+        cache.insert(2, b, values);
+        REQUIRE(cache.find(1, a));
+        cache.insert(3, c, values);
+        REQUIRE(cache.size() == 2);
+        REQUIRE(cache.find(1, a));
+        REQUIRE_FALSE(cache.find(2, b));
+        REQUIRE(cache.find(3, c));
+    }
+
+    SECTION("Entries expire after their TTL") {
+        ProcResultCache cache(8, std::chrono::milliseconds(20));
+        cache.insert(1, a, values);
+        REQUIRE(cache.find(1, a));
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        REQUIRE_FALSE(cache.find(1, a));
+        REQUIRE(cache.size() == 0);
+    }
+}
+
+TEST_CASE("Pure PROCs are answered from the result cache", "[proc][cache]") {
+    Engine engine;
+    int calls = 0;
+    engine.registerProcedure("config", configProc(calls));
+    auto flow = parse(engine, LookupFlow);
+
+    SECTION("Repeated inputs skip the implementation") {
+        for (int i = 0; i < 10; ++i) {
+            auto result = lookup(flow, "timeout");
+            REQUIRE(result.success);
+            REQUIRE(result.returnValues.at("value").asNumber() == 7);
+        }
+        REQUIRE(calls == 1);
+        REQUIRE(lookup(flow, "port").returnValues.at("value").asNumber() == 4);
+        REQUIRE(calls == 2);
+        REQUIRE(engine.getProcedureCache("config")->size() == 2);
+        REQUIRE(engine.getProcedureCache("config")->hits() == 9);
+    }
+
+    SECTION("Errors are not cached") {
+        REQUIRE_FALSE(lookup(flow, "missing").success);
+        REQUIRE_FALSE(lookup(flow, "missing").success);
+        REQUIRE(calls == 2);
+    }
+
+    SECTION("Procedures that are not pure are always called") {
+        ProcDefinition definition = configProc(calls);
+        definition.pure = false;
+        engine.registerProcedure("config", definition);
+        auto uncached = parse(engine, LookupFlow);
+        lookup(uncached, "timeout");
+        lookup(uncached, "timeout");
+        REQUIRE(calls == 2);
+        REQUIRE(engine.getProcedureCache("config") == nullptr);
+    }
+
+    SECTION("Async results are cached when they complete") {
+        ProcCompletionCallback* pending = nullptr;
+        ProcDefinition definition;
+        definition.pure = true;
+        definition.implementation = [&](const ParameterMap&, ProcCompletionCallback& callback) {
+            ++calls;
+            pending = &callback;
+        };
+        engine.registerProcedure("config", definition);
+        auto async = parse(engine, LookupFlow);
+
+        FlowScheduler scheduler;
+        ParameterMap params;
+        params["key"] = createValue("timeout");
+        scheduler.submit(async, params);
+        ParameterMap values;
+        values["value"] = createValue(3.0);
+        (*pending)(ProcResult::completedSuccess(values));
+        REQUIRE(scheduler.poll() == 1);
+
+        auto result = lookup(async, "timeout"); // synchronous: only possible from the cache
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("value").asNumber() == 3);
+        REQUIRE(calls == 1);
+    }
+
+    SECTION("Hits and misses are profiled") {
+        auto profiler = std::make_shared<Profiler>();
+        engine.setProfiler(profiler);
+        for (const char* key : {"a", "b", "a", "a"}) {
+            REQUIRE(lookup(flow, key).success);
+        }
+        ProfileStats stats = profiler->snapshot();
+        REQUIRE(stats.procedures.size() == 1);
+        REQUIRE(stats.procedures[0].calls == 4);
+        REQUIRE(stats.procedures[0].cacheHits == 2);
+        REQUIRE(stats.procedures[0].cacheMisses == 2);
+    }
+}
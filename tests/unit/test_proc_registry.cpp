@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+const char* const ScaleFlow = R"(
+TITLE: Scale
+
+PARAMS:
+N x
+
+RETURNS:
+N y
+
+NODES:
+10 PROC scale x>>value y<<result
+
+FLOW:
+START -> 10
+10 -> END
+)";
+
+LegacyExternalProcedure scaleBy(double factor) {
+    return [factor](const ParameterMap& params) {
+        ParameterMap values;
+        values["result"] = createValue(params.at("value").asNumber() * factor);
+        return values;
+    };
+}
+
+ParameterMap input(double x) {
+    ParameterMap params;
+    params["x"] = createValue(x);
+    return params;
+}
+
+} // namespace
+
+TEST_CASE("Procedures registered after a flow was loaded are called", "[proc][registry]") {
+    Engine engine;
+    engine.setStrictProcedures(false);
+    auto flow = parse(engine, ScaleFlow);
+    
+    REQUIRE_FALSE(engine.hasProcedure("scale"));
+    auto names = engine.getRegisteredProcedures();
+    REQUIRE(std::find(names.begin(), names.end(), "scale") == names.end());
+    REQUIRE_FALSE(flow.execute(input(2)).success);
+    REQUIRE_FALSE(flow.validate().empty());
+    
+    engine.registerLegacyProcedure("scale", scaleBy(3));
+    REQUIRE(engine.hasProcedure("scale"));
+    REQUIRE(flow.validate().empty());
+    auto result = flow.execute(input(2));
+    REQUIRE(result.success);
+    REQUIRE(result.returnValues.at("y").asNumber() == 6.0);
+    
+    SECTION("Re-registration replaces the procedure for loaded flows") {
+        engine.registerLegacyProcedure("scale", scaleBy(10));
+        REQUIRE(flow.execute(input(2)).returnValues.at("y").asNumber() == 20.0);
+    }
+    
+    SECTION("Definitions of replaced procedures stay valid") {
+        const ProcDefinition& before = engine.getProcedureDefinition("scale");
+        engine.registerLegacyProcedure("scale", scaleBy(10));
+        REQUIRE(before.title == "scale");
+        REQUIRE(&engine.getProcedureDefinition("scale") != &before);
+    }
+}
+
+TEST_CASE("Procedures can be registered while flows execute on other threads", "[proc][registry][threads]") {
+    Engine engine;
+    engine.registerLegacyProcedure("scale", scaleBy(1));
+    auto flow = parse(engine, ScaleFlow);
+    
+    constexpr int Threads = 4;
+    constexpr int Executions = 2000;
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < Threads; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < Executions; ++i) {
+                auto result = flow.execute(input(i));
+                // Either factor is fine; a torn or missing procedure is not
+                double y = result.success ? result.returnValues.at("y").asNumber() : -1;
+                if (y != i && y != 2.0 * i) {
+                    ++failures;
+                }
+            }
+        });
+    }
+    
+    // Plugins register procedures while the flow runs: new names and replacements
+    int registered = 0;
+    std::thread plugin([&]() {
+        for (; registered < 200; ++registered) {
+            engine.registerLegacyProcedure("scale", scaleBy(registered % 2 ? 2 : 1));
+            engine.registerLegacyProcedure("plugin_" + std::to_string(registered), scaleBy(0));
+        }
+        done = true;
+    });
+    
+    plugin.join();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    REQUIRE(done);
+    REQUIRE(failures == 0);
+    REQUIRE(engine.hasProcedure("plugin_199"));
+    REQUIRE(engine.getRegisteredProcedures().size() == 203); // print, log, scale and the plugins
+}
@@ -0,0 +1,197 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <sstream>
+#include <thread>
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+const char* const CounterFlow = R"(
+TITLE: Counter
+
+PARAMS:
+N limit
+
+RETURNS:
+N count
+
+NODES:
+10 ASSIGN N count 0
+20 COND count < limit
+30 ASSIGN N count count + 1
+40 PROC tick
+
+FLOW:
+START -> 10
+10 -> 20
+20.Y -> 30
+20.N -> END
+30 -> 40
+40 -> 20
+)";
+
+const ProfileStats::Node* findNode(const ProfileStats& stats, const std::string& id) {
+    for (const auto& node : stats.nodes) {
+        if (node.node == id) {
+            return &node;
+        }
+    }
+    return nullptr;
+}
+
+const ProfileStats::Procedure* findProcedure(const ProfileStats& stats, const std::string& name) {
+    for (const auto& procedure : stats.procedures) {
+        if (procedure.name == name) {
+            return &procedure;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("Profiler counts node visits and PROC calls", "[profiler]") {
+    Engine engine;
+    engine.registerProcedure("tick", [](const ParameterMap&, ProcCompletionCallback& callback) {
+        callback(ProcResult::completedSuccess());
+    });
+    auto flow = parse(engine, CounterFlow);
+    ParameterMap params;
+    params["limit"] = createValue(5.0);
+
+    SECTION("Unprofiled executions record nothing") {
+        auto profiler = std::make_shared<Profiler>();
+        REQUIRE(flow.execute(params).success);
+        REQUIRE(profiler->snapshot().nodes.empty());
+        REQUIRE(engine.getProfiler() == nullptr);
+    }
+
+    SECTION("Every node visit is counted") {
+        auto profiler = std::make_shared<Profiler>();
+        engine.setProfiler(profiler);
+        auto result = flow.execute(params);
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("count").asNumber() == 5);
+
+        ProfileStats stats = profiler->snapshot();
+        REQUIRE(stats.nodes.size() == 4);
+        REQUIRE(findNode(stats, "10")->visits == 1);
+        REQUIRE(findNode(stats, "20")->visits == 6);
+        REQUIRE(findNode(stats, "30")->visits == 5);
+        REQUIRE(findNode(stats, "40")->kind == NodeKind::Proc);
+        REQUIRE(findNode(stats, "40")->flow == "Counter");
+
+        const auto* tick = findProcedure(stats, "tick");
+        REQUIRE(tick);
+        REQUIRE(tick->calls == 5);
+        REQUIRE(tick->asyncCalls == 0);
+        REQUIRE(stats.traceEvents == 0); // tracing is off by default
+
+        engine.setProfiler(nullptr);
+        REQUIRE(flow.execute(params).success);
+        REQUIRE(findNode(profiler->snapshot(), "10")->visits == 1);
+    }
+
+    SECTION("A flow profiler overrides the engine's") {
+        auto engineProfiler = std::make_shared<Profiler>();
+        auto flowProfiler = std::make_shared<Profiler>();
+        engine.setProfiler(engineProfiler);
+        flow.setProfiler(flowProfiler);
+        REQUIRE(flow.execute(params).success);
+        REQUIRE(engineProfiler->snapshot().nodes.empty());
+        REQUIRE(findNode(flowProfiler->snapshot(), "20")->visits == 6);
+    }
+
+    SECTION("Counters of all threads are aggregated") {
+        auto profiler = std::make_shared<Profiler>();
+        flow.setProfiler(profiler);
+        std::vector<ParameterMap> batch(64, params);
+        for (const auto& result : flow.executeBatch(batch, 4)) {
+            REQUIRE(result.success);
+        }
+        ProfileStats stats = profiler->snapshot();
+        REQUIRE(stats.nodes.size() == 4);
+        REQUIRE(findNode(stats, "20")->visits == 64 * 6);
+        REQUIRE(findProcedure(stats, "tick")->calls == 64 * 5);
+    }
+}
+
+TEST_CASE("Profiler measures async PROC latency", "[profiler][async]") {
+    Engine engine;
+    ProcCompletionCallback* pending = nullptr;
+    engine.registerProcedure("fetch", [&pending](const ParameterMap&, ProcCompletionCallback& callback) {
+        pending = &callback;
+    });
+    auto flow = parse(engine, R"(
+TITLE: Fetch
+
+RETURNS:
+N data
+
+NODES:
+10 PROC fetch data<<value
+20 ASSIGN N data data * 2
+
+FLOW:
+START -> 10
+10 -> 20
+20 -> END
+)");
+    auto profiler = std::make_shared<Profiler>(Profiler::Options{true, 1 << 10});
+    flow.setProfiler(profiler);
+
+    auto context = flow.acquireContext();
+    REQUIRE_FALSE(flow.start(*context));
+    REQUIRE(pending);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ParameterMap values;
+    values["value"] = createValue(21.0);
+    (*pending)(ProcResult::completedSuccess(values));
+    auto result = flow.resume(*context);
+    REQUIRE(result);
+    REQUIRE(result->returnValues.at("data").asNumber() == 42);
+    flow.releaseContext(std::move(context));
+
+    ProfileStats stats = profiler->snapshot();
+    const auto* fetch = findProcedure(stats, "fetch");
+    REQUIRE(fetch);
+    REQUIRE(fetch->calls == 1);
+    REQUIRE(fetch->asyncCalls == 1);
+    REQUIRE(fetch->asyncTotalNanos >= 5'000'000);
+    REQUIRE(fetch->asyncLatency[ProfileStats::latencyBucket(fetch->asyncTotalNanos)] == 1);
+    REQUIRE(fetch->asyncLatencyPercentileMicros(0.99) >= 5'000);
+    REQUIRE(findNode(stats, "20")->visits == 1);
+    REQUIRE(stats.traceEvents == 3); // two node visits and the async wait
+
+    std::ostringstream trace;
+    profiler->writeChromeTrace(trace);
+    REQUIRE(trace.str().find("\"traceEvents\":[") != std::string::npos);
+    REQUIRE(trace.str().find("\"name\":\"fetch (async)\"") != std::string::npos);
+    REQUIRE(trace.str().find("\"name\":\"20 ASSIGN\",\"cat\":\"Fetch\",\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(trace.str().find("\"droppedTraceEvents\":0") != std::string::npos);
+}
+
+TEST_CASE("Profiler trace is bounded", "[profiler]") {
+    Engine engine;
+    engine.registerProcedure("tick", [](const ParameterMap&, ProcCompletionCallback& callback) {
+        callback(ProcResult::completedSuccess());
+    });
+    auto flow = parse(engine, CounterFlow);
+    auto profiler = std::make_shared<Profiler>(Profiler::Options{true, 8});
+    flow.setProfiler(profiler);
+    ParameterMap params;
+    params["limit"] = createValue(10.0);
+    REQUIRE(flow.execute(params).success);
+
+    ProfileStats stats = profiler->snapshot();
+    REQUIRE(stats.traceEvents == 8);
+    REQUIRE(stats.droppedTraceEvents == 1 + 11 + 10 + 10 - 8);
+    REQUIRE(findNode(stats, "20")->visits == 11); // counters are not bounded
+
+    std::ostringstream trace;
+    profiler->writeChromeTrace(trace);
+    REQUIRE(trace.str().find("\"droppedTraceEvents\":24") != std::string::npos);
+}
@@ -0,0 +1,151 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include <thread>
+
+using namespace FlowGraph;
+
+namespace {
+
+// Flow: 10 PROC fetch(key>>id, value<<data) -> 20 ASSIGN result = value * 2 -> END
+std::unique_ptr<FlowAST> makeFetchAST() {
+    auto ast = std::make_unique<FlowAST>();
+    ast->parameters.emplace_back("key", TypeInfo(ValueType::Number));
+    ast->returnValues.emplace_back("result", TypeInfo(ValueType::Number));
+    auto fetch = std::make_unique<ProcNode>("10", "fetch");
+    fetch->addBinding("key", "id", false);
+    fetch->addBinding("value", "data", true);
+    ast->nodes.push_back(std::move(fetch));
+    ast->nodes.push_back(std::make_unique<AssignNode>("20", TypeInfo(ValueType::Number), "result", "value * 2"));
+    ast->connections.emplace_back("START", "10");
+    ast->connections.emplace_back("10", "20");
+    ast->connections.emplace_back("20", "END");
+    return ast;
+}
+
+struct PendingCall {
+    double id;
+    ProcCompletionCallback* callback;
+};
+
+ProcResult fetchResult(double id) {
+    ParameterMap values;
+    values["data"] = createValue(id + 1);
+    return ProcResult::completedSuccess(std::move(values));
+}
+
+} // namespace
+
+TEST_CASE("FlowScheduler resumes suspended executions", "[scheduler][async]") {
+    Engine engine;
+    std::vector<PendingCall> pending;
+    engine.registerProcedure("fetch", [&pending](const ParameterMap& params, ProcCompletionCallback& callback) {
+        pending.push_back({params.at("id").asNumber(), &callback});
+    });
+    auto flow = engine.createFlow(makeFetchAST());
+    ParameterMap keyParams;
+    keyParams["key"] = createValue(1.0);
+    
+    SECTION("Synchronous execution still reports async PROCs") {
+        auto result = flow.execute(keyParams);
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "Async PROC execution not supported in synchronous mode");
+    }
+    
+    SECTION("Many executions are suspended and resumed on one thread") {
+        FlowScheduler scheduler;
+        std::vector<double> results(1000, -1);
+        for (int i = 0; i < 1000; ++i) {
+            ParameterMap params;
+            params["key"] = createValue(static_cast<double>(i));
+            scheduler.submit(flow, params, [&results, i](FlowScheduler::TaskId, const ExecutionResult& result) {
+                REQUIRE(result.success);
+                results[i] = result.returnValues.at("result").asNumber();
+            });
+        }
+        REQUIRE(scheduler.inFlight() == 1000);
+        REQUIRE(pending.size() == 1000);
+        
+        REQUIRE(scheduler.poll() == 0); // nothing completed yet
+        
+        for (size_t i = 0; i < pending.size(); i += 2) {
+            (*pending[i].callback)(fetchResult(pending[i].id));
+        }
+        REQUIRE(scheduler.poll() == 500);
+        REQUIRE(scheduler.inFlight() == 500);
+        
+        for (size_t i = 1; i < pending.size(); i += 2) {
+            (*pending[i].callback)(fetchResult(pending[i].id));
+        }
+        REQUIRE(scheduler.poll() == 500);
+        REQUIRE(scheduler.inFlight() == 0);
+        
+        for (int i = 0; i < 1000; ++i) {
+            REQUIRE(results[i] == (i + 1) * 2.0);
+        }
+    }
+    
+    SECTION("Completion errors follow error capture ports") {
+        auto ast = makeFetchAST();
+        ast->errors.emplace_back("MISSING");
+        ast->connections.emplace_back("10", "MISSING", "MISSING");
+        auto capturing = engine.createFlow(std::move(ast));
+        
+        FlowScheduler scheduler;
+        std::string error;
+        scheduler.submit(capturing, keyParams, [&error](FlowScheduler::TaskId, const ExecutionResult& result) {
+            error = result.error;
+        });
+        (*pending.at(0).callback)(ProcResult::completedError("MISSING"));
+        REQUIRE(scheduler.poll() == 1);
+        REQUIRE(error == "MISSING");
+    }
+}
+
+TEST_CASE("FlowScheduler with synchronous and threaded completions", "[scheduler][async]") {
+    SECTION("Flows that finish synchronously complete inside submit") {
+        Engine engine;
+        engine.registerProcedure("fetch", [](const ParameterMap& params, ProcCompletionCallback& callback) {
+            callback(fetchResult(params.at("id").asNumber()));
+        });
+        auto flow = engine.createFlow(makeFetchAST());
+        
+        FlowScheduler scheduler;
+        double result = 0;
+        ParameterMap params;
+        params["key"] = createValue(4.0);
+        scheduler.submit(flow, params, [&result](FlowScheduler::TaskId, const ExecutionResult& r) {
+            result = r.returnValues.at("result").asNumber();
+        });
+        REQUIRE(result == 10.0);
+        REQUIRE(scheduler.inFlight() == 0);
+        REQUIRE(scheduler.poll() == 0); // synchronous completions are never queued
+    }
+    
+    SECTION("run() waits for completions from worker threads") {
+        Engine engine;
+        std::vector<std::thread> workers;
+        engine.registerProcedure("fetch", [&workers](const ParameterMap& params, ProcCompletionCallback& callback) {
+            double id = params.at("id").asNumber();
+            workers.emplace_back([id, &callback] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                callback(fetchResult(id));
+            });
+        });
+        auto flow = engine.createFlow(makeFetchAST());
+        
+        FlowScheduler scheduler;
+        double sum = 0;
+        for (int i = 0; i < 8; ++i) {
+            ParameterMap params;
+            params["key"] = createValue(static_cast<double>(i));
+            scheduler.submit(flow, params, [&sum](FlowScheduler::TaskId, const ExecutionResult& r) {
+                sum += r.returnValues.at("result").asNumber();
+            });
+        }
+        REQUIRE(scheduler.run() == 8);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        REQUIRE(sum == 2.0 * (1 + 2 + 3 + 4 + 5 + 6 + 7 + 8));
+    }
+}
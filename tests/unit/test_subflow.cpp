@@ -0,0 +1,275 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <filesystem>
+#include <fstream>
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+// n = x + 1, optionally through another module
+std::string incrementSource(const std::string& next) {
+    std::string nodes = next.empty() ? "10 ASSIGN I n x + 1\n"
+                                     : "10 PROC " + next + " x>>x n<<n\n20 ASSIGN I n n + 1\n";
+    std::string flow = next.empty() ? "START -> 10\n10 -> END\n" : "START -> 10\n10 -> 20\n20 -> END\n";
+    return "TITLE: Increment\n\nPARAMS:\nI x\n\nRETURNS:\nI n\n\nNODES:\n" + nodes + "\nFLOW:\n" + flow;
+}
+
+const char* checkSource = R"(
+TITLE: Check
+
+PARAMS:
+I value
+
+RETURNS:
+S status
+
+ERRORS:
+NEGATIVE
+
+NODES:
+10 COND value < 0
+20 ASSIGN S status "ok"
+
+FLOW:
+START -> 10
+10.Y -> NEGATIVE
+10.N -> 20
+20 -> END
+)";
+
+const char* callerSource = R"(
+TITLE: Caller
+
+PARAMS:
+I input
+
+RETURNS:
+S status
+
+NODES:
+10 PROC check.flow input>>value status<<status
+20 ASSIGN S status "rejected"
+
+FLOW:
+START -> 10
+10 -> END
+10.NEGATIVE -> 20
+20 -> END
+)";
+
+} // namespace
+
+TEST_CASE("Sub-flow calls run natively", "[subflow]") {
+    Engine engine;
+
+    SECTION("Inputs and RETURNS are bound through the call") {
+        engine.registerModule("inc.flow", parse(engine, incrementSource(""), "inc.flow"));
+        auto main = parse(engine, incrementSource("inc.flow"), "main.flow");
+        REQUIRE(main.validate().empty());
+
+        ParameterMap params;
+        params["x"] = createValue(40.0);
+        auto result = main.execute(params);
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("n").asNumber() == 42);
+
+        // The callee frame is reused by the next execution
+        params["x"] = createValue(1.0);
+        REQUIRE(main.execute(params).returnValues.at("n").asNumber() == 3);
+    }
+
+    SECTION("Calls nest several levels deep") {
+        engine.registerModule("level0.flow", parse(engine, incrementSource(""), "level0.flow"));
+        for (int level = 1; level <= 6; ++level) {
+            std::string name = "level" + std::to_string(level) + ".flow";
+            engine.registerModule(name, parse(engine, incrementSource("level" + std::to_string(level - 1) + ".flow"), name));
+        }
+        auto top = *engine.findModule("level6.flow");
+
+        ParameterMap params;
+        params["x"] = createValue(0.0);
+        auto result = top.execute(params);
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("n").asNumber() == 7);
+    }
+
+    SECTION("Errors emitted by the callee are routed like PROC errors") {
+        engine.registerModule("check.flow", parse(engine, checkSource, "check.flow"));
+        auto caller = parse(engine, callerSource, "caller.flow");
+
+        ParameterMap params;
+        params["input"] = createValue(5.0);
+        REQUIRE(caller.execute(params).returnValues.at("status").asString() == "ok");
+
+        params["input"] = createValue(-5.0);
+        auto result = caller.execute(params);
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("status").asString() == "rejected");
+
+        // Without a capture port the call fails
+        std::string uncaughtSource = callerSource;
+        uncaughtSource.erase(uncaughtSource.find("10.NEGATIVE -> 20\n"), std::string("10.NEGATIVE -> 20\n").size());
+        auto uncaught = parse(engine, uncaughtSource, "uncaught.flow");
+        auto failed = uncaught.execute(params);
+        REQUIRE_FALSE(failed.success);
+        REQUIRE(failed.error == "Execution error: PROC execution failed: NEGATIVE");
+    }
+
+    SECTION("Modules registered after the caller are linked on first call") {
+        auto main = parse(engine, incrementSource("late.flow"), "main.flow");
+        REQUIRE(main.validate() == std::vector<std::string>{"Module not found: late.flow (node 10)"});
+        REQUIRE(main.execute().error == "Execution error: Module not found: late.flow");
+
+        engine.registerModule("late.flow", parse(engine, incrementSource(""), "late.flow"));
+        ParameterMap params;
+        params["x"] = createValue(1.0);
+        REQUIRE(main.execute(params).returnValues.at("n").asNumber() == 3);
+        REQUIRE(main.validate().empty());
+    }
+
+    SECTION("Runaway recursion is stopped") {
+        engine.registerModule("loop.flow", parse(engine, incrementSource("loop.flow"), "loop.flow"));
+        auto result = engine.findModule("loop.flow")->execute();
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error == "Execution error: Sub-flow call depth exceeded: loop.flow");
+    }
+}
+
+TEST_CASE("Async PROCs inside sub-flows suspend the whole execution", "[subflow][async]") {
+    Engine engine;
+    ProcCompletionCallback* pending = nullptr;
+    engine.registerProcedure("fetch", [&pending](const ParameterMap&, ProcCompletionCallback& callback) {
+        pending = &callback;
+    });
+    engine.registerModule("fetch.flow", parse(engine, R"(
+TITLE: Fetch
+
+RETURNS:
+I data
+
+NODES:
+10 PROC fetch data<<value
+20 ASSIGN I data data * 2
+
+FLOW:
+START -> 10
+10 -> 20
+20 -> END
+)", "fetch.flow"));
+    auto caller = parse(engine, R"(
+TITLE: Caller
+
+RETURNS:
+I result
+
+NODES:
+10 PROC fetch.flow result<<data
+20 ASSIGN I result result + 1
+
+FLOW:
+START -> 10
+10 -> 20
+20 -> END
+)", "caller.flow");
+
+    auto context = caller.acquireContext();
+    REQUIRE_FALSE(caller.start(*context));
+    REQUIRE(context->isWaitingForAsync());
+    REQUIRE(context->getWaitingAsyncProc() == "fetch");
+    REQUIRE(context->callDepth() == 1);
+    REQUIRE_FALSE(caller.resume(*context)); // not completed yet
+
+    ParameterMap values;
+    values["value"] = createValue(20.0);
+    (*pending)(ProcResult::completedSuccess(values));
+    auto result = caller.resume(*context);
+    REQUIRE(result);
+    REQUIRE(result->success);
+    REQUIRE(result->returnValues.at("result").asNumber() == 41);
+    REQUIRE(context->callDepth() == 0);
+    caller.releaseContext(std::move(context));
+}
+
+TEST_CASE("loadDirectory links module calls", "[subflow][library][file]") {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "flowgraph_subflow_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "math");
+    std::ofstream(dir / "main.flow") << incrementSource("math/inc.flow");
+    std::ofstream(dir / "math" / "inc.flow") << incrementSource("base.flow");
+    std::ofstream(dir / "math" / "base.flow") << incrementSource("");
+
+    FlowGraphEngine engine;
+    auto loaded = engine.loadDirectory(dir.string());
+    REQUIRE(loaded.success());
+
+    ParameterMap params;
+    params["x"] = createValue(10.0);
+    auto result = engine.getModule("main.flow")->execute(params);
+    REQUIRE(result.success);
+    REQUIRE(result.returnValues.at("n").asNumber() == 13);
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Replaced modules are freed once nothing holds them", "[subflow]") {
+    Engine engine;
+    ProcCompletionCallback* pending = nullptr;
+    engine.registerProcedure("wait", [&pending](const ParameterMap&, ProcCompletionCallback& callback) {
+        pending = &callback;
+    });
+
+    SECTION("Links hold the version they were made to") {
+        engine.registerModule("inc.flow", parse(engine, incrementSource(""), "inc.flow"));
+        auto main = parse(engine, incrementSource("inc.flow"), "main.flow");
+        std::weak_ptr<const Flow> first = engine.resolveModule("", "inc.flow");
+
+        engine.registerModule("inc.flow", parse(engine, incrementSource(""), "inc.flow"));
+        REQUIRE_FALSE(first.expired());
+        main.linkModules();
+        REQUIRE(first.expired());
+    }
+
+    SECTION("Modules calling themselves are freed with the engine") {
+        std::weak_ptr<const Flow> loop;
+        {
+            Engine owner;
+            owner.registerModule("loop.flow", parse(owner, incrementSource("loop.flow"), "loop.flow"));
+            loop = owner.resolveModule("", "loop.flow");
+            REQUIRE_FALSE(owner.findModule("loop.flow")->execute().success);
+
+            owner.registerModule("loop.flow", parse(owner, incrementSource(""), "loop.flow"));
+            REQUIRE_FALSE(loop.expired());
+        }
+        REQUIRE(loop.expired());
+    }
+
+    SECTION("A call suspended in a replaced module finishes on it") {
+        std::string waitSource = incrementSource("");
+        waitSource.replace(waitSource.find("10 ASSIGN I n x + 1"), 19, "10 PROC wait n<<n");
+        engine.registerModule("inc.flow", parse(engine, waitSource, "inc.flow"));
+        auto main = parse(engine, incrementSource("inc.flow"), "main.flow");
+        std::weak_ptr<const Flow> first = engine.resolveModule("", "inc.flow");
+
+        auto context = main.acquireContext();
+        REQUIRE_FALSE(main.start(*context));
+        engine.registerModule("inc.flow", parse(engine, incrementSource(""), "inc.flow"));
+        main.linkModules();
+        REQUIRE_FALSE(first.expired());
+
+        ParameterMap values;
+        values["n"] = createValue(5.0);
+        (*pending)(ProcResult::completedSuccess(values));
+        auto result = main.resume(*context);
+        REQUIRE(result);
+        REQUIRE(result->returnValues.at("n").asNumber() == 6);
+        REQUIRE(first.expired());
+
+        ParameterMap params;
+        params["x"] = createValue(1.0);
+        REQUIRE(main.execute(params).returnValues.at("n").asNumber() == 3);
+        main.releaseContext(std::move(context));
+    }
+}
@@ -0,0 +1,227 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+// Counts i up to limit, calling tick in every iteration: 3 * limit + 2 nodes
+const char* const CountFlow = R"(
+TITLE: Count
+
+PARAMS:
+N limit
+N id
+
+RETURNS:
+N i
+
+NODES:
+10 ASSIGN N i 0
+20 COND i < limit
+30 PROC tick id>>id
+40 ASSIGN N i i + 1
+
+FLOW:
+START -> 10
+10 -> 20
+20.Y -> 30
+20.N -> END
+30 -> 40
+40 -> 20
+)";
+
+ParameterMap countParams(double limit, double id = 0) {
+    ParameterMap params;
+    params["limit"] = createValue(limit);
+    params["id"] = createValue(id);
+    return params;
+}
+
+// Records the id of every call
+ProcDefinition tick(std::vector<int>& calls) {
+    ProcDefinition definition;
+    definition.implementation = [&calls](const ParameterMap& params, ProcCompletionCallback& callback) {
+        calls.push_back(static_cast<int>(params.at("id").asNumber()));
+        callback(ProcResult::completedSuccess());
+    };
+    return definition;
+}
+
+} // namespace
+
+TEST_CASE("executeFor runs an execution within a budget", "[budget]") {
+    Engine engine;
+    std::vector<int> calls;
+    engine.registerProcedure("tick", tick(calls));
+    auto flow = parse(engine, CountFlow);
+    auto context = flow.acquireContext();
+
+    SECTION("A step budget pauses the execution and the next call continues it") {
+        // 10 ASSIGN, 4 x (COND, PROC, ASSIGN), final COND: 14 nodes
+        size_t runs = 0;
+        std::optional<ExecutionResult> result;
+        while (!result) {
+            result = flow.executeFor(*context, ExecutionBudget::steps(5), countParams(4));
+            ++runs;
+            if (!result) {
+                REQUIRE(context->getState() == ExecutionState::Paused);
+            }
+        }
+        REQUIRE(runs == 3);
+        REQUIRE(result->success);
+        REQUIRE(result->returnValues.at("i").asNumber() == 4);
+    }
+
+    SECTION("Parameters are only bound when an execution starts") {
+        REQUIRE_FALSE(flow.executeFor(*context, ExecutionBudget::steps(2), countParams(3)));
+        auto result = flow.executeFor(*context, ExecutionBudget::steps(100), countParams(100));
+        REQUIRE(result);
+        REQUIRE(result->returnValues.at("i").asNumber() == 3);
+
+        result = flow.executeFor(*context, ExecutionBudget::steps(100), countParams(5));
+        REQUIRE(result->returnValues.at("i").asNumber() == 5); // a finished context starts over
+    }
+
+    SECTION("A passed deadline still runs one node per call") {
+        auto past = ExecutionBudget::until(ExecutionBudget::Clock::now());
+        size_t paused = 0;
+        while (!flow.executeFor(*context, past, countParams(2))) {
+            ++paused;
+        }
+        REQUIRE(paused == 7); // 8 nodes
+    }
+
+    SECTION("An unlimited budget runs to the end") {
+        auto result = flow.executeFor(*context, ExecutionBudget{}, countParams(1000));
+        REQUIRE(result);
+        REQUIRE(result->returnValues.at("i").asNumber() == 1000);
+    }
+
+    SECTION("A paused context can be abandoned") {
+        REQUIRE_FALSE(flow.executeFor(*context, ExecutionBudget::steps(3), countParams(10)));
+        flow.releaseContext(std::move(context));
+        REQUIRE(flow.execute(countParams(2)).returnValues.at("i").asNumber() == 2);
+    }
+
+    if (context) {
+        flow.releaseContext(std::move(context));
+    }
+}
+
+TEST_CASE("executeFor waits for async PROCs", "[budget][async]") {
+    Engine engine;
+    ProcCompletionCallback* pending = nullptr;
+    ProcDefinition fetch;
+    fetch.implementation = [&pending](const ParameterMap&, ProcCompletionCallback& callback) {
+        pending = &callback;
+    };
+    engine.registerProcedure("fetch", fetch);
+    auto flow = parse(engine, R"(
+TITLE: Fetch
+RETURNS:
+N total
+NODES:
+10 ASSIGN N total 1
+20 PROC fetch total<<value
+30 ASSIGN N total total + 1
+40 ASSIGN N total total * 2
+FLOW:
+START -> 10
+10 -> 20
+20 -> 30
+30 -> 40
+40 -> END
+)");
+    auto context = flow.acquireContext();
+
+    REQUIRE_FALSE(flow.executeFor(*context, ExecutionBudget::steps(5)));
+    REQUIRE(context->isWaitingForAsync());
+    REQUIRE_FALSE(flow.executeFor(*context, ExecutionBudget::steps(5))); // not completed yet
+    REQUIRE(context->isWaitingForAsync());
+
+    ParameterMap values;
+    values["value"] = createValue(10.0);
+    (*pending)(ProcResult::completedSuccess(values));
+    REQUIRE_FALSE(flow.executeFor(*context, ExecutionBudget::steps(1)));
+    REQUIRE(context->getState() == ExecutionState::Paused);
+    auto result = flow.executeFor(*context, ExecutionBudget::steps(1));
+    REQUIRE(result);
+    REQUIRE(result->returnValues.at("total").asNumber() == 22);
+    flow.releaseContext(std::move(context));
+}
+
+TEST_CASE("FlowScheduler shares frames between sliced executions", "[budget][scheduler]") {
+    Engine engine;
+    std::vector<int> calls;
+    engine.registerProcedure("tick", tick(calls));
+    auto flow = parse(engine, CountFlow);
+    FlowScheduler scheduler;
+    scheduler.setTimeSlice(30); // 10 loop iterations
+
+    SECTION("Executions take turns") {
+        std::vector<double> results;
+        for (int id = 0; id < 3; ++id) {
+            scheduler.submit(flow, countParams(50, id), [&results](FlowScheduler::TaskId, const ExecutionResult& result) {
+                results.push_back(result.returnValues.at("i").asNumber());
+            });
+        }
+        REQUIRE(calls.empty()); // queued until the scheduler runs
+        REQUIRE(scheduler.ready() == 3);
+
+        REQUIRE(scheduler.poll() == 3);
+        REQUIRE(results == std::vector<double>{50, 50, 50});
+        REQUIRE(calls.size() == 150);
+        // Never more than one slice of calls in a row
+        size_t run = 1, longest = 1;
+        for (size_t i = 1; i < calls.size(); ++i) {
+            run = calls[i] == calls[i - 1] ? run + 1 : 1;
+            longest = std::max(longest, run);
+        }
+        REQUIRE(longest <= 10);
+        REQUIRE(calls[9] == 0);
+        REQUIRE(calls[10] == 1);
+    }
+
+    SECTION("A frame budget stops long executions and the next frame continues them") {
+        size_t finished = 0;
+        scheduler.submit(flow, countParams(1e6), [&finished](FlowScheduler::TaskId, const ExecutionResult&) { ++finished; });
+        scheduler.submit(flow, countParams(3), [&finished](FlowScheduler::TaskId, const ExecutionResult&) { ++finished; });
+
+        auto start = std::chrono::steady_clock::now();
+        REQUIRE(scheduler.runFrame(std::chrono::milliseconds(2)) == 1); // the short one finished in its first turn
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500));
+        REQUIRE(scheduler.inFlight() == 1);
+        REQUIRE(scheduler.ready() == 1);
+
+        size_t before = calls.size();
+        REQUIRE(scheduler.runFrame(std::chrono::milliseconds(2)) == 0);
+        REQUIRE(calls.size() > before);
+        REQUIRE(scheduler.runFrame(std::chrono::milliseconds(0)) == 0);
+    }
+
+    SECTION("Async completions rejoin the queue") {
+        ProcCompletionCallback* pending = nullptr;
+        ProcDefinition wait;
+        wait.implementation = [&pending](const ParameterMap&, ProcCompletionCallback& callback) {
+            pending = &callback;
+        };
+        engine.registerProcedure("tick", wait);
+        std::optional<ExecutionResult> result;
+        scheduler.submit(parse(engine, CountFlow), countParams(1),
+                         [&result](FlowScheduler::TaskId, const ExecutionResult& finished) { result = finished; });
+        REQUIRE(scheduler.runFrame(std::chrono::milliseconds(10)) == 0);
+        REQUIRE(pending);
+        REQUIRE(scheduler.ready() == 0);
+
+        (*pending)(ProcResult::completedSuccess());
+        REQUIRE(scheduler.runFrame(std::chrono::milliseconds(10)) == 1);
+        REQUIRE(result->returnValues.at("i").asNumber() == 1);
+    }
+}
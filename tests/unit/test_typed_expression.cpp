@@ -0,0 +1,197 @@
+#include <catch2/catch_test_macros.hpp>
+#include "flowgraph/FlowGraph.hpp"
+#include "TestHelpers.hpp"
+#include <unordered_map>
+
+using namespace FlowGraph;
+using FlowGraph::test::parse;
+
+namespace {
+
+struct TestScope : TypedExpression::Scope {
+    std::unordered_map<std::string, std::pair<uint32_t, StaticType>> variables;
+
+    void add(const std::string& name, StaticType type) {
+        variables[name] = {static_cast<uint32_t>(variables.size()), type};
+    }
+
+    std::optional<uint32_t> slot(std::string_view name) const override {
+        auto it = variables.find(std::string(name));
+        if (it == variables.end()) {
+            return std::nullopt;
+        }
+        return it->second.first;
+    }
+
+    StaticType type(uint32_t slot) const override {
+        for (const auto& entry : variables) {
+            if (entry.second.first == slot) {
+                return entry.second.second;
+            }
+        }
+        return StaticType::Unknown;
+    }
+};
+
+} // namespace
+
+TEST_CASE("Typed expressions compile the Number/Boolean subset", "[typed][expression]") {
+    TestScope scope;
+    scope.add("x", StaticType::Number);
+    scope.add("flag", StaticType::Boolean);
+    scope.add("any", StaticType::Unknown);
+    std::vector<Value> values = {Value(4.0), Value(true), Value(2.0)};
+    auto lookup = [&values](SlotIndex slot) -> const Value* { return slot < values.size() ? &values[slot] : nullptr; };
+
+    SECTION("Literal subexpressions are folded") {
+        auto folded = TypedExpression::compile("2 + 3 * 4", scope);
+        REQUIRE(folded);
+        REQUIRE(folded->isConstant());
+        REQUIRE(folded->type() == StaticType::Number);
+        REQUIRE(folded->code()[0].value == 14);
+
+        auto partial = TypedExpression::compile("x * (10 - 4) / 2", scope);
+        REQUIRE(partial);
+        REQUIRE(partial->code().size() == 5); // x, 6, *, 2, /
+
+        REQUIRE(TypedExpression::compile("!(1 < 2) || 3 == 3", scope)->isConstant());
+        REQUIRE(TypedExpression::compile("true ? 1 : 2", scope)->code()[0].value == 1);
+
+        // Division by zero is left for run time
+        REQUIRE_FALSE(TypedExpression::compile("1 / 0", scope)->isConstant());
+    }
+
+    SECTION("Compiled code evaluates like ExpressionKit") {
+        Value result;
+        REQUIRE(TypedExpression::compile("x * 2 + 1 > 8 && flag", scope)->evaluate(lookup, result));
+        REQUIRE(result.isBoolean());
+        REQUIRE(result.asBoolean());
+
+        REQUIRE(TypedExpression::compile("flag ? -x : x", scope)->evaluate(lookup, result));
+        REQUIRE(result.asNumber() == -4);
+
+        REQUIRE(TypedExpression::compile("any - x / 8", scope, StaticType::Number)->evaluate(lookup, result));
+        REQUIRE(result.asNumber() == 1.5);
+
+        REQUIRE(TypedExpression::compile("x != 4 == false", scope)->evaluate(lookup, result));
+        REQUIRE(result.asBoolean());
+    }
+
+    SECTION("Unexpected values and errors are left to the generic evaluator") {
+        Value result;
+        values[0] = Value(std::string("text"));
+        REQUIRE_FALSE(TypedExpression::compile("x + 1", scope)->evaluate(lookup, result));
+
+        values[0] = Value(4.0);
+        REQUIRE_FALSE(TypedExpression::compile("x / (x - 4)", scope)->evaluate(lookup, result));
+
+        values.resize(1); // flag is unset
+        REQUIRE_FALSE(TypedExpression::compile("x > 1 || flag", scope)->evaluate(lookup, result));
+    }
+
+    SECTION("Expressions outside the subset are not compiled") {
+        for (const char* text : {"\"a\" + \"b\"", "max(x, 1)", "x % 2", "unknown + 1", "1e3", "x +", "any",
+                                 "any == any", "x + flag", "(x"}) {
+            INFO(text);
+            REQUIRE_FALSE(TypedExpression::compile(text, scope));
+        }
+        REQUIRE_FALSE(TypedExpression::compile("x > 1", scope, StaticType::Number));
+    }
+}
+
+TEST_CASE("Flows use typed fast paths", "[typed][compiled]") {
+    Engine engine;
+
+    SECTION("ASSIGN and COND nodes get typed code") {
+        auto flow = parse(engine, R"(
+TITLE: Typed
+
+PARAMS:
+N x
+S text
+
+RETURNS:
+N y
+B big
+S label
+
+NODES:
+10 ASSIGN N y 2 + 3 * 4
+20 ASSIGN N y y + x * 2
+30 ASSIGN B big y > 20
+40 COND big && x >= 0
+50 ASSIGN S label text + "!"
+
+FLOW:
+START -> 10
+10 -> 20
+20 -> 30
+30 -> 40
+40.Y -> 50
+40.N -> END
+50 -> END
+)");
+        REQUIRE(flow.validate().empty());
+        const CompiledFlow& program = flow.getProgram();
+        REQUIRE(program.node(0).typed->isConstant());
+        REQUIRE(program.node(1).typed);
+        REQUIRE(program.node(2).typed->type() == StaticType::Boolean);
+        REQUIRE(program.node(3).typed);
+        REQUIRE_FALSE(program.node(4).typed);
+
+        ParameterMap params;
+        params["x"] = createValue(4.0);
+        params["text"] = createValue(std::string("big"));
+        auto result = flow.execute(params);
+        REQUIRE(result.success);
+        REQUIRE(result.returnValues.at("y").asNumber() == 22);
+        REQUIRE(result.returnValues.at("big").asBoolean());
+        REQUIRE(result.returnValues.at("label").asString() == "big!");
+    }
+
+    SECTION("Errors are reported by the generic evaluator") {
+        auto flow = parse(engine, R"(
+TITLE: Division
+
+PARAMS:
+N x
+
+RETURNS:
+N y
+
+NODES:
+10 ASSIGN N y 1 / x
+
+FLOW:
+START -> 10
+10 -> END
+)");
+        ParameterMap params;
+        params["x"] = createValue(0.0);
+        auto result = flow.execute(params);
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.error.find("Division by zero") != std::string::npos);
+        REQUIRE_FALSE(flow.execute().success); // x unset
+    }
+
+    SECTION("ASSIGN types are checked against the expression") {
+        auto flow = parse(engine, R"(
+TITLE: Mismatch
+
+PARAMS:
+N x
+
+NODES:
+10 ASSIGN N positive x > 0
+20 ASSIGN S text x + 1
+
+FLOW:
+START -> 10
+10 -> 20
+20 -> END
+)");
+        REQUIRE(flow.validate() == std::vector<std::string>{
+            "Type mismatch in node 10: positive is declared N but the expression is Boolean",
+            "Type mismatch in node 20: text is declared S but the expression is Number"});
+    }
+}